@@ -0,0 +1,64 @@
+//
+// Created by ottohesl on 26-1-14.
+//
+
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "NAV_Filter.h"
+
+/************************ 航点与制导参数 ************************/
+#define AP_MAX_WAYPOINTS      32        // 航点表容量（RAM）
+#define AP_ACCEPT_RADIUS      5.0f      // 默认到达半径（m）
+#define AP_LOOKAHEAD          8.0f      // 航迹偏差修正前视距离（m），越小纠偏越猛
+#define AP_CONTROL_DT         0.01f     // 控制周期（s），与控制任务周期一致
+
+/************************ 航向PID参数 ************************/
+#define AP_HEADING_KP         1.2f      // 航向误差(°) -> 偏航角速度(°/s)
+#define AP_HEADING_KI         0.05f     // 积分增益（1/s）
+#define AP_HEADING_KD         0.1f      // 微分增益（s）
+#define AP_YAW_RATE_MAX       30.0f     // 偏航角速度设定限幅（°/s）
+
+/************************ 速度设定 ************************/
+#define AP_SPEED_CRUISE       6         // 巡航摆动速度档（与steering的speed一致，2-10）
+#define AP_SPEED_TURN         2         // 航向误差大时的低速档
+#define AP_TURN_ERROR         45.0f     // 超过该航向误差（°）时降速转向
+
+/************************ 结构体定义 ************************/
+// 航点（经纬度，1e-7度）
+typedef struct {
+    int32_t latitude;                   // 纬度，1e-7度
+    int32_t longitude;                  // 经度，1e-7度
+    float radius;                       // 到达半径，m（0=使用AP_ACCEPT_RADIUS）
+} AP_Waypoint_t;
+
+// 自动驾驶输出与状态
+typedef struct {
+    float yaw_rate;                     // 偏航角速度设定，°/s，顺时针为正
+    uint8_t speed;                      // 摆动速度档设定
+    bool active;                        // true=正在跟踪航点
+    uint8_t wp_index;                   // 当前目标航点序号
+    float distance;                     // 到目标航点距离，m
+    float bearing;                      // 到目标航点方位，°（0=北，顺时针）
+    float cross_track;                  // 航迹偏差，m（航线右侧为正）
+    float heading_error;                // 航向误差，°
+} AP_Output_t;
+
+/************************ 函数声明 ************************/
+// 初始化（PID参数、清空航点表）
+void AP_Init(void);
+// 清空航点表
+void AP_Clear_Waypoints(void);
+// 追加航点，返回false表示航点表已满
+bool AP_Add_Waypoint(int32_t latitude, int32_t longitude, float radius);
+// 重新开始跟踪（从第一个航点开始，清PID状态）
+void AP_Restart(void);
+// 控制周期调用：输入导航状态和航向，输出偏航角速度与速度设定
+void AP_Step(const NAV_State_t *nav, float heading, AP_Output_t *out);
+
+/************************ 全局变量声明 ************************/
+extern AP_Output_t ap_output;
+
+#endif //AUTOPILOT_H
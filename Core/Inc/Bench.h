@@ -0,0 +1,79 @@
+//
+// Created by ottohesl on 26-1-27.
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define BENCH_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (BENCH_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (BENCH_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (BENCH_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+// 基准测试镜像：1=main在外设初始化后进入Bench_Main，不启动传感器DMA与调度器（CMake目标FISH_H7_bench）
+#ifndef BENCH_ENABLE
+#define BENCH_ENABLE 0
+#endif
+
+/************************ 测试参数 ************************/
+#define BENCH_WARMUP          3U              // 每个用例正式测量前的预热次数（缓存、分支预测与解析器状态就位）
+#define BENCH_RUNS            31U             // 每个用例的测量次数（奇数，中位数取排序后的中间一次）
+#define BENCH_PERIOD_MS       5000U           // 板上每轮之间的间隔（上位机随时连接都能收到完整一轮）
+
+/************************ 缓存状态 ************************/
+typedef enum {
+    BENCH_CACHE_WARM = 0,               // 热缓存：预热后直接测量
+    BENCH_CACHE_COLD,                   // 冷缓存：每次测量前写回并作废D缓存、作废I缓存（ITCM/DTCM中的不受影响）
+    BENCH_CACHE_OFF                     // 关缓存：整个用例期间关闭I/D缓存
+} Bench_Cache_t;
+
+/************************ 结构体定义 ************************/
+// 测试用例（用BENCH_CASE注册，不要直接定义）
+typedef struct {
+    const char *name;                   // 用例名（上位机按名称比较）
+    void (*setup)(void);                // 每次测量前调用，不计时（准备输入、复位状态），可为NULL
+    void (*run)(void);                  // 被测内核
+    uint16_t batch;                     // 每次测量连续调用run的次数，结果按单次折算（短内核用来摊薄计时开销）
+    uint8_t cache;                      // Bench_Cache_t
+} Bench_Case_t;
+
+// 单个用例的结果：单次调用耗时（板上为CPU周期，主机为纳秒）
+typedef struct {
+    uint32_t min;
+    uint32_t median;
+    uint32_t max;
+    uint32_t overhead;                  // 已扣除的计时开销（一次空测量）
+} Bench_Result_t;
+
+/************************ 注册宏 ************************/
+// 注册一个用例：setup_fn可为NULL，batch_n为0按1；用例表放在bench_cases段，各文件中的用例由链接器汇总
+// 段中只放指针（各平台对齐一致），板上由链接脚本保留并给出__start/__stop符号，主机由链接器自动生成
+#define BENCH_CASE(id, setup_fn, run_fn, batch_n, cache_mode)                                       \
+    static const Bench_Case_t bench_case_##id = {#id, (setup_fn), (run_fn), (batch_n), (cache_mode)}; \
+    static const Bench_Case_t *const bench_ref_##id                                                 \
+        __attribute__((used, section("bench_cases"))) = &bench_case_##id
+
+// 防止被测结果被编译器优化掉：写入一个volatile变量
+#define BENCH_SINK(v)         (bench_sink = (uint32_t)(v))
+
+/************************ 函数声明 ************************/
+// 用例表（链接器汇总的全部用例，count返回个数）
+const Bench_Case_t *const *Bench_Cases(uint32_t *count);
+// 升序排序后取最小/中位/最大（samples会被重排）
+void Bench_Summary(uint32_t *samples, uint32_t n, Bench_Result_t *result);
+#if BENCH_ENABLE
+// 板上基准测试主循环（外设初始化后调用，不返回）：每BENCH_PERIOD_MS运行全部用例，结果打印到调试串口
+void Bench_Main(void);
+#endif
+
+/************************ 全局变量声明 ************************/
+extern volatile uint32_t bench_sink;
+
+#endif //BENCH_H
@@ -0,0 +1,90 @@
+//
+// Created by ottohesl on 26-1-19.
+//
+
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "Telemetry.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define BLACKBOX_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (BLACKBOX_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (BLACKBOX_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (BLACKBOX_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 记录区参数 ************************/
+// 记录区占用内部Flash后半（扇区4-7），链接脚本中FLASH长度相应缩为512K
+#define BB_FLASH_BASE         0x08080000U     // 记录区起始地址
+#define BB_SECTOR_FIRST       4               // 记录区第一个扇区号
+#define BB_SECTOR_COUNT       4               // 扇区数（环形轮换）
+#define BB_SECTOR_SIZE        (128U * 1024U)  // 扇区大小（字节）
+#define BB_WORD_SIZE          32U             // Flash字（最小编程单位，字节）
+#define BB_MAGIC              0x58424246U     // 扇区头标识"FBBX"
+
+/************************ 缓冲与调度参数 ************************/
+#define BB_BUFFER_SIZE        1024U           // 单个RAM缓冲大小（字节，Flash字的整数倍）
+#define BB_BUFFER_COUNT       12U             // RAM缓冲个数（环形）：预擦除一个扇区（约1s）期间不能编程，
+                                              // 默认记录频率约7KB/s，12KB可撑约1.5s不丢记录
+#define BB_ERASE_AHEAD        2               // 鱼停止时预先擦除的扇区数（运动中写满已擦除扇区后暂停记录）
+#define BB_ERASE_WHILE_RUNNING 0              // 1=运动中也允许擦除（擦除期间取指停顿，会造成控制周期抖动）
+#define BB_SERVICE_PERIOD_MS  100             // 后台任务无通知时的最长等待（ms）
+#define BB_FLAG_WRITE         0x0001U         // 后台任务线程标志：有缓冲待写/有请求
+
+/************************ 结构体定义 ************************/
+// 记录器状态
+typedef enum {
+    BB_STATE_OFF = 0,                   // 未初始化
+    BB_STATE_RECORDING,                 // 记录中
+    BB_STATE_FULL,                      // 已擦除扇区用完，等鱼停止擦除后继续
+    BB_STATE_FLUSH,                     // 导出请求：等待控制任务交出半满缓冲
+    BB_STATE_DUMPING,                   // 导出中（暂停记录）
+} BB_State_t;
+
+// 扇区头（占扇区第一个Flash字）
+typedef struct {
+    uint32_t magic;                     // BB_MAGIC
+    uint32_t generation;                // 写入代数（每换一个扇区加1，上电后接着最大值）
+    uint32_t session;                   // 上电会话号
+    uint32_t erase_count;               // 该扇区累计擦除次数
+    uint32_t boot_tick;                 // 开始写该扇区时的系统时间，ms
+    uint32_t reserved[2];
+    uint32_t crc;                       // 前28字节的CRC32
+} BB_SectorHeader_t;
+
+// 记录统计
+typedef struct {
+    uint32_t records;                   // 已写入缓冲的记录条数
+    uint32_t dropped;                   // 丢弃的记录条数
+    uint32_t lost_bytes;                // 已进缓冲但因无已擦除扇区未能写入的字节数
+    uint32_t flash_bytes;               // 已编程的字节数（含扇区头）
+    uint32_t flash_errors;              // 编程/擦除失败次数
+    uint32_t program_cycles_max;        // 单个Flash字编程最大CPU周期
+    uint16_t erases;                    // 擦除次数
+    uint16_t erase_ms_max;              // 单次擦除最长耗时，ms
+    uint32_t dump_words;                // 本次导出已发送的Flash字数
+} BB_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（扫描扇区头、开新会话并擦除首个扇区，需在MX_CRC_Init之后、调度器启动前调用）
+void BlackBox_Init(void);
+// 设置某类消息的记录频率（Hz，0=不记录）
+void BlackBox_Set_Rate(TLM_MsgType_t type, uint16_t rate_hz);
+// 控制任务周期调用：按频率表采样并写入RAM缓冲
+void BlackBox_Process(uint32_t now_ms);
+// 后台任务循环体：写满的缓冲编程到Flash、预擦除、导出
+void BlackBox_Service(void);
+// 请求导出（经遥测BB_DATA消息发送全部记录），返回false表示正在导出或未初始化
+bool BlackBox_Request_Dump(void);
+// 填写状态消息
+void BlackBox_Get_Status(TLM_BB_Status_t *status);
+
+/************************ 全局变量声明 ************************/
+extern BB_Stats_t bb_stats;
+
+#endif //BLACKBOX_H
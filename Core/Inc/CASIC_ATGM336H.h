@@ -0,0 +1,54 @@
+//
+// Created by ottohesl on 26-1-10.
+//
+
+#ifndef CASIC_ATGM336H_H
+#define CASIC_ATGM336H_H
+#include <stdint.h>
+#include "usart.h"
+#include "NMEA_ATGM336H.h"
+
+/************************ 接收机配置 ************************/
+#define GPS_BAUD_DEFAULT      9600    // ATGM336H上电默认波特率（与CubeMX一致）
+#define GPS_BAUD_FAST         115200  // 配置后的工作波特率
+#define GPS_BAUD_CODE_FAST    5       // PCAS01波特率代码：0=4800 1=9600 2=19200 3=38400 4=57600 5=115200
+#define GPS_FIX_PERIOD_MS     100     // 定位输出周期（ms），100=10Hz，200=5Hz
+#define GPS_USE_BINARY        1       // 1=输出CASIC二进制NAV-PV并关闭NMEA，0=只保留GGA/RMC
+
+/************************ CASIC二进制协议常量 ************************/
+#define CASIC_HEAD_1          0xBA    // 帧头1
+#define CASIC_HEAD_2          0xCE    // 帧头2
+#define CASIC_MAX_PAYLOAD     128     // 支持的最大负载长度
+#define CASIC_CLASS_NAV       0x01    // NAV类
+#define CASIC_ID_NAV_PV       0x03    // NAV-PV 位置速度
+#define CASIC_CLASS_CFG       0x06    // CFG类
+#define CASIC_ID_CFG_MSG      0x01    // CFG-MSG 消息输出频率
+#define CASIC_NAV_PV_LENGTH   80      // NAV-PV负载长度
+
+/************************ 枚举定义 ************************/
+// CASIC二进制帧解析状态机
+typedef enum {
+    CASIC_SEEK_HEAD_1 = 0,  // 寻找0xBA
+    CASIC_SEEK_HEAD_2,      // 寻找0xCE
+    CASIC_RECEIVE_LENGTH,   // 接收长度（2字节）
+    CASIC_RECEIVE_CLASS,    // 接收类
+    CASIC_RECEIVE_ID,       // 接收ID
+    CASIC_RECEIVE_PAYLOAD,  // 接收负载
+    CASIC_RECEIVE_CHECKSUM, // 接收校验（4字节）
+} CASIC_FrameState;
+
+/************************ 函数声明 ************************/
+// 上电配置：提高波特率、设置定位频率、裁剪输出语句
+void CASIC_Configure(UART_HandleTypeDef *huart);
+// 发送文本命令（自动添加$、*校验、\r\n）
+void CASIC_Send_Text(UART_HandleTypeDef *huart, const char *body);
+// 发送二进制命令
+void CASIC_Send_Binary(UART_HandleTypeDef *huart, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len);
+// 二进制帧逐字节解析，返回1表示收到一帧校验正确的完整帧
+uint8_t CASIC_Parse_Byte(uint8_t byte);
+// 将最近一帧NAV-PV解码到GPS数据，返回1表示定位有效
+uint8_t CASIC_Decode_NavPV(GPS_Data_t *gps_data);
+// 是否正处于二进制帧中（期间字节不能交给NMEA分帧）
+uint8_t CASIC_In_Frame(void);
+
+#endif //CASIC_ATGM336H_H
@@ -0,0 +1,70 @@
+//
+// Created by ottohesl on 26-1-18.
+//
+
+#ifndef CMD_ARBITER_H
+#define CMD_ARBITER_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "steering.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define CMD_ARBITER_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (CMD_ARBITER_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (CMD_ARBITER_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (CMD_ARBITER_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 各指令源超时（ms） ************************/
+#define CMD_SBUS_TIMEOUT      100     // 遥控：与SBUS_FAILSAFE_TIMEOUT一致
+#define CMD_UPLINK_TIMEOUT    500     // 地面站：设定值需周期重发，超时即失效
+#define CMD_AUTO_TIMEOUT      50      // 自动驾驶：控制任务每周期提交
+
+/************************ 枚举定义 ************************/
+// 指令源（数值越小优先级越高）
+typedef enum {
+    CMD_SRC_SBUS = 0,                   // 遥控手动（安全员，最高优先级）
+    CMD_SRC_UPLINK,                     // 地面站手动设定
+    CMD_SRC_AUTO,                       // 航点自动驾驶
+    CMD_SRC_COUNT,
+    CMD_SRC_NONE = CMD_SRC_COUNT        // 无有效指令源（停止）
+} CMD_Source_t;
+
+/************************ 结构体定义 ************************/
+// 单个指令源的最新请求
+typedef struct {
+    Command_t cmd;                      // 离散命令（setpoint=false时有效）
+    bool setpoint;                      // true=连续设定（偏航角速度+速度档）
+    float yaw_rate;                     // 偏航角速度设定，°/s
+    uint8_t speed;                      // 摆动速度档
+    uint64_t time_us;                   // 提交时间（TimeBase时基），us
+    bool valid;                         // 是否有请求
+    bool fresh;                         // 提交后尚未执行
+} CMD_Request_t;
+
+// 仲裁统计
+typedef struct {
+    CMD_Source_t active;                // 当前生效的指令源
+    uint32_t switches;                  // 指令源切换次数
+    uint32_t timeouts[CMD_SRC_COUNT];   // 各指令源超时失效次数
+} CMD_Arbiter_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（清空所有请求）
+void CMD_Arbiter_Init(void);
+// 提交离散命令（任务上下文，可跨任务调用）
+void CMD_Submit(CMD_Source_t src, Command_t cmd);
+// 提交连续设定（偏航角速度°/s，速度档；速度档为0表示停止）
+void CMD_Submit_Setpoint(CMD_Source_t src, float yaw_rate, uint8_t speed);
+// 撤销某指令源（失联、退出模式时调用）
+void CMD_Release(CMD_Source_t src);
+// 控制任务周期调用：选出优先级最高的有效指令源并执行，返回生效的指令源（now_us取自TimeBase_Now_us）
+CMD_Source_t CMD_Arbiter_Run(uint64_t now_us);
+
+/************************ 全局变量声明 ************************/
+extern CMD_Arbiter_Stats_t cmd_arbiter_stats;
+
+#endif //CMD_ARBITER_H
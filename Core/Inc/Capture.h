@@ -0,0 +1,60 @@
+//
+// Created by ottohesl on 26-1-26.
+//
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "Telemetry.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define CAPTURE_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (CAPTURE_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (CAPTURE_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (CAPTURE_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 采集参数 ************************/
+#define CAPTURE_SLOTS         64U             // 数据块缓冲槽数（2的幂，每槽一条TLM_Capture_t，共4KB）
+#define CAPTURE_FLAG_DRAIN    0x0008U         // 后台任务线程标志：有待发送的数据块（与BB_FLAG_WRITE共用黑匣子任务）
+#define CAPTURE_TX_RESERVE    1024U           // 调试串口发送缓冲区至少留给周期遥测与printf的空间（字节）
+#define CAPTURE_DEFAULT_MASK  0x00U           // 上电默认采集的源（按Capture_Source_t位，0=关闭）
+
+/************************ 数据源 ************************/
+// 与录制文件（Tools/capture.py）中的源编号一致
+typedef enum {
+    CAPTURE_SRC_SBUS = 0,               // USART1 遥控接收机（SBUS）
+    CAPTURE_SRC_IMU,                    // USART2 姿态传感器（JY901S）
+    CAPTURE_SRC_GPS,                    // USART6 GPS（ATGM336H）
+    CAPTURE_SRC_COUNT
+} Capture_Source_t;
+
+/************************ 结构体定义 ************************/
+// 采集统计（只增不清）
+typedef struct {
+    uint32_t bytes[CAPTURE_SRC_COUNT];  // 各源采集的字节数（含缓冲区满丢弃的部分）
+    uint32_t chunks;                    // 写入缓冲区的数据块数
+    uint32_t sent;                      // 已发送的数据块数
+    uint32_t dropped;                   // 缓冲区满丢弃的字节数
+    uint16_t pending_max;               // 缓冲区最高占用，槽
+} Capture_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（各传感器启动DMA接收之前调用）：清空缓冲区，采集源为CAPTURE_DEFAULT_MASK
+void Capture_Init(void);
+// 设置采集源（按Capture_Source_t位），关闭的源仍跟踪DMA位置，重新开启后从下一个接收事件开始采集
+void Capture_Set_Mask(uint8_t mask);
+uint8_t Capture_Get_Mask(void);
+// 接收事件回调中调用（中断上下文）：把DMA环形缓冲区上次位置到pos之间的新数据打上时间戳存入缓冲区
+void Capture_Rx(Capture_Source_t src, const uint8_t *ring, uint16_t size, uint16_t pos);
+// 后台任务调用：把缓冲区中的数据块作为遥测CAPTURE消息发出
+void Capture_Service(void);
+
+/************************ 全局变量声明 ************************/
+extern Capture_Stats_t capture_stats;
+
+#endif //CAPTURE_H
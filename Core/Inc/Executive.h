@@ -0,0 +1,60 @@
+//
+// Created by ottohesl on 26-1-24.
+//
+
+#ifndef EXECUTIVE_H
+#define EXECUTIVE_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define EXECUTIVE_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (EXECUTIVE_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (EXECUTIVE_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (EXECUTIVE_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+// 实时部分的运行方式：0=每个传感器一个任务（默认），1=单栈表驱动执行器（CMake选项FISH_EXECUTIVE）
+// 执行器下SBUS/GPS/JY901S任务不创建，解析、控制、遥测作为作业在Control任务中按优先级逐个运行到完成
+#ifndef EXEC_ENABLE
+#define EXEC_ENABLE 0
+#endif
+
+/************************ 执行器参数 ************************/
+#define EXEC_JOBS_MAX         8               // 作业表最大长度
+
+/************************ 结构体定义 ************************/
+// 作业入口：release_ms为本次释放对应的内核节拍（周期作业为理想释放时刻，事件作业为发现事件的时刻）
+typedef void (*Exec_Handler_t)(uint32_t release_ms);
+
+// 作业声明（常量表，按需组合周期/事件/超时释放）
+typedef struct {
+    const char *name;                   // 名称（top文本）
+    Exec_Handler_t handler;             // 入口，运行到完成，不得阻塞
+    uint8_t priority;                   // 优先级，数值大者先运行（同一时刻有多个作业就绪时）
+    uint16_t period_ms;                 // 周期释放（ms），0=无
+    uint32_t event;                     // 线程标志释放（中断中osThreadFlagsSet），0=无
+    uint16_t timeout_ms;                // 事件作业超过该时间无事件也释放一次（失联检测），0=无
+} Exec_Job_t;
+
+// 单个作业的统计（只增不清）
+typedef struct {
+    uint32_t runs;                      // 运行次数
+    uint32_t overruns;                  // 上次释放还未运行又被释放的次数（周期作业即错过周期）
+    uint32_t cycles_max;                // 单次运行最大耗时，CPU周期
+    uint32_t wait_us_max;               // 从被释放到开始运行的最大等待（被其他作业占用），us
+} Exec_Job_Stats_t;
+
+/************************ 函数声明 ************************/
+// 运行执行器（在承载任务中调用，不返回）：等待线程标志或最近一个周期释放，每次只运行一个最高优先级的就绪作业
+void Exec_Run(const Exec_Job_t *jobs, uint32_t count);
+// 当前作业表（执行器未运行时返回0），top文本按此打印各作业统计
+uint32_t Exec_Get_Jobs(const Exec_Job_t **jobs);
+
+/************************ 全局变量声明 ************************/
+extern Exec_Job_Stats_t exec_stats[EXEC_JOBS_MAX];
+
+#endif //EXECUTIVE_H
@@ -0,0 +1,47 @@
+//
+// Created by ottohesl on 26-1-19.
+//
+
+#ifndef FMT_H
+#define FMT_H
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define FMT_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (FMT_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (FMT_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (FMT_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 格式化常量 ************************/
+#define FMT_F32_DECIMALS_MAX  9       // 浮点最多保留的小数位数（超出按该值截断）
+#define FMT_F32_BUF           52      // FMT_F32输出缓冲区最小长度（符号+39位整数+小数点+9位小数+'\0'）
+#define FMT_INT_BUF           12      // FMT_U32/FMT_I32/FMT_Hex32输出缓冲区最小长度
+
+// 周期对比测试：1=启动时打印FMT与newlib vsnprintf的CPU周期（需链接newlib浮点printf，CMake选项FISH_PRINTF_FLOAT）
+#ifndef FMT_BENCH
+#define FMT_BENCH 0
+#endif
+
+/************************ 函数声明 ************************/
+// 浮点转定点小数字符串（与printf "%.Nf" 逐字节一致，不用堆），返回长度
+uint32_t FMT_F32(char *buf, float value, uint8_t decimals);
+// 无符号/有符号十进制，返回长度
+uint32_t FMT_U32(char *buf, uint32_t value);
+uint32_t FMT_I32(char *buf, int32_t value);
+// 十六进制（min_digits位不足补0，upper=true用大写），返回长度
+uint32_t FMT_Hex32(char *buf, uint32_t value, uint8_t min_digits, bool upper);
+// printf风格格式化（支持%d/%i/%u/%x/%X/%c/%s/%f及标志-0+、宽度、精度），返回值同C99 vsnprintf
+int FMT_Vsnprintf(char *buf, uint32_t size, const char *fmt, va_list args);
+int FMT_Snprintf(char *buf, uint32_t size, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+#if FMT_BENCH
+// 周期对比测试（打印到调试串口）
+void FMT_Bench(void);
+#endif
+
+#endif //FMT_H
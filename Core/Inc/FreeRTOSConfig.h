@@ -61,22 +61,23 @@
 
 #define configUSE_PREEMPTION                     1
 #define configSUPPORT_STATIC_ALLOCATION          1
-#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION         0
 #define configUSE_IDLE_HOOK                      0
 #define configUSE_TICK_HOOK                      0
+#define configUSE_TICKLESS_IDLE                  1
 #define configCPU_CLOCK_HZ                       ( SystemCoreClock )
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
-#define configMAX_PRIORITIES                     ( 56 )
+#define configMAX_PRIORITIES                     ( 32 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
-#define configTOTAL_HEAP_SIZE                    ((size_t)15360)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
-#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
 /* USER CODE BEGIN MESSAGE_BUFFER_LENGTH_TYPE */
 /* Defaults to size_t for backward compatibility, but can be changed
    if lengths will always be less than the number of bytes in a size_t. */
@@ -116,12 +117,9 @@ to exclude the API function. */
 #define INCLUDE_uxTaskGetStackHighWaterMark  1
 #define INCLUDE_xTaskGetCurrentTaskHandle    1
 #define INCLUDE_eTaskGetState                1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 1
+#define INCLUDE_xTaskGetIdleTaskHandle       1
 
-/*
- * The CMSIS-RTOS V2 FreeRTOS wrapper is dependent on the heap implementation used
- * by the application thus the correct define need to be enabled below
- */
-#define USE_FreeRTOS_HEAP_4
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -165,6 +163,80 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* 移植层：STM32H723为Cortex-M7 r1p2，使用ARM_CM4F移植（ARM_CM7/r0p1只用于带837070勘误的r0p1内核，
+   其额外的cpsid/cpsie对本芯片无用）。PendSV按EXC_RETURN判断任务是否用过FPU，只对用过的任务保存s16-s31，
+   浮点上下文由硬件惰性压栈（FPCCR.ASPEN|LSPEN，xPortStartScheduler中设置）；configENABLE_FPU只对ARMv8-M移植有效。
+   优先级：CLZ就绪位图要求configMAX_PRIORITIES<=32，CMSIS-RTOS2可用到osPriorityNormal7（31），
+   本工程按速率单调分配（见Start_Task.h）：Idle(1)/定时器任务(2)/BelowNormal(16)/Normal(24)/Normal1(25)/Normal2(26) */
+/* CMSIS-RTOS2封装默认要求56个优先级且不用CLZ选择，这里声明只用前32个：osThreadNew/osThreadSetPriority拒绝更高的优先级 */
+#define configUSE_OS2_REDUCED_PRIORITIES 1
+
+/* 任务切换耗时：PendSV从进入到退出（bx r14前）的DWT周期，含换出任务的寄存器保存（及首条浮点指令触发的惰性FPU压栈）、
+   vTaskSwitchContext选择就绪任务与换入任务的寄存器恢复，不含硬件异常进出的自动压栈/出栈；
+   移植层port.c在PendSV退出前调用OS_Switch_Record（freertos.c），选中的仍是原任务时不计入；
+   PendSV为最低优先级，期间被中断抢占的时间也计入单次最大值。经遥测task消息与黑匣子上报 */
+#define configRECORD_SWITCH_CYCLES       1
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+#include "Trace.h"
+typedef struct {
+  volatile uint32_t count;                /* 切换次数（任务确实改变） */
+  volatile uint32_t cycles_sum;           /* 累计周期 */
+  volatile uint32_t cycles_max;           /* 单次最大周期 */
+} OS_Switch_Stats_t;
+extern OS_Switch_Stats_t os_switch_stats;
+void OS_Switch_Record(uint32_t cycles, void *in_tcb, void *out_tcb);  /* PendSV退出前调用（freertos.c） */
+uint32_t OS_Task_Stack_Bytes(void);       /* 全部任务栈总字节数（freertos.c） */
+#define OS_DWT_CYCCNT                    (*(volatile uint32_t *)0xE0001004UL)
+/* 调度事件记录（Trace.c） */
+#define traceTASK_SWITCHED_OUT()          TRACE_EVENT(TRACE_EV_TASK_OUT, pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SWITCHED_IN()           TRACE_EVENT(TRACE_EV_TASK_IN, pxCurrentTCB->uxTCBNumber, pxCurrentTCB->uxPriority)
+
+/* 队列事件只记录设置了对象号的用户队列（vQueueSetQueueNumber，见Trace_Object_t），参数为操作前的消息数；
+   信号量/互斥量/定时器命令队列的队列号为0，不记录 */
+#define TRACE_QUEUE_EVENT(type, q, arg)                                       \
+  do {                                                                        \
+    if ((q)->uxQueueNumber != 0U) {                                           \
+      TRACE_EVENT((type), (q)->uxQueueNumber, (arg));                         \
+    }                                                                         \
+  } while (0)
+#define traceQUEUE_SEND(q)                TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_SEND, (q), (q)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(q)       TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_SEND, (q), (q)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FAILED(q)         TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_SEND_FAILED, (q), (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE(q)             TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_RECEIVE, (q), (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(q)    TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_RECEIVE, (q), (q)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FAILED(q)      TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_RECEIVE_FAILED, (q), 0)
+#define traceBLOCKING_ON_QUEUE_SEND(q)    TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_BLOCK, (q), 0)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(q) TRACE_QUEUE_EVENT(TRACE_EV_QUEUE_BLOCK, (q), 1)
+
+/* 事件组置位：同样只记录设置了对象号的事件组（vEventGroupSetNumber），参数为本次置位的位 */
+#define traceEVENT_GROUP_SET_BITS(xEventGroup, uxBitsToSet)                   \
+  do {                                                                        \
+    UBaseType_t os_obj = uxEventGroupGetNumber(xEventGroup);                  \
+    if (os_obj != 0U) {                                                       \
+      TRACE_EVENT(TRACE_EV_FLAGS_SET, os_obj, (uxBitsToSet));                 \
+    }                                                                         \
+  } while (0)
+
+/* 任务通知（含CMSIS线程标志）：目标任务号与通知值低16位 */
+#define traceTASK_NOTIFY()                TRACE_EVENT(TRACE_EV_NOTIFY, pxTCB->uxTCBNumber, ulValue)
+#define traceTASK_NOTIFY_FROM_ISR()       TRACE_EVENT(TRACE_EV_NOTIFY, pxTCB->uxTCBNumber, ulValue)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()  TRACE_EVENT(TRACE_EV_NOTIFY, pxTCB->uxTCBNumber, 0)
+
+/* 运行时统计时钟：DWT周期计数器（TimeBase_Init中开启，configureTimerForRunTimeStats兜底）加睡眠补偿，
+   DWT在WFI中停止计数，Power.c唤醒后把睡眠时长折算成周期补到timebase_sleep_cycles，空闲任务的占用因此包含睡眠时间；
+   各任务占用/栈剩余/中断耗时由RT_Stats.c按1s窗口统计 */
+extern volatile uint32_t timebase_sleep_cycles;
+void configureTimerForRunTimeStats(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS configureTimerForRunTimeStats
+#define portGET_RUN_TIME_COUNTER_VALUE()       (OS_DWT_CYCCNT + timebase_sleep_cycles)
+
+/* 无节拍空闲（Power.c）：空闲≥2个节拍时停SysTick进入Sleep，前处理挂起HAL时基并记录起点，
+   关闭睡眠时把空闲节拍数置0跳过WFI；后处理补偿DWT与uwTick */
+void Power_Pre_Sleep(uint32_t *idle_ticks);
+void Power_Post_Sleep(uint32_t idle_ticks);
+#define configPRE_SLEEP_PROCESSING(x)          Power_Pre_Sleep(&(x))
+#define configPOST_SLEEP_PROCESSING(x)         Power_Post_Sleep(x)
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,67 @@
+//
+// Created by ottohesl on 26-1-8.
+//
+
+#ifndef GPS_T_H
+#define GPS_T_H
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "usart.h"
+#include "NMEA_ATGM336H.h"  // NMEA语句解析
+#include "CASIC_ATGM336H.h" // CASIC配置与二进制协议
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define GPS_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (GPS_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (GPS_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (GPS_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 调试模式开关 ************************/
+#define GPS_DEBUG_MODE 1  // 1=开启调试，0=关闭
+
+/************************ OTTOHELS文件包含管理 ************************/
+#define GPS_OTTOHELS 1
+#if GPS_OTTOHELS
+#include "ottohesl.h"
+#endif
+
+/************************ GPS接收常量 ************************/
+#define GPS_DMA_RX_SIZE       512     // DMA环形接收缓冲区大小（字节）
+#define GPS_SENTENCE_MAX      96      // 单条NMEA语句最大长度（协议规定82字节）
+#define GPS_RX_FLAG           0x0004U // 空闲中断通知GPS任务的线程标志（执行器下与其他接收标志共用Control任务，位不重叠）
+
+/************************ 结构体定义 ************************/
+// GPS接收统计
+typedef struct {
+    uint32_t rx_bytes;          // 累计接收字节数
+    uint32_t sentences;         // 成功分帧的语句数
+    uint32_t binary_frames;     // 校验正确的CASIC二进制帧数
+    uint32_t overflows;         // 语句超长被丢弃次数
+    uint32_t ring_overruns;     // 任务来不及处理导致DMA覆盖次数
+    uint32_t checksum_errors;   // NMEA语句格式或校验错误数
+    uint32_t backlog_max;       // 一次处理时环形缓冲区中待处理字节数的最大值（超过GPS_DMA_RX_SIZE即溢出）
+    uint32_t rx_restarts;       // 接收错误（溢出/噪声/帧错误）后重新启动DMA的次数
+} GPS_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化函数（启动循环DMA+空闲中断接收）
+void GPS_Init(UART_HandleTypeDef *h_gps, UART_HandleTypeDef *h_debug);
+// 数据处理（任务上下文：分帧+解析）
+bool GPS_Process(void);
+// 中断回调（仅更新DMA写指针并通知任务）
+void GPS_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+// 错误回调（在HAL_UART_ErrorCallback中调用，接收被中止时重新启动）
+void GPS_ErrorCallback(UART_HandleTypeDef *huart);
+
+/************************ 全局变量声明 ************************/
+extern GPS_Stats_t gps_stats;
+extern UART_HandleTypeDef *gps_huart;
+extern UART_HandleTypeDef *gps_debug_huart;
+extern volatile uint32_t gps_rx_stamp;      // 最近一次接收事件中断的TIMEBASE_CYCLES()
+
+#endif //GPS_T_H
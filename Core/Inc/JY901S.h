@@ -28,6 +28,7 @@
 #define Frame_Quater       0x59        // 四元数数据帧类型
 #define Frame_Length       11          // 单帧数据长度（字节）
 #define RX_SIZE            256         // DMA接收缓冲区大小
+#define JY901S_RX_FLAG     0x0002U     // 空闲中断通知JY901S任务的线程标志（执行器下与其他接收标志共用Control任务，位不重叠）
 
 /************************ 枚举定义 ************************/
 // JY901S帧解析状态机
@@ -51,12 +52,23 @@ typedef struct Jy901s_Gyroscope {
 typedef struct Jy901s_Data {
     JG  gyroscope;        // 陀螺仪参数
     float temp;           // 温度，单位℃
+    uint64_t time_us;     // 采样时间戳，TimeBase微秒（所在一组输出的接收事件中断）
 } jy901;
 
+// JY901S接收统计
+typedef struct Jy901s_Stats {
+    uint32_t frames;          // 校验正确的帧数
+    uint32_t checksum_errors; // 校验和错误被丢弃的帧数
+    uint32_t backlog_max;     // 一次解析时DMA缓冲区中待处理字节数的最大值（接近RX_SIZE即有覆盖风险）
+    uint32_t rx_restarts;     // 接收错误（溢出/噪声/帧错误）后重新启动DMA的次数
+} JY901S_Stats_t;
+
 /************************ 函数声明 ************************/
 /* 主要函数 */
 void Gyroscope_Init(UART_HandleTypeDef *h_senor,UART_HandleTypeDef *h_debug);   // 启动DMA接收陀螺仪数据
 bool Gyroscope_Process();                                 // 解析接收的陀螺仪数据
+void Gyroscope_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size); // 接收事件回调（空闲/半满/满，中断中调用）
+void Gyroscope_ErrorCallback(UART_HandleTypeDef *huart);  // 错误回调（HAL_UART_ErrorCallback中调用，接收被中止时重新启动）
 /* 数据修改 */
 void Gyroscope_Alter_Bit(UART_HandleTypeDef *huart);      // 修改JY901S波特率
 void Gyroscope_Accele_Calibra(UART_HandleTypeDef *huart); // 加速度计校准
@@ -66,4 +78,6 @@ void Gyroscope_Gyro_Calibra(UART_HandleTypeDef *huart);   // 陀螺仪校准
 void Gyroscope_Data_Send(UART_HandleTypeDef *huart);      // 发送解析后的陀螺仪数据
 /************************ 结构声明 ************************/
 extern jy901 gyro_data;
+extern JY901S_Stats_t jy901s_stats;
+extern volatile uint32_t jy901s_rx_stamp;   // 最近一次接收事件中断的TIMEBASE_CYCLES()
 #endif //JY901S_H
\ No newline at end of file
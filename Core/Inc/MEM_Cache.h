@@ -0,0 +1,71 @@
+//
+// Created by ottohesl on 26-1-20.
+//
+
+#ifndef MEM_CACHE_H
+#define MEM_CACHE_H
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define MEM_CACHE_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (MEM_CACHE_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (MEM_CACHE_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (MEM_CACHE_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 存储区参数 ************************/
+#define MEM_CACHE_LINE        32U             // Cortex-M7数据缓存行（字节）
+#define MEM_DMA_BASE          0x30000000U     // DMA缓冲区起始地址（RAM_D2，MPU设为不可缓存）
+#define MEM_DMA_SIZE          (32U * 1024U)   // DMA缓冲区大小（字节，与链接脚本RAM_D2一致）
+
+// TCM放置：1=FAST_CODE/FAST_DATA/FAST_CONST生效（CMake选项FISH_TCM，关闭后用于对比控制周期耗时）
+#ifndef MEM_TCM
+#define MEM_TCM 1
+#endif
+
+// 周期对比测试：1=启动时打印步态/NMEA解析在关缓存与开缓存下的CPU周期（CMake选项FISH_CACHE_BENCH）
+#ifndef MEM_BENCH
+#define MEM_BENCH 0
+#endif
+
+/************************ 放置宏 ************************/
+// DMA缓冲区：H7放入链接脚本.dma_buffer段（RAM_D2，不可缓存，不需要缓存维护），其他芯片无缓存直接放普通RAM
+#if (MEM_CACHE_H_Vision==7)
+#define DMA_BUFFER            __attribute__((section(".dma_buffer"), aligned(MEM_CACHE_LINE)))
+#else
+#define DMA_BUFFER
+#endif
+// 必须留在可缓存区、又与DMA/Flash编程共享的缓冲区按缓存行对齐，维护时不会误伤相邻变量
+#define MEM_CACHE_ALIGNED     __attribute__((aligned(MEM_CACHE_LINE)))
+// 长度向上取整到缓存行
+#define MEM_CACHE_ROUND(len)  (((len) + MEM_CACHE_LINE - 1U) & ~(MEM_CACHE_LINE - 1U))
+// 热点代码放入ITCM（0等待，Reset_Handler从Flash拷贝）；与Flash之间的调用超出BL范围，由链接器插入跳转桩
+// 热点状态/查找表放入DTCM（.dtcm_data段，独立于.data）；const对象用FAST_CONST，同一文件中不能与FAST_DATA混用段名
+#if (MEM_CACHE_H_Vision==7) && MEM_TCM
+#define FAST_CODE             __attribute__((section(".itcm_text")))
+#define FAST_DATA             __attribute__((section(".dtcm_data")))
+#define FAST_CONST            __attribute__((section(".dtcm_rodata")))
+#else
+#define FAST_CODE
+#define FAST_DATA
+#define FAST_CONST
+#endif
+
+/************************ 函数声明 ************************/
+// 初始化（配置MPU并打开I/D缓存，在main的HAL_Init之前调用）
+void MEM_Init(void);
+// 写回：CPU写完、DMA读取之前调用
+void MEM_DCache_Clean(const void *addr, uint32_t len);
+// 作废：DMA/Flash写完、CPU读取之前调用（首尾不满一行的部分先写回再作废）
+void MEM_DCache_Invalidate(void *addr, uint32_t len);
+// 写回并作废
+void MEM_DCache_Clean_Invalidate(void *addr, uint32_t len);
+#if MEM_BENCH
+// 关/开缓存周期对比测试（打印到调试串口，需在TimeBase_Init开启DWT之后调用）
+void MEM_Bench(void);
+#endif
+
+#endif //MEM_CACHE_H
@@ -0,0 +1,67 @@
+//
+// Created by ottohesl on 26-1-12.
+//
+
+#ifndef NAV_FILTER_H
+#define NAV_FILTER_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "arm_math.h"
+#include "JY901S.h"
+#include "NMEA_ATGM336H.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define NAV_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (NAV_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (NAV_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (NAV_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 滤波器参数 ************************/
+#define NAV_STATES            4         // 状态量：北向位置、东向位置、北向速度、东向速度
+#define NAV_ACCEL_NOISE       0.5f      // 加速度过程噪声标准差（m/s²），水下扰动较大
+#define NAV_GPS_UERE          2.5f      // 单位HDOP（无HDOP时为PDOP）对应的位置误差（m）
+#define NAV_GPS_VEL_NOISE     0.3f      // GPS速度测量噪声标准差（m/s）
+#define NAV_INIT_POS_VAR      100.0f    // 初始位置方差（m²）
+#define NAV_INIT_VEL_VAR      1.0f      // 初始速度方差（m²/s²）
+#define NAV_DT_MAX            0.1f      // 单步预测最大步长（s），超过视为数据中断
+#define NAV_EARTH_RADIUS      6378137.0f// 地球半径（m），WGS84长半轴
+
+/************************ 结构体定义 ************************/
+// 融合后的本地NED状态（原点为首次有效定位点）
+typedef struct {
+    float pos_n;                        // 北向位置，m
+    float pos_e;                        // 东向位置，m
+    float vel_n;                        // 北向速度，m/s
+    float vel_e;                        // 东向速度，m/s
+    float cov[NAV_STATES * NAV_STATES]; // 协方差矩阵（行优先）
+    int32_t origin_lat;                 // 原点纬度，1e-7度
+    int32_t origin_lon;                 // 原点经度，1e-7度
+    uint32_t gps_updates;               // GPS校正次数
+    uint32_t predict_steps;             // 预测步数
+    uint32_t predict_cycles_max;        // 单次预测最大CPU周期数
+    uint32_t update_cycles_max;         // 单次校正最大CPU周期数
+    bool valid;                         // 是否已用GPS初始化
+} NAV_State_t;
+
+/************************ 函数声明 ************************/
+// 初始化（预分配矩阵、清零状态）
+void NAV_Init(void);
+// IMU预测一步（JY901S任务调用，dt单位s）
+void NAV_Predict(const jy901 *imu, float dt);
+// 提交一次GPS定位（GPS任务调用，只拷贝，校正在下一次预测后执行）
+void NAV_Post_GPS(const GPS_Data_t *gps);
+// 执行挂起的GPS校正（JY901S任务调用），返回true表示本次做了校正
+bool NAV_Update(void);
+// 获取融合状态副本
+void NAV_Get_State(NAV_State_t *state);
+// JY901S航向角转NED航向（0=北，顺时针，0~360°）
+float NAV_Get_Heading(const jy901 *imu);
+
+/************************ 全局变量声明 ************************/
+extern NAV_State_t nav_state;
+
+#endif //NAV_FILTER_H
@@ -7,19 +7,32 @@
 
 #include "main.h"
 
-// GPS数据结构体
+#define NMEA_MAX_FIELDS   20      // 单条语句最多记录的字段数
+#define NMEA_MAX_LENGTH   100     // 单条语句最大扫描长度（协议规定82字节）
+
+// GPS数据结构体（定点数，单位见注释）
 typedef struct {
-    char latitude[16];    // 纬度
-    char longitude[16];   // 经度
-    char ns_indicator;    // 南北半球指示器 (N/S)
-    char ew_indicator;    // 东西半球指示器 (E/W)
+    int32_t latitude;     // 纬度，1e-7度，北正南负
+    int32_t longitude;    // 经度，1e-7度，东正西负
+    int32_t altitude;     // 海拔高度，cm（GGA）
+    uint32_t utc_time;    // UTC时间，当天毫秒数
+    uint32_t utc_date;    // UTC日期，ddmmyy（RMC）
+    uint16_t speed;       // 对地速度，cm/s（RMC）
+    uint16_t course;      // 对地航向，0.01度（RMC）
+    uint16_t hdop;        // 水平精度因子，0.01（GGA；NAV-PV不含HDOP，置0）
+    uint16_t pdop;        // 位置精度因子，0.01（CASIC NAV-PV；GGA不含PDOP，保持不变）
+    uint8_t fix_quality;  // 定位质量 (0=无效, 1=GPS, 2=DGPS...)（GGA）
+    uint8_t satellites;   // 参与定位卫星数（GGA）
     char status;          // 状态 (A=有效, V=无效)
-    uint8_t is_valid;      // 数据是否有效
+    uint8_t is_valid;     // 数据是否有效
+    uint64_t time_us;     // 接收时间戳，TimeBase微秒（定位所在语句/帧的接收事件中断）
 } GPS_Data_t;
 
 // 函数声明
 void GPS_Parser_Init(void);
-void GPS_Parse_NMEA(const char* nmea_data);
+uint8_t GPS_Parse_NMEA(const char* nmea_data);
 void GPS_Get_Data(GPS_Data_t* gps_data);
+void GPS_Set_Data(const GPS_Data_t* gps_data);
 uint8_t GPS_Check_Checksum(const char* nmea_data);
-#endif //GPS_ATGM336H_NMEA_ATGM336H_H
\ No newline at end of file
+uint32_t GPS_Parse_Errors(void);
+#endif //GPS_ATGM336H_NMEA_ATGM336H_H
@@ -0,0 +1,67 @@
+//
+// Created by ottohesl on 26-1-23.
+//
+
+#ifndef POWER_H
+#define POWER_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "Telemetry.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define POWER_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (POWER_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (POWER_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (POWER_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 功耗参数 ************************/
+#define POWER_FLAG_SWITCH     0x0004U         // 后台任务线程标志：有换档请求（与BB_FLAG_WRITE共用黑匣子任务）
+#define POWER_PWM_MARGIN_US   300U            // 换档时舵机PWM距脉冲结束/周期结束至少留出的时间（us）
+#define POWER_PWM_WAIT_MS     50              // 等待PWM空档的最长时间（ms），超时照常换档
+
+/************************ 时钟档 ************************/
+// 两档AHB/APB分频相同（HCLK=SYSCLK/2，APB=HCLK/2），定时器时钟始终等于HCLK；串口内核时钟为HSI，与档位无关
+typedef enum {
+    POWER_PROFILE_PERFORMANCE = 0,      // CPU 550MHz，VOS0（上电默认）
+    POWER_PROFILE_ECONOMY,              // CPU 160MHz，VOS3（HCLK 80MHz，APB 40MHz）
+    POWER_PROFILE_COUNT
+} Power_Profile_t;
+
+/************************ 结构体定义 ************************/
+// 功耗统计（只增不清，Power_Sample按统计窗口相减）
+typedef struct {
+    uint32_t sleeps;                    // 进入睡眠（WFI）次数
+    uint64_t sleep_us;                  // 累计睡眠时长，us
+    uint32_t switches;                  // 换档次数
+    uint32_t switch_us;                 // 最近一次换档耗时（挂起调度器期间，不含等待PWM空档），us
+    uint32_t switch_errors;             // 换档失败次数（RCC配置超时）
+    uint32_t pwm_wait_timeouts;         // 等不到PWM空档直接换档的次数
+} Power_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（TimeBase_Init之后、调度器启动前调用）：默认性能档、空闲睡眠开启
+void Power_Init(void);
+// 请求换档（在黑匣子后台任务中执行），与当前档相同直接返回true，上一个请求未完成返回false
+bool Power_Request_Profile(Power_Profile_t profile);
+// 空闲时是否进入睡眠（关闭后空闲任务空转，用于对比功耗）
+void Power_Set_Sleep(bool enable);
+// 当前时钟档
+Power_Profile_t Power_Get_Profile(void);
+// 后台任务调用：执行换档请求
+void Power_Service(void);
+// 无节拍空闲前后处理（configPRE/POST_SLEEP_PROCESSING，关中断中调用）
+void Power_Pre_Sleep(uint32_t *idle_ticks);
+void Power_Post_Sleep(uint32_t idle_ticks);
+// 统计窗口结束（与RT_Stats_Sample同一定时器回调）：计算本窗口的睡眠占比与次数
+void Power_Sample(void);
+// 填写遥测POWER消息（睡眠统计取最近一个窗口）
+void Power_Get_Message(TLM_Power_t *msg);
+
+/************************ 全局变量声明 ************************/
+extern Power_Stats_t power_stats;
+
+#endif //POWER_H
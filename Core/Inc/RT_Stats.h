@@ -0,0 +1,106 @@
+//
+// Created by ottohesl on 26-1-21.
+//
+
+#ifndef RT_STATS_H
+#define RT_STATS_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "Telemetry.h"
+#include "Trace.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define RT_STATS_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (RT_STATS_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (RT_STATS_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (RT_STATS_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 统计参数 ************************/
+#define RT_STATS_PERIOD_MS    1000            // 统计窗口（ms，定时器服务任务中采样）
+#define RT_TASK_MAX           TLM_CPU_TASKS   // 统计的任务数（SBUS/GPS/JY901S/Control/BlackBox/定时器服务/空闲）
+#define RT_TOP_LINE_MAX       96              // top文本单行最大长度（字节）
+
+/************************ 中断编号 ************************/
+// 按stm32h7xx_it.c中的中断入口编号，新增中断时同步修改rt_isr_names与遥测CPU消息
+typedef enum {
+    RT_ISR_DMA1_S0 = 0,                 // JY901S接收DMA（USART2 RX）
+    RT_ISR_DMA1_S1,                     // 调试串口发送DMA（USART3 TX）
+    RT_ISR_DMA1_S2,                     // GPS接收DMA（USART6 RX）
+    RT_ISR_DMA1_S3,                     // 调试串口接收DMA（USART3 RX）
+    RT_ISR_DMA1_S4,                     // 遥控接收DMA（USART1 RX）
+    RT_ISR_USART1,                      // 遥控串口（空闲）
+    RT_ISR_USART2,                      // JY901S串口（空闲）
+    RT_ISR_USART3,                      // 调试串口（空闲/发送完成）
+    RT_ISR_USART6,                      // GPS串口（空闲）
+    RT_ISR_TIM23,                       // HAL时基（保持在最后，TRACE_ISR_MASK按位排除）
+    RT_ISR_COUNT                        // 中断数（与TLM_CPU_ISRS一致）
+} RT_ISR_Id_t;
+
+/************************ 结构体定义 ************************/
+// 单个中断的累计量（只增不清，采样时按两次之差计算）
+typedef struct {
+    volatile uint32_t cycles;           // 累计周期（不含嵌套进来的更高优先级中断）
+    volatile uint32_t count;            // 进入次数
+} RT_ISR_Acc_t;
+
+// 单个任务的窗口统计
+typedef struct {
+    const char *name;                   // 任务名（NULL=未创建）
+    uint16_t load;                      // CPU占用，0.01%
+    uint16_t stack_free;                // 栈剩余最小值，字节
+    uint8_t priority;                   // 当前优先级
+    uint8_t state;                      // eTaskState
+} RT_Task_Stats_t;
+
+// 一个统计窗口的结果
+typedef struct {
+    uint32_t window_cycles;             // 窗口长度，CPU周期
+    uint32_t stats_cycles;              // 本次采样自身耗时，CPU周期
+    uint32_t samples;                   // 已完成的窗口数
+    uint32_t window_us;                 // 窗口长度，us（时基，与主频无关）
+    uint32_t switches;                  // 窗口内任务切换次数
+    uint32_t switch_cycles_avg;         // 窗口内任务切换平均耗时，CPU周期
+    RT_Task_Stats_t task[RT_TASK_MAX];
+    uint16_t isr_load[RT_ISR_COUNT];    // 各中断占用，0.01%
+    uint32_t isr_count[RT_ISR_COUNT];   // 各中断窗口内进入次数
+} RT_Report_t;
+
+/************************ 中断计时宏 ************************/
+// 放在中断入口USER CODE 0/1两处；嵌套进来的中断耗时从外层扣除，各中断之和即中断总占用
+// 中断耗时同时计入被打断任务的运行时间（FreeRTOS只在任务切换时计时），任务占用与中断占用有重叠
+// 同时写入调度事件记录（Trace.h，按TRACE_ISR_MASK过滤），记录耗时算在本中断内
+#define RT_ISR_ENTER(id)                                                      \
+    TRACE_ISR_ENTER(id);                                                      \
+    uint32_t rt_isr_t0 = DWT->CYCCNT;                                         \
+    uint32_t rt_isr_outer = rt_isr_nested;                                    \
+    rt_isr_nested = 0U
+#define RT_ISR_EXIT(id)                                                       \
+    do {                                                                      \
+        uint32_t rt_isr_d = DWT->CYCCNT - rt_isr_t0;                          \
+        rt_isr_acc[(id)].cycles += rt_isr_d - rt_isr_nested;                  \
+        rt_isr_acc[(id)].count++;                                             \
+        rt_isr_nested = rt_isr_outer + rt_isr_d;                              \
+        TRACE_ISR_EXIT(id);                                                   \
+    } while (0)
+
+/************************ 函数声明 ************************/
+// 统计定时器回调：计算上一窗口的任务/中断占用与任务切换次数，有请求时打印top文本（定时器服务任务中调用）
+void RT_Stats_Sample(void);
+// 请求在下一个窗口结束时经调试串口打印top文本，返回false表示上一个请求还未处理
+bool RT_Stats_Request_Top(void);
+// 读取最近一个窗口的结果
+void RT_Stats_Get(RT_Report_t *report);
+// 填写遥测CPU消息
+void RT_Stats_Get_Message(TLM_CPU_t *msg);
+// 中断名称（top文本与调度事件名称表共用）
+const char *RT_ISR_Name(RT_ISR_Id_t id);
+
+/************************ 全局变量声明 ************************/
+extern RT_ISR_Acc_t rt_isr_acc[RT_ISR_COUNT];
+extern volatile uint32_t rt_isr_nested;
+
+#endif //RT_STATS_H
@@ -9,6 +9,7 @@
 #include <string.h>
 #include "usart.h"
 #include "steering.h"  // 机械鱼运动控制头文件
+#include "CMD_Arbiter.h" // 运动指令源仲裁
 
 /************************ 预处理命令-芯片版本选择 ************************/
 #define SBUS_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
@@ -37,6 +38,7 @@
 #define SBUS_DMA_RX_SIZE      256     // DMA接收缓冲区大小（环形）
 #define SBUS_FRAME_TIMEOUT    100     // 帧解析超时阈值（ms）
 #define SBUS_FAILSAFE_TIMEOUT 100     // 通信超时阈值（ms）
+#define SBUS_RX_FLAG          0x0001U // 空闲中断通知SBUS任务的线程标志（执行器下与其他接收标志共用Control任务，位不重叠）
 
 /************************ SBUS控制参数 ************************/
 #define sbus_ch3_max          1208
@@ -44,6 +46,10 @@
 #define speed_max             10
 #define speed_min             2
 
+/************************ 模式切换 ************************/
+#define SBUS_MODE_CHANNEL     4       // 模式开关通道（CH5，从0计数）
+#define SBUS_MODE_AUTO_MIN    1000    // 通道值高于该值为自动驾驶模式
+
 /************************ 枚举定义 ************************/
 // SBUS帧解析状态机
 typedef enum SBUS_FrameState {
@@ -67,15 +73,30 @@ typedef struct {
     uint8_t failsafe;                       // 1=失联，0=正常
     uint8_t frame_lost;                     // 1=丢帧，0=正常
     uint8_t new_data_available;             // 1=有新数据，0=无
-    uint32_t last_update_time;              // 最后数据更新时间（ms）
+    uint64_t last_update_us;                // 最后一帧的接收时间戳（TimeBase微秒）
     uint8_t raw_data[SBUS_PACKET_LENGTH];   // 原始帧数据
 } SBUS_Data_t;
 
+// SBUS接收统计
+typedef struct {
+    uint32_t frames;                        // 帧头帧尾正确并解码的帧数
+    uint32_t format_errors;                 // 帧尾错误被丢弃的帧数
+    uint32_t rx_restarts;                   // 接收错误（溢出/噪声/帧错误）后重新启动DMA的次数
+} SBUS_Stats_t;
+
 /************************ 函数声明 ************************/
 // 初始化函数
 void SBUS_Init(UART_HandleTypeDef *h_sbus, UART_HandleTypeDef *h_debug);
 // 数据处理（解析DMA缓冲区+执行命令）
 bool SBUS_Process(void);
+// 接收事件回调（空闲/半满/满，中断中调用）
+void SBUS_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+// 错误回调（在HAL_UART_ErrorCallback中调用，接收被中止时重新启动）
+void SBUS_ErrorCallback(UART_HandleTypeDef *huart);
+// 是否处于自动驾驶模式（模式开关拨高且未失联）
+bool SBUS_Auto_Mode(void);
+// 解码一帧完整的25字节SBUS帧（不经DMA状态机，基准测试用）
+void SBUS_Decode_Frame(uint8_t *packet);
 // 私有函数（内部调用）
 static void SBUS_DecodePacket(uint8_t *packet);
 static SBUS_Command_t SBUS_GetCommand(void);
@@ -84,7 +105,9 @@ static int mapValue(int value);
 
 /************************ 全局变量声明 ************************/
 extern SBUS_Data_t sbus_data;
+extern SBUS_Stats_t sbus_stats;
 extern UART_HandleTypeDef *sbus_huart;
 extern UART_HandleTypeDef *sbus_debug_huart;
+extern volatile uint32_t sbus_rx_stamp;     // 最近一次接收事件中断的TIMEBASE_CYCLES()
 
 #endif //SBUS_T_H
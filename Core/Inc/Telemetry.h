@@ -0,0 +1,270 @@
+//
+// Created by ottohesl on 26-1-17.
+//
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define TELEMETRY_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (TELEMETRY_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (TELEMETRY_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (TELEMETRY_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 帧格式常量 ************************/
+// 一帧 = 0x00 + COBS(消息头 + 负载 + CRC32小端) + 0x00，上位机解析见Tools/telemetry.py
+#define TLM_FRAME_DELIMITER   0x00    // 帧分隔符（COBS编码后数据中不含0x00）
+#define TLM_PAYLOAD_MAX       64      // 单条消息负载最大长度（字节）
+#define TLM_TASK_MAX          6       // 任务统计消息中的任务数
+#define TLM_TASK_INPUTS       3       // 任务统计消息中的输入数（与Start_Task.h的INPUT_COUNT一致）
+#define TLM_CPU_TASKS         7       // CPU占用消息中的任务数（TASK消息中的6个任务+空闲任务）
+#define TLM_CPU_ISRS          10      // CPU占用消息中的中断数（与RT_ISR_COUNT一致）
+#define TLM_TRACE_EVENTS      5       // 每条调度事件导出消息中的事件数（每个8字节，见Trace.h）
+#define TLM_CAPTURE_BYTES     54      // 每条原始数据采集消息最多携带的字节数（负载其余10字节为块头）
+
+/************************ 消息类型 ************************/
+typedef enum {
+    TLM_MSG_IMU   = 0x01,             // 姿态传感器采样
+    TLM_MSG_RC    = 0x02,             // 遥控通道
+    TLM_MSG_GAIT  = 0x03,             // 步态状态机与自动驾驶
+    TLM_MSG_SERVO = 0x04,             // 舵机输出
+    TLM_MSG_GPS   = 0x05,             // GPS定位
+    TLM_MSG_TASK  = 0x06,             // 任务与系统统计
+    TLM_MSG_NAV   = 0x07,             // 导航滤波状态
+    TLM_MSG_ACK   = 0x08,             // 上行命令应答（事件消息，不按频率发送）
+    TLM_MSG_BB_DATA   = 0x09,         // 黑匣子导出数据块（事件消息，不按频率发送）
+    TLM_MSG_BB_STATUS = 0x0A,         // 黑匣子状态
+    TLM_MSG_CPU   = 0x0B,             // 各任务/中断CPU占用与栈剩余（运行时统计，1s窗口）
+    TLM_MSG_TRACE_DATA = 0x0C,        // 调度事件导出数据（事件消息，不按频率发送）
+    TLM_MSG_TRACE_INFO = 0x0D,        // 调度事件记录器状态（事件消息：导出开始/结束、触发后停止）
+    TLM_MSG_TRACE_NAME = 0x0E,        // 调度事件名称表（事件消息，导出时发送）
+    TLM_MSG_POWER = 0x0F,             // 功耗管理：时钟档、空闲睡眠占比与唤醒次数
+    TLM_MSG_CAPTURE = 0x10,           // 传感器串口原始数据块（事件消息，采集开启时发送，见Capture.h）
+    TLM_MSG_INPUT = 0x11,             // 传感器解析统计：帧数、校验错误（回放对照）
+    TLM_MSG_COUNT                     // 消息类型数（最大类型号+1）
+} TLM_MsgType_t;
+
+/************************ 消息结构体（小端、紧凑排列，与上位机解析一一对应） ************************/
+// 消息头
+typedef struct __attribute__((packed)) {
+    uint8_t type;                       // 消息类型TLM_MsgType_t
+    uint16_t seq;                       // 全局序号（发送失败也递增，上位机据此统计丢帧）
+    uint64_t time_us;                   // 采样时间戳，TimeBase微秒（上电后，不回绕）
+} TLM_Header_t;
+
+// 帧长度上限
+#define TLM_RAW_MAX    (sizeof(TLM_Header_t) + TLM_PAYLOAD_MAX + 4)    // 编码前最大长度
+#define TLM_FRAME_MAX  (TLM_RAW_MAX + TLM_RAW_MAX / 254 + 3)           // 编码后最大长度（含两个分隔符）
+
+// 0x01 姿态传感器
+typedef struct __attribute__((packed)) {
+    int16_t accele[3];                  // 加速度，0.01 m/s²
+    int16_t gyro[3];                    // 角速度，0.1 °/s
+    int16_t angle[3];                   // 横滚/俯仰/偏航，0.01 °
+    int16_t temp;                       // 温度，0.01 ℃
+} TLM_IMU_t;
+
+// 0x02 遥控通道
+typedef struct __attribute__((packed)) {
+    uint16_t channels[16];              // SBUS原始通道值（0-2047）
+    uint8_t flags;                      // SBUS标志字节
+    uint8_t failsafe;                   // 1=失联
+    uint8_t frame_lost;                 // 1=丢帧
+    uint8_t auto_mode;                  // 1=自动驾驶模式
+} TLM_RC_t;
+
+// 0x03 步态与自动驾驶
+typedef struct __attribute__((packed)) {
+    uint8_t state;                      // 步态状态FishState_t
+    uint8_t command;                    // 当前命令Command_t
+    uint8_t speed;                      // 摆动速度档
+    uint8_t ap_active;                  // 1=正在跟踪航点
+    uint8_t wp_index;                   // 当前目标航点
+    int16_t yaw_rate;                   // 偏航角速度设定，0.01 °/s
+    int16_t heading_error;              // 航向误差，0.01 °
+    float distance;                     // 到目标航点距离，m
+    float cross_track;                  // 航迹偏差，m
+    uint8_t source;                     // 生效的指令源CMD_Source_t（3=无）
+} TLM_Gait_t;
+
+// 0x04 舵机输出
+typedef struct __attribute__((packed)) {
+    uint16_t angle_body;                // 鱼身舵机角度，°
+    uint16_t angle_tail;                // 鱼尾舵机角度，°
+    uint16_t pulse_body;                // 鱼身PWM比较值
+    uint16_t pulse_tail;                // 鱼尾PWM比较值
+} TLM_Servo_t;
+
+// 0x05 GPS定位
+typedef struct __attribute__((packed)) {
+    int32_t latitude;                   // 纬度，1e-7度
+    int32_t longitude;                  // 经度，1e-7度
+    int32_t altitude;                   // 海拔，cm
+    uint32_t utc_time;                  // UTC当天毫秒数
+    uint16_t speed;                     // 对地速度，cm/s
+    uint16_t course;                    // 对地航向，0.01度
+    uint16_t hdop;                      // 水平精度因子，0.01（GGA）
+    uint16_t pdop;                      // 位置精度因子，0.01（CASIC NAV-PV）
+    uint8_t fix_quality;                // 定位质量
+    uint8_t satellites;                 // 卫星数
+    uint8_t is_valid;                   // 1=有效
+} TLM_GPS_t;
+
+// 0x06 任务与系统统计
+typedef struct __attribute__((packed)) {
+    uint16_t stack_free[TLM_TASK_MAX];  // 各任务栈剩余最小值，字节（SBUS/GPS/JY901S/Control/BlackBox/定时器服务）
+    uint32_t uart_dropped;              // 调试串口丢弃字节数
+    uint32_t tlm_dropped;               // 遥测丢弃帧数
+    uint32_t gps_overruns;              // GPS接收溢出次数
+    uint32_t control_cycles;            // 最近一个控制周期耗时，CPU周期
+    uint32_t control_cycles_max;        // 控制周期最大耗时，CPU周期
+    uint32_t switch_cycles_avg;         // 最近一个统计窗口（1s）任务切换（PendSV进入到退出）平均耗时，CPU周期
+    uint32_t switch_cycles_max;         // 任务切换最大耗时，CPU周期
+    uint32_t input_age_max[TLM_TASK_INPUTS]; // 各输入从接收中断到被控制周期读到的最大延迟，CPU周期（IMU/遥控/GPS）
+    uint16_t switches;                  // 最近一个统计窗口（1s）的任务切换次数，次/s
+    uint16_t control_jitter_max;        // 控制周期起点抖动最大值，us
+    uint16_t stack_bytes;               // 全部任务栈总字节数（多任务/执行器布局对比）
+    uint32_t control_misses;            // 控制周期错过截止时间的累计次数
+    uint16_t uart_level_max;            // 调试串口发送缓冲区最高水位，字节
+} TLM_Task_t;
+
+// 0x07 导航滤波状态
+typedef struct __attribute__((packed)) {
+    float pos_n;                        // 北向位置，m
+    float pos_e;                        // 东向位置，m
+    float vel_n;                        // 北向速度，m/s
+    float vel_e;                        // 东向速度，m/s
+    uint32_t gps_updates;               // GPS校正次数
+    uint8_t valid;                      // 1=已初始化
+} TLM_Nav_t;
+
+// 0x08 上行命令应答
+typedef struct __attribute__((packed)) {
+    uint8_t cmd;                        // 命令类型
+    uint16_t seq;                       // 命令序号
+    uint8_t result;                     // 执行结果UPLINK_Result_t
+} TLM_Ack_t;
+
+// 0x09 黑匣子导出数据块（一个Flash字）
+typedef struct __attribute__((packed)) {
+    uint32_t generation;                // 所在扇区的写入代数（上位机按代数排序拼接）
+    uint32_t offset;                    // 扇区内偏移，字节（0为扇区头）
+    uint8_t data[32];                   // Flash字内容
+} TLM_BB_Data_t;
+
+// 0x0A 黑匣子状态
+typedef struct __attribute__((packed)) {
+    uint32_t session;                   // 本次上电的记录会话号
+    uint32_t generation;                // 当前扇区写入代数
+    uint32_t records;                   // 已记录条数
+    uint32_t dropped;                   // 缓冲区满/无已擦除扇区丢弃的条数
+    uint32_t flash_bytes;               // 已写入Flash的字节数
+    uint32_t dump_words;                // 本次导出已发送的Flash字数
+    uint16_t erases;                    // 本次上电擦除扇区次数
+    uint16_t erase_ms_max;              // 单次擦除最长耗时，ms
+    uint8_t state;                      // BB_State_t
+    uint8_t sector;                     // 当前扇区（记录区内序号）
+} TLM_BB_Status_t;
+
+// 0x0B 运行时统计（最近一个1s窗口，见RT_Stats.h）
+typedef struct __attribute__((packed)) {
+    uint16_t task_load[TLM_CPU_TASKS];  // 各任务CPU占用，0.01%（SBUS/GPS/JY901S/Control/BlackBox/定时器服务/空闲）
+    uint16_t task_stack[TLM_CPU_TASKS]; // 各任务栈剩余最小值，字节
+    uint16_t isr_load[TLM_CPU_ISRS];    // 各中断占用，0.01%（顺序见RT_ISR_Id_t）
+    uint32_t stats_cycles;              // 统计采样自身耗时，CPU周期
+} TLM_CPU_t;
+
+// 0x0C 调度事件导出数据
+typedef struct __attribute__((packed)) {
+    uint16_t index;                     // 第一个事件在本次导出中的序号（从0开始，由旧到新）
+    uint8_t count;                      // 有效事件数（1~TLM_TRACE_EVENTS）
+    uint8_t reserved;
+    uint8_t events[TLM_TRACE_EVENTS * 8];   // Trace_Event_t：time(u32) type(u8) id(u8) arg(u16)
+} TLM_Trace_Data_t;
+
+// 0x0D 调度事件记录器状态
+typedef struct __attribute__((packed)) {
+    uint32_t cpu_hz;                    // 时间戳频率（DWT，CPU主频）
+    uint32_t recorded;                  // 本轮记录的事件总数（超过缓冲区容量的部分已被覆盖）
+    uint16_t events;                    // 本次导出的事件数
+    uint16_t dumped;                    // 已发送的事件数
+    uint16_t event_cycles;              // 单个事件写入耗时，CPU周期
+    uint8_t state;                      // Trace_State_t
+    uint8_t trigger;                    // Trace_Trigger_t
+    uint64_t sync_us;                   // 停止记录时的TimeBase微秒（与sync_cycles同时读取）
+    uint32_t sync_cycles;               // 停止记录时的DWT计数，上位机据此把事件时间换算为TimeBase时间
+} TLM_Trace_Info_t;
+
+// 0x0E 调度事件名称表
+typedef struct __attribute__((packed)) {
+    uint8_t kind;                       // Trace_NameKind_t
+    uint8_t id;                         // 任务号/中断号/队列号/标记号
+    char name[16];                      // 名称（不足补0）
+} TLM_Trace_Name_t;
+
+// 0x0F 功耗管理（睡眠占比与唤醒次数为最近一个统计窗口（1s）的增量，见Power.h）
+typedef struct __attribute__((packed)) {
+    uint32_t cpu_hz;                    // 当前CPU主频
+    uint32_t sleeps;                    // 最近一个统计窗口进入睡眠（WFI）的次数
+    uint16_t sleep;                     // 最近一个统计窗口CPU睡眠时间占比，0.01%
+    uint16_t switch_us;                 // 最近一次换档耗时（挂起调度器期间），us
+    uint16_t switches;                  // 累计换档次数
+    uint8_t profile;                    // Power_Profile_t
+    uint8_t sleep_enable;               // 1=空闲时进入睡眠
+    uint8_t vos;                        // 内核电压档（0=VOS0，最高）
+} TLM_Power_t;
+
+// 0x10 传感器串口原始数据块（变长：负载 = 块头10字节 + len字节数据）
+typedef struct __attribute__((packed)) {
+    uint32_t offset;                    // 第一个字节在该源数据流中的偏移（含未发出的部分，上位机据此发现缺口）
+    uint32_t time_us;                   // 所在接收事件中断的TimeBase微秒（低32位，上位机按消息头时间展开）
+    uint8_t source;                     // Capture_Source_t
+    uint8_t len;                        // 有效字节数（1~TLM_CAPTURE_BYTES）
+    uint8_t data[TLM_CAPTURE_BYTES];
+} TLM_Capture_t;
+
+// 0x11 传感器解析统计（累计值，上位机按两次之差计算）
+typedef struct __attribute__((packed)) {
+    uint32_t sbus_frames;               // SBUS解码帧数
+    uint32_t sbus_errors;               // SBUS帧尾错误数
+    uint32_t imu_frames;                // JY901S校验正确的帧数
+    uint32_t imu_errors;                // JY901S校验和错误数
+    uint32_t gps_sentences;             // GPS分帧的NMEA语句数
+    uint32_t gps_errors;                // NMEA格式或校验错误数
+    uint32_t gps_bytes;                 // GPS接收字节数
+    uint32_t capture_dropped;           // 原始数据采集缓冲区满丢弃的字节数
+    uint16_t imu_backlog_max;           // JY901S接收缓冲区一次解析的最大积压，字节
+    uint16_t gps_backlog_max;           // GPS接收缓冲区一次处理的最大积压，字节
+} TLM_Input_t;
+
+// 遥测统计
+typedef struct {
+    uint32_t frames;                    // 成功写入发送缓冲区的帧数
+    uint32_t bytes;                     // 成功写入的字节数（含COBS与分隔符）
+    uint32_t dropped;                   // 发送缓冲区满被丢弃的帧数
+} TLM_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（加载默认发送频率）
+void Telemetry_Init(void);
+// 设置某类消息的发送频率（Hz，0=关闭，上限为调用Telemetry_Process的频率）
+void Telemetry_Set_Rate(TLM_MsgType_t type, uint16_t rate_hz);
+// 立即发送一条消息（负载由调用方填好）
+bool Telemetry_Send(TLM_MsgType_t type, const void *payload, uint8_t len);
+// 按类型采样当前状态填入负载（至少TLM_PAYLOAD_MAX字节），返回负载长度，0=该类型不能采样
+uint8_t Telemetry_Pack(TLM_MsgType_t type, void *payload);
+// 编码一帧：COBS(消息头+负载+CRC32) + 结尾分隔符（不含前导分隔符），返回长度（不超过TLM_FRAME_MAX-1）
+uint32_t Telemetry_Encode(uint8_t *dst, TLM_MsgType_t type, uint16_t seq, const void *payload, uint8_t len);
+// 控制任务周期调用：按频率表采样并发送到期的消息
+void Telemetry_Process(uint32_t now_ms);
+
+/************************ 全局变量声明 ************************/
+extern TLM_Stats_t tlm_stats;
+
+#endif //TELEMETRY_H
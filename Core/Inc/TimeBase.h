@@ -0,0 +1,46 @@
+//
+// Created by ottohesl on 26-1-22.
+//
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define TIMEBASE_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (TIMEBASE_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (TIMEBASE_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (TIMEBASE_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 时基参数 ************************/
+#define TIMEBASE_HZ           1000000U        // 计数频率（TIM24预分频到1MHz，与DWT同源于PLL1，无相对漂移）
+#define TIMEBASE_US_PER_MS    1000U
+#define TIMEBASE_MS(ms)       ((uint64_t)(ms) * TIMEBASE_US_PER_MS)   // 毫秒换算为时基微秒
+
+// 连续周期计数：DWT在CPU睡眠（WFI）期间停止，唤醒后由Power按睡眠时长补到timebase_sleep_cycles；
+// 中断时间戳、运行时统计、调度事件等跨越睡眠的周期差都用它，只在同一段运行内计时的可直接读DWT
+#define TIMEBASE_CYCLES()     (DWT->CYCCNT + timebase_sleep_cycles)
+
+/************************ 函数声明 ************************/
+// 初始化：启动32位自由运行定时器与溢出中断，开启DWT（需在MX_TIM24_Init之后、任何时间戳之前调用）
+void TimeBase_Init(TIM_HandleTypeDef *htim);
+// 当前时间（上电后微秒，64位不回绕），任务、中断、临界区中均可调用，不关中断
+uint64_t TimeBase_Now_us(void);
+// 把中断中记下的TIMEBASE_CYCLES()换算为时基微秒（只对最近约7.8s内的计数有效）
+uint64_t TimeBase_From_Cycles(uint32_t cycles);
+// DWT周期数与微秒互换（32位，超过约7.8s的周期数不可表示）
+uint32_t TimeBase_Cycles_To_us(uint32_t cycles);
+uint32_t TimeBase_us_To_Cycles(uint32_t us);
+// 定时器溢出回调（HAL_TIM_PeriodElapsedCallback中调用）
+void TimeBase_Overflow_Callback(TIM_HandleTypeDef *htim);
+// 系统时钟切换后调用（关中断）：按新的定时器时钟重设预分频并保留当前计数，更新周期/微秒换算
+void TimeBase_Clock_Changed(uint32_t timer_hz);
+
+/************************ 全局变量声明 ************************/
+extern volatile uint32_t timebase_sleep_cycles;
+
+#endif //TIMEBASE_H
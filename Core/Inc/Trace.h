@@ -0,0 +1,143 @@
+//
+// Created by ottohesl on 26-1-21.
+//
+
+#ifndef TRACE_H
+#define TRACE_H
+#include <stdbool.h>
+#include <stdint.h>
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define TRACE_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (TRACE_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (TRACE_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (TRACE_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+// 调度事件记录：1=FreeRTOS trace宏、中断入口与用户标记写入环形缓冲区（CMake选项FISH_TRACE，关闭后宏全部为空）
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1
+#endif
+
+/************************ 记录参数 ************************/
+#define TRACE_EVENTS          2048U           // 环形缓冲区事件数（2的幂，每个8字节，放在DTCM）
+#define TRACE_POST_EVENTS     512U            // 触发后继续记录的事件数（其余为触发前的历史）
+#define TRACE_ISR_MASK        0x1FFU          // 记录的中断（按RT_ISR_Id_t位，默认不记1kHz的HAL时基TIM23）
+#define TRACE_LATE_PERCENT    150U            // 控制周期起点间隔超过周期的该百分比时触发（卡顿）
+#define TRACE_FLAG_DUMP       0x0002U         // 后台任务线程标志：有导出请求（与BB_FLAG_WRITE共用黑匣子任务）
+#define TRACE_NAME_LEN        16              // 名称表中名称的最大长度（与configMAX_TASK_NAME_LEN一致）
+
+/************************ 事件类型 ************************/
+typedef enum {
+    TRACE_EV_TASK_IN = 1,               // 任务换入（id=任务号，arg=优先级）
+    TRACE_EV_TASK_OUT,                  // 任务换出（id=任务号）
+    TRACE_EV_ISR_ENTER,                 // 进入中断（id=RT_ISR_Id_t）
+    TRACE_EV_ISR_EXIT,                  // 退出中断（id=RT_ISR_Id_t）
+    TRACE_EV_QUEUE_SEND,                // 队列写入（id=对象号，arg=写入前的消息数）
+    TRACE_EV_QUEUE_RECEIVE,             // 队列读出（id=队列号，arg=读出前的消息数）
+    TRACE_EV_QUEUE_SEND_FAILED,         // 队列满写入失败
+    TRACE_EV_QUEUE_RECEIVE_FAILED,      // 队列空读出失败
+    TRACE_EV_QUEUE_BLOCK,               // 在队列上阻塞（arg：0=等待写入，1=等待读出）
+    TRACE_EV_NOTIFY,                    // 任务通知/线程标志（id=目标任务号，arg=通知值低16位）
+    TRACE_EV_MARK,                      // 用户标记（id=Trace_Marker_t，arg=用户数据）
+    TRACE_EV_SPAN_BEGIN,                // 用户区间开始（id=Trace_Marker_t）
+    TRACE_EV_SPAN_END,                  // 用户区间结束（id=Trace_Marker_t）
+    TRACE_EV_TRIGGER,                   // 触发（id=Trace_Trigger_t，之后再记TRACE_POST_EVENTS个事件停止）
+    TRACE_EV_FLAGS_SET,                 // 事件组置位（id=对象号，arg=置位的位）
+} Trace_EventType_t;
+
+// 用户标记与区间
+typedef enum {
+    TRACE_MARK_CONTROL = 0,             // 控制周期（区间）
+    TRACE_MARK_UART_BLOCKING,           // 阻塞式HAL_UART_Transmit（区间）
+    TRACE_MARK_NAV_UPDATE,              // 导航滤波预测+校正（区间）
+    TRACE_MARK_FLASH_PROGRAM,           // 黑匣子缓冲编程到Flash（区间）
+    TRACE_MARK_COUNT
+} Trace_Marker_t;
+
+// 对象号（队列vQueueSetQueueNumber、事件组vEventGroupSetNumber共用编号，0=不记录，内核队列保持0）
+typedef enum {
+    TRACE_OBJ_INPUTS = 1,               // 输入事件组（Start_Task.h中的INPUT_EVT_*）
+    TRACE_OBJ_COUNT
+} Trace_Object_t;
+
+// 触发原因
+typedef enum {
+    TRACE_TRIG_NONE = 0,
+    TRACE_TRIG_CONTROL_LATE,            // 控制周期卡顿
+    TRACE_TRIG_MANUAL,                  // 上行命令
+} Trace_Trigger_t;
+
+// 记录器状态
+typedef enum {
+    TRACE_STATE_RECORDING = 0,          // 环形记录
+    TRACE_STATE_TRIGGERED,              // 已触发，记满TRACE_POST_EVENTS后停止
+    TRACE_STATE_STOPPED,                // 已停止，等待导出
+    TRACE_STATE_DUMPING,                // 导出中（不记录）
+} Trace_State_t;
+
+// 名称表类型（导出时随数据发送，上位机据此命名时间线）
+typedef enum {
+    TRACE_NAME_TASK = 0,
+    TRACE_NAME_ISR,
+    TRACE_NAME_OBJECT,
+    TRACE_NAME_MARKER,
+} Trace_NameKind_t;
+
+/************************ 结构体定义 ************************/
+// 单个事件（8字节）
+typedef struct {
+    uint32_t time;                      // DWT周期计数
+    uint8_t type;                       // Trace_EventType_t
+    uint8_t id;
+    uint16_t arg;
+} Trace_Event_t;
+
+// 记录统计
+typedef struct {
+    uint32_t recorded;                  // 本轮记录的事件总数（含被覆盖的）
+    uint32_t triggers;                  // 触发次数（含停止后被忽略的）
+    uint16_t event_cycles;              // 单个事件写入耗时（初始化时实测，CPU周期）
+    uint16_t dumped;                    // 本次导出已发送的事件数
+    uint8_t trigger;                    // 本轮触发原因
+    uint64_t sync_us;                   // 停止记录（触发后记满或开始导出）时的TimeBase微秒
+    uint32_t sync_cycles;               // 同一时刻的DWT计数
+} Trace_Stats_t;
+
+/************************ 记录宏 ************************/
+#if TRACE_ENABLE
+#define TRACE_EVENT(type, id, arg)  Trace_Event((uint8_t)(type), (uint8_t)(id), (uint16_t)(arg))
+#define TRACE_ISR_ENTER(id)                                                   \
+    do { if ((TRACE_ISR_MASK >> (id)) & 1U) TRACE_EVENT(TRACE_EV_ISR_ENTER, (id), 0); } while (0)
+#define TRACE_ISR_EXIT(id)                                                    \
+    do { if ((TRACE_ISR_MASK >> (id)) & 1U) TRACE_EVENT(TRACE_EV_ISR_EXIT, (id), 0); } while (0)
+#else
+#define TRACE_EVENT(type, id, arg)
+#define TRACE_ISR_ENTER(id)
+#define TRACE_ISR_EXIT(id)
+#endif
+#define TRACE_MARK(marker, arg)     TRACE_EVENT(TRACE_EV_MARK, (marker), (arg))
+#define TRACE_BEGIN(marker)         TRACE_EVENT(TRACE_EV_SPAN_BEGIN, (marker), 0)
+#define TRACE_END(marker)           TRACE_EVENT(TRACE_EV_SPAN_END, (marker), 0)
+
+/************************ 函数声明 ************************/
+// 初始化（需在TimeBase_Init开启DWT之后、调度器启动前调用，同时实测单个事件的写入耗时）
+void Trace_Init(void);
+// 写入一个事件（任务、中断、临界区中均可调用）
+void Trace_Event(uint8_t type, uint8_t id, uint16_t arg);
+// 触发：记录触发事件，再记TRACE_POST_EVENTS个事件后停止；已触发/停止时只计数
+void Trace_Trigger(Trace_Trigger_t reason);
+// 清空并重新开始记录（导出中返回false）
+bool Trace_Restart(void);
+// 请求导出（经遥测TRACE_*消息发送缓冲区中的全部事件，完成后重新开始记录），正在导出返回false
+bool Trace_Request_Dump(void);
+// 后台任务调用：处理导出请求，停止后上报一次状态
+void Trace_Service(void);
+
+/************************ 全局变量声明 ************************/
+extern Trace_Stats_t trace_stats;
+
+#endif //TRACE_H
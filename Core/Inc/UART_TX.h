@@ -0,0 +1,53 @@
+//
+// Created by ottohesl on 26-1-16.
+//
+
+#ifndef UART_TX_H
+#define UART_TX_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "usart.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define UART_TX_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (UART_TX_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (UART_TX_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (UART_TX_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 发送环形缓冲区参数 ************************/
+#define UART_TX_RING_SIZE     4096    // 环形缓冲区大小（字节，必须为2的幂且不超过32768）
+#define UART_TX_CHUNK_MAX     1024    // 单次DMA发送最大长度（字节）
+#define UART_TX_STDOUT_SIZE   128     // printf行缓冲大小（字节，静态分配，不再由newlib首次输出时malloc）
+
+/************************ 结构体定义 ************************/
+// 发送统计
+typedef struct {
+    volatile uint32_t queued;           // 写入环形缓冲区的字节数
+    volatile uint32_t sent;             // DMA发送完成的字节数
+    volatile uint32_t dropped;          // 缓冲区满被丢弃的字节数
+    volatile uint32_t dma_errors;       // 启动DMA失败次数
+    volatile uint32_t level_max;        // 环形缓冲区待发送字节数的最大值（写入时刻）
+} UART_TX_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（绑定发送串口，需开启TX DMA与串口全局中断）
+void UART_TX_Init(UART_HandleTypeDef *huart);
+// 写入数据（不阻塞，可在任务和中断中调用；空间不足整条丢弃），返回写入字节数
+uint32_t UART_TX_Write(const void *data, uint32_t len);
+// 环形缓冲区剩余空间（字节），低优先级的大量输出据此让出空间给遥测与printf
+uint32_t UART_TX_Free(void);
+// 是否为本模块管理的串口
+bool UART_TX_Owns(const UART_HandleTypeDef *huart);
+// 发送完成回调（在HAL_UART_TxCpltCallback中调用）
+void UART_TX_TxCpltCallback(UART_HandleTypeDef *huart);
+// 错误回调（在HAL_UART_ErrorCallback中调用）
+void UART_TX_ErrorCallback(UART_HandleTypeDef *huart);
+
+/************************ 全局变量声明 ************************/
+extern UART_TX_Stats_t uart_tx_stats;
+
+#endif //UART_TX_H
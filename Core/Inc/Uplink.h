@@ -0,0 +1,142 @@
+//
+// Created by ottohesl on 26-1-18.
+//
+
+#ifndef UPLINK_H
+#define UPLINK_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "usart.h"
+
+/************************ 预处理命令-芯片版本选择 ************************/
+#define UPLINK_H_Vision 7  // 根据实际芯片修改：1=F1,4=F4,7=H7
+#if   (UPLINK_H_Vision==1)
+#include "stm32f1xx_hal.h"
+#elif (UPLINK_H_Vision==4)
+#include "stm32f4xx_hal.h"
+#elif (UPLINK_H_Vision==7)
+#include "stm32h7xx_hal.h"
+#endif
+
+/************************ 上行接收常量 ************************/
+// 一帧 = 0x00 + COBS(命令头 + 负载 + CRC32小端) + 0x00，与遥测帧格式相同，上位机见Tools/uplink.py
+#define UPLINK_DMA_RX_SIZE    256     // DMA环形接收缓冲区大小（字节）
+#define UPLINK_FRAME_MAX      64      // 单帧最大长度（COBS编码后，不含分隔符）
+#define UPLINK_LINK_TIMEOUT   1000    // 超过该时间（ms）未收到有效帧视为地面站断开
+
+/************************ 命令类型 ************************/
+typedef enum {
+    UPLINK_CMD_HEARTBEAT = 0x81,      // 心跳（无负载），维持连接与模式
+    UPLINK_CMD_MODE      = 0x82,      // 模式切换
+    UPLINK_CMD_SETPOINT  = 0x83,      // 连续设定：偏航角速度+速度档
+    UPLINK_CMD_COMMAND   = 0x84,      // 离散命令（与遥控相同的前进/左转/右转/停止）
+    UPLINK_CMD_GAIT      = 0x85,      // 步态参数
+    UPLINK_CMD_WP_CLEAR  = 0x86,      // 清空航点表
+    UPLINK_CMD_WP_ADD    = 0x87,      // 追加航点
+    UPLINK_CMD_TLM_RATE  = 0x88,      // 设置遥测消息频率
+    UPLINK_CMD_BB_DUMP   = 0x89,      // 导出黑匣子记录（无负载，数据经遥测BB_DATA消息返回）
+    UPLINK_CMD_TOP       = 0x8A,      // 打印top文本（无负载，下一个运行时统计窗口结束时输出到调试串口）
+    UPLINK_CMD_TRACE     = 0x8B,      // 调度事件记录操作（导出/重新记录/手动触发，数据经遥测TRACE_*消息返回）
+    UPLINK_CMD_POWER     = 0x8C,      // 时钟档与空闲睡眠开关（换档在后台任务中执行，结果见遥测POWER消息）
+    UPLINK_CMD_CAPTURE   = 0x8D,      // 传感器原始数据采集源（数据经遥测CAPTURE消息返回，见Capture.h）
+} UPLINK_Cmd_t;
+
+// 地面站模式
+typedef enum {
+    UPLINK_MODE_MANUAL = 0,           // 手动：SETPOINT/COMMAND生效
+    UPLINK_MODE_AUTO   = 1,           // 自动：执行航点表
+} UPLINK_Mode_t;
+
+// 调度事件记录操作
+typedef enum {
+    UPLINK_TRACE_DUMP    = 0,         // 导出缓冲区中的全部事件，完成后重新记录
+    UPLINK_TRACE_RESTART = 1,         // 清空并重新记录
+    UPLINK_TRACE_TRIGGER = 2,         // 手动触发（再记一段后停止）
+} UPLINK_Trace_Op_t;
+
+// 应答结果（经遥测ACK消息返回）
+typedef enum {
+    UPLINK_OK = 0,                    // 已执行
+    UPLINK_BAD_LENGTH,                // 负载长度不符
+    UPLINK_BAD_VALUE,                 // 参数越界
+    UPLINK_REJECTED,                  // 当前状态下拒绝（如航点表已满）
+    UPLINK_UNKNOWN,                   // 未知命令
+} UPLINK_Result_t;
+
+/************************ 命令结构体（小端、紧凑排列） ************************/
+// 命令头
+typedef struct __attribute__((packed)) {
+    uint8_t type;                       // 命令类型UPLINK_Cmd_t
+    uint16_t seq;                       // 命令序号（原样回送在ACK中）
+} UPLINK_Header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t mode;                       // UPLINK_Mode_t
+} UPLINK_Mode_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    float yaw_rate;                     // 偏航角速度，°/s，顺时针为正
+    uint8_t speed;                      // 摆动速度档（0=停止，1-10）
+} UPLINK_Setpoint_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t cmd;                        // Command_t
+} UPLINK_Command_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint16_t swing_amplitude;           // 摆动幅度，°
+    uint16_t swing_speed;               // 摆动速度档（频率），1-10
+    uint16_t turn_body_bias;            // 转向身体偏置，°
+    uint16_t turn_tail_bias;            // 转向尾巴偏置，°
+} UPLINK_Gait_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    int32_t latitude;                   // 纬度，1e-7度
+    int32_t longitude;                  // 经度，1e-7度
+    float radius;                       // 到达半径，m（0=默认）
+} UPLINK_Waypoint_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;                       // 遥测消息类型TLM_MsgType_t
+    uint16_t rate_hz;                   // 频率，Hz（0=关闭）
+} UPLINK_Rate_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t op;                         // UPLINK_Trace_Op_t
+} UPLINK_Trace_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t profile;                    // Power_Profile_t
+    uint8_t sleep;                      // 1=空闲时进入睡眠，0=不睡眠（对比功耗用）
+} UPLINK_Power_Msg_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t mask;                       // 采集源，按Capture_Source_t位（0=停止采集）
+} UPLINK_Capture_Msg_t;
+
+// 上行接收统计
+typedef struct {
+    uint32_t rx_bytes;                  // 累计接收字节数
+    uint32_t frames;                    // 校验通过的命令帧数
+    uint32_t crc_errors;                // CRC/COBS错误帧数
+    uint32_t oversize;                  // 超长被丢弃的帧数
+    uint32_t ring_overruns;             // 来不及处理导致DMA覆盖次数
+    uint32_t rx_restarts;               // 串口错误后重启接收次数
+} UPLINK_Stats_t;
+
+/************************ 函数声明 ************************/
+// 初始化（启动循环DMA+空闲中断接收，需开启该串口RX DMA循环模式）
+void Uplink_Init(UART_HandleTypeDef *huart);
+// 控制任务周期调用：解析并执行收到的命令
+void Uplink_Process(uint32_t now_ms);
+// 地面站是否在线且处于自动模式
+bool Uplink_Auto_Mode(uint32_t now_ms);
+// 接收事件回调（在HAL_UARTEx_RxEventCallback中调用）
+void Uplink_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+// 错误回调（在HAL_UART_ErrorCallback中调用，接收被中止时重新启动）
+void Uplink_ErrorCallback(UART_HandleTypeDef *huart);
+
+/************************ 全局变量声明 ************************/
+extern UPLINK_Stats_t uplink_stats;
+
+#endif //UPLINK_H
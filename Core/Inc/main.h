@@ -36,7 +36,7 @@ extern "C" {
 
 /* Exported types ------------------------------------------------------------*/
 /* USER CODE BEGIN ET */
-  void UART6_Receive_Start(void);
+
 /* USER CODE END ET */
 
 /* Exported constants --------------------------------------------------------*/
@@ -56,8 +56,12 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
- extern osMessageQueueId_t JY901SHandle;
-  extern osMessageQueueId_t SBUSHandle;
+  extern osEventFlagsId_t InputsHandle;
+  extern osThreadId_t GPS_TaskHandle;
+  extern osThreadId_t SBUS_TaskHandle;
+  extern osThreadId_t JY901S_TaskHandle;
+  extern osThreadId_t ControlHandle;
+  extern osThreadId_t BlackBox_TaskHandle;
 /* USER CODE END EFP */
 
 /* Private defines -----------------------------------------------------------*/
@@ -18,6 +18,13 @@
 
 
 #define OTTOHESL_UART_BUFFER 256
+#include "FMT.h"                    /* 格式化统一走FMT_Vsnprintf（无堆、浮点不依赖newlib） */
+
+/* 调试串口交给UART_TX异步发送引擎：1=开启，0=沿用轮询/单缓冲DMA发送 */
+#define OTTOHESL_UART_TX 1
+#if OTTOHESL_UART_TX
+#include "UART_TX.h"
+#endif
 
 
 void ottohesl_uart(UART_HandleTypeDef *huart, const char *fmt, ...);
@@ -8,6 +8,9 @@
 #include "main.h"
 #include "tim.h"
 
+/************************ 调试模式开关 ************************/
+#define FISH_DEBUG_MODE 0  // 1=打印步态状态（每个控制周期都打印），0=关闭
+
 
 typedef enum {
     STATE_STOP,
@@ -26,7 +29,7 @@ typedef enum {
 
 extern  Command_t current_command;
 extern FishState_t current_state ;
-extern uint32_t state_start_time ;
+extern uint64_t state_start_time ;
 extern float recovery_progress;  // 新增：恢复进度
 
 extern uint32_t turn_cycle_count;  // 新增：记录左转摆动周期计数
@@ -39,8 +42,20 @@ extern float target_body_median;     // 目标身体中值
 extern float target_tail_median;     // 目标尾巴中值
 
 extern  uint8_t speed;
+extern uint16_t swing_amplitude;
+extern uint16_t swing_speed;
+extern uint16_t turn_body_bias;
+extern uint16_t turn_tail_bias;
+
+// 自动驾驶设定：偏航角速度映射为前进摆动的中值偏置
+#define FISH_YAW_RATE_MAX   30.0f   // 偏置满量程对应的偏航角速度（°/s）
+#define FISH_SPEED_DEFAULT  2       // 默认摆动速度档
 
 void Set_Servo_Angle(TIM_HandleTypeDef *htim, uint32_t Channel, uint16_t angle);
+// 步态参数（地面站可在线修改）
+void Set_Swing_Amplitude(uint16_t amplitude);
+void Set_Swing_Speed(uint16_t new_speed);
+void Set_Turn_Parameters(uint16_t body_bias, uint16_t tail_bias);
 void Fish_Stop(void);
 void Fish_Forward(void);
 
@@ -54,5 +69,8 @@ void Fish_StateMachine(void);
 
 // 新增命令响应函数
 void Fish_ExecuteCommand(Command_t cmd);
+// 自动驾驶设定（偏航角速度°/s，顺时针为正；摆动速度档）
+void Fish_Set_Setpoint(float yaw_rate, uint8_t swing_speed);
+void Fish_Clear_Setpoint(void);
 
 #endif //FLSH_STM_STEERING_H
\ No newline at end of file
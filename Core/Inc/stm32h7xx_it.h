@@ -54,7 +54,15 @@ void UsageFault_Handler(void);
 void DebugMon_Handler(void);
 void DMA1_Stream0_IRQHandler(void);
 void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
+void USART1_IRQHandler(void);
+void USART2_IRQHandler(void);
+void USART3_IRQHandler(void);
+void USART6_IRQHandler(void);
 void TIM23_IRQHandler(void);
+void TIM24_IRQHandler(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
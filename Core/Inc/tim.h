@@ -38,6 +38,8 @@ extern TIM_HandleTypeDef htim3;
 
 extern TIM_HandleTypeDef htim4;
 
+extern TIM_HandleTypeDef htim24;
+
 /* USER CODE BEGIN Private defines */
 
 /* USER CODE END Private defines */
@@ -45,6 +47,7 @@ extern TIM_HandleTypeDef htim4;
 void MX_TIM2_Init(void);
 void MX_TIM3_Init(void);
 void MX_TIM4_Init(void);
+void MX_TIM24_Init(void);
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 
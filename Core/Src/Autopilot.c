@@ -0,0 +1,191 @@
+/**
+ * @file       Autopilot.c
+ * @brief      航点自动驾驶（等距圆柱近似求方位/航迹偏差 + 航向PID）
+ * @author     ottohesl
+ * @date       26-1-14
+ * @version    V1.0
+ * @note       1. 航点表存放在RAM中，按顺序逐个跟踪，最后一个航点到达后停止
+ *             2. 位置取自导航滤波的本地NED状态，航点经纬度用原点纬度余弦换算成平面坐标
+ *             3. 期望航向=航线方位-atan(航迹偏差/前视距离)，再由arm_pid_f32输出偏航角速度
+ *             4. 每个控制周期运算量固定（不遍历航点表、无动态内存），适合在控制任务中按固定周期调用
+ */
+#include "Autopilot.h"
+#include <math.h>
+#include <string.h>
+
+/************************ 宏定义 ************************/
+#define AP_DEG2RAD     0.017453292519943295f    // 度转弧度
+#define AP_RAD2DEG     57.29577951308232f       // 弧度转度
+
+/************************ 全局变量 ************************/
+AP_Output_t ap_output;                          // 最近一次输出
+
+/************************ 私有变量 ************************/
+static AP_Waypoint_t waypoints[AP_MAX_WAYPOINTS]; // 航点表
+static uint8_t waypoint_count = 0;               // 航点数
+static uint8_t waypoint_index = 0;               // 当前目标航点
+static arm_pid_instance_f32 heading_pid;         // 航向PID
+static float leg_start_n = 0.0f;                 // 当前航线起点（北向，m）
+static float leg_start_e = 0.0f;                 // 当前航线起点（东向，m）
+static bool leg_start_valid = false;             // 航线起点是否已记录
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  角度归一化到(-180, 180]
+ */
+static float AP_Wrap180(float angle) {
+    while (angle > 180.0f) angle -= 360.0f;
+    while (angle <= -180.0f) angle += 360.0f;
+    return angle;
+}
+
+/**
+ * @brief  航点经纬度转本地NED平面坐标（等距圆柱近似）
+ * @param  nav: 导航状态（提供原点）
+ * @param  wp: 航点
+ * @param  cos_lat: 原点纬度余弦
+ * @param  n/e: 输出北向/东向坐标，m
+ */
+static void AP_Waypoint_To_NED(const NAV_State_t *nav, const AP_Waypoint_t *wp, float cos_lat, float *n, float *e) {
+    const float k = 1e-7f * AP_DEG2RAD * NAV_EARTH_RADIUS;
+    *n = (float)(wp->latitude - nav->origin_lat) * k;
+    *e = (float)(wp->longitude - nav->origin_lon) * k * cos_lat;
+}
+
+/**
+ * @brief  输出停止设定
+ */
+static void AP_Hold(AP_Output_t *out) {
+    out->yaw_rate = 0.0f;
+    out->speed = 0;
+    out->active = false;
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  自动驾驶初始化
+ * @note   arm_pid为离散增量式，Ki、Kd按控制周期AP_CONTROL_DT换算
+ */
+void AP_Init(void) {
+    memset(&ap_output, 0, sizeof(AP_Output_t));
+    heading_pid.Kp = AP_HEADING_KP;
+    heading_pid.Ki = AP_HEADING_KI * AP_CONTROL_DT;
+    heading_pid.Kd = AP_HEADING_KD / AP_CONTROL_DT;
+    arm_pid_init_f32(&heading_pid, 1);
+    AP_Clear_Waypoints();
+}
+
+/**
+ * @brief  清空航点表
+ */
+void AP_Clear_Waypoints(void) {
+    waypoint_count = 0;
+    AP_Restart();
+}
+
+/**
+ * @brief  追加航点
+ * @param  latitude/longitude: 经纬度，1e-7度
+ * @param  radius: 到达半径，m（0=默认）
+ * @retval true: 成功；false: 航点表已满
+ */
+bool AP_Add_Waypoint(int32_t latitude, int32_t longitude, float radius) {
+    if (waypoint_count >= AP_MAX_WAYPOINTS) {
+        return false;
+    }
+    waypoints[waypoint_count].latitude = latitude;
+    waypoints[waypoint_count].longitude = longitude;
+    waypoints[waypoint_count].radius = (radius > 0.0f) ? radius : AP_ACCEPT_RADIUS;
+    waypoint_count++;
+    return true;
+}
+
+/**
+ * @brief  从第一个航点重新开始跟踪
+ * @note   切入自动模式时调用，第一段航线以当时位置为起点
+ */
+void AP_Restart(void) {
+    waypoint_index = 0;
+    leg_start_valid = false;
+    arm_pid_reset_f32(&heading_pid);
+}
+
+/**
+ * @brief  自动驾驶单步（控制周期调用）
+ * @param  nav: 导航滤波状态
+ * @param  heading: 当前航向，°（0=北，顺时针为正）
+ * @param  out: 输出设定（同时写入ap_output）
+ * @note   1. 导航未初始化或航点跑完时输出停止
+ *         2. 进入到达半径后切换到下一航点，新航线以上一航点为起点
+ *         3. 输出饱和时停止积分，限幅只作用于输出，防止积分饱和
+ */
+void AP_Step(const NAV_State_t *nav, float heading, AP_Output_t *out) {
+    if (!nav->valid || waypoint_index >= waypoint_count) {
+        AP_Hold(out);
+        out->wp_index = waypoint_index;
+        ap_output = *out;
+        return;
+    }
+
+    float cos_lat = cosf((float)nav->origin_lat * 1e-7f * AP_DEG2RAD);
+    if (!leg_start_valid) {
+        leg_start_n = nav->pos_n;
+        leg_start_e = nav->pos_e;
+        leg_start_valid = true;
+    }
+
+    // 目标航点平面坐标与距离
+    float wp_n, wp_e;
+    AP_Waypoint_To_NED(nav, &waypoints[waypoint_index], cos_lat, &wp_n, &wp_e);
+    float dn = wp_n - nav->pos_n;
+    float de = wp_e - nav->pos_e;
+    float distance;
+    arm_sqrt_f32(dn * dn + de * de, &distance);
+
+    // 到达：切换到下一航点（本周期仍按旧航点输出，下一周期生效）
+    if (distance < waypoints[waypoint_index].radius) {
+        leg_start_n = wp_n;
+        leg_start_e = wp_e;
+        waypoint_index++;
+        arm_pid_reset_f32(&heading_pid);
+    }
+
+    // 航线方位与航迹偏差
+    float leg_n = wp_n - leg_start_n;
+    float leg_e = wp_e - leg_start_e;
+    float leg_len;
+    arm_sqrt_f32(leg_n * leg_n + leg_e * leg_e, &leg_len);
+    float bearing = atan2f(de, dn) * AP_RAD2DEG;
+    float course_cmd = bearing;
+    float cross_track = 0.0f;
+    if (leg_len > 1.0f) {
+        float leg_bearing = atan2f(leg_e, leg_n) * AP_RAD2DEG;
+        // 叉积：位置相对航线起点的偏移在航线法向上的投影，右侧为正
+        cross_track = ((nav->pos_e - leg_start_e) * leg_n - (nav->pos_n - leg_start_n) * leg_e) / leg_len;
+        course_cmd = leg_bearing - atanf(cross_track / AP_LOOKAHEAD) * AP_RAD2DEG;
+    }
+
+    // 航向PID -> 偏航角速度
+    float heading_error = AP_Wrap180(course_cmd - heading);
+    float yaw_rate = arm_pid_f32(&heading_pid, heading_error);
+    if ((yaw_rate > AP_YAW_RATE_MAX && heading_error > 0.0f) ||
+        (yaw_rate < -AP_YAW_RATE_MAX && heading_error < 0.0f)) {
+        // 饱和时撤销本周期积分项（增量式PID的条件积分）
+        heading_pid.state[2] -= heading_pid.Ki * heading_error;
+    }
+    if (yaw_rate > AP_YAW_RATE_MAX) {
+        yaw_rate = AP_YAW_RATE_MAX;
+    } else if (yaw_rate < -AP_YAW_RATE_MAX) {
+        yaw_rate = -AP_YAW_RATE_MAX;
+    }
+
+    out->yaw_rate = yaw_rate;
+    out->speed = (fabsf(heading_error) > AP_TURN_ERROR) ? AP_SPEED_TURN : AP_SPEED_CRUISE;
+    out->active = true;
+    out->wp_index = waypoint_index;
+    out->distance = distance;
+    out->bearing = (bearing < 0.0f) ? bearing + 360.0f : bearing;
+    out->cross_track = cross_track;
+    out->heading_error = heading_error;
+    ap_output = *out;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file       Bench.c
+ * @brief      微基准测试框架：用例表、结果统计与板上运行器（DWT周期计数，结果经调试串口输出）
+ * @author     ottohesl
+ * @date       26-1-27
+ * @version    V1.0
+ * @note       1. 用例在Bench_Cases.c等文件中用BENCH_CASE注册，链接器把各文件的用例指针汇总到bench_cases段；
+ *                板上镜像FISH_H7_bench与主机运行器FISH_H7_bench_host（Sim/Src/Sim_Bench.c）编译同一份用例
+ *             2. 每个用例：预热BENCH_WARMUP次，再测量BENCH_RUNS次，每次测量前调用setup（不计时），
+ *                连续调用batch次run计为一次测量，扣除一次空测量的开销后按单次折算，取最小/中位/最大
+ *             3. 缓存状态按用例选择：热缓存直接测；冷缓存每次测量前写回并作废D缓存、作废I缓存；
+ *                关缓存整个用例期间关闭I/D缓存（DMA缓冲区不可缓存，关闭前SCB_DisableDCache写回全部脏行）
+ *             4. 板上运行时不启动传感器DMA与调度器，只有HAL节拍、时基溢出与调试串口发送中断；
+ *                每个用例打印后等发送完成再测下一个，串口中断不落在测量区间内，偶发的节拍中断由中位数滤除
+ *             5. 输出每行一个用例，逗号分隔，便于Tools/bench.py解析与基线比较：
+ *                BENCH,begin,轮次,CPU频率,测量次数 / BENCH,用例,缓存状态,batch,最小,中位,最大 / BENCH,end,轮次
+ */
+#include "Bench.h"
+#if BENCH_ENABLE
+#include <stdio.h>
+#include "UART_TX.h"
+#endif
+
+/************************ 全局变量 ************************/
+volatile uint32_t bench_sink;           // BENCH_SINK的写入目标
+
+/************************ 用例表 ************************/
+// bench_cases段的起止（板上由链接脚本定义，主机由链接器按段名自动生成）
+extern const Bench_Case_t *const __start_bench_cases[];
+extern const Bench_Case_t *const __stop_bench_cases[];
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  取用例表
+ * @param  count: 输出用例个数
+ * @retval 用例指针数组（按链接顺序）
+ */
+const Bench_Case_t *const *Bench_Cases(uint32_t *count) {
+    *count = (uint32_t)(__stop_bench_cases - __start_bench_cases);
+    return __start_bench_cases;
+}
+
+/**
+ * @brief  统计一组测量值
+ * @param  samples: 测量值（排序后原地返回）
+ * @param  n: 个数（大于0）
+ * @param  result: 输出最小/中位/最大（overhead不修改）
+ * @note   插入排序，n只有几十
+ */
+void Bench_Summary(uint32_t *samples, uint32_t n, Bench_Result_t *result) {
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t v = samples[i];
+        uint32_t j = i;
+        while (j > 0U && samples[j - 1U] > v) {
+            samples[j] = samples[j - 1U];
+            j--;
+        }
+        samples[j] = v;
+    }
+    result->min = samples[0];
+    result->median = samples[n / 2U];
+    result->max = samples[n - 1U];
+}
+
+#if BENCH_ENABLE
+/************************ 板上运行器 ************************/
+static const char *const bench_cache_names[] = {"warm", "cold", "off"};
+
+/**
+ * @brief  空测量的开销（两次读DWT之间的周期，取多次最小值）
+ */
+static uint32_t Bench_Overhead(void) {
+    uint32_t best = UINT32_MAX;
+    for (uint32_t i = 0; i < 16U; i++) {
+        uint32_t t0 = DWT->CYCCNT;
+        uint32_t t = DWT->CYCCNT - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief  等待调试串口发送完成（测量区间内不出现发送中断）
+ */
+static void Bench_Wait_TX(void) {
+    while (UART_TX_Free() < UART_TX_RING_SIZE) {
+    }
+}
+
+/**
+ * @brief  测量一次：setup（不计时） -> 缓存准备 -> batch次run
+ * @retval 本次测量的总周期（含计时开销）
+ */
+static uint32_t Bench_Measure(const Bench_Case_t *c, uint32_t batch) {
+    if (c->setup != NULL) {
+        c->setup();
+    }
+    if (c->cache == BENCH_CACHE_COLD) {
+        SCB_CleanInvalidateDCache();
+        SCB_InvalidateICache();
+    }
+    uint32_t t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < batch; i++) {
+        c->run();
+    }
+    return DWT->CYCCNT - t0;
+}
+
+/**
+ * @brief  运行一个用例
+ * @param  c: 用例
+ * @param  overhead: 空测量开销
+ * @param  result: 输出单次调用的周期
+ */
+static void Bench_Run_Case(const Bench_Case_t *c, uint32_t overhead, Bench_Result_t *result) {
+    static uint32_t samples[BENCH_RUNS];
+    uint32_t batch = (c->batch == 0U) ? 1U : c->batch;
+    bool icache = (SCB->CCR & SCB_CCR_IC_Msk) != 0U;
+    bool dcache = (SCB->CCR & SCB_CCR_DC_Msk) != 0U;
+
+    if (c->cache == BENCH_CACHE_OFF) {
+        SCB_DisableDCache();
+        SCB_DisableICache();
+    }
+    for (uint32_t i = 0; i < BENCH_WARMUP; i++) {
+        (void)Bench_Measure(c, batch);
+    }
+    for (uint32_t i = 0; i < BENCH_RUNS; i++) {
+        uint32_t t = Bench_Measure(c, batch);
+        t = (t > overhead) ? t - overhead : 0U;
+        samples[i] = (t + batch / 2U) / batch;
+    }
+    if (c->cache == BENCH_CACHE_OFF) {
+        if (icache) {
+            SCB_EnableICache();
+        }
+        if (dcache) {
+            SCB_EnableDCache();
+        }
+    }
+    Bench_Summary(samples, BENCH_RUNS, result);
+    result->overhead = overhead;
+}
+
+/**
+ * @brief  板上基准测试主循环
+ * @note   1. 在main中TimeBase_Init（开启DWT）与UART_TX_Init之后调用，不返回
+ *         2. 用例会改动全局状态（姿态/定位数据、舵机比较值），镜像只用于测量，不控制实物
+ */
+void Bench_Main(void) {
+    uint32_t count;
+    const Bench_Case_t *const *cases = Bench_Cases(&count);
+
+    for (uint32_t round = 1U; ; round++) {
+        uint32_t overhead = Bench_Overhead();
+        printf("BENCH,begin,%lu,%lu,%u\n", (unsigned long)round, (unsigned long)SystemCoreClock,
+               (unsigned)BENCH_RUNS);
+        for (uint32_t i = 0; i < count; i++) {
+            const Bench_Case_t *c = cases[i];
+            Bench_Result_t r;
+            Bench_Wait_TX();
+            Bench_Run_Case(c, overhead, &r);
+            printf("BENCH,%s,%s,%u,%lu,%lu,%lu\n", c->name, bench_cache_names[c->cache],
+                   (unsigned)((c->batch == 0U) ? 1U : c->batch),
+                   (unsigned long)r.min, (unsigned long)r.median, (unsigned long)r.max);
+        }
+        printf("BENCH,end,%lu\n", (unsigned long)round);
+        HAL_Delay(BENCH_PERIOD_MS);
+    }
+}
+#endif
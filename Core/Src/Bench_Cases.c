@@ -0,0 +1,254 @@
+/**
+ * @file       Bench_Cases.c
+ * @brief      微基准测试用例：正弦（sinf与CMSIS-DSP查表）、姿态帧解析、SBUS解码、NMEA解析、导航滤波、格式化、舵机输出
+ * @author     ottohesl
+ * @date       26-1-27
+ * @version    V1.0
+ * @note       1. 板上镜像FISH_H7_bench与主机运行器FISH_H7_bench_host编译同一份用例，名称相同，上位机可分别建立基线
+ *             2. 输入在setup中准备（不计时）：姿态帧写入JY901S的DMA接收缓冲区并改写DMA剩余计数，
+ *                与DMA写入后的状态一致；镜像中传感器DMA未启动，计数可以直接写
+ *             3. 每次调用的输入轮换（相位、舵机角度、GGA/RMC），避免分支预测与缓存只看到同一组数据
+ *             4. 冷缓存用例（_cold）与关缓存用例（_nocache）只对放在Flash/AXI SRAM中的代码和数据有意义，
+ *                FAST_CODE/FAST_DATA在ITCM/DTCM中，这类用例的差别本身就是放置是否生效的检查
+ */
+#include "Bench.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "arm_math.h"
+#include "main.h"
+#include "usart.h"
+#include "tim.h"
+#include "JY901S.h"
+#include "SBUS_T.h"
+#include "NMEA_ATGM336H.h"
+#include "steering.h"
+#include "NAV_Filter.h"
+#include "FMT.h"
+
+/************************ 宏定义 ************************/
+#define BENCH_SIN_POINTS      64U             // 相位表点数（2的幂）
+#define BENCH_IMU_FRAMES      5U              // 一组姿态输出：加速度、角速度、角度、磁场、四元数
+#define BENCH_FMT_BUF         64U
+
+/************************ 外部变量 ************************/
+// JY901S.c中的DMA接收缓冲区与串口句柄（未在头文件中导出）
+extern uint8_t RX[RX_SIZE];
+extern UART_HandleTypeDef *huart_sensor;
+
+/************************ 私有变量 ************************/
+static float bench_phase[BENCH_SIN_POINTS];     // 0~2π的相位
+static uint32_t bench_phase_i = 0;
+static uint32_t bench_imu_pos = 0;              // 姿态帧写入位置（模拟DMA写指针）
+static uint16_t bench_angle = 0;
+static uint32_t bench_sentence = 0;
+static uint32_t bench_fix = 0;
+static jy901 bench_nav_imu;
+static char bench_buf[BENCH_FMT_BUF];
+
+static uint8_t bench_sbus_frame[SBUS_PACKET_LENGTH] = {
+    0x0F, 0xE0, 0x03, 0x1F, 0x58, 0xC0, 0x07, 0x16, 0xB0, 0x80, 0x05, 0x2C, 0x60,
+    0x01, 0x0B, 0xF8, 0xC0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+static const char bench_gga[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char bench_rmc[] = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+static const float bench_attitude[][3] = {
+    {0.0f, -0.0f, 1.005f}, {12.345f, -179.99f, 359.995f}, {-3.14159f, 2.71828f, 0.125f}, {0.5f, 1.5f, 2.5f},
+};
+
+/************************ 正弦 ************************/
+/**
+ * @brief  准备相位表（只在第一次调用时生成）
+ */
+static void Bench_Sin_Setup(void) {
+    if (bench_phase[1] == 0.0f) {
+        for (uint32_t i = 0; i < BENCH_SIN_POINTS; i++) {
+            bench_phase[i] = 6.2831853f * (float)i / (float)BENCH_SIN_POINTS;
+        }
+    }
+}
+
+static void Bench_Sinf(void) {
+    float v = sinf(bench_phase[bench_phase_i++ & (BENCH_SIN_POINTS - 1U)]);
+    BENCH_SINK(v * 1000.0f);
+}
+
+static void Bench_Arm_Sin(void) {
+    float v = arm_sin_f32(bench_phase[bench_phase_i++ & (BENCH_SIN_POINTS - 1U)]);
+    BENCH_SINK(v * 1000.0f);
+}
+
+BENCH_CASE(sinf, Bench_Sin_Setup, Bench_Sinf, 64, BENCH_CACHE_WARM);
+BENCH_CASE(arm_sin_f32, Bench_Sin_Setup, Bench_Arm_Sin, 64, BENCH_CACHE_WARM);
+BENCH_CASE(sinf_nocache, Bench_Sin_Setup, Bench_Sinf, 64, BENCH_CACHE_OFF);
+BENCH_CASE(arm_sin_f32_nocache, Bench_Sin_Setup, Bench_Arm_Sin, 64, BENCH_CACHE_OFF);
+
+/************************ 姿态帧解析 ************************/
+/**
+ * @brief  生成一帧JY901S数据（帧头、类型、4个16位数、和校验）
+ */
+static void Bench_IMU_Frame(uint8_t *frame, uint8_t type, int16_t a, int16_t b, int16_t c, int16_t d) {
+    int16_t v[4] = {a, b, c, d};
+    uint8_t sum = Frame_Head + type;
+    frame[0] = Frame_Head;
+    frame[1] = type;
+    for (uint32_t i = 0; i < 4U; i++) {
+        frame[2U + 2U * i] = (uint8_t)((uint16_t)v[i] & 0xFFU);
+        frame[3U + 2U * i] = (uint8_t)((uint16_t)v[i] >> 8);
+    }
+    for (uint32_t i = 2; i < Frame_Length - 1U; i++) {
+        sum += frame[i];
+    }
+    frame[Frame_Length - 1U] = sum;
+}
+
+/**
+ * @brief  一组5帧写入DMA接收缓冲区，DMA剩余计数指向组尾
+ */
+static void Bench_IMU_Setup(void) {
+    uint8_t group[BENCH_IMU_FRAMES * Frame_Length];
+    int16_t t = (int16_t)(bench_imu_pos * 7U);
+    Bench_IMU_Frame(&group[0], Frame_Accele, 120, -35, 2048, 2500);
+    Bench_IMU_Frame(&group[11], Frame_Gyro, t, -t, 16, 0);
+    Bench_IMU_Frame(&group[22], Frame_Angle, 455, -910, t, 0);
+    Bench_IMU_Frame(&group[33], Frame_Magnet, 300, -120, 45, 0);
+    Bench_IMU_Frame(&group[44], Frame_Quater, 32000, 100, -200, t);
+
+    huart_sensor = &huart_JY901S;
+    for (uint32_t i = 0; i < sizeof(group); i++) {
+        RX[(bench_imu_pos + i) % RX_SIZE] = group[i];
+    }
+    bench_imu_pos = (bench_imu_pos + sizeof(group)) % RX_SIZE;
+    __HAL_DMA_SET_COUNTER(huart_JY901S.hdmarx, RX_SIZE - bench_imu_pos);
+}
+
+static void Bench_IMU_Run(void) {
+    BENCH_SINK(Gyroscope_Process());
+}
+
+BENCH_CASE(gyroscope_process, Bench_IMU_Setup, Bench_IMU_Run, 1, BENCH_CACHE_WARM);
+BENCH_CASE(gyroscope_process_cold, Bench_IMU_Setup, Bench_IMU_Run, 1, BENCH_CACHE_COLD);
+
+/************************ SBUS解码 ************************/
+static void Bench_SBUS_Run(void) {
+    bench_sbus_frame[1] = (uint8_t)bench_angle++;
+    SBUS_Decode_Frame(bench_sbus_frame);
+}
+
+BENCH_CASE(sbus_decode_packet, NULL, Bench_SBUS_Run, 8, BENCH_CACHE_WARM);
+
+/************************ NMEA解析 ************************/
+static void Bench_GGA_Run(void) {
+    BENCH_SINK(GPS_Parse_NMEA(bench_gga));
+}
+
+static void Bench_RMC_Run(void) {
+    BENCH_SINK(GPS_Parse_NMEA(bench_rmc));
+}
+
+static void Bench_NMEA_Run(void) {
+    BENCH_SINK(GPS_Parse_NMEA((bench_sentence++ & 1U) ? bench_rmc : bench_gga));
+}
+
+BENCH_CASE(gps_parse_gga, NULL, Bench_GGA_Run, 1, BENCH_CACHE_WARM);
+BENCH_CASE(gps_parse_rmc, NULL, Bench_RMC_Run, 1, BENCH_CACHE_WARM);
+BENCH_CASE(gps_parse_nmea_cold, NULL, Bench_NMEA_Run, 1, BENCH_CACHE_COLD);
+
+/************************ 导航滤波 ************************/
+/**
+ * @brief  第一次调用时初始化滤波器并用一次定位建立原点（之后各次测量沿用同一原点）
+ */
+static void Bench_NAV_Setup(void) {
+    if (!nav_state.valid) {
+        GPS_Data_t gps = {.latitude = 481173000, .longitude = 115166667, .speed = 120, .course = 4500,
+                          .hdop = 90, .is_valid = 1};
+        NAV_Init();
+        NAV_Post_GPS(&gps);
+        NAV_Update();
+        bench_nav_imu.gyroscope.accele[0] = 0.35f;
+        bench_nav_imu.gyroscope.accele[1] = -0.12f;
+        bench_nav_imu.gyroscope.accele[2] = 9.81f;
+        bench_nav_imu.gyroscope.angle[0] = 2.5f;
+        bench_nav_imu.gyroscope.angle[1] = -4.0f;
+    }
+}
+
+/**
+ * @brief  提交下一次定位（位置在原点附近绕行，NAV_Update走完整的校正而不是初始化）
+ */
+static void Bench_NAV_Update_Setup(void) {
+    Bench_NAV_Setup();
+    uint32_t i = bench_fix++;
+    GPS_Data_t gps = {.latitude = 481173000 + (int32_t)(i & 0xFFU) * 9,
+                      .longitude = 115166667 - (int32_t)(i & 0x7FU) * 13,
+                      .speed = (uint16_t)(100U + (i & 0x3FU)), .course = (uint16_t)((i * 250U) % 36000U),
+                      .hdop = (uint16_t)(80U + (i & 0x1FU)), .is_valid = 1};
+    NAV_Post_GPS(&gps);
+}
+
+static void Bench_NAV_Predict_Run(void) {
+    bench_nav_imu.gyroscope.angle[2] = (float)(bench_angle++ % 360U) - 180.0f;
+    NAV_Predict(&bench_nav_imu, 0.01f);
+    BENCH_SINK(nav_state.predict_steps);
+}
+
+static void Bench_NAV_Update_Run(void) {
+    BENCH_SINK(NAV_Update());
+}
+
+BENCH_CASE(nav_predict, Bench_NAV_Setup, Bench_NAV_Predict_Run, 4, BENCH_CACHE_WARM);
+BENCH_CASE(nav_update, Bench_NAV_Update_Setup, Bench_NAV_Update_Run, 1, BENCH_CACHE_WARM);
+BENCH_CASE(nav_update_cold, Bench_NAV_Update_Setup, Bench_NAV_Update_Run, 1, BENCH_CACHE_COLD);
+
+/************************ 格式化 ************************/
+/**
+ * @brief  按printf的方式转交vsnprintf（调试打印走的是同一条路径）
+ */
+static int Bench_Vsnprintf(char *buf, uint32_t size, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return len;
+}
+
+static void Bench_Vsnprintf_Int(void) {
+    uint32_t i = bench_sentence++;
+    BENCH_SINK(Bench_Vsnprintf(bench_buf, sizeof(bench_buf), "diff=%d  flag=%d pos=%lu\n",
+                               (int)(i & 0x3FFU) - 512, (int)(i & 3U), (unsigned long)i));
+}
+
+static void Bench_FMT_Int(void) {
+    uint32_t i = bench_sentence++;
+    BENCH_SINK(FMT_Snprintf(bench_buf, sizeof(bench_buf), "diff=%d  flag=%d pos=%lu\n",
+                            (int)(i & 0x3FFU) - 512, (int)(i & 3U), (unsigned long)i));
+}
+
+#if FMT_BENCH || defined(FISH_SIM)
+// newlib只在链接浮点printf（FISH_PRINTF_FLOAT）时支持%f，否则板上该用例测的是空转换
+static void Bench_Vsnprintf_F32(void) {
+    const float *a = bench_attitude[bench_sentence++ & 3U];
+    BENCH_SINK(Bench_Vsnprintf(bench_buf, sizeof(bench_buf), "%.2f,%.2f,%.2f", a[0], a[1], a[2]));
+}
+#endif
+
+static void Bench_FMT_F32(void) {
+    const float *a = bench_attitude[bench_sentence++ & 3U];
+    BENCH_SINK(FMT_Snprintf(bench_buf, sizeof(bench_buf), "%.2f,%.2f,%.2f", a[0], a[1], a[2]));
+}
+
+BENCH_CASE(vsnprintf_int, NULL, Bench_Vsnprintf_Int, 4, BENCH_CACHE_WARM);
+BENCH_CASE(fmt_snprintf_int, NULL, Bench_FMT_Int, 4, BENCH_CACHE_WARM);
+BENCH_CASE(fmt_snprintf_f32, NULL, Bench_FMT_F32, 4, BENCH_CACHE_WARM);
+#if FMT_BENCH || defined(FISH_SIM)
+BENCH_CASE(vsnprintf_f32, NULL, Bench_Vsnprintf_F32, 4, BENCH_CACHE_WARM);
+#endif
+
+/************************ 舵机输出 ************************/
+static void Bench_Servo_Run(void) {
+    bench_angle = (uint16_t)((bench_angle + 7U) % 181U);
+    Set_Servo_Angle(&htim3, TIM_CHANNEL_1, bench_angle);
+}
+
+BENCH_CASE(set_servo_angle, NULL, Bench_Servo_Run, 16, BENCH_CACHE_WARM);
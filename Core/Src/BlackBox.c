@@ -0,0 +1,507 @@
+/**
+ * @file       BlackBox.c
+ * @brief      内部Flash黑匣子（遥测同格式记录 + RAM环形缓冲 + 后台任务编程 + 扇区轮换）
+ * @author     ottohesl
+ * @date       26-1-19
+ * @version    V1.0
+ * @note       1. 记录与遥测帧格式相同（COBS(消息头+负载+CRC32) + 0x00），导出后可直接交给Tools/tlm2csv.py解析
+ *             2. 控制任务按频率表采样写入RAM缓冲（只做拷贝），写满一个交给后台任务按32字节Flash字编程；
+ *                缓冲为BB_BUFFER_COUNT个的环形，后台任务擦除扇区期间（不能编程）由其余缓冲接住记录
+ *             3. 记录区4个128K扇区环形轮换，每个扇区首字为扇区头（代数/会话/擦除次数），均匀磨损
+ *             4. H723只有一个Bank，擦除/编程期间从Flash取指会停顿：编程单字约十几us，擦除整扇区约1s，
+ *                因此只在鱼停止时预先擦除后面的扇区，运动中写满已擦除扇区则暂停记录并计数，不阻塞控制环
+ *             5. 导出请求（上行命令）先让控制任务交出半满缓冲（补0x00到Flash字边界），再逐字经遥测发送
+ */
+#include "BlackBox.h"
+#include <stddef.h>
+#include <string.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "crc.h"
+#include "MEM_Cache.h"
+#include "Trace.h"
+#include "steering.h"
+
+/************************ 宏定义 ************************/
+#define BB_ADDR(slot, offset)  (BB_FLASH_BASE + (uint32_t)(slot) * BB_SECTOR_SIZE + (uint32_t)(offset))
+#define BB_DUMP_RETRY          100      // 导出时发送缓冲区满的最大重试次数（每次等2ms）
+
+/************************ 全局变量 ************************/
+BB_Stats_t bb_stats;                            // 记录统计
+
+/************************ 环形缓冲 ************************/
+static uint8_t bb_buf[BB_BUFFER_COUNT][BB_BUFFER_SIZE] __attribute__((aligned(32)));
+static volatile uint16_t bb_len[BB_BUFFER_COUNT];   // 已交给后台任务的缓冲长度（0=空闲，控制任务可写）
+static uint8_t bb_active = 0;                   // 控制任务正在写的缓冲
+static uint16_t bb_pos = 0;                     // 控制任务写入位置
+static uint8_t bb_write_next = 0;               // 后台任务下一个要编程的缓冲（与交出顺序一致）
+
+/************************ 记录区状态 ************************/
+static volatile BB_State_t bb_state = BB_STATE_OFF;
+static volatile bool bb_dump_pending = false;   // 有导出请求待处理
+static uint32_t bb_slot;                        // 当前扇区（0 ~ BB_SECTOR_COUNT-1）
+static uint32_t bb_offset;                      // 当前扇区写入偏移
+static uint32_t bb_generation;                  // 当前扇区写入代数
+static uint32_t bb_session;                     // 本次上电会话号
+static uint32_t bb_erase_count[BB_SECTOR_COUNT];// 各扇区累计擦除次数
+static bool bb_blank[BB_SECTOR_COUNT];          // 扇区已擦除且未写入
+
+/************************ 采样频率 ************************/
+static uint16_t bb_seq = 0;                     // 记录序号（与遥测独立，导出后按序号间隔统计丢失）
+static uint16_t bb_period[TLM_MSG_COUNT];       // 各类消息记录周期，ms（0=不记录）
+static uint32_t bb_next[TLM_MSG_COUNT];         // 各类消息下次记录时间，ms
+
+// 默认记录频率（Hz），合计约200条/秒、7KB/s，一个扇区约18s
+static const uint16_t bb_default_rate[TLM_MSG_COUNT] = {
+    [TLM_MSG_IMU]   = 100,
+    [TLM_MSG_RC]    = 10,
+    [TLM_MSG_GAIT]  = 20,
+    [TLM_MSG_SERVO] = 50,
+    [TLM_MSG_GPS]   = 10,
+    [TLM_MSG_TASK]  = 1,
+    [TLM_MSG_NAV]   = 10,
+    [TLM_MSG_CPU]   = 1,
+};
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  读取DWT周期计数器（TimeBase_Init中已开启）
+ */
+static inline uint32_t BB_Cycles(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief  当前是否允许擦除（擦除期间CPU从Flash取指停顿）
+ */
+static bool BB_Erase_Allowed(void) {
+#if BB_ERASE_WHILE_RUNNING
+    return true;
+#else
+    return current_state == STATE_STOP;
+#endif
+}
+
+/**
+ * @brief  编程一个Flash字
+ * @param  addr: 目标地址（32字节对齐）
+ * @param  src: 源数据（4字节对齐）
+ */
+static bool BB_Program(uint32_t addr, const void *src) {
+    uint32_t start = BB_Cycles();
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, addr, (uint32_t)src);
+    HAL_FLASH_Lock();
+    uint32_t cycles = BB_Cycles() - start;
+    if (cycles > bb_stats.program_cycles_max) {
+        bb_stats.program_cycles_max = cycles;
+    }
+    if (status != HAL_OK) {
+        bb_stats.flash_errors++;
+        return false;
+    }
+    bb_stats.flash_bytes += BB_WORD_SIZE;
+    return true;
+}
+
+/**
+ * @brief  擦除一个记录区扇区（阻塞约1s）
+ */
+static bool BB_Erase(uint32_t slot) {
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t sector_error = 0;
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Banks = FLASH_BANK_1;
+    erase.Sector = BB_SECTOR_FIRST + slot;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    // 擦除期间SysTick/定时器中断同样停顿，耗时按DWT周期换算
+    uint32_t start = BB_Cycles();
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &sector_error);
+    HAL_FLASH_Lock();
+    uint32_t ms = (BB_Cycles() - start) / (SystemCoreClock / 1000U);
+    MEM_DCache_Invalidate((void *)BB_ADDR(slot, 0), BB_SECTOR_SIZE);   // 记录区经D缓存读取，擦除后作废旧内容
+
+    bb_erase_count[slot]++;
+    bb_stats.erases++;
+    if (ms > bb_stats.erase_ms_max) {
+        bb_stats.erase_ms_max = (uint16_t)ms;
+    }
+    bb_blank[slot] = (status == HAL_OK);
+    if (status != HAL_OK) {
+        bb_stats.flash_errors++;
+    }
+    return bb_blank[slot];
+}
+
+/**
+ * @brief  扇区头是否有效
+ */
+static bool BB_Header_Valid(const BB_SectorHeader_t *h) {
+    return h->magic == BB_MAGIC && h->crc == CRC32_Calc((const uint8_t *)h, offsetof(BB_SectorHeader_t, crc));
+}
+
+/**
+ * @brief  扇区是否全为0xFF（已擦除）
+ */
+static bool BB_Sector_Blank(uint32_t slot) {
+    const uint32_t *p = (const uint32_t *)BB_ADDR(slot, 0);
+    for (uint32_t i = 0; i < BB_SECTOR_SIZE / 4; i++) {
+        if (p[i] != 0xFFFFFFFFU) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief  扇区已写入的长度（最后一个非空Flash字之后）
+ */
+static uint32_t BB_Sector_End(uint32_t slot) {
+    const uint32_t *p = (const uint32_t *)BB_ADDR(slot, 0);
+    for (uint32_t i = BB_SECTOR_SIZE / 4; i > 0; i--) {
+        if (p[i - 1] != 0xFFFFFFFFU) {
+            return ((i - 1) / (BB_WORD_SIZE / 4) + 1) * BB_WORD_SIZE;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  开始写一个已擦除的扇区（写扇区头）
+ */
+static void BB_Begin_Sector(uint32_t slot) {
+    BB_SectorHeader_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic = BB_MAGIC;
+    h.generation = ++bb_generation;
+    h.session = bb_session;
+    h.erase_count = bb_erase_count[slot];
+    h.boot_tick = HAL_GetTick();
+    h.crc = CRC32_Calc((const uint8_t *)&h, offsetof(BB_SectorHeader_t, crc));
+    BB_Program(BB_ADDR(slot, 0), &h);
+    bb_blank[slot] = false;
+    bb_slot = slot;
+    bb_offset = BB_WORD_SIZE;
+}
+
+/**
+ * @brief  把一个缓冲编程到Flash（后台任务）
+ * @note   当前扇区写满时换到下一个扇区；下一个扇区未擦除且不允许擦除时丢弃剩余数据并进入FULL
+ */
+static void BB_Write_Buffer(const uint8_t *src, uint32_t len) {
+    for (uint32_t i = 0; i < len; i += BB_WORD_SIZE) {
+        if (bb_offset >= BB_SECTOR_SIZE) {
+            uint32_t next = (bb_slot + 1) % BB_SECTOR_COUNT;
+            if (!bb_blank[next] && !(BB_Erase_Allowed() && BB_Erase(next))) {
+                bb_state = BB_STATE_FULL;
+                bb_stats.lost_bytes += len - i;
+                return;
+            }
+            BB_Begin_Sector(next);
+        }
+        BB_Program(BB_ADDR(bb_slot, bb_offset), &src[i]);
+        bb_offset += BB_WORD_SIZE;
+    }
+}
+
+/**
+ * @brief  交出当前缓冲给后台任务
+ * @param  len: 有效长度（Flash字的整数倍）
+ */
+static void BB_Handover(uint16_t len) {
+    __DMB();
+    bb_len[bb_active] = len;
+    bb_active = (uint8_t)((bb_active + 1U) % BB_BUFFER_COUNT);
+    bb_pos = 0;
+    osThreadFlagsSet(BlackBox_TaskHandle, BB_FLAG_WRITE);
+}
+
+/**
+ * @brief  追加一条记录到RAM缓冲（控制任务）
+ * @retval false: 当前缓冲与下一个空闲缓冲都不够，整条丢弃
+ */
+FAST_CODE static bool BB_Append(const uint8_t *data, uint32_t len) {
+    uint8_t next = (uint8_t)((bb_active + 1U) % BB_BUFFER_COUNT);
+    uint32_t space = 0;
+    if (bb_len[bb_active] == 0) {
+        space = BB_BUFFER_SIZE - bb_pos;
+        if (bb_len[next] == 0) {
+            space += BB_BUFFER_SIZE;
+        }
+    }
+    if (len > space) {
+        return false;
+    }
+    uint32_t first = BB_BUFFER_SIZE - bb_pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&bb_buf[bb_active][bb_pos], data, first);
+    bb_pos += first;
+    if (bb_pos == BB_BUFFER_SIZE) {
+        BB_Handover(BB_BUFFER_SIZE);
+        memcpy(&bb_buf[bb_active][0], &data[first], len - first);
+        bb_pos = (uint16_t)(len - first);
+    }
+    return true;
+}
+
+/**
+ * @brief  导出全部记录（后台任务，按代数从旧到新）
+ */
+static void BB_Dump(void) {
+    uint32_t order[BB_SECTOR_COUNT];
+    uint32_t gens[BB_SECTOR_COUNT];
+    uint32_t count = 0;
+    bb_stats.dump_words = 0;
+
+    // 1. 有效扇区按代数插入排序
+    for (uint32_t slot = 0; slot < BB_SECTOR_COUNT; slot++) {
+        const BB_SectorHeader_t *h = (const BB_SectorHeader_t *)BB_ADDR(slot, 0);
+        MEM_DCache_Invalidate((void *)BB_ADDR(slot, 0), BB_SECTOR_SIZE);
+        if (!BB_Header_Valid(h)) {
+            continue;
+        }
+        uint32_t i = count++;
+        while (i > 0 && gens[i - 1] > h->generation) {
+            gens[i] = gens[i - 1];
+            order[i] = order[i - 1];
+            i--;
+        }
+        gens[i] = h->generation;
+        order[i] = slot;
+    }
+
+    // 2. 逐字发送（含扇区头），发送缓冲区满时等待
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t slot = order[n];
+        uint32_t end = (slot == bb_slot) ? bb_offset : BB_Sector_End(slot);
+        TLM_BB_Data_t m;
+        m.generation = gens[n];
+        for (uint32_t off = 0; off < end; off += BB_WORD_SIZE) {
+            m.offset = off;
+            memcpy(m.data, (const void *)BB_ADDR(slot, off), BB_WORD_SIZE);
+            uint32_t retry = 0;
+            while (!Telemetry_Send(TLM_MSG_BB_DATA, &m, sizeof(m))) {
+                if (++retry > BB_DUMP_RETRY) {
+                    return;
+                }
+                osDelay(2);
+            }
+            bb_stats.dump_words++;
+        }
+    }
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  黑匣子初始化
+ * @note   1. 扫描各扇区头，会话号与写入代数接着历史最大值，从最新扇区的下一个扇区开始写
+ *         2. 起始扇区未擦除则在此擦除（调度器启动前，阻塞不影响控制环）
+ *         3. 需在MX_CRC_Init、TimeBase_Init（开启DWT）之后调用
+ */
+void BlackBox_Init(void) {
+    uint32_t max_session = 0;
+    int32_t last = -1;
+    memset(&bb_stats, 0, sizeof(BB_Stats_t));
+    bb_generation = 0;
+    for (uint32_t slot = 0; slot < BB_SECTOR_COUNT; slot++) {
+        const BB_SectorHeader_t *h = (const BB_SectorHeader_t *)BB_ADDR(slot, 0);
+        bb_erase_count[slot] = 0;
+        if (BB_Header_Valid(h)) {
+            bb_erase_count[slot] = h->erase_count;
+            if (last < 0 || h->generation > bb_generation) {
+                bb_generation = h->generation;
+                last = (int32_t)slot;
+            }
+            if (h->session > max_session) {
+                max_session = h->session;
+            }
+        }
+        bb_blank[slot] = BB_Sector_Blank(slot);
+    }
+    bb_session = max_session + 1;
+
+    for (int i = 0; i < TLM_MSG_COUNT; i++) {
+        BlackBox_Set_Rate((TLM_MsgType_t)i, bb_default_rate[i]);
+        bb_next[i] = 0;
+    }
+    memset((void *)bb_len, 0, sizeof(bb_len));
+    bb_active = bb_write_next = 0;
+    bb_pos = 0;
+
+    uint32_t start = (last < 0) ? 0 : ((uint32_t)last + 1) % BB_SECTOR_COUNT;
+    if (bb_blank[start] || BB_Erase(start)) {
+        BB_Begin_Sector(start);
+        bb_state = BB_STATE_RECORDING;
+    } else {
+        bb_state = BB_STATE_OFF;
+    }
+}
+
+/**
+ * @brief  设置某类消息的记录频率
+ * @param  type: 消息类型
+ * @param  rate_hz: 频率，Hz（0=不记录）
+ */
+void BlackBox_Set_Rate(TLM_MsgType_t type, uint16_t rate_hz) {
+    if ((unsigned)type >= TLM_MSG_COUNT) {
+        return;
+    }
+    if (rate_hz == 0) {
+        bb_period[type] = 0;
+    } else {
+        bb_period[type] = (rate_hz >= 1000) ? 1 : (uint16_t)(1000 / rate_hz);
+    }
+}
+
+/**
+ * @brief  周期采样（控制任务调用）
+ * @param  now_ms: 当前时间，ms
+ * @note   1. 只做采样、编码和内存拷贝，不访问Flash
+ *         2. FLUSH状态下补齐并交出半满缓冲，随后进入DUMPING
+ */
+FAST_CODE void BlackBox_Process(uint32_t now_ms) {
+    BB_State_t state = bb_state;
+    if (state == BB_STATE_FLUSH) {
+        if (bb_len[bb_active] == 0) {
+            if (bb_pos != 0) {
+                // 补0x00到Flash字边界（空帧，解析时跳过）
+                uint16_t padded = (uint16_t)((bb_pos + BB_WORD_SIZE - 1) & ~(BB_WORD_SIZE - 1));
+                memset(&bb_buf[bb_active][bb_pos], TLM_FRAME_DELIMITER, padded - bb_pos);
+                BB_Handover(padded);
+            }
+            bb_state = BB_STATE_DUMPING;
+            osThreadFlagsSet(BlackBox_TaskHandle, BB_FLAG_WRITE);
+        }
+        return;
+    }
+
+    for (int i = 0; i < TLM_MSG_COUNT; i++) {
+        uint16_t period = bb_period[i];
+        if (period == 0 || (int32_t)(now_ms - bb_next[i]) < 0) {
+            continue;
+        }
+        bb_next[i] += period;
+        if ((int32_t)(now_ms - bb_next[i]) >= 0) {
+            bb_next[i] = now_ms + period;
+        }
+
+        if (state == BB_STATE_FULL) {
+            bb_stats.dropped++;
+            continue;
+        }
+        if (state != BB_STATE_RECORDING) {
+            continue;
+        }
+        uint8_t payload[TLM_PAYLOAD_MAX];
+        uint8_t frame[TLM_FRAME_MAX];
+        uint8_t len = Telemetry_Pack((TLM_MsgType_t)i, payload);
+        if (len == 0) {
+            continue;
+        }
+        uint32_t frame_len = Telemetry_Encode(frame, (TLM_MsgType_t)i, bb_seq++, payload, len);
+        if (BB_Append(frame, frame_len)) {
+            bb_stats.records++;
+        } else {
+            bb_stats.dropped++;
+        }
+    }
+}
+
+/**
+ * @brief  后台任务循环体
+ * @note   1. 按交出顺序编程缓冲
+ *         2. 处理导出请求：RECORDING/FULL -> FLUSH，控制任务交出缓冲后 -> DUMPING -> 导出 -> RECORDING
+ *         3. 鱼停止时每次最多预擦除一个扇区；FULL状态下下一扇区擦好后恢复记录
+ */
+void BlackBox_Service(void) {
+    // 1. 编程已交出的缓冲
+    while (bb_len[bb_write_next] != 0) {
+        if (bb_state != BB_STATE_FULL) {
+            TRACE_BEGIN(TRACE_MARK_FLASH_PROGRAM);
+            BB_Write_Buffer(bb_buf[bb_write_next], bb_len[bb_write_next]);
+            TRACE_END(TRACE_MARK_FLASH_PROGRAM);
+        } else {
+            bb_stats.lost_bytes += bb_len[bb_write_next];
+        }
+        __DMB();
+        bb_len[bb_write_next] = 0;
+        bb_write_next = (uint8_t)((bb_write_next + 1U) % BB_BUFFER_COUNT);
+    }
+
+    // 2. 导出
+    BB_State_t state = bb_state;
+    if (bb_dump_pending && (state == BB_STATE_RECORDING || state == BB_STATE_FULL)) {
+        bb_dump_pending = false;
+        bb_state = BB_STATE_FLUSH;
+        return;
+    }
+    if (state == BB_STATE_DUMPING) {
+        TLM_BB_Status_t status;
+        for (uint32_t i = 0; i < BB_BUFFER_COUNT; i++) {
+            if (bb_len[i] != 0) {
+                return;         // 控制任务刚交出的半满缓冲尚未编程，线程标志已置位，下一轮处理
+            }
+        }
+        BB_Dump();
+        bb_state = (bb_offset >= BB_SECTOR_SIZE) ? BB_STATE_FULL : BB_STATE_RECORDING;
+        BlackBox_Get_Status(&status);
+        Telemetry_Send(TLM_MSG_BB_STATUS, &status, sizeof(status));
+        return;
+    }
+    if (state == BB_STATE_OFF || state == BB_STATE_FLUSH) {
+        return;
+    }
+
+    // 3. 预擦除（鱼停止时）
+    if (BB_Erase_Allowed()) {
+        for (uint32_t i = 1; i <= BB_ERASE_AHEAD && i < BB_SECTOR_COUNT; i++) {
+            uint32_t slot = (bb_slot + i) % BB_SECTOR_COUNT;
+            if (!bb_blank[slot]) {
+                BB_Erase(slot);
+                break;
+            }
+        }
+    }
+
+    // 4. FULL恢复：从下一个已擦除扇区继续
+    uint32_t next = (bb_slot + 1) % BB_SECTOR_COUNT;
+    if (state == BB_STATE_FULL && bb_blank[next]) {
+        BB_Begin_Sector(next);
+        bb_state = BB_STATE_RECORDING;
+    }
+}
+
+/**
+ * @brief  请求导出
+ * @retval false: 未初始化或正在导出
+ */
+bool BlackBox_Request_Dump(void) {
+    BB_State_t state = bb_state;
+    if (state != BB_STATE_RECORDING && state != BB_STATE_FULL) {
+        return false;
+    }
+    bb_dump_pending = true;
+    osThreadFlagsSet(BlackBox_TaskHandle, BB_FLAG_WRITE);
+    return true;
+}
+
+/**
+ * @brief  填写状态消息
+ */
+void BlackBox_Get_Status(TLM_BB_Status_t *status) {
+    status->session = bb_session;
+    status->generation = bb_generation;
+    status->records = bb_stats.records;
+    status->dropped = bb_stats.dropped;
+    status->flash_bytes = bb_stats.flash_bytes;
+    status->dump_words = bb_stats.dump_words;
+    status->erases = bb_stats.erases;
+    status->erase_ms_max = bb_stats.erase_ms_max;
+    status->state = (uint8_t)bb_state;
+    status->sector = (uint8_t)bb_slot;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file       CASIC_ATGM336H.c
+ * @brief      ATGM336H（AT6558）CASIC协议：上电配置命令与二进制NAV-PV解码
+ * @author     ottohesl
+ * @date       26-1-10
+ * @version    V1.0
+ * @note       1. 上电默认9600波特率、1Hz、全量NMEA输出（GSV/GSA等均无用）
+ *             2. 配置后115200波特率、10Hz，只输出需要的数据，减少解析开销
+ *             3. GPS_USE_BINARY=1时改为输出二进制NAV-PV（80字节定长，免文本解析）
+ *             4. 配置未保存到接收机Flash，掉电后恢复默认，每次上电重新下发
+ */
+#include "CASIC_ATGM336H.h"
+#include <string.h>
+#include "FMT.h"
+#include "MEM_Cache.h"
+#include "Trace.h"
+
+/************************ 二进制帧解析静态变量 ************************/
+static CASIC_FrameState frame_state = CASIC_SEEK_HEAD_1;  // 解析状态机
+static uint16_t frame_len = 0;                            // 负载长度
+static uint16_t frame_pos = 0;                            // 当前字段接收位置
+static uint8_t frame_class = 0;                           // 帧类
+static uint8_t frame_id = 0;                              // 帧ID
+static uint32_t frame_checksum = 0;                       // 接收到的校验
+static uint8_t frame_payload[CASIC_MAX_PAYLOAD] __attribute__((aligned(4))); // 负载缓冲区
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  CASIC校验：(id<<24)+(class<<16)+len，再按小端32位字累加负载
+ */
+static uint32_t CASIC_Checksum(uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len) {
+    uint32_t sum = ((uint32_t)id << 24) + ((uint32_t)cls << 16) + len;
+    for (uint16_t i = 0; i + 3 < len; i += 4) {
+        sum += (uint32_t)payload[i] | ((uint32_t)payload[i + 1] << 8) |
+               ((uint32_t)payload[i + 2] << 16) | ((uint32_t)payload[i + 3] << 24);
+    }
+    return sum;
+}
+
+static float read_f32(const uint8_t *p) {
+    float v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static double read_f64(const uint8_t *p) {
+    double v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  发送CASIC文本命令
+ * @param  huart: GPS串口句柄
+ * @param  body: 不含'$'和校验的命令体，如"PCAS02,100"
+ */
+void CASIC_Send_Text(UART_HandleTypeDef *huart, const char *body) {
+    char cmd[80];
+    uint8_t checksum = 0;
+    for (const char *p = body; *p; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    int len = FMT_Snprintf(cmd, sizeof(cmd), "$%s*%02X\r\n", body, checksum);
+    if (len > 0 && len < (int)sizeof(cmd)) {
+        TRACE_BEGIN(TRACE_MARK_UART_BLOCKING);
+        HAL_UART_Transmit(huart, (uint8_t *)cmd, (uint16_t)len, 100);
+        TRACE_END(TRACE_MARK_UART_BLOCKING);
+    }
+}
+
+/**
+ * @brief  发送CASIC二进制命令
+ * @param  huart: GPS串口句柄
+ * @param  cls/id: 消息类与ID
+ * @param  payload: 负载（长度需为4的倍数）
+ * @param  len: 负载长度
+ */
+void CASIC_Send_Binary(UART_HandleTypeDef *huart, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len) {
+    uint8_t frame[6 + CASIC_MAX_PAYLOAD + 4];
+    if (len > CASIC_MAX_PAYLOAD) {
+        return;
+    }
+    uint32_t sum = CASIC_Checksum(cls, id, payload, len);
+    frame[0] = CASIC_HEAD_1;
+    frame[1] = CASIC_HEAD_2;
+    frame[2] = (uint8_t)(len & 0xFF);
+    frame[3] = (uint8_t)(len >> 8);
+    frame[4] = cls;
+    frame[5] = id;
+    memcpy(&frame[6], payload, len);
+    frame[6 + len] = (uint8_t)(sum & 0xFF);
+    frame[7 + len] = (uint8_t)(sum >> 8);
+    frame[8 + len] = (uint8_t)(sum >> 16);
+    frame[9 + len] = (uint8_t)(sum >> 24);
+    TRACE_BEGIN(TRACE_MARK_UART_BLOCKING);
+    HAL_UART_Transmit(huart, frame, (uint16_t)(len + 10), 100);
+    TRACE_END(TRACE_MARK_UART_BLOCKING);
+}
+
+/**
+ * @brief  ATGM336H上电配置（阻塞，需在启动调度器前调用）
+ * @param  huart: GPS串口句柄（此时为CubeMX默认的9600波特率）
+ * @note   1. 9600下发送PCAS01切到115200，随后本端串口同步切换
+ *         2. PCAS02设置定位周期，PCAS03关闭GSV/GSA/GLL/VTG等无用语句
+ *         3. 二进制模式下用CFG-MSG打开NAV-PV，并关闭全部NMEA输出
+ */
+void CASIC_Configure(UART_HandleTypeDef *huart) {
+    char body[32];
+
+    // 1. 提高波特率（接收机先切换，本端随后切换）
+    FMT_Snprintf(body, sizeof(body), "PCAS01,%d", GPS_BAUD_CODE_FAST);
+    CASIC_Send_Text(huart, body);
+    HAL_Delay(50);
+    huart->Init.BaudRate = GPS_BAUD_FAST;
+    HAL_UART_Init(huart);
+    HAL_Delay(50);
+
+    // 2. 定位输出周期
+    FMT_Snprintf(body, sizeof(body), "PCAS02,%d", GPS_FIX_PERIOD_MS);
+    CASIC_Send_Text(huart, body);
+    HAL_Delay(20);
+
+#if GPS_USE_BINARY
+    // 3. 打开二进制NAV-PV（每次定位输出一次），关闭全部NMEA
+    const uint8_t nav_pv_rate[4] = {CASIC_CLASS_NAV, CASIC_ID_NAV_PV, 0x01, 0x00};
+    CASIC_Send_Binary(huart, CASIC_CLASS_CFG, CASIC_ID_CFG_MSG, nav_pv_rate, sizeof(nav_pv_rate));
+    HAL_Delay(20);
+    CASIC_Send_Text(huart, "PCAS03,0,0,0,0,0,0,0,0,0,0,,,0,0,,,,0");
+#else
+    // 3. 只保留GGA和RMC
+    CASIC_Send_Text(huart, "PCAS03,1,0,0,0,1,0,0,0,0,0,,,0,0,,,,0");
+#endif
+    HAL_Delay(20);
+}
+
+/**
+ * @brief  CASIC二进制帧逐字节解析
+ * @param  byte: 接收字节
+ * @retval 1=收到一帧校验正确的完整帧，0=未完成或出错
+ */
+FAST_CODE uint8_t CASIC_Parse_Byte(uint8_t byte) {
+    switch (frame_state) {
+        case CASIC_SEEK_HEAD_1:
+            if (byte == CASIC_HEAD_1) {
+                frame_state = CASIC_SEEK_HEAD_2;
+            }
+            break;
+
+        case CASIC_SEEK_HEAD_2:
+            frame_state = (byte == CASIC_HEAD_2) ? CASIC_RECEIVE_LENGTH : CASIC_SEEK_HEAD_1;
+            frame_pos = 0;
+            frame_len = 0;
+            break;
+
+        case CASIC_RECEIVE_LENGTH:
+            frame_len |= (uint16_t)byte << (8 * frame_pos);
+            if (++frame_pos >= 2) {
+                // 超长或非4字节对齐的帧直接丢弃
+                frame_state = (frame_len <= CASIC_MAX_PAYLOAD && (frame_len & 0x3) == 0)
+                              ? CASIC_RECEIVE_CLASS : CASIC_SEEK_HEAD_1;
+            }
+            break;
+
+        case CASIC_RECEIVE_CLASS:
+            frame_class = byte;
+            frame_state = CASIC_RECEIVE_ID;
+            break;
+
+        case CASIC_RECEIVE_ID:
+            frame_id = byte;
+            frame_pos = 0;
+            frame_state = (frame_len > 0) ? CASIC_RECEIVE_PAYLOAD : CASIC_RECEIVE_CHECKSUM;
+            break;
+
+        case CASIC_RECEIVE_PAYLOAD:
+            frame_payload[frame_pos++] = byte;
+            if (frame_pos >= frame_len) {
+                frame_pos = 0;
+                frame_checksum = 0;
+                frame_state = CASIC_RECEIVE_CHECKSUM;
+            }
+            break;
+
+        case CASIC_RECEIVE_CHECKSUM:
+            frame_checksum |= (uint32_t)byte << (8 * frame_pos);
+            if (++frame_pos >= 4) {
+                frame_state = CASIC_SEEK_HEAD_1;
+                return frame_checksum == CASIC_Checksum(frame_class, frame_id, frame_payload, frame_len);
+            }
+            break;
+    }
+    return 0;
+}
+
+/**
+ * @brief  是否正处于二进制帧中
+ * @retval 1=已收到帧头，后续字节属于二进制帧
+ */
+uint8_t CASIC_In_Frame(void) {
+    return frame_state > CASIC_SEEK_HEAD_2;
+}
+
+/**
+ * @brief  解码最近一帧NAV-PV
+ * @param  gps_data: 输出GPS数据（只更新NAV-PV包含的字段）
+ * @retval 1=定位有效，0=不是NAV-PV或定位无效
+ * @note   NAV-PV不含UTC时间，utc_time/utc_date保持不变；只有pDop，写入pdop，hdop置0（不能把PDOP当HDOP）
+ */
+uint8_t CASIC_Decode_NavPV(GPS_Data_t *gps_data) {
+    if (frame_class != CASIC_CLASS_NAV || frame_id != CASIC_ID_NAV_PV || frame_len != CASIC_NAV_PV_LENGTH) {
+        return 0;
+    }
+    const uint8_t *p = frame_payload;
+    uint8_t pos_valid = p[4];             // 0无效 ... 6=2D 7=3D 8=组合导航
+
+    gps_data->satellites = p[7];
+    gps_data->pdop = (uint16_t)(read_f32(&p[12]) * 100.0f);                // pDop
+    gps_data->hdop = 0;                                                    // NAV-PV不含hDop
+    gps_data->longitude = (int32_t)(read_f64(&p[16]) * 1e7);               // lon，度
+    gps_data->latitude = (int32_t)(read_f64(&p[24]) * 1e7);                // lat，度
+    gps_data->altitude = (int32_t)(read_f32(&p[32]) * 100.0f);             // height，m
+    gps_data->speed = (uint16_t)(read_f32(&p[64]) * 100.0f);               // speed2D，m/s
+    float heading = read_f32(&p[68]);                                      // heading，度
+    gps_data->course = (uint16_t)((heading < 0.0f ? heading + 360.0f : heading) * 100.0f);
+
+    gps_data->fix_quality = (pos_valid >= 6) ? 1 : 0;
+    gps_data->status = gps_data->fix_quality ? 'A' : 'V';
+    gps_data->is_valid = gps_data->fix_quality;
+    return gps_data->is_valid;
+}
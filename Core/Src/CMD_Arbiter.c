@@ -0,0 +1,166 @@
+/**
+ * @file       CMD_Arbiter.c
+ * @brief      运动指令源仲裁（遥控/地面站/自动驾驶）
+ * @author     ottohesl
+ * @date       26-1-18
+ * @version    V1.0
+ * @note       1. 各指令源只提交请求，不直接调用Fish_ExecuteCommand，由控制任务统一执行，避免多任务同时改状态机
+ *             2. 优先级：遥控手动 > 地面站 > 自动驾驶；请求超过各自超时未刷新即失效，全部失效时停止
+ *             3. 只有新提交的请求或指令源切换时才执行命令，保证与原先“每帧执行一次”的遥控行为一致
+ *             4. 遥控在手动档且信号正常时始终持有控制权，地面站需遥控拨到自动档或关闭遥控后才能接管
+ *             5. 提交时间和仲裁时间都取TimeBase_Now_us，同一时钟，超时判断不受HAL节拍与内核节拍偏差影响
+ */
+#include "CMD_Arbiter.h"
+#include <string.h>
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+
+/************************ 全局变量 ************************/
+CMD_Arbiter_Stats_t cmd_arbiter_stats;          // 仲裁统计
+
+/************************ 私有变量 ************************/
+static CMD_Request_t requests[CMD_SRC_COUNT];   // 各指令源最新请求
+static bool setpoint_applied = false;           // 当前是否处于连续设定（需要在切走时清除偏置）
+
+static const uint16_t source_timeout[CMD_SRC_COUNT] FAST_CONST = {
+    [CMD_SRC_SBUS]   = CMD_SBUS_TIMEOUT,
+    [CMD_SRC_UPLINK] = CMD_UPLINK_TIMEOUT,
+    [CMD_SRC_AUTO]   = CMD_AUTO_TIMEOUT,
+};
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  写入请求（关中断保证请求整体一致，耗时为常数）
+ */
+static void CMD_Store(CMD_Source_t src, const CMD_Request_t *req) {
+    if ((unsigned)src >= CMD_SRC_COUNT) {
+        return;
+    }
+    __disable_irq();
+    requests[src] = *req;
+    __enable_irq();
+}
+
+/**
+ * @brief  执行选中的请求
+ */
+static void CMD_Apply(const CMD_Request_t *req) {
+    if (req->setpoint) {
+        if (req->speed == 0) {
+            Fish_Clear_Setpoint();
+            setpoint_applied = false;
+            Fish_ExecuteCommand(CMD_STOP);
+            return;
+        }
+        Fish_Set_Setpoint(req->yaw_rate, req->speed);
+        setpoint_applied = true;
+        Fish_ExecuteCommand(CMD_FORWARD);
+        return;
+    }
+    if (setpoint_applied) {
+        Fish_Clear_Setpoint();
+        setpoint_applied = false;
+    }
+    Fish_ExecuteCommand(req->cmd);
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  仲裁器初始化
+ */
+void CMD_Arbiter_Init(void) {
+    memset(requests, 0, sizeof(requests));
+    memset(&cmd_arbiter_stats, 0, sizeof(CMD_Arbiter_Stats_t));
+    cmd_arbiter_stats.active = CMD_SRC_NONE;
+    setpoint_applied = false;
+}
+
+/**
+ * @brief  提交离散命令
+ * @param  src: 指令源
+ * @param  cmd: 命令
+ */
+void CMD_Submit(CMD_Source_t src, Command_t cmd) {
+    CMD_Request_t req = {0};
+    req.cmd = cmd;
+    req.time_us = TimeBase_Now_us();
+    req.valid = true;
+    req.fresh = true;
+    CMD_Store(src, &req);
+}
+
+/**
+ * @brief  提交连续设定
+ * @param  src: 指令源
+ * @param  yaw_rate: 偏航角速度，°/s，顺时针为正
+ * @param  speed: 摆动速度档（0=停止）
+ */
+void CMD_Submit_Setpoint(CMD_Source_t src, float yaw_rate, uint8_t speed) {
+    CMD_Request_t req = {0};
+    req.cmd = (speed == 0) ? CMD_STOP : CMD_FORWARD;
+    req.setpoint = true;
+    req.yaw_rate = yaw_rate;
+    req.speed = speed;
+    req.time_us = TimeBase_Now_us();
+    req.valid = true;
+    req.fresh = true;
+    CMD_Store(src, &req);
+}
+
+/**
+ * @brief  撤销某指令源
+ * @param  src: 指令源
+ * @note   下一次仲裁时立即让给低优先级的指令源
+ */
+void CMD_Release(CMD_Source_t src) {
+    CMD_Request_t req = {0};
+    CMD_Store(src, &req);
+}
+
+/**
+ * @brief  指令仲裁（控制任务周期调用）
+ * @param  now_us: 当前时间（TimeBase_Now_us），us
+ * @retval 生效的指令源（CMD_SRC_NONE表示停止）
+ * @note   1. 按优先级找第一个未超时的请求；新请求或切换指令源时才执行
+ *         2. 没有有效指令源时只在切换的那一次执行停止
+ */
+FAST_CODE CMD_Source_t CMD_Arbiter_Run(uint64_t now_us) {
+    CMD_Source_t selected = CMD_SRC_NONE;
+    CMD_Request_t req = {0};
+
+    __disable_irq();
+    for (int i = 0; i < CMD_SRC_COUNT; i++) {
+        if (!requests[i].valid) {
+            continue;
+        }
+        // 其他任务可能在now_us采样之后提交，差值按有符号比较
+        if ((int64_t)(now_us - requests[i].time_us) > (int64_t)TIMEBASE_MS(source_timeout[i])) {
+            requests[i].valid = false;
+            cmd_arbiter_stats.timeouts[i]++;
+            continue;
+        }
+        if (selected == CMD_SRC_NONE) {
+            selected = (CMD_Source_t)i;
+            req = requests[i];
+            requests[i].fresh = false;
+        }
+    }
+    __enable_irq();
+
+    bool switched = (selected != cmd_arbiter_stats.active);
+    if (switched) {
+        cmd_arbiter_stats.active = selected;
+        cmd_arbiter_stats.switches++;
+    }
+
+    if (selected == CMD_SRC_NONE) {
+        if (switched) {
+            Fish_Clear_Setpoint();
+            setpoint_applied = false;
+            Fish_ExecuteCommand(CMD_STOP);
+        }
+    } else if (switched || req.fresh) {
+        CMD_Apply(&req);
+    }
+    return selected;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file       Capture.c
+ * @brief      传感器串口原始数据采集（SBUS/JY901S/GPS的DMA接收数据打时间戳后经遥测发出，供离线回放）
+ * @author     ottohesl
+ * @date       26-1-26
+ * @version    V1.0
+ * @note       1. 各传感器的接收事件回调（空闲/半满/满）调用Capture_Rx，把DMA环形缓冲区上次位置到本次位置之间的
+ *                新字节按TLM_CAPTURE_BYTES切块，连同源编号、流偏移、事件时间存入数据块缓冲区
+ *             2. 缓冲区满时整块丢弃并计数，流偏移照常前进，上位机按偏移缺口定位丢失的数据
+ *             3. 黑匣子后台任务在调试串口发送缓冲区空闲超过CAPTURE_TX_RESERVE时发出数据块（遥测CAPTURE消息），
+ *                周期遥测与printf优先；115200波特率约11KB/s，三路同时采集会超出带宽，按需选择数据源
+ *             4. 上位机Tools/capture.py录制为带时间戳的采集文件，回放到仿真（FISH_H7_sim --replay）或经串口回环送回板子
+ *             5. 每个DMA缓冲区的一圈内必须至少有一次接收事件（半满/满事件保证），否则两次事件之间的数据无法区分
+ */
+#include "Capture.h"
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include "TimeBase.h"
+#include "UART_TX.h"
+#include "MEM_Cache.h"
+
+/************************ 宏定义 ************************/
+#define CAPTURE_SLOT_MASK     (CAPTURE_SLOTS - 1U)
+#define CAPTURE_HEADER_BYTES  (sizeof(TLM_Capture_t) - TLM_CAPTURE_BYTES)     // 消息中数据之前的块头长度
+
+/************************ 全局变量 ************************/
+Capture_Stats_t capture_stats;                  // 采集统计
+
+/************************ 私有变量 ************************/
+static TLM_Capture_t capture_ring[CAPTURE_SLOTS];       // 数据块缓冲区（中断写入，后台任务发送）
+static volatile uint32_t capture_head = 0;              // 写入位置（仅中断在临界区内写）
+static volatile uint32_t capture_tail = 0;              // 发送位置（仅后台任务写）
+static volatile uint8_t capture_mask = CAPTURE_DEFAULT_MASK;
+static uint16_t capture_pos[CAPTURE_SRC_COUNT];         // 各源上一次接收事件时的DMA写入位置
+static uint32_t capture_offset[CAPTURE_SRC_COUNT];      // 各源已采集的字节数（下一块的流偏移）
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  采集初始化
+ * @note   需在各传感器启动DMA接收之前调用（DMA从缓冲区起点开始写，与capture_pos初值一致）
+ */
+void Capture_Init(void) {
+    memset(&capture_stats, 0, sizeof(capture_stats));
+    memset(capture_pos, 0, sizeof(capture_pos));
+    memset(capture_offset, 0, sizeof(capture_offset));
+    capture_head = 0;
+    capture_tail = 0;
+    capture_mask = CAPTURE_DEFAULT_MASK;
+}
+
+/**
+ * @brief  设置采集源
+ * @param  mask: 按Capture_Source_t的位，0=全部关闭
+ */
+void Capture_Set_Mask(uint8_t mask) {
+    capture_mask = mask & (uint8_t)((1U << CAPTURE_SRC_COUNT) - 1U);
+}
+
+uint8_t Capture_Get_Mask(void) {
+    return capture_mask;
+}
+
+/**
+ * @brief  采集一次接收事件的新数据（中断上下文）
+ * @param  src: 数据源
+ * @param  ring: 该源的DMA环形接收缓冲区
+ * @param  size: 缓冲区长度
+ * @param  pos: HAL_UARTEx_RxEventCallback的Size（当前写入位置，写满事件为size）
+ * @note   1. 未开启的源只更新位置，耗时为常数
+ *         2. 开启时在临界区内拷贝（每个事件最多半个DMA缓冲区），各串口中断之间可能互相抢占
+ */
+FAST_CODE void Capture_Rx(Capture_Source_t src, const uint8_t *ring, uint16_t size, uint16_t pos) {
+    if ((unsigned)src >= CAPTURE_SRC_COUNT) {
+        return;
+    }
+    if (pos >= size) {
+        pos = 0;
+    }
+    // 同一串口的DMA中断与串口中断优先级可能不同，位置的读写也放在临界区内
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    uint16_t last = capture_pos[src];
+    capture_pos[src] = pos;
+    if ((capture_mask & (1U << src)) == 0U || pos == last) {
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        return;
+    }
+
+    uint32_t n = (pos > last) ? (uint32_t)(pos - last) : (uint32_t)(size + pos - last);
+    uint32_t time_us = (uint32_t)TimeBase_Now_us();
+    uint32_t offset = capture_offset[src];
+    capture_offset[src] = offset + n;
+    capture_stats.bytes[src] += n;
+    while (n > 0U) {
+        uint32_t used = capture_head - capture_tail;
+        if (used >= CAPTURE_SLOTS) {
+            capture_stats.dropped += n;
+            break;
+        }
+        TLM_Capture_t *c = &capture_ring[capture_head & CAPTURE_SLOT_MASK];
+        uint32_t len = (n > TLM_CAPTURE_BYTES) ? TLM_CAPTURE_BYTES : n;
+        uint32_t first = size - last;
+        if (first > len) {
+            first = len;
+        }
+        c->offset = offset;
+        c->time_us = time_us;
+        c->source = (uint8_t)src;
+        c->len = (uint8_t)len;
+        memcpy(c->data, &ring[last], first);
+        memcpy(&c->data[first], ring, len - first);
+        last = (uint16_t)((last + len) % size);
+        offset += len;
+        n -= len;
+        capture_head++;
+        capture_stats.chunks++;
+        if (used + 1U > capture_stats.pending_max) {
+            capture_stats.pending_max = (uint16_t)(used + 1U);
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (BlackBox_TaskHandle != NULL) {
+        osThreadFlagsSet(BlackBox_TaskHandle, CAPTURE_FLAG_DRAIN);
+    }
+}
+
+/**
+ * @brief  发送缓冲区中的数据块（黑匣子后台任务调用）
+ * @note   调试串口发送缓冲区剩余不足时停止，等下一次接收事件或后台任务超时再发
+ */
+void Capture_Service(void) {
+    while (capture_tail != capture_head) {
+        if (UART_TX_Free() < TLM_FRAME_MAX + CAPTURE_TX_RESERVE) {
+            return;
+        }
+        const TLM_Capture_t *c = &capture_ring[capture_tail & CAPTURE_SLOT_MASK];
+        if (!Telemetry_Send(TLM_MSG_CAPTURE, c, (uint8_t)(CAPTURE_HEADER_BYTES + c->len))) {
+            return;
+        }
+        capture_tail++;
+        capture_stats.sent++;
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * @file       Executive.c
+ * @brief      单栈表驱动执行器（周期/事件作业按优先级运行到完成）
+ * @author     ottohesl
+ * @date       26-1-24
+ * @version    V1.0
+ * @note       1. 作业以常量表声明（周期、事件线程标志、超时、优先级），全部在承载任务的一个栈上运行，
+ *                作业之间不抢占，中断照常抢占；FreeRTOS只负责承载任务与后台任务（黑匣子、定时器服务、空闲）
+ *             2. 循环：等待任一事件标志或最近一个周期/超时释放（osThreadFlagsWait超时），收集释放后
+ *                只运行一个优先级最高的就绪作业，然后不阻塞地重新收集，新到的高优先级事件在下一个作业边界得到处理
+ *             3. 周期作业的释放时刻按理想节拍累加（与osDelayUntil相同，不累积漂移），落后多个周期只补运行一次，
+ *                其余计为overrun；事件作业的超时在每次事件后重新计时，只在长时间无事件时释放（失联检测）
+ *             4. 同一作业在运行前被再次释放只运行一次（线程标志同样会合并），计为overrun
+ *             5. 作业不得阻塞（osDelay/等待队列等）：阻塞会推迟全部实时作业；Flash编程等长操作留在后台任务
+ *             6. 统计：运行次数、单次最大耗时、从释放到开始运行的最大等待（被其他作业占用的时间），
+ *                在top文本末尾打印，控制抖动与切换次数见遥测task消息，用于与多任务布局对比
+ */
+#include "Executive.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "cmsis_os.h"
+#include "TimeBase.h"
+#include "MEM_Cache.h"
+
+/************************ 全局变量 ************************/
+Exec_Job_Stats_t exec_stats[EXEC_JOBS_MAX];         // 各作业统计（下标与作业表一致）
+
+/************************ 私有变量 ************************/
+static const Exec_Job_t *exec_jobs = NULL;          // 作业表
+static uint32_t exec_count = 0;                     // 作业数
+static uint32_t exec_next[EXEC_JOBS_MAX];           // 下次周期/超时释放的内核节拍
+static uint32_t exec_release[EXEC_JOBS_MAX];        // 待运行释放对应的节拍
+static uint64_t exec_release_us[EXEC_JOBS_MAX];     // 发现释放时的时基微秒
+static uint32_t exec_pending = 0;                   // 就绪作业位图
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  作业的定时释放间隔：周期作业为周期，事件作业为超时，0=无定时释放
+ */
+static uint32_t Exec_Step(const Exec_Job_t *job) {
+    return (job->period_ms != 0U) ? job->period_ms : job->timeout_ms;
+}
+
+/**
+ * @brief  登记一次释放，已就绪的作业不重复登记（计为overrun，保留较早的释放时刻）
+ */
+static void Exec_Release(uint32_t i, uint32_t release_ms, uint64_t now_us) {
+    if ((exec_pending & (1U << i)) != 0U) {
+        exec_stats[i].overruns++;
+        return;
+    }
+    exec_pending |= 1U << i;
+    exec_release[i] = release_ms;
+    exec_release_us[i] = now_us;
+}
+
+/**
+ * @brief  按收到的线程标志与当前节拍释放作业
+ * @param  flags: 本次取到的线程标志
+ * @param  now_ms: 当前内核节拍
+ */
+static FAST_CODE void Exec_Collect(uint32_t flags, uint32_t now_ms) {
+    uint64_t now_us = TimeBase_Now_us();
+    for (uint32_t i = 0; i < exec_count; i++) {
+        const Exec_Job_t *job = &exec_jobs[i];
+        if (job->event != 0U && (flags & job->event) != 0U) {
+            Exec_Release(i, now_ms, now_us);
+            if (job->period_ms == 0U && job->timeout_ms != 0U) {
+                exec_next[i] = now_ms + job->timeout_ms;
+            }
+        }
+        uint32_t step = Exec_Step(job);
+        if (step == 0U) {
+            continue;
+        }
+        while ((int32_t)(now_ms - exec_next[i]) >= 0) {
+            Exec_Release(i, exec_next[i], now_us);
+            exec_next[i] += step;
+        }
+    }
+}
+
+/**
+ * @brief  距最近一次定时释放的节拍数（有就绪作业时为0，不阻塞）
+ */
+static uint32_t Exec_Wait_Ticks(uint32_t now_ms) {
+    if (exec_pending != 0U) {
+        return 0U;
+    }
+    uint32_t wait = osWaitForever;
+    for (uint32_t i = 0; i < exec_count; i++) {
+        if (Exec_Step(&exec_jobs[i]) == 0U) {
+            continue;
+        }
+        int32_t d = (int32_t)(exec_next[i] - now_ms);
+        if (d <= 0) {
+            return 0U;
+        }
+        if ((uint32_t)d < wait) {
+            wait = (uint32_t)d;
+        }
+    }
+    return wait;
+}
+
+/**
+ * @brief  运行一个作业并统计
+ */
+static FAST_CODE void Exec_Dispatch(uint32_t i) {
+    const Exec_Job_t *job = &exec_jobs[i];
+    Exec_Job_Stats_t *st = &exec_stats[i];
+
+    exec_pending &= ~(1U << i);
+    uint32_t wait_us = (uint32_t)(TimeBase_Now_us() - exec_release_us[i]);
+    uint32_t start = DWT->CYCCNT;
+    job->handler(exec_release[i]);
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    st->runs++;
+    if (cycles > st->cycles_max) {
+        st->cycles_max = cycles;
+    }
+    if (wait_us > st->wait_us_max) {
+        st->wait_us_max = wait_us;
+    }
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  运行执行器（不返回）
+ * @param  jobs: 作业表（常量，需在整个运行期间有效）
+ * @param  count: 作业数，超过EXEC_JOBS_MAX的部分忽略
+ * @note   1. 事件作业的线程标志由中断置到承载任务上，各作业的标志位不能重叠
+ *         2. 周期作业第一次在一个周期后释放，事件作业的超时从启动时开始计
+ */
+FAST_CODE void Exec_Run(const Exec_Job_t *jobs, uint32_t count) {
+    uint32_t events = 0;
+    uint32_t now_ms = osKernelGetTickCount();
+
+    if (count > EXEC_JOBS_MAX) {
+        count = EXEC_JOBS_MAX;
+    }
+    memset(exec_stats, 0, sizeof(exec_stats));
+    for (uint32_t i = 0; i < count; i++) {
+        events |= jobs[i].event;
+        exec_next[i] = now_ms + Exec_Step(&jobs[i]);
+    }
+    exec_pending = 0;
+    exec_jobs = jobs;
+    exec_count = count;
+
+    for (;;) {
+        uint32_t wait = Exec_Wait_Ticks(now_ms);
+        uint32_t flags = (wait == 0U) ? osThreadFlagsClear(events)
+                                      : osThreadFlagsWait(events, osFlagsWaitAny, wait);
+        if ((flags & osFlagsError) != 0U) {
+            flags = 0U;
+        }
+        flags &= events;
+        now_ms = osKernelGetTickCount();
+        Exec_Collect(flags, now_ms);
+
+        // 就绪作业中优先级最高的一个，同优先级按表中顺序
+        int32_t best = -1;
+        for (uint32_t i = 0; i < exec_count; i++) {
+            if ((exec_pending & (1U << i)) != 0U &&
+                (best < 0 || jobs[i].priority > jobs[best].priority)) {
+                best = (int32_t)i;
+            }
+        }
+        if (best >= 0) {
+            Exec_Dispatch((uint32_t)best);
+        }
+    }
+}
+
+/**
+ * @brief  当前作业表
+ * @param  jobs: 输出作业表指针
+ * @retval 作业数（执行器未运行时为0）
+ */
+uint32_t Exec_Get_Jobs(const Exec_Job_t **jobs) {
+    *jobs = exec_jobs;
+    return exec_count;
+}
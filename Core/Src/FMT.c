@@ -0,0 +1,465 @@
+/**
+ * @file       FMT.c
+ * @brief      轻量格式化库（浮点/整数/十六进制转字符串 + printf风格前端），替代newlib浮点printf
+ * @author     ottohesl
+ * @date       26-1-19
+ * @version    V1.0
+ * @note       1. 浮点按IEEE754位模式精确换算：尾数m×2^e拆成整数部分和二进制小数，小数乘10^N后按余数舍入（四舍六入五成双），
+ *                结果与printf "%.Nf"（参数为float）逐字节一致
+ *             2. 只用32/64位整数运算，无堆、无递归，循环次数有上界（整数部分最多5组9位十进制）
+ *             3. FMT_Vsnprintf只实现本工程用到的转换符，未知转换符原样输出；%f的参数按float精度处理
+ *             4. 可重入，任务和中断中均可调用；缓冲区由调用者提供
+ */
+#include "FMT.h"
+#include <string.h>
+#include "MEM_Cache.h"
+#if FMT_BENCH
+#include <stdio.h>
+#endif
+
+/************************ 私有变量 ************************/
+static const uint32_t fmt_pow10[FMT_F32_DECIMALS_MAX + 1] FAST_CONST = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+// 输出游标（超出缓冲区的部分只计数不写入）
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+} FMT_Out_t;
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  十进制（不补0）
+ */
+static uint32_t FMT_Dec(char *buf, uint32_t value) {
+    char tmp[10];
+    uint32_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value != 0);
+    for (uint32_t i = 0; i < n; i++) {
+        buf[i] = tmp[n - 1 - i];
+    }
+    return n;
+}
+
+/**
+ * @brief  十进制定长（高位补0）
+ */
+static void FMT_Dec_Fixed(char *buf, uint32_t value, uint32_t digits) {
+    for (uint32_t i = digits; i > 0; i--) {
+        buf[i - 1] = (char)('0' + value % 10u);
+        value /= 10u;
+    }
+}
+
+/**
+ * @brief  128位无符号整数转十进制
+ * @param  w: 小端32位字，w[0]最低（函数内会被改写）
+ * @note   每轮整体除以10^9取一组9位数，float整数部分不超过2^128，最多5组
+ */
+static uint32_t FMT_Dec128(char *buf, uint32_t w[4]) {
+    uint32_t groups[5];
+    uint32_t count = 0;
+    while ((w[0] | w[1] | w[2] | w[3]) != 0 && count < 5) {
+        uint64_t rem = 0;
+        for (int i = 3; i >= 0; i--) {
+            uint64_t cur = (rem << 32) | w[i];
+            w[i] = (uint32_t)(cur / 1000000000u);
+            rem = cur % 1000000000u;
+        }
+        groups[count++] = (uint32_t)rem;
+    }
+    uint32_t len = FMT_Dec(buf, groups[count - 1]);
+    for (uint32_t i = count - 1; i > 0; i--) {
+        FMT_Dec_Fixed(&buf[len], groups[i - 1], 9);
+        len += 9;
+    }
+    return len;
+}
+
+/**
+ * @brief  写入一个字符
+ */
+static void FMT_Put(FMT_Out_t *out, char c) {
+    if (out->len + 1 < out->size) {
+        out->buf[out->len] = c;
+    }
+    out->len++;
+}
+
+/**
+ * @brief  写入n个相同字符
+ */
+static void FMT_Fill(FMT_Out_t *out, char c, int32_t n) {
+    while (n-- > 0) {
+        FMT_Put(out, c);
+    }
+}
+
+/**
+ * @brief  写入字符串
+ */
+static void FMT_Write(FMT_Out_t *out, const char *s, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        FMT_Put(out, s[i]);
+    }
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  浮点转定点小数字符串
+ * @param  buf: 输出缓冲区（至少FMT_F32_BUF字节）
+ * @param  value: 数值
+ * @param  decimals: 小数位数（0-9，超出按9处理）
+ * @retval 字符串长度（不含'\0'）
+ * @note   1. 结果与snprintf("%.Nf", (double)value)一致，包括-0.00、inf、nan
+ *         2. 小数部分：f/2^k乘10^N得商q与余数r，r与2^(k-1)比较决定进位，恰为一半时向偶数舍入
+ *         3. k>63时f×10^N < 2^54 < 2^(k-1)，必然舍去，直接得0
+ */
+uint32_t FMT_F32(char *buf, float value, uint8_t decimals) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    uint32_t len = 0;
+
+    if (decimals > FMT_F32_DECIMALS_MAX) {
+        decimals = FMT_F32_DECIMALS_MAX;
+    }
+    if (bits >> 31) {
+        buf[len++] = '-';
+    }
+    if (exponent == 0xFFu) {
+        memcpy(&buf[len], mantissa ? "nan" : "inf", 4);
+        return len + 3;
+    }
+
+    // 1. value = m × 2^e
+    int32_t e;
+    if (exponent == 0) {
+        e = -149;
+    } else {
+        mantissa |= 0x800000u;
+        e = (int32_t)exponent - 150;
+    }
+
+    uint32_t w[4] = {0, 0, 0, 0};
+    uint32_t frac_digits = 0;
+    if (e >= 0) {
+        // 2a. 纯整数（最多128位），小数部分为0
+        uint64_t shifted = (uint64_t)mantissa << (e & 31);
+        w[e >> 5] = (uint32_t)shifted;
+        if ((e >> 5) < 3) {
+            w[(e >> 5) + 1] = (uint32_t)(shifted >> 32);
+        }
+    } else {
+        // 2b. 整数部分 + k位二进制小数
+        uint32_t k = (uint32_t)(-e);
+        uint32_t int_part = (k < 24) ? (mantissa >> k) : 0;
+        uint32_t frac = (k < 24) ? (mantissa & ((1u << k) - 1u)) : mantissa;
+        if (k <= 63) {
+            uint64_t p = (uint64_t)frac * fmt_pow10[decimals];
+            uint64_t q = p >> k;
+            uint64_t r = p - (q << k);
+            uint64_t half = 1ull << (k - 1);
+            uint32_t last = (decimals != 0) ? (uint32_t)q : int_part;
+            if (r > half || (r == half && (last & 1u))) {
+                q++;
+            }
+            if (q == fmt_pow10[decimals]) {
+                int_part++;
+                q = 0;
+            }
+            frac_digits = (uint32_t)q;
+        }
+        w[0] = int_part;
+    }
+
+    // 3. 整数部分
+    if ((w[1] | w[2] | w[3]) == 0) {
+        len += FMT_Dec(&buf[len], w[0]);
+    } else {
+        len += FMT_Dec128(&buf[len], w);
+    }
+
+    // 4. 小数部分
+    if (decimals != 0) {
+        buf[len++] = '.';
+        FMT_Dec_Fixed(&buf[len], frac_digits, decimals);
+        len += decimals;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief  无符号十进制
+ * @param  buf: 输出缓冲区（至少FMT_INT_BUF字节）
+ * @retval 字符串长度
+ */
+uint32_t FMT_U32(char *buf, uint32_t value) {
+    uint32_t len = FMT_Dec(buf, value);
+    buf[len] = '\0';
+    return len;
+}
+
+/**
+ * @brief  有符号十进制
+ * @param  buf: 输出缓冲区（至少FMT_INT_BUF字节）
+ * @retval 字符串长度
+ */
+uint32_t FMT_I32(char *buf, int32_t value) {
+    if (value < 0) {
+        buf[0] = '-';
+        return 1 + FMT_U32(&buf[1], 0u - (uint32_t)value);
+    }
+    return FMT_U32(buf, (uint32_t)value);
+}
+
+/**
+ * @brief  十六进制
+ * @param  buf: 输出缓冲区（至少FMT_INT_BUF字节）
+ * @param  min_digits: 最少位数（不足高位补0，最大8）
+ * @param  upper: true=A-F，false=a-f
+ * @retval 字符串长度
+ */
+uint32_t FMT_Hex32(char *buf, uint32_t value, uint8_t min_digits, bool upper) {
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    uint32_t n = 1;
+    while (n < 8 && (value >> (4 * n)) != 0) {
+        n++;
+    }
+    if (min_digits > 8) {
+        min_digits = 8;
+    }
+    if (n < min_digits) {
+        n = min_digits;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        buf[n - 1 - i] = digits[(value >> (4 * i)) & 0xFu];
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief  printf风格格式化
+ * @param  buf: 输出缓冲区
+ * @param  size: 缓冲区大小（含'\0'）
+ * @param  fmt: 格式字符串
+ * @param  args: 可变参数列表
+ * @retval 完整输出所需长度（不含'\0'），大于等于size表示被截断
+ * @note   1. 格式：%[标志][宽度][.精度][长度]转换符，标志支持- 0 + 空格，宽度/精度支持*
+ *         2. 转换符：d i u x X c s f F %；长度修饰h l z在32位平台上忽略
+ *         3. 整数精度为最少位数；%f精度默认6，最大9；%s精度为最多输出字符数
+ */
+int FMT_Vsnprintf(char *buf, uint32_t size, const char *fmt, va_list args) {
+    FMT_Out_t out = {buf, size, 0};
+    char body[FMT_F32_BUF];
+
+    while (*fmt != '\0') {
+        if (*fmt != '%') {
+            FMT_Put(&out, *fmt++);
+            continue;
+        }
+        const char *spec = fmt++;
+
+        // 1. 标志
+        bool left = false, zero = false;
+        char sign_flag = 0;
+        for (;; fmt++) {
+            if (*fmt == '-') left = true;
+            else if (*fmt == '0') zero = true;
+            else if (*fmt == '+') sign_flag = '+';
+            else if (*fmt == ' ') { if (sign_flag == 0) sign_flag = ' '; }
+            else break;
+        }
+
+        // 2. 宽度
+        int32_t width = 0;
+        if (*fmt == '*') {
+            width = va_arg(args, int);
+            if (width < 0) {
+                left = true;
+                width = -width;
+            }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') {
+                width = width * 10 + (*fmt++ - '0');
+            }
+        }
+
+        // 3. 精度（-1=未指定）
+        int32_t precision = -1;
+        if (*fmt == '.') {
+            fmt++;
+            precision = 0;
+            if (*fmt == '*') {
+                precision = va_arg(args, int);
+                if (precision < 0) precision = -1;
+                fmt++;
+            } else {
+                while (*fmt >= '0' && *fmt <= '9') {
+                    precision = precision * 10 + (*fmt++ - '0');
+                }
+            }
+        }
+
+        // 4. 长度修饰（int与long同为32位）
+        while (*fmt == 'h' || *fmt == 'l' || *fmt == 'z') {
+            fmt++;
+        }
+
+        // 5. 转换
+        char sign = 0;
+        const char *text = body;
+        uint32_t text_len;
+        bool numeric = true;
+        switch (*fmt) {
+            case 'd':
+            case 'i': {
+                int32_t v = va_arg(args, int);
+                uint32_t mag = (v < 0) ? 0u - (uint32_t)v : (uint32_t)v;
+                sign = (v < 0) ? '-' : sign_flag;
+                text_len = (precision == 0 && mag == 0) ? 0 : FMT_U32(body, mag);
+                break;
+            }
+            case 'u': {
+                uint32_t v = va_arg(args, unsigned int);
+                text_len = (precision == 0 && v == 0) ? 0 : FMT_U32(body, v);
+                break;
+            }
+            case 'x':
+            case 'X': {
+                uint32_t v = va_arg(args, unsigned int);
+                text_len = (precision == 0 && v == 0) ? 0 : FMT_Hex32(body, v, 1, *fmt == 'X');
+                break;
+            }
+            case 'f':
+            case 'F': {
+                float v = (float)va_arg(args, double);
+                uint8_t decimals = (precision < 0) ? 6 : (uint8_t)(precision > FMT_F32_DECIMALS_MAX ? FMT_F32_DECIMALS_MAX : precision);
+                text_len = FMT_F32(body, v, decimals);
+                if (body[0] == '-') {
+                    sign = '-';
+                    text++;
+                    text_len--;
+                } else {
+                    sign = sign_flag;
+                }
+                if (text[0] == 'i' || text[0] == 'n') {
+                    zero = false;           // inf/nan不补0
+                    if (*fmt == 'F') {
+                        for (uint32_t i = 0; i < text_len; i++) {
+                            body[(text - body) + i] -= 'a' - 'A';   // %F输出INF/NAN
+                        }
+                    }
+                }
+                precision = -1;             // 已用作小数位数，不再作为整数最少位数
+                break;
+            }
+            case 'c':
+                body[0] = (char)va_arg(args, int);
+                text_len = 1;
+                numeric = false;
+                break;
+            case 's': {
+                text = va_arg(args, const char *);
+                if (text == NULL) {
+                    text = "(null)";
+                }
+                text_len = 0;
+                while (text[text_len] != '\0' && (precision < 0 || text_len < (uint32_t)precision)) {
+                    text_len++;
+                }
+                numeric = false;
+                break;
+            }
+            case '%':
+                FMT_Put(&out, '%');
+                fmt++;
+                continue;
+            default:
+                // 不支持的转换符：原样输出
+                if (*fmt == '\0') {
+                    FMT_Write(&out, spec, (uint32_t)(fmt - spec));
+                    continue;
+                }
+                fmt++;
+                FMT_Write(&out, spec, (uint32_t)(fmt - spec));
+                continue;
+        }
+        fmt++;
+
+        // 6. 补齐：[空格][符号][0][正文][空格]
+        int32_t zeros = 0;
+        if (numeric && precision > (int32_t)text_len) {
+            zeros = precision - (int32_t)text_len;
+        }
+        int32_t pad = width - (int32_t)text_len - zeros - (sign ? 1 : 0);
+        if (numeric && zero && !left && precision < 0 && pad > 0) {
+            zeros += pad;
+            pad = 0;
+        }
+        if (!left) FMT_Fill(&out, ' ', pad);
+        if (sign) FMT_Put(&out, sign);
+        FMT_Fill(&out, '0', zeros);
+        FMT_Write(&out, text, text_len);
+        if (left) FMT_Fill(&out, ' ', pad);
+    }
+
+    if (size != 0) {
+        buf[(out.len < size) ? out.len : size - 1] = '\0';
+    }
+    return (int)out.len;
+}
+
+/**
+ * @brief  printf风格格式化（可变参数版）
+ */
+int FMT_Snprintf(char *buf, uint32_t size, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int len = FMT_Vsnprintf(buf, size, fmt, args);
+    va_end(args);
+    return len;
+}
+
+#if FMT_BENCH
+/**
+ * @brief  FMT与newlib vsnprintf周期对比
+ * @note   1. 同一组姿态角数据分别用FMT_Snprintf和snprintf格式化"%.2f,%.2f,%.2f"，统计平均/最大CPU周期
+ *         2. 需先开启DWT周期计数（TimeBase_Init中已开启），链接newlib浮点printf时两者输出应逐字节一致
+ */
+void FMT_Bench(void) {
+    static const float samples[][3] = {
+        {0.0f, -0.0f, 1.005f}, {12.345f, -179.99f, 359.995f}, {-3.14159f, 2.71828f, 0.125f},
+        {1234.5678f, -0.004999f, 89.9999f}, {1e-6f, -1e6f, 65535.5f}, {0.5f, 1.5f, 2.5f},
+    };
+    const uint32_t n = sizeof(samples) / sizeof(samples[0]);
+    char a[64], b[64];
+    uint32_t fmt_sum = 0, fmt_max = 0, lib_sum = 0, lib_max = 0, mismatch = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        const float *s = samples[i];
+        uint32_t t0 = DWT->CYCCNT;
+        FMT_Snprintf(a, sizeof(a), "%.2f,%.2f,%.2f", s[0], s[1], s[2]);
+        uint32_t t1 = DWT->CYCCNT;
+        snprintf(b, sizeof(b), "%.2f,%.2f,%.2f", s[0], s[1], s[2]);
+        uint32_t t2 = DWT->CYCCNT;
+        fmt_sum += t1 - t0;
+        lib_sum += t2 - t1;
+        if (t1 - t0 > fmt_max) fmt_max = t1 - t0;
+        if (t2 - t1 > lib_max) lib_max = t2 - t1;
+        mismatch += (strcmp(a, b) != 0);
+    }
+    printf("FMT bench: fmt avg=%lu max=%lu, newlib avg=%lu max=%lu cycles, mismatch=%lu\n",
+           (unsigned long)(fmt_sum / n), (unsigned long)fmt_max,
+           (unsigned long)(lib_sum / n), (unsigned long)lib_max, (unsigned long)mismatch);
+}
+#endif
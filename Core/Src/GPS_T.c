@@ -0,0 +1,217 @@
+/**
+ * @file       GPS_T.c
+ * @brief      ATGM336H GPS接收驱动（循环DMA+空闲中断接收，任务上下文分帧解析）
+ * @author     ottohesl
+ * @date       26-1-8
+ * @version    V1.0
+ * @note       1. 取代main.c中每字节一次中断的HAL_UART_Receive_IT接收方式
+ *             2. 中断中只搬运DMA写指针并通知GPS任务，不做memset/解析/printf
+ *             3. NMEA分帧与解析在低优先级GPS任务中完成，不影响控制环时序
+ */
+#include "GPS_T.h"
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+#include "Capture.h"
+
+/************************ 全局变量 ************************/
+UART_HandleTypeDef *gps_huart;          // GPS串口句柄
+UART_HandleTypeDef *gps_debug_huart;    // 调试串口句柄
+GPS_Stats_t gps_stats;                  // GPS接收统计
+volatile uint32_t gps_rx_stamp;         // 最近一次接收事件中断的TIMEBASE_CYCLES()（控制任务统计输入延迟）
+
+/************************ DMA接收缓冲区 ************************/
+// STM32H7放入RAM_D2不可缓存区（DMA_BUFFER，见MEM_Cache.h），DMA与CPU无需缓存维护
+uint8_t GPS_RX[GPS_DMA_RX_SIZE] DMA_BUFFER;
+
+/************************ 中断与任务共享的索引 ************************/
+static volatile uint32_t dma_last_pos = 0;   // 中断中上一次的DMA位置（仅中断写）
+static volatile uint32_t rx_total = 0;       // 累计写入字节数（仅中断写，任务读）
+static uint32_t rd_total = 0;                // 累计已处理字节数（仅任务读写）
+static volatile uint32_t rx_epoch = 0;       // 接收重启次数（仅中断写，任务读）
+static volatile uint32_t rx_restart = 0;     // 最近一次重启时的rx_total（缓冲区起点，仅中断写）
+static uint32_t rd_epoch = 0;                // 任务侧已同步的重启次数
+
+/************************ 分帧静态变量 ************************/
+static char sentence_buf[GPS_SENTENCE_MAX];  // 单条语句缓冲区
+static uint16_t sentence_pos = 0;            // 当前语句写入位置
+static uint8_t sentence_active = 0;          // 1=已找到'$'正在接收语句
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  逐字节分帧：'$'开始，'\n'结束，完整语句交给NMEA解析器
+ * @param  byte: 接收字节
+ * @retval true: 本字节结束了一条有效语句
+ */
+FAST_CODE static bool GPS_FrameByte(uint8_t byte) {
+    // 二进制帧优先：帧内字节（可能含'$'）不交给NMEA分帧
+    if (CASIC_Parse_Byte(byte)) {
+        GPS_Data_t gps_data;
+        gps_stats.binary_frames++;
+        GPS_Get_Data(&gps_data);
+        bool valid = CASIC_Decode_NavPV(&gps_data);
+        GPS_Set_Data(&gps_data);
+        return valid;
+    }
+    if (CASIC_In_Frame()) {
+        return false;
+    }
+    if (byte == '$') {
+        // 新语句开始（丢弃之前未结束的残帧）
+        sentence_buf[0] = '$';
+        sentence_pos = 1;
+        sentence_active = 1;
+        return false;
+    }
+    if (!sentence_active) {
+        return false;
+    }
+    if (byte == '\r') {
+        return false;
+    }
+    if (byte == '\n') {
+        sentence_buf[sentence_pos] = '\0';
+        sentence_active = 0;
+        gps_stats.sentences++;
+        bool valid = GPS_Parse_NMEA(sentence_buf);
+        gps_stats.checksum_errors = GPS_Parse_Errors();
+        return valid;
+    }
+    if (sentence_pos >= GPS_SENTENCE_MAX - 1) {
+        // 语句超长，丢弃并等待下一个'$'
+        sentence_active = 0;
+        gps_stats.overflows++;
+        return false;
+    }
+    sentence_buf[sentence_pos++] = (char)byte;
+    return false;
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  GPS初始化（启动循环DMA+空闲中断接收）
+ * @param  h_gps: GPS串口句柄
+ * @param  h_debug: 调试串口句柄
+ * @note   1. 需在CubeMX中开启USART6 RX DMA（循环模式）及USART6全局中断
+ *         2. 空闲、半满、满三种事件都会进入GPS_RxEventCallback
+ *         3. 启动接收前先下发CASIC配置（阻塞，约200ms），之后串口为115200
+ *         4. 配置期间模块照常输出而接收未启动，ORE已置位，启动DMA前先清除，否则一启动就进入错误回调
+ */
+void GPS_Init(UART_HandleTypeDef *h_gps, UART_HandleTypeDef *h_debug) {
+    gps_huart = h_gps;
+    gps_debug_huart = h_debug;
+
+    memset(&gps_stats, 0, sizeof(GPS_Stats_t));
+    dma_last_pos = 0;
+    rx_total = 0;
+    rd_total = 0;
+    sentence_pos = 0;
+    sentence_active = 0;
+    GPS_Parser_Init();
+    CASIC_Configure(gps_huart);
+
+    __HAL_UART_CLEAR_OREFLAG(gps_huart);
+    HAL_StatusTypeDef ret = HAL_UARTEx_ReceiveToIdle_DMA(gps_huart, GPS_RX, GPS_DMA_RX_SIZE);
+#if GPS_DEBUG_MODE
+    if (ret != HAL_OK) {
+        ottohesl_uart(gps_debug_huart, "GPS DMA初始化失败\r\n");
+    } else if (gps_huart->hdmarx == NULL || gps_huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+        ottohesl_uart(gps_debug_huart, "GPS DMA未配置为循环模式\r\n");
+    }
+#endif
+}
+
+/**
+ * @brief  USART6接收事件回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @param  Size: DMA缓冲区中当前写入位置
+ * @note   只计算新增字节数并通知GPS任务，耗时为常数（开启原始数据采集时另加拷贝，见Capture.c）
+ */
+FAST_CODE void GPS_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart != gps_huart) {
+        return;
+    }
+    uint32_t pos = (Size >= GPS_DMA_RX_SIZE) ? 0 : Size;
+    uint32_t last = dma_last_pos;
+    rx_total += (pos >= last) ? (pos - last) : (GPS_DMA_RX_SIZE + pos - last);
+    dma_last_pos = pos;
+    gps_rx_stamp = TIMEBASE_CYCLES();
+    Capture_Rx(CAPTURE_SRC_GPS, GPS_RX, GPS_DMA_RX_SIZE, Size);
+
+    if (GPS_TaskHandle != NULL) {
+        osThreadFlagsSet(GPS_TaskHandle, GPS_RX_FLAG);
+    }
+}
+
+/**
+ * @brief  USART6错误回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @note   溢出等阻塞性错误会中止DMA接收，此时从缓冲区起点重新启动，任务侧丢弃残句重新同步
+ */
+void GPS_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != gps_huart || huart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    // 写指针对齐到缓冲区起点，与DMA从0开始写入保持一致
+    uint32_t rem = rx_total % GPS_DMA_RX_SIZE;
+    if (rem != 0) {
+        rx_total += GPS_DMA_RX_SIZE - rem;
+    }
+    dma_last_pos = 0;
+    rx_restart = rx_total;
+    rx_epoch++;
+    gps_stats.rx_restarts++;
+    __HAL_UART_CLEAR_OREFLAG(gps_huart);
+    HAL_UARTEx_ReceiveToIdle_DMA(gps_huart, GPS_RX, GPS_DMA_RX_SIZE);
+}
+
+/**
+ * @brief  GPS数据处理（GPS任务中调用）
+ * @retval true: 本次解析到有效定位；false: 无
+ * @note   1. 从环形缓冲区读出上次处理位置到当前DMA写指针之间的数据
+ *         2. 积压超过缓冲区长度说明已被DMA覆盖，直接跳到最新位置
+ */
+bool GPS_Process(void) {
+    bool has_fix = false;
+    // 重启次数、重启位置与写指针须是同一时刻的快照
+    __disable_irq();
+    uint32_t epoch = rx_epoch;
+    uint32_t restart = rx_restart;
+    uint32_t head = rx_total;
+    __enable_irq();
+    if (epoch != rd_epoch) {
+        // 接收重启过：之前的残句和未读数据都不可信，从重启后写入的第一个字节继续
+        rd_epoch = epoch;
+        rd_total = restart;
+        sentence_active = 0;
+    }
+    uint32_t pending = head - rd_total;
+
+    if (pending > gps_stats.backlog_max) {
+        gps_stats.backlog_max = pending;
+    }
+    if (pending > GPS_DMA_RX_SIZE) {
+        // 数据已被DMA覆盖，丢弃积压并重新同步
+        gps_stats.ring_overruns++;
+        rd_total = head - GPS_DMA_RX_SIZE;
+        sentence_active = 0;
+        pending = GPS_DMA_RX_SIZE;
+    }
+
+    while (rd_total != head) {
+        uint8_t byte = GPS_RX[rd_total % GPS_DMA_RX_SIZE];
+        rd_total++;
+        if (GPS_FrameByte(byte)) {
+            has_fix = true;
+        }
+    }
+    gps_stats.rx_bytes += pending;
+
+    // 定位打上接收事件中断的时间戳（同一批数据中的多个定位共用最后一次事件时刻）
+    if (has_fix) {
+        GPS_Data_t gps;
+        GPS_Get_Data(&gps);
+        gps.time_us = TimeBase_From_Cycles(gps_rx_stamp);
+        GPS_Set_Data(&gps);
+    }
+    return has_fix;
+}
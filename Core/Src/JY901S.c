@@ -14,6 +14,9 @@
  *         v1.4     添加预处理命令，可以进行串口debug寻找具体错误原因
  */
 #include "JY901S.h"
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+#include "Capture.h"
 
 /************************ 宏定义 ************************/
 #define G 9.80665f  // 重力加速度常量，单位m/s²
@@ -26,23 +29,16 @@
 
 /************************ 缓冲区 ************************/
 //stm32h7使用前必看--->>>>>>非h7等高端芯片可直接更改版本号
-//开始之前将以下代码粘贴到本文件目录下的_FLASH.ld文件末尾处，并确认RAM区域是0x24000000开始的
-/*
-.sram_msg :
-{
-    . = ALIGN(4);
-    *(.ram) // 匹配代码中的section名
-    } > RAM //映射到0x24000000开始的SRAM
-*/
-#if JY901S_H_Vision==7
-uint8_t RX[RX_SIZE] __attribute__((section(".ram"))); // DMA接收缓冲区（迁址到DMA可访问区域）
-#else
-uint8_t RX[RX_SIZE];
-#endif
+//H7的DMA缓冲区由MEM_Cache.h的DMA_BUFFER放入链接脚本.dma_buffer段（RAM_D2，MPU设为不可缓存）
+uint8_t RX[RX_SIZE] DMA_BUFFER; // DMA接收缓冲区（迁址到DMA可访问、不可缓存区域）
 /************************ 全局变量 ************************/
 UART_HandleTypeDef *huart_sensor;
 UART_HandleTypeDef *huart_debugs;
 jy901 gyro_data;       // 陀螺仪解析后的数据存储
+JY901S_Stats_t jy901s_stats;        // 帧数与校验错误统计
+volatile uint32_t jy901s_rx_stamp;  // 最近一次接收事件中断的TIMEBASE_CYCLES()（控制任务统计输入延迟）
+/************************ 私有变量 ************************/
+static volatile uint32_t rx_epoch = 0; // 接收重启次数（错误回调递增，解析侧据此把读位置同步到缓冲区起点）
 /************************ 私有函数声明 ************************/
 static void Gyroscope_Data(const uint8_t *data) ;        // 解析单帧陀螺仪原始数据
 static int16_t Gyroscope_HL_Combine(uint8_t h,uint8_t l); // 高低字节合成16位有符号数
@@ -161,11 +157,13 @@ void Gyroscope_Gyro_Calibra(UART_HandleTypeDef *huart) {
  * @note       1. 基于HAL库DMA接收接口，缓冲区为全局数组RX[RX_SIZE]
  *             2. 需确保RX缓冲区迁址到STM32H7 DMA可访问区域（0x24000000后）
  *             3. 调用一次即可持续DMA接收，无需重复调用
+ *             4. 循环DMA+空闲中断，一组帧发完（空闲）或缓冲区半满/满时进入Gyroscope_RxEventCallback唤醒JY901S任务
  */
 void Gyroscope_Init(UART_HandleTypeDef *h_senor,UART_HandleTypeDef *h_debug) {
     huart_sensor = h_senor;
     huart_debugs = h_debug;
-    HAL_StatusTypeDef Check_Error=HAL_UART_Receive_DMA(huart_sensor,RX,RX_SIZE);//一定要开启dma循环模式
+    memset(&jy901s_stats, 0, sizeof(JY901S_Stats_t));
+    HAL_StatusTypeDef Check_Error=HAL_UARTEx_ReceiveToIdle_DMA(huart_sensor,RX,RX_SIZE);//一定要开启dma循环模式
 #if DEBUG_MODE
     if (Check_Error!=HAL_OK) {
         ottohesl_uart(huart_debugs,"串口接受初始化错误");
@@ -185,6 +183,39 @@ void Gyroscope_Init(UART_HandleTypeDef *h_senor,UART_HandleTypeDef *h_debug) {
     #endif
 }
 
+/**
+ * @brief      USART2接收事件回调（中断上下文）
+ * @param      huart  串口句柄
+ * @param      Size   DMA缓冲区中当前写入位置（解析时直接读DMA计数，这里只用于原始数据采集）
+ * @retval     无
+ * @note       只记录时间并通知JY901S任务，耗时为常数（开启原始数据采集时另加拷贝，见Capture.c）
+ */
+FAST_CODE void Gyroscope_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart != huart_sensor) {
+        return;
+    }
+    jy901s_rx_stamp = TIMEBASE_CYCLES();
+    Capture_Rx(CAPTURE_SRC_IMU, RX, RX_SIZE, Size);
+    if (JY901S_TaskHandle != NULL) {
+        osThreadFlagsSet(JY901S_TaskHandle, JY901S_RX_FLAG);
+    }
+}
+
+/**
+ * @brief      USART2错误回调（中断上下文）
+ * @param      huart  串口句柄
+ * @retval     无
+ * @note       溢出等阻塞性错误会中止DMA接收，此时从缓冲区起点重新启动，解析侧把读位置同步到起点并丢弃残帧
+ */
+void Gyroscope_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != huart_sensor || huart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    rx_epoch++;
+    jy901s_stats.rx_restarts++;
+    HAL_UARTEx_ReceiveToIdle_DMA(huart_sensor, RX, RX_SIZE);
+}
+
 /**
  * @brief      解析JY901S DMA接收的原始数据
  * @retval     bool  - true：解析到有效数据；false：无有效数据
@@ -193,7 +224,7 @@ void Gyroscope_Init(UART_HandleTypeDef *h_senor,UART_HandleTypeDef *h_debug) {
  *             2. 解析前关闭全局中断，防止DMA缓冲区数据污染
  *             3. 支持多帧连续解析，校验和错误帧自动丢弃
  */
-bool Gyroscope_Process() {
+FAST_CODE bool Gyroscope_Process() {
     bool Available_Data = false;               // 有效数据标志
     uint32_t DMA_Received_Index = 0;           // DMA当前接收位置
     uint32_t DMA_Received_Length = 0;          // 本次待解析数据长度
@@ -204,9 +235,19 @@ bool Gyroscope_Process() {
     static uint8_t RX_Process[Frame_Length];   // 单帧数据临时缓冲区
     static uint32_t DMA_Received_Index_Last = 0;// 上一次解析位置
     static Frame_State frame_state = SEEK_FRAME_HEAD; // 帧解析状态机
+    static uint32_t rd_epoch = 0;              // 已同步的接收重启次数
 
     // 关闭全局中断，防止DMA缓冲区数据被篡改
     __disable_irq();
+    // 接收重启过：DMA从缓冲区起点重新写入，之前的残帧不可信
+    if (rx_epoch != rd_epoch) {
+        rd_epoch = rx_epoch;
+        DMA_Received_Index_Last = 0;
+        checksum = 0;
+        byte_pos = 0;
+        frame_timeout = 0;
+        frame_state = SEEK_FRAME_HEAD;
+    }
     // 获取DMA当前接收位置（剩余字节数反算已接收位置）
     DMA_Received_Index= RX_SIZE - __HAL_DMA_GET_COUNTER(huart_sensor->hdmarx);
     // 计算本次待解析的数据长度（处理缓冲区环形溢出）
@@ -217,6 +258,9 @@ bool Gyroscope_Process() {
     }
     // 恢复全局中断
     __enable_irq();
+    if (DMA_Received_Length > jy901s_stats.backlog_max) {
+        jy901s_stats.backlog_max = DMA_Received_Length;
+    }
 #if DEBUG_MODE
     static int error_count = 0;
     static uint32_t DMA_Received_Length_Debug = 0;
@@ -280,6 +324,9 @@ bool Gyroscope_Process() {
                         if ((checksum&0xFF) == RX_Process[10]) {
                             Gyroscope_Data(RX_Process);
                             Available_Data= true;
+                            jy901s_stats.frames++;
+                        } else {
+                            jy901s_stats.checksum_errors++;
                         }
                         // 重置状态机，准备解析下一帧
                         byte_pos=0;
@@ -293,6 +340,10 @@ bool Gyroscope_Process() {
     }
     // 更新上一次解析位置
     DMA_Received_Index_Last=DMA_Received_Index;
+    // 新数据打上接收事件中断的时间戳（导航滤波按相邻两组的时间差积分）
+    if (Available_Data) {
+        gyro_data.time_us = TimeBase_From_Cycles(jy901s_rx_stamp);
+    }
     return Available_Data;
 }
 
@@ -304,7 +355,7 @@ bool Gyroscope_Process() {
  *             2. 原始数据为16位有符号数，需转换为物理量（带单位）
  *             3. 温度数据随加速度帧一并解析
  */
-static void Gyroscope_Data(const uint8_t *data) {
+FAST_CODE static void Gyroscope_Data(const uint8_t *data) {
     switch (data[1]) {
         case Frame_Accele: // 加速度+温度帧
             gyro_data.gyroscope.accele[0] = (float)Gyroscope_HL_Combine(data[3],data[2])/32768.0f * 16.0f * G;
@@ -372,26 +423,26 @@ void Gyroscope_Data_Send(UART_HandleTypeDef *huart) {
     char Send_Date_Quater[size]; // 四元数数据字符串
     ottohesl_uart(huart,"%.2f,%.2f,%.2f",gyro_data.gyroscope.angle[0],gyro_data.gyroscope.angle[1],gyro_data.gyroscope.angle[2]);
     // 格式化加速度数据
-    int len_accle=sprintf(Send_Date_accle,"x加速度: %.2f，y加速度: %.2f，z加速度: %.2f\n",
+    int len_accle=FMT_Snprintf(Send_Date_accle,size,"x加速度: %.2f，y加速度: %.2f，z加速度: %.2f\n",
         gyro_data.gyroscope.accele[0],gyro_data.gyroscope.accele[1],gyro_data.gyroscope.accele[2]);
 
     // 格式化角速度数据）
-    int len_gyro=sprintf(Send_Date_gyro,"x角速度: %.2f，y角速度: %.2f，z角速度: %.2f\n",
+    int len_gyro=FMT_Snprintf(Send_Date_gyro,size,"x角速度: %.2f，y角速度: %.2f，z角速度: %.2f\n",
         gyro_data.gyroscope.gyro[0],gyro_data.gyroscope.gyro[1],gyro_data.gyroscope.gyro[2]);
 
     // 格式化角度数据
-    int len_angle=sprintf(Send_Date_angle,"翻滚角: %.2f，俯仰角: %.2f，航偏角: %.2f\n",
+    int len_angle=FMT_Snprintf(Send_Date_angle,size,"翻滚角: %.2f，俯仰角: %.2f，航偏角: %.2f\n",
         gyro_data.gyroscope.angle[0],gyro_data.gyroscope.angle[1],gyro_data.gyroscope.angle[2]);
 
     // 格式化温度数据
-    int len_temp=sprintf(Send_Date_temp,"温度: %.2f\n",gyro_data.temp);
+    int len_temp=FMT_Snprintf(Send_Date_temp,size,"温度: %.2f\n",gyro_data.temp);
 
     // 格式化磁场数据
-    int len_magent=sprintf(Send_Date_Magnet,"x磁: %.2f，y磁: %.2f，z磁: %.2f\n",
+    int len_magent=FMT_Snprintf(Send_Date_Magnet,size,"x磁: %.2f，y磁: %.2f，z磁: %.2f\n",
         gyro_data.gyroscope.magnet[0],gyro_data.gyroscope.magnet[1],gyro_data.gyroscope.magnet[2]);
 
     // 格式化四元数数据
-    int len_Quater=sprintf(Send_Date_Quater,"w: %.2f，x: %.2f，y: %.2f，z: %.2f\n",
+    int len_Quater=FMT_Snprintf(Send_Date_Quater,size,"w: %.2f，x: %.2f，y: %.2f，z: %.2f\n",
         gyro_data.gyroscope.quaternion[0],gyro_data.gyroscope.quaternion[1],gyro_data.gyroscope.quaternion[2],gyro_data.gyroscope.quaternion[3]);
 
     // 启用以下代码可发送对应数据
@@ -0,0 +1,266 @@
+/**
+ * @file       MEM_Cache.c
+ * @brief      存储系统初始化（MPU分区 + I/D缓存）与数据缓存维护接口
+ * @author     ottohesl
+ * @date       26-1-20
+ * @version    V1.0
+ * @note       1. 代码在Flash（3个等待周期），不开I缓存时每次取指都要等Flash；.data/.bss在DTCM不经过缓存，
+ *                D缓存主要加速Flash中的常量表和AXI SRAM
+ *             2. MPU区域0按ST推荐禁止访问未使用的外部存储地址（防止推测读挂死总线），
+ *                区域1把RAM_D2（0x30000000，32K）设为不可缓存，串口DMA缓冲区统一用DMA_BUFFER放在这里，
+ *                CPU与DMA看到的始终是同一份数据，不需要缓存维护
+ *             3. 仍在可缓存区、又被DMA或Flash控制器改写的数据（如黑匣子记录区）用MEM_DCache_*维护，
+ *                地址和长度按缓存行扩展；作废时首尾不满一行的部分先写回，不会丢掉相邻变量的修改
+ *             4. DMA1/DMA2可以访问RAM_D2和AXI SRAM，不能访问DTCM，DMA缓冲区不要放在普通全局变量里
+ *             5. ITCM/DTCM不经过缓存、0等待：控制周期、步态、帧解析和串口回调用FAST_CODE放入ITCM，
+ *                FreeRTOS切换/节拍与中断入口由链接脚本按段名放入，Reset_Handler在调用main前完成拷贝
+ */
+#include "MEM_Cache.h"
+#include <stdbool.h>
+#if MEM_BENCH
+#include <stdio.h>
+#include "steering.h"
+#include "NMEA_ATGM336H.h"
+#endif
+
+/************************ 私有函数实现 ************************/
+#if (MEM_CACHE_H_Vision==7)
+/**
+ * @brief  D缓存是否已开启（未开启时维护操作无意义）
+ */
+static inline bool MEM_DCache_Enabled(void) {
+    return (SCB->CCR & SCB_CCR_DC_Msk) != 0U;
+}
+
+/**
+ * @brief  配置MPU区域
+ * @note   1. 区域0：4G背景区禁止访问，子区域0/1/2/7关闭（保留Flash、SRAM、外设与系统区的默认属性），
+ *            只拦截0x60000000~0xDFFFFFFF的FMC/OCTOSPI外部存储地址
+ *         2. 区域1：RAM_D2普通存储、不可缓存、不可执行
+ */
+static void MEM_MPU_Config(void) {
+    MPU_Region_InitTypeDef region = {0};
+
+    HAL_MPU_Disable();
+
+    region.Enable = MPU_REGION_ENABLE;
+    region.Number = MPU_REGION_NUMBER0;
+    region.BaseAddress = 0x00000000U;
+    region.Size = MPU_REGION_SIZE_4GB;
+    region.SubRegionDisable = 0x87;
+    region.TypeExtField = MPU_TEX_LEVEL0;
+    region.AccessPermission = MPU_REGION_NO_ACCESS;
+    region.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+    region.IsShareable = MPU_ACCESS_SHAREABLE;
+    region.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+    region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&region);
+
+    region.Number = MPU_REGION_NUMBER1;
+    region.BaseAddress = MEM_DMA_BASE;
+    region.Size = MPU_REGION_SIZE_32KB;
+    region.SubRegionDisable = 0x00;
+    region.TypeExtField = MPU_TEX_LEVEL1;       // TEX=1,C=0,B=0：普通存储、不可缓存
+    region.AccessPermission = MPU_REGION_FULL_ACCESS;
+    region.DisableExec = MPU_INSTRUCTION_ACCESS_DISABLE;
+    region.IsShareable = MPU_ACCESS_NOT_SHAREABLE;
+    region.IsCacheable = MPU_ACCESS_NOT_CACHEABLE;
+    region.IsBufferable = MPU_ACCESS_NOT_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&region);
+
+    // 未命中任何区域的特权访问使用默认存储映射
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+}
+
+/**
+ * @brief  地址范围按缓存行扩展
+ * @param  addr: 起始地址
+ * @param  len: 长度（字节）
+ * @param  start: 输出，向下对齐的起始地址
+ * @retval 扩展后的长度
+ */
+static uint32_t MEM_Line_Range(const void *addr, uint32_t len, uint32_t *start) {
+    uint32_t first = (uint32_t)addr & ~(MEM_CACHE_LINE - 1U);
+    uint32_t end = MEM_CACHE_ROUND((uint32_t)addr + len);
+    *start = first;
+    return end - first;
+}
+#endif
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  存储系统初始化
+ * @retval 无
+ * @note   1. 在main的USER CODE BEGIN 1处（HAL_Init之前）调用，与CubeMX生成的MPU_Config位置相同
+ *         2. 打开RAM_D2时钟（SRAM1/SRAM2），CPU停机时DMA仍可访问
+ *         3. SCB_EnableDCache内部先作废整个D缓存，开启前RAM中的数据不受影响
+ */
+void MEM_Init(void) {
+#if (MEM_CACHE_H_Vision==7)
+    MEM_MPU_Config();
+    __HAL_RCC_D2SRAM1_CLK_ENABLE();
+    __HAL_RCC_D2SRAM2_CLK_ENABLE();
+    SCB_EnableICache();
+    SCB_EnableDCache();
+#endif
+}
+
+/**
+ * @brief  写回D缓存
+ * @param  addr: 起始地址（不要求对齐）
+ * @param  len: 长度（字节）
+ * @retval 无
+ */
+void MEM_DCache_Clean(const void *addr, uint32_t len) {
+#if (MEM_CACHE_H_Vision==7)
+    uint32_t start;
+    if (len == 0U || !MEM_DCache_Enabled()) {
+        return;
+    }
+    uint32_t size = MEM_Line_Range(addr, len, &start);
+    SCB_CleanDCache_by_Addr((uint32_t *)start, (int32_t)size);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+
+/**
+ * @brief  作废D缓存
+ * @param  addr: 起始地址（不要求对齐）
+ * @param  len: 长度（字节）
+ * @retval 无
+ * @note   1. 首尾不满一行时这两行改为写回并作废，保留同一行里相邻变量的修改
+ *         2. 范围内的数据以内存为准，调用前CPU对该范围的未写回修改会丢失
+ */
+void MEM_DCache_Invalidate(void *addr, uint32_t len) {
+#if (MEM_CACHE_H_Vision==7)
+    uint32_t start;
+    if (len == 0U || !MEM_DCache_Enabled()) {
+        return;
+    }
+    uint32_t size = MEM_Line_Range(addr, len, &start);
+    uint32_t end = start + size;
+    uint32_t head = (uint32_t)addr;
+    uint32_t tail = (uint32_t)addr + len;
+
+    if (head != start) {
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, (int32_t)MEM_CACHE_LINE);
+        start += MEM_CACHE_LINE;
+    }
+    if (tail != end && end - MEM_CACHE_LINE >= start) {
+        SCB_CleanInvalidateDCache_by_Addr((uint32_t *)(end - MEM_CACHE_LINE), (int32_t)MEM_CACHE_LINE);
+        end -= MEM_CACHE_LINE;
+    }
+    if (end > start) {
+        SCB_InvalidateDCache_by_Addr((uint32_t *)start, (int32_t)(end - start));
+    }
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+
+/**
+ * @brief  写回并作废D缓存
+ * @param  addr: 起始地址（不要求对齐）
+ * @param  len: 长度（字节）
+ * @retval 无
+ */
+void MEM_DCache_Clean_Invalidate(void *addr, uint32_t len) {
+#if (MEM_CACHE_H_Vision==7)
+    uint32_t start;
+    if (len == 0U || !MEM_DCache_Enabled()) {
+        return;
+    }
+    uint32_t size = MEM_Line_Range(addr, len, &start);
+    SCB_CleanInvalidateDCache_by_Addr((uint32_t *)start, (int32_t)size);
+#else
+    (void)addr;
+    (void)len;
+#endif
+}
+
+#if MEM_BENCH
+/************************ 周期对比测试 ************************/
+#define MEM_BENCH_RUNS  16      // 每种配置每个内核的运行次数
+
+typedef struct {
+    uint32_t first;             // 第一次运行（冷启动）
+    uint32_t avg;               // 其余各次平均
+} MEM_Bench_Result_t;
+
+typedef void (*MEM_Kernel_t)(void);
+
+static const char mem_gga[] = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+static const char mem_rmc[] = "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n";
+
+/**
+ * @brief  步态内核：前进摆动一步（正弦插值 + 舵机比较值更新）
+ * @note   Fish_Forward的日志由FISH_DEBUG_MODE控制，默认编译掉，计时只含插值与两次比较值写入
+ */
+static void MEM_Kernel_Gait(void) {
+    Fish_Forward();
+}
+
+/**
+ * @brief  解析内核：GGA + RMC各一条
+ */
+static void MEM_Kernel_NMEA(void) {
+    GPS_Parse_NMEA(mem_gga);
+    GPS_Parse_NMEA(mem_rmc);
+}
+
+static MEM_Bench_Result_t MEM_Bench_Run(MEM_Kernel_t kernel) {
+    MEM_Bench_Result_t r = {0};
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < MEM_BENCH_RUNS; i++) {
+        uint32_t t0 = DWT->CYCCNT;
+        kernel();
+        uint32_t cycles = DWT->CYCCNT - t0;
+        if (i == 0) {
+            r.first = cycles;
+        } else {
+            sum += cycles;
+        }
+    }
+    r.avg = sum / (MEM_BENCH_RUNS - 1);
+    return r;
+}
+
+/**
+ * @brief  关/开缓存周期对比
+ * @note   1. 关缓存前SCB_DisableDCache会写回全部脏行，DMA缓冲区不可缓存，测试期间串口接收不受影响
+ *         2. 步态内核会改舵机比较值和摆动计数，GPS内核会改定位数据，测试后恢复（舵机回中）
+ *         3. FISH_DEBUG_MODE打开时步态内核含Fish_Forward的日志printf，结果后另行提示
+ */
+void MEM_Bench(void) {
+    static const MEM_Kernel_t kernels[] = {MEM_Kernel_Gait, MEM_Kernel_NMEA};
+    static const char *const names[] = {"gait", "nmea"};
+    MEM_Bench_Result_t off[2], on[2];
+    GPS_Data_t gps;
+
+    GPS_Get_Data(&gps);
+    SCB_DisableDCache();
+    SCB_DisableICache();
+    for (uint32_t k = 0; k < 2; k++) {
+        off[k] = MEM_Bench_Run(kernels[k]);
+    }
+    SCB_EnableICache();
+    SCB_EnableDCache();
+    for (uint32_t k = 0; k < 2; k++) {
+        on[k] = MEM_Bench_Run(kernels[k]);
+    }
+    GPS_Set_Data(&gps);
+    Fish_Stop();
+
+    for (uint32_t k = 0; k < 2; k++) {
+        printf("MEM bench %s: cache off first=%lu avg=%lu, cache on first=%lu avg=%lu cycles\n", names[k],
+               (unsigned long)off[k].first, (unsigned long)off[k].avg,
+               (unsigned long)on[k].first, (unsigned long)on[k].avg);
+    }
+#if FISH_DEBUG_MODE
+    printf("MEM bench: FISH_DEBUG_MODE on, gait cycles include the Fish_Forward log printf\n");
+#endif
+}
+#endif
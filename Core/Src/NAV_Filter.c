@@ -0,0 +1,321 @@
+/**
+ * @file       NAV_Filter.c
+ * @brief      GPS/IMU松耦合导航滤波（4状态线性卡尔曼：本地NED平面位置+速度）
+ * @author     ottohesl
+ * @date       26-1-12
+ * @version    V1.0
+ * @note       1. 预测：JY901S每出一组数据，用姿态角把机体加速度转到NED，积分位置/速度
+ *             2. 校正：每次GPS有效定位，用位置（由HDOP估计噪声，二进制NAV-PV只有PDOP）+对地速度校正
+ *             3. GPS中断（水面失锁、下潜）期间只做惯性推算，协方差随之增长
+ *             4. 全部矩阵静态预分配，使用CMSIS-DSP矩阵函数，每步运算量固定
+ *             5. 校正在JY901S任务中执行，GPS任务只提交数据，滤波器状态单线程访问
+ */
+#include "NAV_Filter.h"
+#include <math.h>
+#include <string.h>
+
+/************************ 宏定义 ************************/
+#define NAV_DEG2RAD    0.017453292519943295f    // 度转弧度
+#define N              NAV_STATES
+
+/************************ 全局变量 ************************/
+NAV_State_t nav_state;                          // 融合状态（发布给其他任务）
+
+/************************ 滤波器矩阵（预分配） ************************/
+static float32_t x_data[N];                     // 状态 [pN pE vN vE]
+static float32_t P_data[N * N];                 // 协方差
+static float32_t F_data[N * N];                 // 状态转移
+static float32_t FT_data[N * N];                // 状态转移转置
+static float32_t Q_data[N * N];                 // 过程噪声
+static float32_t R_data[N * N];                 // 测量噪声
+static float32_t I_data[N * N];                 // 单位阵
+static float32_t Sinv_data[N * N];              // 新息协方差逆
+static float32_t K_data[N * N];                 // 卡尔曼增益
+static float32_t T1_data[N * N];                // 临时矩阵1
+static float32_t T2_data[N * N];                // 临时矩阵2
+static float32_t z_data[N];                     // 测量值
+static float32_t y_data[N];                     // 新息
+static float32_t Ky_data[N];                    // 状态增量
+
+static arm_matrix_instance_f32 mat_x, mat_P, mat_F, mat_FT, mat_Q, mat_R, mat_I;
+static arm_matrix_instance_f32 mat_Sinv, mat_K, mat_T1, mat_T2, mat_y, mat_Ky;
+
+/************************ GPS挂起数据 ************************/
+static GPS_Data_t gps_pending;                  // 待校正的GPS定位
+static volatile bool gps_pending_flag = false;  // true=有新定位未处理
+static float cos_origin_lat = 1.0f;             // 原点纬度余弦（东向距离换算）
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  读取DWT周期计数器
+ */
+static inline uint32_t NAV_Cycles(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief  JY901S加速度转到NED系水平分量
+ * @param  imu: JY901S数据（加速度m/s²，角度°）
+ * @param  acc_n/acc_e: 输出北向/东向运动加速度（已扣除重力），m/s²
+ * @note   1. JY901S坐标系为X前、Y左、Z上，航向角逆时针为正
+ *         2. 转成FRD机体系（X前、Y右、Z下）和NED欧拉角（航向顺时针为正）后用ZYX旋转
+ *         3. 比力在NED中加上重力即为运动加速度，此处只需水平分量，重力不参与
+ */
+static void NAV_Accel_To_NED(const jy901 *imu, float *acc_n, float *acc_e) {
+    float fx = imu->gyroscope.accele[0];
+    float fy = -imu->gyroscope.accele[1];
+    float fz = -imu->gyroscope.accele[2];
+    float roll = imu->gyroscope.angle[0] * NAV_DEG2RAD;
+    float pitch = -imu->gyroscope.angle[1] * NAV_DEG2RAD;
+    float yaw = -imu->gyroscope.angle[2] * NAV_DEG2RAD;
+
+    float sr = sinf(roll), cr = cosf(roll);
+    float sp = sinf(pitch), cp = cosf(pitch);
+    float sy = sinf(yaw), cy = cosf(yaw);
+
+    // 机体系到NED的方向余弦矩阵前两行
+    *acc_n = cp * cy * fx + (sr * sp * cy - cr * sy) * fy + (cr * sp * cy + sr * sy) * fz;
+    *acc_e = cp * sy * fx + (sr * sp * sy + cr * cy) * fy + (cr * sp * sy - sr * cy) * fz;
+}
+
+/**
+ * @brief  用首个有效定位建立本地原点并初始化状态
+ */
+static void NAV_Reset(const GPS_Data_t *gps, float vel_n, float vel_e) {
+    nav_state.origin_lat = gps->latitude;
+    nav_state.origin_lon = gps->longitude;
+    cos_origin_lat = cosf((float)gps->latitude * 1e-7f * NAV_DEG2RAD);
+
+    x_data[0] = 0.0f;
+    x_data[1] = 0.0f;
+    x_data[2] = vel_n;
+    x_data[3] = vel_e;
+    memset(P_data, 0, sizeof(P_data));
+    P_data[0 * N + 0] = NAV_INIT_POS_VAR;
+    P_data[1 * N + 1] = NAV_INIT_POS_VAR;
+    P_data[2 * N + 2] = NAV_INIT_VEL_VAR;
+    P_data[3 * N + 3] = NAV_INIT_VEL_VAR;
+}
+
+/**
+ * @brief  把滤波器内部状态写到发布结构体
+ */
+static void NAV_Publish(void) {
+    __disable_irq();
+    nav_state.pos_n = x_data[0];
+    nav_state.pos_e = x_data[1];
+    nav_state.vel_n = x_data[2];
+    nav_state.vel_e = x_data[3];
+    memcpy(nav_state.cov, P_data, sizeof(P_data));
+    __enable_irq();
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  导航滤波初始化
+ * @note   1. 绑定预分配矩阵，清零状态，需在启动调度器前调用
+ *         2. 每步运算周期用DWT计数器统计（TimeBase_Init已开启，这里不再清零：之前的接收中断已经在用它打时间戳）
+ */
+void NAV_Init(void) {
+    memset(&nav_state, 0, sizeof(NAV_State_t));
+    memset(F_data, 0, sizeof(F_data));
+    memset(Q_data, 0, sizeof(Q_data));
+    memset(R_data, 0, sizeof(R_data));
+    memset(I_data, 0, sizeof(I_data));
+    for (uint8_t i = 0; i < N; i++) {
+        F_data[i * N + i] = 1.0f;
+        I_data[i * N + i] = 1.0f;
+    }
+    memcpy(FT_data, F_data, sizeof(F_data));
+    gps_pending_flag = false;
+
+    arm_mat_init_f32(&mat_x, N, 1, x_data);
+    arm_mat_init_f32(&mat_P, N, N, P_data);
+    arm_mat_init_f32(&mat_F, N, N, F_data);
+    arm_mat_init_f32(&mat_FT, N, N, FT_data);
+    arm_mat_init_f32(&mat_Q, N, N, Q_data);
+    arm_mat_init_f32(&mat_R, N, N, R_data);
+    arm_mat_init_f32(&mat_I, N, N, I_data);
+    arm_mat_init_f32(&mat_Sinv, N, N, Sinv_data);
+    arm_mat_init_f32(&mat_K, N, N, K_data);
+    arm_mat_init_f32(&mat_T1, N, N, T1_data);
+    arm_mat_init_f32(&mat_T2, N, N, T2_data);
+    arm_mat_init_f32(&mat_y, N, 1, y_data);
+    arm_mat_init_f32(&mat_Ky, N, 1, Ky_data);
+}
+
+/**
+ * @brief  IMU预测一步
+ * @param  imu: JY901S最新数据
+ * @param  dt: 距上次预测的时间，s
+ * @note   1. x = F*x + B*a，P = F*P*F' + Q（Q为白噪声加速度模型）
+ *         2. 未用GPS初始化前不推算；dt超过NAV_DT_MAX按NAV_DT_MAX处理
+ */
+void NAV_Predict(const jy901 *imu, float dt) {
+    if (!nav_state.valid || dt <= 0.0f) {
+        return;
+    }
+    if (dt > NAV_DT_MAX) {
+        dt = NAV_DT_MAX;
+    }
+    uint32_t start = NAV_Cycles();
+
+    float acc_n, acc_e;
+    NAV_Accel_To_NED(imu, &acc_n, &acc_e);
+
+    // 状态推算（F稀疏，直接展开）
+    float half_dt2 = 0.5f * dt * dt;
+    x_data[0] += x_data[2] * dt + acc_n * half_dt2;
+    x_data[1] += x_data[3] * dt + acc_e * half_dt2;
+    x_data[2] += acc_n * dt;
+    x_data[3] += acc_e * dt;
+
+    // 更新F、F'中的dt项
+    F_data[0 * N + 2] = dt;
+    F_data[1 * N + 3] = dt;
+    FT_data[2 * N + 0] = dt;
+    FT_data[3 * N + 1] = dt;
+
+    // 过程噪声：q*[dt^4/4 dt^3/2; dt^3/2 dt^2]，南北、东西各一块
+    float q = NAV_ACCEL_NOISE * NAV_ACCEL_NOISE;
+    float q_pp = q * half_dt2 * half_dt2;
+    float q_pv = q * half_dt2 * dt;
+    float q_vv = q * dt * dt;
+    Q_data[0 * N + 0] = q_pp;  Q_data[0 * N + 2] = q_pv;
+    Q_data[1 * N + 1] = q_pp;  Q_data[1 * N + 3] = q_pv;
+    Q_data[2 * N + 0] = q_pv;  Q_data[2 * N + 2] = q_vv;
+    Q_data[3 * N + 1] = q_pv;  Q_data[3 * N + 3] = q_vv;
+
+    // P = F*P*F' + Q
+    arm_mat_mult_f32(&mat_F, &mat_P, &mat_T1);
+    arm_mat_mult_f32(&mat_T1, &mat_FT, &mat_T2);
+    arm_mat_add_f32(&mat_T2, &mat_Q, &mat_P);
+
+    NAV_Publish();
+    uint32_t cycles = NAV_Cycles() - start;
+    if (cycles > nav_state.predict_cycles_max) {
+        nav_state.predict_cycles_max = cycles;
+    }
+    nav_state.predict_steps++;
+}
+
+/**
+ * @brief  提交一次GPS定位
+ * @param  gps: 解析后的GPS数据
+ * @note   只拷贝数据，校正在JY901S任务中的NAV_Update执行，避免两任务同时改滤波器
+ */
+void NAV_Post_GPS(const GPS_Data_t *gps) {
+    if (gps == NULL || !gps->is_valid) {
+        return;
+    }
+    __disable_irq();
+    memcpy(&gps_pending, gps, sizeof(GPS_Data_t));
+    gps_pending_flag = true;
+    __enable_irq();
+}
+
+/**
+ * @brief  执行挂起的GPS校正
+ * @retval true: 本次执行了校正或初始化；false: 无新定位
+ * @note   1. 测量为[pN pE vN vE]，H=I，故S=P+R，K=P*S^-1
+ *         2. 位置噪声=HDOP*NAV_GPS_UERE，无HDOP（NAV-PV）时用PDOP（不小于HDOP，偏保守），速度噪声固定
+ *         3. P=(I-K)*P后再对称化，抑制单精度舍入误差累积
+ */
+bool NAV_Update(void) {
+    GPS_Data_t gps;
+    if (!gps_pending_flag) {
+        return false;
+    }
+    __disable_irq();
+    memcpy(&gps, &gps_pending, sizeof(GPS_Data_t));
+    gps_pending_flag = false;
+    __enable_irq();
+
+    uint32_t start = NAV_Cycles();
+
+    // 对地速度+航向 -> NED速度
+    float speed = (float)gps.speed * 0.01f;
+    float course = (float)gps.course * 0.01f * NAV_DEG2RAD;
+    float vel_n = speed * cosf(course);
+    float vel_e = speed * sinf(course);
+
+    if (!nav_state.valid) {
+        NAV_Reset(&gps, vel_n, vel_e);
+        nav_state.valid = true;
+        NAV_Publish();
+        return true;
+    }
+
+    // 经纬度差 -> 本地平面坐标（整数差避免单精度丢失有效位）
+    z_data[0] = (float)(gps.latitude - nav_state.origin_lat) * 1e-7f * NAV_DEG2RAD * NAV_EARTH_RADIUS;
+    z_data[1] = (float)(gps.longitude - nav_state.origin_lon) * 1e-7f * NAV_DEG2RAD * NAV_EARTH_RADIUS * cos_origin_lat;
+    z_data[2] = vel_n;
+    z_data[3] = vel_e;
+
+    // 测量噪声
+    uint16_t dop = gps.hdop ? gps.hdop : gps.pdop;
+    float pos_sigma = (float)dop * 0.01f * NAV_GPS_UERE;
+    if (pos_sigma < 1.0f) {
+        pos_sigma = 1.0f;
+    }
+    R_data[0 * N + 0] = pos_sigma * pos_sigma;
+    R_data[1 * N + 1] = pos_sigma * pos_sigma;
+    R_data[2 * N + 2] = NAV_GPS_VEL_NOISE * NAV_GPS_VEL_NOISE;
+    R_data[3 * N + 3] = NAV_GPS_VEL_NOISE * NAV_GPS_VEL_NOISE;
+
+    // S = P + R，求逆会破坏输入，先算到T1
+    arm_mat_add_f32(&mat_P, &mat_R, &mat_T1);
+    if (arm_mat_inverse_f32(&mat_T1, &mat_Sinv) != ARM_MATH_SUCCESS) {
+        return false;
+    }
+
+    // K = P * S^-1
+    arm_mat_mult_f32(&mat_P, &mat_Sinv, &mat_K);
+
+    // x = x + K*(z - x)
+    arm_sub_f32(z_data, x_data, y_data, N);
+    arm_mat_mult_f32(&mat_K, &mat_y, &mat_Ky);
+    arm_add_f32(x_data, Ky_data, x_data, N);
+
+    // P = (I - K) * P，再取 (P + P')/2
+    arm_mat_sub_f32(&mat_I, &mat_K, &mat_T1);
+    arm_mat_mult_f32(&mat_T1, &mat_P, &mat_T2);
+    arm_mat_trans_f32(&mat_T2, &mat_T1);
+    arm_mat_add_f32(&mat_T1, &mat_T2, &mat_P);
+    arm_mat_scale_f32(&mat_P, 0.5f, &mat_P);
+
+    NAV_Publish();
+    uint32_t cycles = NAV_Cycles() - start;
+    if (cycles > nav_state.update_cycles_max) {
+        nav_state.update_cycles_max = cycles;
+    }
+    nav_state.gps_updates++;
+    return true;
+}
+
+/**
+ * @brief  获取融合状态副本
+ * @param  state: 输出状态
+ */
+void NAV_Get_State(NAV_State_t *state) {
+    if (state == NULL) {
+        return;
+    }
+    __disable_irq();
+    memcpy(state, &nav_state, sizeof(NAV_State_t));
+    __enable_irq();
+}
+
+/**
+ * @brief  JY901S航向角转NED航向
+ * @param  imu: JY901S数据
+ * @retval 航向，°（0=北，顺时针为正，0~360）
+ * @note   JY901S航向角逆时针为正，取反后归一化
+ */
+float NAV_Get_Heading(const jy901 *imu) {
+    float heading = -imu->gyroscope.angle[2];
+    if (heading < 0.0f) {
+        heading += 360.0f;
+    }
+    return heading;
+}
@@ -1,161 +1,279 @@
 #include "NMEA_ATGM336H.h"
 #include "string.h"
-#include "stdlib.h"
-#include "stdio.h"
+#include "MEM_Cache.h"
 // 全局GPS数据结构
 static GPS_Data_t g_gps_data = {0};
+// 格式或校验错误的语句数（采集回放时与上位机离线解析结果对照）
+static uint32_t g_parse_errors = 0;
 
-// 初始化GPS解析器
-void GPS_Parser_Init(void)
+// 5字符语句ID打包为整数，供switch分发（talker 2字节 + 类型 3字节）
+#define NMEA_ID(a, b, c, d, e) \
+    (((uint64_t)(a) << 32) | ((uint64_t)(b) << 24) | ((uint64_t)(c) << 16) | ((uint64_t)(d) << 8) | (uint64_t)(e))
+
+// 单遍扫描结果：字段起始位置都指向原语句，不做拷贝
+typedef struct {
+    const char* field[NMEA_MAX_FIELDS];  // 各字段起始地址
+    uint8_t count;                       // 字段数
+} NMEA_Fields_t;
+
+static uint8_t hex_value(char c)
 {
-    memset(&g_gps_data, 0, sizeof(GPS_Data_t));
-    g_gps_data.is_valid = 0;
-    g_gps_data.status = 'V';  // 默认无效
+    if (c >= '0' && c <= '9') return (uint8_t)(c - '0');
+    if (c >= 'A' && c <= 'F') return (uint8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f') return (uint8_t)(c - 'a' + 10);
+    return 0xFF;
 }
 
-uint8_t GPS_Check_Checksum(const char* nmea_data)
+static uint8_t is_field_end(char c)
 {
-    if (nmea_data == NULL || strlen(nmea_data) < 7) {
-        return 0;
-    }
+    return c == ',' || c == '*' || c == '\0';
+}
 
-    if (nmea_data[0] != '$') {
+/**
+ * @brief  单遍扫描NMEA语句：同时计算异或校验、记录字段位置并比对校验和
+ * @param  nmea_data: 以'$'开头的语句
+ * @param  fields: 输出字段位置，可为NULL（只校验）
+ * @retval 1=校验通过，0=格式或校验错误
+ */
+FAST_CODE static uint8_t NMEA_Scan(const char* nmea_data, NMEA_Fields_t* fields)
+{
+    if (nmea_data == NULL || nmea_data[0] != '$') {
         return 0;
     }
 
     uint8_t calculated_checksum = 0;
-    uint8_t received_checksum = 0;
     const char* ptr = nmea_data + 1;
+    const char* end = nmea_data + NMEA_MAX_LENGTH;
 
-    // 计算校验和
-    while (*ptr && *ptr != '*' && (ptr - nmea_data) < 100) {
-        calculated_checksum ^= *ptr;
-        ptr++;
+    if (fields != NULL) {
+        fields->field[0] = ptr;
+        fields->count = 1;
     }
 
-    // 获取接收到的校验和
-    if (*ptr == '*' && *(ptr+1) && *(ptr+2)) {
-        char hex[3] = {*(ptr+1), *(ptr+2), '\0'};
-        received_checksum = (uint8_t)strtol(hex, NULL, 16);
-        return (calculated_checksum == received_checksum);
+    while (*ptr && *ptr != '*' && ptr < end) {
+        calculated_checksum ^= (uint8_t)*ptr;
+        if (*ptr == ',' && fields != NULL && fields->count < NMEA_MAX_FIELDS) {
+            fields->field[fields->count++] = ptr + 1;
+        }
+        ptr++;
     }
 
-    return 0;
+    // 语句ID至少5个字符，且校验和后两位为十六进制
+    if (*ptr != '*' || (ptr - nmea_data) < 6) {
+        return 0;
+    }
+    if (ptr[1] == '\0') {                // '*'后截断，不再读ptr[2]
+        return 0;
+    }
+    uint8_t high = hex_value(ptr[1]);
+    uint8_t low = hex_value(ptr[2]);
+    if (high > 0x0F || low > 0x0F) {
+        return 0;
+    }
+    return calculated_checksum == (uint8_t)((high << 4) | low);
 }
-// 解析GGA语句
-void GPS_Parse_GGA(const char* nmea_data)
-{
-    char copy[256];
-    char* tokens[20];
-    uint8_t token_count = 0;
 
-    strncpy(copy, nmea_data, sizeof(copy)-1);
-    copy[sizeof(copy)-1] = '\0';
+/**
+ * @brief  解析定点小数字段（如"123.45"），按decimals位小数放大为整数
+ * @param  p: 字段起始
+ * @param  decimals: 保留小数位数，多余位截断，不足补零
+ * @param  out: 输出值
+ * @retval 1=字段非空，0=空字段
+ */
+static uint8_t parse_fixed(const char* p, uint8_t decimals, int32_t* out)
+{
+    int32_t value = 0;
+    uint8_t negative = 0;
+    uint8_t frac = 0;
+    uint8_t in_frac = 0;
+    uint8_t digits = 0;
 
-    // 分割字符串
-    char* token = strtok(copy, ",");
-    while (token != NULL && token_count < 20) {
-        tokens[token_count++] = token;
-        token = strtok(NULL, ",");
+    if (*p == '-') {
+        negative = 1;
+        p++;
     }
-    // 只有满足条件时才设置有效
-    if (token_count >= 10) {
-        // 纬度
-        if (strlen(tokens[2]) > 0) {
-            strncpy(g_gps_data.latitude, tokens[2], sizeof(g_gps_data.latitude)-1);
-            g_gps_data.latitude[sizeof(g_gps_data.latitude)-1] = '\0';
-            g_gps_data.ns_indicator = (tokens[3][0] == 'N' || tokens[3][0] == 'S') ? tokens[3][0] : 'N';
+    for (; !is_field_end(*p); p++) {
+        if (*p == '.') {
+            in_frac = 1;
+            continue;
         }
-
-        // 经度
-        if (strlen(tokens[4]) > 0) {
-            strncpy(g_gps_data.longitude, tokens[4], sizeof(g_gps_data.longitude)-1);
-            g_gps_data.longitude[sizeof(g_gps_data.longitude)-1] = '\0';
-            g_gps_data.ew_indicator = (tokens[5][0] == 'E' || tokens[5][0] == 'W') ? tokens[5][0] : 'E';
+        if (*p < '0' || *p > '9' || value > 214748363) {
+            break;
         }
+        if (in_frac) {
+            if (frac >= decimals) {
+                continue;
+            }
+            frac++;
+        }
+        value = value * 10 + (*p - '0');
+        digits++;
+    }
+    if (digits == 0) {
+        return 0;
+    }
+    for (; frac < decimals; frac++) {
+        value *= 10;
+    }
+    *out = negative ? -value : value;
+    return 1;
+}
 
-        // 状态 (GGA语句中第6个字段是定位状态)
-        g_gps_data.status = (token_count > 6 && tokens[6][0] == '1') ? 'A' : 'V';
-
-        // 只有状态为A时才认为数据有效
-        g_gps_data.is_valid = (g_gps_data.status == 'A');
-
-        printf("  GGA Latitude: %s %c\n", g_gps_data.latitude, g_gps_data.ns_indicator);
-        printf("  GGA Longitude: %s %c\n", g_gps_data.longitude, g_gps_data.ew_indicator);
-    } else {
-        g_gps_data.is_valid = 0;
-
+/**
+ * @brief  解析经纬度字段（d..dmm.mmmm）为1e-7度
+ * @param  p: 坐标字段
+ * @param  hemi: 半球字段（N/S/E/W）
+ * @param  out: 输出值，南纬/西经为负
+ * @retval 1=成功，0=空字段
+ */
+static uint8_t parse_coordinate(const char* p, const char* hemi, int32_t* out)
+{
+    int32_t raw;  // 以1e-5分为单位的dddmm.mmmmm
+    if (!parse_fixed(p, 5, &raw) || raw < 0) {
+        return 0;
     }
+    int32_t degrees = raw / 10000000;
+    int32_t minutes_e5 = raw % 10000000;
+    // 1e-5分 -> 1e-7度：x * 100 / 60，四舍五入
+    int32_t value = degrees * 10000000 + (minutes_e5 * 5 + 1) / 3;
+    *out = (*hemi == 'S' || *hemi == 'W') ? -value : value;
+    return 1;
 }
-// 解析RMC语句
-void GPS_Parse_RMC(const char* nmea_data)
+
+/**
+ * @brief  解析UTC时间字段（hhmmss.sss）为当天毫秒数
+ */
+static uint8_t parse_time(const char* p, uint32_t* out)
 {
+    int32_t raw;  // hhmmss.sss * 1000
+    if (!parse_fixed(p, 3, &raw) || raw < 0) {
+        return 0;
+    }
+    uint32_t hh = (uint32_t)raw / 10000000U;
+    uint32_t mm = ((uint32_t)raw / 100000U) % 100U;
+    uint32_t ss_ms = (uint32_t)raw % 100000U;
+    *out = (hh * 3600U + mm * 60U) * 1000U + ss_ms;
+    return 1;
+}
 
+// 初始化GPS解析器
+void GPS_Parser_Init(void)
+{
+    memset(&g_gps_data, 0, sizeof(GPS_Data_t));
     g_gps_data.is_valid = 0;
-    char copy[256];
-    char* tokens[20];
-    uint8_t token_count = 0;
+    g_gps_data.status = 'V';  // 默认无效
+    g_parse_errors = 0;
+}
 
-    strncpy(copy, nmea_data, sizeof(copy)-1);
-    copy[sizeof(copy)-1] = '\0';
+uint8_t GPS_Check_Checksum(const char* nmea_data)
+{
+    return NMEA_Scan(nmea_data, NULL);
+}
+
+// 解析GGA语句
+static void GPS_Parse_GGA(const NMEA_Fields_t* f)
+{
+    int32_t value;
 
-    char* token = strtok(copy, ",");
-    while (token != NULL && token_count < 20) {
-        tokens[token_count++] = token;
-        token = strtok(NULL, ",");
+    // 只有满足条件时才设置有效
+    if (f->count < 10) {
+        g_gps_data.is_valid = 0;
+        return;
     }
 
+    parse_time(f->field[1], &g_gps_data.utc_time);
 
+    // 纬度、经度
+    parse_coordinate(f->field[2], f->field[3], &g_gps_data.latitude);
+    parse_coordinate(f->field[4], f->field[5], &g_gps_data.longitude);
 
-    if (token_count >= 12) {  // RMC语句通常有12个字段
-       // printf("RMC has enough tokens\n");
+    // 定位质量、卫星数、HDOP、海拔
+    g_gps_data.fix_quality = parse_fixed(f->field[6], 0, &value) ? (uint8_t)value : 0;
+    if (parse_fixed(f->field[7], 0, &value)) g_gps_data.satellites = (uint8_t)value;
+    if (parse_fixed(f->field[8], 2, &value)) g_gps_data.hdop = (uint16_t)value;
+    if (parse_fixed(f->field[9], 2, &value)) g_gps_data.altitude = value;
 
-        // 状态 (RMC语句中第2个字段是状态)
-        g_gps_data.status = tokens[2][0];
+    // 状态 (GGA语句中第6个字段是定位质量，非0即已定位)
+    g_gps_data.status = (g_gps_data.fix_quality != 0) ? 'A' : 'V';
 
-        // 纬度 (第3个字段是纬度，第4个是N/S指示器)
-        if (strlen(tokens[3]) > 0) {
-            strncpy(g_gps_data.latitude, tokens[3], sizeof(g_gps_data.latitude)-1);
-            g_gps_data.latitude[sizeof(g_gps_data.latitude)-1] = '\0';
-            g_gps_data.ns_indicator = tokens[4][0];
-        }
+    // 只有状态为A时才认为数据有效
+    g_gps_data.is_valid = (g_gps_data.status == 'A');
+}
 
-        // 经度 (第5个字段是经度，第6个是E/W指示器)
-        if (strlen(tokens[5]) > 0) {
-            strncpy(g_gps_data.longitude, tokens[5], sizeof(g_gps_data.longitude)-1);
-            g_gps_data.longitude[sizeof(g_gps_data.longitude)-1] = '\0';
-            g_gps_data.ew_indicator = tokens[6][0];
-        }
+// 解析RMC语句
+static void GPS_Parse_RMC(const NMEA_Fields_t* f)
+{
+    int32_t value;
+
+    if (f->count < 10) {  // RMC语句至少包含到日期字段
+        g_gps_data.is_valid = 0;
+        return;
+    }
 
-        g_gps_data.is_valid = (g_gps_data.status == 'A');
+    parse_time(f->field[1], &g_gps_data.utc_time);
 
-        // 打印RMC解析结果
-        printf("  RMC Latitude: %s %c\n", g_gps_data.latitude, g_gps_data.ns_indicator);
-        printf("  RMC Longitude: %s %c\n", g_gps_data.longitude, g_gps_data.ew_indicator);
+    // 状态 (RMC语句中第2个字段是状态)
+    g_gps_data.status = f->field[2][0];
 
-    } else {
-        g_gps_data.is_valid = 0;
+    // 纬度 (第3个字段是纬度，第4个是N/S指示器)
+    parse_coordinate(f->field[3], f->field[4], &g_gps_data.latitude);
+    // 经度 (第5个字段是经度，第6个是E/W指示器)
+    parse_coordinate(f->field[5], f->field[6], &g_gps_data.longitude);
 
+    // 速度：节(1e-3) -> cm/s，1节=51.4444cm/s
+    if (parse_fixed(f->field[7], 3, &value) && value >= 0) {
+        g_gps_data.speed = (uint16_t)(((int64_t)value * 514444 + 5000000) / 10000000);
+    }
+    // 航向：度 -> 0.01度
+    if (parse_fixed(f->field[8], 2, &value) && value >= 0) {
+        g_gps_data.course = (uint16_t)value;
     }
+    // 日期：ddmmyy
+    if (parse_fixed(f->field[9], 0, &value)) {
+        g_gps_data.utc_date = (uint32_t)value;
+    }
+
+    g_gps_data.is_valid = (g_gps_data.status == 'A');
 }
-void GPS_Parse_NMEA(const char* nmea_data)
+
+/**
+ * @brief  解析一条NMEA语句（原地单遍扫描，无拷贝、无strtok/strstr）
+ * @param  nmea_data: 以'$'开头、'\0'结尾的语句（可带\r\n）
+ * @retval 1=本条语句给出有效定位，0=无效或不关心的语句
+ */
+FAST_CODE uint8_t GPS_Parse_NMEA(const char* nmea_data)
 {
+    NMEA_Fields_t fields;
+
     g_gps_data.is_valid = 0;
 
-    if (nmea_data == NULL || strlen(nmea_data) < 7 || nmea_data[0] != '$') {
-        return;
+    if (!NMEA_Scan(nmea_data, &fields)) {
+        g_parse_errors++;
+        return 0;
     }
 
-    if (!GPS_Check_Checksum(nmea_data)) {
-        return;
-    }
+    const char* id = fields.field[0];
+    switch (NMEA_ID(id[0], id[1], id[2], id[3], id[4])) {
+        case NMEA_ID('G', 'P', 'G', 'G', 'A'):
+        case NMEA_ID('G', 'N', 'G', 'G', 'A'):
+            GPS_Parse_GGA(&fields);
+            break;
 
-    if (strstr(nmea_data, "$GPGGA") || strstr(nmea_data, "$GNGGA")) {
-        GPS_Parse_GGA(nmea_data);
-    }
-    else if (strstr(nmea_data, "$GPRMC") || strstr(nmea_data, "$GNRMC")) {
-        GPS_Parse_RMC(nmea_data);
+        case NMEA_ID('G', 'P', 'R', 'M', 'C'):
+        case NMEA_ID('G', 'N', 'R', 'M', 'C'):
+            GPS_Parse_RMC(&fields);
+            break;
+
+        default:
+            break;
     }
+    return g_gps_data.is_valid;
+}
+
+// 格式或校验错误的语句数
+uint32_t GPS_Parse_Errors(void)
+{
+    return g_parse_errors;
 }
 
 // 获取GPS数据
@@ -164,4 +282,12 @@ void GPS_Get_Data(GPS_Data_t* gps_data)
     if (gps_data != NULL) {
         memcpy(gps_data, &g_gps_data, sizeof(GPS_Data_t));
     }
-}
\ No newline at end of file
+}
+
+// 更新GPS数据（二进制协议解码后写入）
+void GPS_Set_Data(const GPS_Data_t* gps_data)
+{
+    if (gps_data != NULL) {
+        memcpy(&g_gps_data, gps_data, sizeof(GPS_Data_t));
+    }
+}
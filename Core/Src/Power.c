@@ -0,0 +1,378 @@
+/**
+ * @file       Power.c
+ * @brief      功耗管理（无节拍空闲睡眠 + 运行时切换性能/节能时钟档）
+ * @author     ottohesl
+ * @date       26-1-23
+ * @version    V1.0
+ * @note       1. 空闲：FreeRTOS无节拍空闲（configUSE_TICKLESS_IDLE），预计空闲≥2个节拍时停SysTick，
+ *                CPU以WFI进入Sleep（CSleep），DMA、串口、定时器照常运行，任一中断唤醒
+ *             2. 不进Stop：DMA1与各串口在D2域，Stop下随CPU一起停止，SBUS/JY901S/GPS的连续数据流会丢；
+ *                睡眠期间挂起HAL时基TIM23中断（否则每1ms唤醒一次），唤醒后按TIM23计数补上uwTick，相位不变
+ *             3. DWT在睡眠期间不计数，唤醒后按TimeBase测得的睡眠时长补到timebase_sleep_cycles，
+ *                运行时统计、调度事件、输入延迟等跨睡眠的周期差用TIMEBASE_CYCLES()保持连续
+ *             4. 时钟档：性能550MHz（VOS0），节能160MHz（VOS3）。两档AHB/APB分频相同，定时器时钟=HCLK
+ *                （275MHz/80MHz，均为整MHz），换档后按比例重设各定时器预分频，PWM计数频率不变；
+ *                串口内核时钟为HSI（64MHz），波特率与档位无关
+ *             5. 换档在黑匣子后台任务中执行：等舵机PWM脉冲结束后挂起调度器，SYSCLK临时切到HSI、重配PLL1、
+ *                切回，再重设定时器、TimeBase与SysTick；调度器挂起约百微秒，期间中断照常响应
+ *             6. 功耗测量：遥测POWER消息给出睡眠占比与唤醒次数，CPU消息中的空闲任务占用即CPU余量；
+ *                Tools/powerbench.py依次切换档位/睡眠开关，记录电源电流，输出电流与余量对照表
+ */
+#include "Power.h"
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include "tim.h"
+#include "TimeBase.h"
+#include "MEM_Cache.h"
+
+/************************ 宏定义 ************************/
+#define POWER_PLLM            4U              // PLL1输入分频：HSI 64MHz/4 = 16MHz（两档相同）
+#define POWER_TICK_PERIOD_US  1000U           // HAL时基TIM23周期（1MHz计数，1ms）
+
+/************************ 私有类型 ************************/
+// 时钟档参数
+typedef struct {
+    uint32_t voltage;                   // 内核电压档PWR_REGULATOR_VOLTAGE_SCALEx
+    uint32_t plln;                      // PLL1倍频（VCO = 16MHz × (N + FRACN/8192)）
+    uint32_t pllfracn;                  // PLL1小数倍频
+    uint32_t pllp;                      // SYSCLK分频
+    uint32_t pllqr;                     // Q/R分频（未使用，但HAL会打开输出，需在该电压档的上限内）
+    uint32_t latency;                   // Flash等待周期
+    uint8_t vos;                        // 电压档编号（遥测）
+} Power_Clock_t;
+
+/************************ 全局变量 ************************/
+Power_Stats_t power_stats;                      // 功耗统计
+
+/************************ 私有变量 ************************/
+static const Power_Clock_t power_clocks[POWER_PROFILE_COUNT] = {
+    // 16MHz×34.375 = 550MHz，/1：CPU 550MHz，HCLK 275MHz，APB 137.5MHz，定时器275MHz（与CubeMX配置一致）
+    [POWER_PROFILE_PERFORMANCE] = {PWR_REGULATOR_VOLTAGE_SCALE0, 34U, 3072U, 1U, 2U, FLASH_LATENCY_3, 0U},
+    // 16MHz×40 = 640MHz，/4：CPU 160MHz，HCLK 80MHz，APB 40MHz，定时器80MHz（VOS3上限170/85/42.5MHz），
+    // Flash等待按VOS2的表取，留有余量
+    [POWER_PROFILE_ECONOMY]     = {PWR_REGULATOR_VOLTAGE_SCALE3, 40U, 0U,    4U, 4U, FLASH_LATENCY_2, 3U},
+};
+
+// 换档时需要保持计数频率的PWM定时器（未启动的跳过）
+static TIM_HandleTypeDef *const power_pwm_timers[] = {&htim2, &htim3, &htim4};
+
+static Power_Profile_t power_profile = POWER_PROFILE_PERFORMANCE;
+static volatile Power_Profile_t power_request = POWER_PROFILE_PERFORMANCE;
+static volatile bool power_switch_pending = false;  // 换档请求已提交、后台任务还未执行
+static volatile bool power_sleep_enable = true;     // 空闲时进入睡眠
+static bool power_sleeping = false;                 // 本次空闲执行了WFI（前后处理之间）
+static uint64_t power_sleep_start_us;               // 本次睡眠开始的时基微秒
+static uint32_t power_sleep_start_cycles;           // 本次睡眠开始的DWT计数
+static uint32_t power_tick_phase;                   // 本次睡眠开始时TIM23计数（1ms周期内的相位）
+static uint32_t power_window_sleeps;                // 最近一个统计窗口的睡眠次数
+static uint16_t power_window_sleep;                 // 最近一个统计窗口的睡眠占比，0.01%
+
+extern TIM_HandleTypeDef htim23;
+// FreeRTOS移植层（port.c）：按当前configCPU_CLOCK_HZ重设SysTick与无节拍空闲的换算常数
+extern void vPortSetupTimerInterrupt(void);
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  APB1定时器时钟（APB1分频不为1时为PCLK1的2倍，两档APB1均为/2）
+ */
+static uint32_t Power_Timer_Clock(void) {
+    return HAL_RCC_GetPCLK1Freq() * 2U;
+}
+
+/**
+ * @brief  各PWM定时器是否都处在脉冲结束之后、周期结束之前的空档中
+ * @note   脉冲宽度取已使能通道中最大的比较值，两侧各留POWER_PWM_MARGIN_US
+ */
+static bool Power_PWM_In_Gap(void) {
+    uint32_t timer_hz = Power_Timer_Clock();
+    for (uint32_t i = 0; i < sizeof(power_pwm_timers) / sizeof(power_pwm_timers[0]); i++) {
+        TIM_TypeDef *tim = power_pwm_timers[i]->Instance;
+        if ((tim->CR1 & TIM_CR1_CEN) == 0U) {
+            continue;
+        }
+        uint32_t tick_hz = timer_hz / (tim->PSC + 1U);
+        uint32_t margin = (uint32_t)((uint64_t)tick_hz * POWER_PWM_MARGIN_US / 1000000U);
+        uint32_t pulse = 0;
+        if ((tim->CCER & TIM_CCER_CC1E) != 0U && tim->CCR1 > pulse) pulse = tim->CCR1;
+        if ((tim->CCER & TIM_CCER_CC2E) != 0U && tim->CCR2 > pulse) pulse = tim->CCR2;
+        if ((tim->CCER & TIM_CCER_CC3E) != 0U && tim->CCR3 > pulse) pulse = tim->CCR3;
+        if ((tim->CCER & TIM_CCER_CC4E) != 0U && tim->CCR4 > pulse) pulse = tim->CCR4;
+        uint32_t cnt = tim->CNT;
+        if (cnt < pulse + margin || cnt + margin > tim->ARR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief  等待PWM空档并挂起调度器
+ * @retval true=在空档中，false=等待超时（同样已挂起调度器）
+ * @note   判断与换档之间不能被抢占，判断前先挂起调度器，不在空档则恢复后延时1ms再试
+ */
+static bool Power_Wait_PWM_Gap(void) {
+    for (int i = 0; i < POWER_PWM_WAIT_MS; i++) {
+        vTaskSuspendAll();
+        if (Power_PWM_In_Gap()) {
+            return true;
+        }
+        (void)xTaskResumeAll();
+        osDelay(1);
+    }
+    vTaskSuspendAll();
+    return false;
+}
+
+/**
+ * @brief  设置内核电压并等待稳定
+ */
+static void Power_Set_Voltage(uint32_t voltage) {
+    __HAL_PWR_VOLTAGESCALING_CONFIG(voltage);
+    while (!__HAL_PWR_GET_FLAG(PWR_FLAG_VOSRDY)) {}
+}
+
+/**
+ * @brief  切换系统时钟
+ * @param  to: 目标时钟档
+ * @retval true=成功
+ * @note   1. PLL1只能在不作系统时钟时重配：先切到HSI（AHB/APB分频不变），重配PLL1后切回
+ *         2. 升频先升电压，降频后再降电压；Flash等待周期由HAL_RCC_ClockConfig按升降频顺序调整
+ *         3. HAL_RCC_ClockConfig内会按新时钟重新初始化HAL时基TIM23（HAL_InitTick）
+ */
+static bool Power_Switch_Clock(const Power_Clock_t *to, bool raise) {
+    RCC_ClkInitTypeDef clk;
+    RCC_OscInitTypeDef osc = {0};
+    uint32_t latency;
+
+    if (raise) {
+        Power_Set_Voltage(to->voltage);
+    }
+    HAL_RCC_GetClockConfig(&clk, &latency);
+    clk.ClockType = RCC_CLOCKTYPE_SYSCLK;
+    clk.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+    if (HAL_RCC_ClockConfig(&clk, latency) != HAL_OK) {
+        return false;
+    }
+
+    osc.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+    osc.PLL.PLLState = RCC_PLL_ON;
+    osc.PLL.PLLSource = RCC_PLLSOURCE_HSI;
+    osc.PLL.PLLM = POWER_PLLM;
+    osc.PLL.PLLN = to->plln;
+    osc.PLL.PLLP = to->pllp;
+    osc.PLL.PLLQ = to->pllqr;
+    osc.PLL.PLLR = to->pllqr;
+    osc.PLL.PLLRGE = RCC_PLL1VCIRANGE_3;
+    osc.PLL.PLLVCOSEL = RCC_PLL1VCOWIDE;
+    osc.PLL.PLLFRACN = to->pllfracn;
+    if (HAL_RCC_OscConfig(&osc) != HAL_OK) {
+        return false;
+    }
+
+    clk.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+    if (HAL_RCC_ClockConfig(&clk, to->latency) != HAL_OK) {
+        return false;
+    }
+    if (!raise) {
+        Power_Set_Voltage(to->voltage);
+    }
+    return true;
+}
+
+/**
+ * @brief  换档后重设定时器预分频（关中断调用）
+ * @param  old_hz: 换档前的定时器时钟
+ * @param  new_hz: 换档后的定时器时钟
+ * @note   1. 按原计数频率换算新预分频；PWM定时器在空档中软件更新立即装载，新周期从头开始（本帧缩短，脉宽不变）
+ *         2. TimeBase保留当前计数，HAL时基已由HAL_InitTick重设
+ */
+static void Power_Rescale_Timers(uint32_t old_hz, uint32_t new_hz) {
+    for (uint32_t i = 0; i < sizeof(power_pwm_timers) / sizeof(power_pwm_timers[0]); i++) {
+        TIM_HandleTypeDef *htim = power_pwm_timers[i];
+        uint32_t tick_hz = old_hz / (htim->Instance->PSC + 1U);
+        uint32_t psc = new_hz / tick_hz - 1U;
+        htim->Init.Prescaler = psc;
+        htim->Instance->PSC = psc;
+        if ((htim->Instance->CR1 & TIM_CR1_CEN) != 0U) {
+            htim->Instance->EGR = TIM_EGR_UG;
+        }
+    }
+    TimeBase_Clock_Changed(new_hz);
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  功耗管理初始化
+ * @retval 无
+ * @note   空闲睡眠用Sleep（SLEEPDEEP=0），不进Stop
+ */
+void Power_Init(void) {
+    memset(&power_stats, 0, sizeof(power_stats));
+    power_profile = POWER_PROFILE_PERFORMANCE;
+    power_sleep_enable = true;
+    CLEAR_BIT(SCB->SCR, SCB_SCR_SLEEPDEEP_Msk);
+}
+
+/**
+ * @brief  请求换档
+ * @param  profile: 目标时钟档
+ * @retval true=已登记（或已是该档），false=参数越界/上一个请求未完成
+ */
+bool Power_Request_Profile(Power_Profile_t profile) {
+    if ((unsigned)profile >= POWER_PROFILE_COUNT || power_switch_pending) {
+        return false;
+    }
+    if (profile == power_profile) {
+        return true;
+    }
+    power_request = profile;
+    power_switch_pending = true;
+    osThreadFlagsSet(BlackBox_TaskHandle, POWER_FLAG_SWITCH);
+    return true;
+}
+
+/**
+ * @brief  空闲睡眠开关
+ * @param  enable: true=空闲时进入睡眠
+ */
+void Power_Set_Sleep(bool enable) {
+    power_sleep_enable = enable;
+}
+
+/**
+ * @brief  当前时钟档
+ */
+Power_Profile_t Power_Get_Profile(void) {
+    return power_profile;
+}
+
+/**
+ * @brief  后台任务处理：执行换档请求
+ * @retval 无
+ * @note   1. 调度器挂起期间中断照常响应（HAL的RCC超时依赖HAL时基中断），只阻止其他任务在时钟切换中途运行
+ *         2. 换档失败时停在实际生效的时钟上，定时器与时基仍按实际时钟重设，档位不变
+ */
+void Power_Service(void) {
+    if (!power_switch_pending) {
+        return;
+    }
+    Power_Profile_t profile = power_request;
+    const Power_Clock_t *to = &power_clocks[profile];
+    bool raise = (profile == POWER_PROFILE_PERFORMANCE);
+
+    if (!Power_Wait_PWM_Gap()) {
+        power_stats.pwm_wait_timeouts++;
+    }
+    uint64_t t0 = TimeBase_Now_us();
+    uint32_t old_hz = Power_Timer_Clock();
+    bool ok = Power_Switch_Clock(to, raise);
+    __disable_irq();
+    Power_Rescale_Timers(old_hz, Power_Timer_Clock());
+    vPortSetupTimerInterrupt();
+    __enable_irq();
+    power_stats.switch_us = (uint32_t)(TimeBase_Now_us() - t0);
+    (void)xTaskResumeAll();
+
+    if (ok) {
+        power_profile = profile;
+        power_stats.switches++;
+    } else {
+        power_stats.switch_errors++;
+    }
+    power_switch_pending = false;
+}
+
+/**
+ * @brief  进入睡眠前处理（移植层vPortSuppressTicksAndSleep中，关中断、SysTick已按空闲时长重装）
+ * @param  idle_ticks: 预计空闲节拍数，置0则不执行WFI
+ * @retval 无
+ */
+FAST_CODE void Power_Pre_Sleep(uint32_t *idle_ticks) {
+    if (!power_sleep_enable) {
+        *idle_ticks = 0U;
+        return;
+    }
+    power_sleeping = true;
+    HAL_SuspendTick();
+    // 挂起前已到期的HAL时基中断在这里直接计入，唤醒后的补偿只算睡眠期间的
+    if (__HAL_TIM_GET_FLAG(&htim23, TIM_FLAG_UPDATE) != RESET) {
+        __HAL_TIM_CLEAR_FLAG(&htim23, TIM_FLAG_UPDATE);
+        HAL_IncTick();
+    }
+    power_tick_phase = __HAL_TIM_GET_COUNTER(&htim23);
+    power_sleep_start_cycles = DWT->CYCCNT;
+    power_sleep_start_us = TimeBase_Now_us();
+}
+
+/**
+ * @brief  唤醒后处理（仍在关中断中，唤醒源中断在之后执行）
+ * @param  idle_ticks: 预计空闲节拍数（未使用）
+ * @retval 无
+ * @note   1. DWT补偿只补差值：调试器开启DBGSLEEP时DWT在睡眠中照常计数，不重复补
+ *         2. HAL时基：睡眠期间TIM23计数照常，到期次数 = (起始相位 + 睡眠时长) / 1ms，清标志后一次补上
+ */
+FAST_CODE void Power_Post_Sleep(uint32_t idle_ticks) {
+    (void)idle_ticks;
+    if (!power_sleeping) {
+        return;
+    }
+    power_sleeping = false;
+    uint32_t slept_us = (uint32_t)(TimeBase_Now_us() - power_sleep_start_us);
+    uint32_t counted = DWT->CYCCNT - power_sleep_start_cycles;
+    uint32_t expected = TimeBase_us_To_Cycles(slept_us);
+    if (expected > counted) {
+        timebase_sleep_cycles += expected - counted;
+    }
+
+    uint32_t missed = (power_tick_phase + slept_us) / POWER_TICK_PERIOD_US;
+    if (missed > 0U) {
+        __HAL_TIM_CLEAR_FLAG(&htim23, TIM_FLAG_UPDATE);
+        uwTick += missed * (uint32_t)uwTickFreq;
+    }
+    HAL_ResumeTick();
+
+    power_stats.sleeps++;
+    power_stats.sleep_us += slept_us;
+}
+
+/**
+ * @brief  统计窗口结束：计算本窗口的睡眠次数与占比
+ * @note   1. 与RT_Stats_Sample在同一定时器回调中调用，遥测与黑匣子读同一份结果
+ *         2. 睡眠统计在空闲任务的关中断段中更新，定时器服务任务读取时不会被其打断，不需要加锁
+ */
+void Power_Sample(void) {
+    static uint64_t last_us = 0, last_sleep_us = 0;
+    static uint32_t last_sleeps = 0;
+    uint64_t now_us = TimeBase_Now_us();
+    uint64_t window = now_us - last_us;
+    uint64_t slept = power_stats.sleep_us - last_sleep_us;
+    uint32_t sleeps = power_stats.sleeps;
+
+    vTaskSuspendAll();
+    power_window_sleeps = sleeps - last_sleeps;
+    power_window_sleep = (window != 0U) ? (uint16_t)(slept * 10000U / window) : 0U;
+    (void)xTaskResumeAll();
+    last_us = now_us;
+    last_sleep_us += slept;
+    last_sleeps = sleeps;
+}
+
+/**
+ * @brief  填写遥测POWER消息
+ * @param  msg: 输出
+ */
+void Power_Get_Message(TLM_Power_t *msg) {
+    msg->cpu_hz = SystemCoreClock;
+    vTaskSuspendAll();
+    msg->sleeps = power_window_sleeps;
+    msg->sleep = power_window_sleep;
+    (void)xTaskResumeAll();
+    msg->switch_us = (uint16_t)(power_stats.switch_us > 0xFFFFU ? 0xFFFFU : power_stats.switch_us);
+    msg->switches = (uint16_t)power_stats.switches;
+    msg->profile = (uint8_t)power_profile;
+    msg->sleep_enable = power_sleep_enable ? 1U : 0U;
+    msg->vos = power_clocks[power_profile].vos;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file       RT_Stats.c
+ * @brief      运行时统计服务（各任务CPU占用、栈剩余、各中断耗时）
+ * @author     ottohesl
+ * @date       26-1-21
+ * @version    V1.0
+ * @note       1. FreeRTOS运行时统计时钟为DWT周期计数器（configGENERATE_RUN_TIME_STATS，TimeBase_Init中开启），
+ *                任务切换时直接读寄存器，不另占定时器；32位计数约7.8s回绕，跨回绕的那一段运行时间被内核丢弃，误差可忽略
+ *             2. 每个窗口（RT_STATS_PERIOD_MS）由软件定时器回调在定时器服务任务中采样一次：
+ *                uxTaskGetSystemState取各任务累计运行周期与栈剩余，与上一窗口相减得到占用
+ *             3. 中断耗时由各中断入口的RT_ISR_ENTER/RT_ISR_EXIT累加，只增不清，采样时同样相减
+ *             4. 结果经遥测CPU消息（二进制）上报；上行命令TOP请求后在下一窗口结束时打印top文本
+ *             5. 采样本身的耗时（主要是按填充字节扫描各任务栈）记在stats_cycles中，约几十微秒/秒，远小于1%
+ *             6. 任务切换次数与平均耗时（os_switch_stats只增不清）同样按窗口相减；遥测task消息与黑匣子都读这份结果，
+ *                不各自保存上次采样值（否则同一节拍先后采样的一方总是得到空窗口）
+ */
+#include "RT_Stats.h"
+#include <stdarg.h>
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "cmsis_os.h"
+#include "UART_TX.h"
+#include "FMT.h"
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+#include "Executive.h"
+
+/************************ 宏定义 ************************/
+#define RT_STATUS_MAX  (RT_TASK_MAX + 3)    // uxTaskGetSystemState数组长度（留出以后新增任务的余量）
+#define RT_LOAD_FULL   10000U               // 100.00%
+
+/************************ 全局变量 ************************/
+RT_ISR_Acc_t rt_isr_acc[RT_ISR_COUNT] FAST_DATA;    // 各中断累计量（中断中写）
+volatile uint32_t rt_isr_nested FAST_DATA;          // 当前中断内嵌套中断已用周期（RT_ISR_*宏使用）
+
+/************************ 私有变量 ************************/
+static TaskStatus_t rt_status[RT_STATUS_MAX];       // 任务状态快照（定时器服务任务栈较小，不放在栈上）
+static uint32_t rt_last_run[RT_TASK_MAX];           // 上一窗口各任务累计运行周期
+static uint32_t rt_last_total = 0;                  // 上一窗口结束时的运行时统计时钟
+static uint32_t rt_last_isr_cycles[RT_ISR_COUNT];   // 上一窗口各中断累计周期
+static uint32_t rt_last_isr_count[RT_ISR_COUNT];    // 上一窗口各中断累计次数
+static uint32_t rt_last_switches = 0;               // 上一窗口结束时的任务切换累计次数
+static uint32_t rt_last_switch_cycles = 0;          // 上一窗口结束时的任务切换累计周期
+static uint64_t rt_last_us = 0;                     // 上一窗口结束时的时基微秒
+static RT_Report_t rt_report;                       // 最近一个窗口的结果
+static volatile bool rt_top_request = false;        // top文本打印请求
+
+static const char *const rt_isr_names[RT_ISR_COUNT] = {
+    [RT_ISR_DMA1_S0] = "DMA1_S0 imu_rx",
+    [RT_ISR_DMA1_S1] = "DMA1_S1 dbg_tx",
+    [RT_ISR_DMA1_S2] = "DMA1_S2 gps_rx",
+    [RT_ISR_DMA1_S3] = "DMA1_S3 dbg_rx",
+    [RT_ISR_DMA1_S4] = "DMA1_S4 rc_rx",
+    [RT_ISR_USART1]  = "USART1 rc",
+    [RT_ISR_USART2]  = "USART2 imu",
+    [RT_ISR_USART3]  = "USART3",
+    [RT_ISR_USART6]  = "USART6",
+    [RT_ISR_TIM23]   = "TIM23 hal_tick",
+};
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  周期数换算为占用（0.01%，饱和到100%）
+ */
+static uint16_t RT_Load(uint32_t cycles, uint32_t window) {
+    if (window == 0U) {
+        return 0;
+    }
+    uint64_t load = (uint64_t)cycles * RT_LOAD_FULL / window;
+    return (uint16_t)(load > RT_LOAD_FULL ? RT_LOAD_FULL : load);
+}
+
+/**
+ * @brief  统计槽位对应的任务句柄（顺序与遥测CPU消息一致）
+ */
+static void RT_Task_Handles(TaskHandle_t handles[RT_TASK_MAX]) {
+#if EXEC_ENABLE
+    // 执行器布局：传感器句柄指向Control，其工作计入Control，各作业耗时见top文本末尾
+    handles[0] = NULL;
+    handles[1] = NULL;
+    handles[2] = NULL;
+#else
+    handles[0] = (TaskHandle_t)SBUS_TaskHandle;
+    handles[1] = (TaskHandle_t)GPS_TaskHandle;
+    handles[2] = (TaskHandle_t)JY901S_TaskHandle;
+#endif
+    handles[3] = (TaskHandle_t)ControlHandle;
+    handles[4] = (TaskHandle_t)BlackBox_TaskHandle;
+    handles[5] = xTimerGetTimerDaemonTaskHandle();
+    handles[6] = xTaskGetIdleTaskHandle();
+}
+
+/**
+ * @brief  写一行top文本到调试串口
+ */
+static void RT_Top_Line(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void RT_Top_Line(const char *fmt, ...) {
+    char line[RT_TOP_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int len = FMT_Vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len > (int)sizeof(line) - 1) {
+        len = (int)sizeof(line) - 1;
+    }
+    if (len > 0) {
+        UART_TX_Write(line, (uint32_t)len);
+    }
+}
+
+/**
+ * @brief  打印top文本
+ * @note   1. 每行单独写入发送缓冲区，与遥测帧之间有0x00分隔，上位机按文本处理
+ *         2. 状态：X=运行 R=就绪 B=阻塞 S=挂起 D=已删除
+ */
+static void RT_Print_Top(const RT_Report_t *r) {
+    static const char states[] = "XRBSD";
+    uint32_t task_sum = 0, isr_sum = 0;
+
+    RT_Top_Line("\r\ntop - %lu ms, window %lu cycles, stats %lu cycles\r\n",
+                (unsigned long)osKernelGetTickCount(), (unsigned long)r->window_cycles,
+                (unsigned long)r->stats_cycles);
+    RT_Top_Line("  %-16s %3s %s %7s %6s\r\n", "TASK", "PRI", "S", "CPU%", "STACK");
+    for (int i = 0; i < RT_TASK_MAX; i++) {
+        const RT_Task_Stats_t *t = &r->task[i];
+        if (t->name == NULL) {
+            continue;
+        }
+        task_sum += t->load;
+        RT_Top_Line("  %-16s %3u %c %3u.%02u%% %6u\r\n", t->name, t->priority,
+                    states[t->state < 5 ? t->state : 4], t->load / 100U, t->load % 100U, t->stack_free);
+    }
+    RT_Top_Line("  %-16s %5s %7s %6s\r\n", "ISR", "", "CPU%", "COUNT");
+    for (int i = 0; i < RT_ISR_COUNT; i++) {
+        isr_sum += r->isr_load[i];
+        RT_Top_Line("  %-16s %5s %3u.%02u%% %6lu\r\n", rt_isr_names[i], "",
+                    r->isr_load[i] / 100U, r->isr_load[i] % 100U, (unsigned long)r->isr_count[i]);
+    }
+    RT_Top_Line("  tasks %lu.%02lu%% (incl. isr %lu.%02lu%%)\r\n",
+                (unsigned long)(task_sum / 100U), (unsigned long)(task_sum % 100U),
+                (unsigned long)(isr_sum / 100U), (unsigned long)(isr_sum % 100U));
+#if EXEC_ENABLE
+    // 执行器作业（在Control任务中运行，占用已计入Control）：运行次数、单次最大耗时、释放后最大等待、错过释放次数
+    const Exec_Job_t *jobs;
+    uint32_t n = Exec_Get_Jobs(&jobs);
+    RT_Top_Line("  %-16s %3s %8s %7s %7s %6s\r\n", "JOB", "PRI", "RUNS", "MAX_US", "WAIT_US", "MISSED");
+    for (uint32_t i = 0; i < n; i++) {
+        const Exec_Job_Stats_t *st = &exec_stats[i];
+        RT_Top_Line("  %-16s %3u %8lu %7lu %7lu %6lu\r\n", jobs[i].name, jobs[i].priority,
+                    (unsigned long)st->runs, (unsigned long)TimeBase_Cycles_To_us(st->cycles_max),
+                    (unsigned long)st->wait_us_max, (unsigned long)st->overruns);
+    }
+#endif
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  统计采样（每RT_STATS_PERIOD_MS一次）
+ * @retval 无
+ * @note   1. 在定时器服务任务中调用，uxTaskGetSystemState期间挂起调度器，不关中断
+ *         2. 窗口长度取内核返回的运行时统计时钟之差，定时器被推迟时占用仍按实际窗口计算
+ */
+void RT_Stats_Sample(void) {
+    uint32_t start = DWT->CYCCNT;
+    TaskHandle_t handles[RT_TASK_MAX];
+    uint32_t total = 0;
+    RT_Report_t r;
+
+    memset(&r, 0, sizeof(r));
+    RT_Task_Handles(handles);
+    UBaseType_t n = uxTaskGetSystemState(rt_status, RT_STATUS_MAX, &total);
+    r.window_cycles = total - rt_last_total;
+    rt_last_total = total;
+
+    for (int i = 0; i < RT_TASK_MAX; i++) {
+        for (UBaseType_t k = 0; k < n; k++) {
+            const TaskStatus_t *s = &rt_status[k];
+            if (handles[i] == NULL || s->xHandle != handles[i]) {
+                continue;
+            }
+            r.task[i].name = s->pcTaskName;
+            r.task[i].load = RT_Load(s->ulRunTimeCounter - rt_last_run[i], r.window_cycles);
+            r.task[i].stack_free = (uint16_t)(s->usStackHighWaterMark * sizeof(StackType_t));
+            r.task[i].priority = (uint8_t)s->uxCurrentPriority;
+            r.task[i].state = (uint8_t)s->eCurrentState;
+            rt_last_run[i] = s->ulRunTimeCounter;
+            break;
+        }
+    }
+
+    for (int i = 0; i < RT_ISR_COUNT; i++) {
+        uint32_t cycles = rt_isr_acc[i].cycles;
+        uint32_t count = rt_isr_acc[i].count;
+        r.isr_load[i] = RT_Load(cycles - rt_last_isr_cycles[i], r.window_cycles);
+        r.isr_count[i] = count - rt_last_isr_count[i];
+        rt_last_isr_cycles[i] = cycles;
+        rt_last_isr_count[i] = count;
+    }
+
+    uint32_t switches = os_switch_stats.count;
+    uint32_t switch_cycles = os_switch_stats.cycles_sum;
+    uint64_t now_us = TimeBase_Now_us();
+    r.window_us = (uint32_t)(now_us - rt_last_us);
+    r.switches = switches - rt_last_switches;
+    r.switch_cycles_avg = (r.switches != 0U) ? (switch_cycles - rt_last_switch_cycles) / r.switches : 0U;
+    rt_last_switches = switches;
+    rt_last_switch_cycles = switch_cycles;
+    rt_last_us = now_us;
+
+    r.samples = rt_report.samples + 1U;
+    r.stats_cycles = DWT->CYCCNT - start;
+    // 控制任务中的遥测采样可能同时读取，整体替换时挂起调度器
+    vTaskSuspendAll();
+    rt_report = r;
+    (void)xTaskResumeAll();
+
+    if (rt_top_request) {
+        rt_top_request = false;
+        RT_Print_Top(&r);
+    }
+}
+
+/**
+ * @brief  请求打印top文本
+ * @retval true=已登记，false=上一个请求还未处理
+ */
+bool RT_Stats_Request_Top(void) {
+    if (rt_top_request) {
+        return false;
+    }
+    rt_top_request = true;
+    return true;
+}
+
+/**
+ * @brief  读取最近一个窗口的结果
+ * @param  report: 输出
+ */
+void RT_Stats_Get(RT_Report_t *report) {
+    vTaskSuspendAll();
+    *report = rt_report;
+    (void)xTaskResumeAll();
+}
+
+/**
+ * @brief  填写遥测CPU消息
+ * @param  msg: 输出
+ */
+void RT_Stats_Get_Message(TLM_CPU_t *msg) {
+    RT_Report_t r;
+    RT_Stats_Get(&r);
+    for (int i = 0; i < RT_TASK_MAX; i++) {
+        msg->task_load[i] = r.task[i].load;
+        msg->task_stack[i] = r.task[i].stack_free;
+    }
+    for (int i = 0; i < RT_ISR_COUNT; i++) {
+        msg->isr_load[i] = r.isr_load[i];
+    }
+    msg->stats_cycles = r.stats_cycles;
+}
+
+/**
+ * @brief  中断名称
+ * @param  id: 中断编号
+ * @retval 名称，编号越界返回"?"
+ */
+const char *RT_ISR_Name(RT_ISR_Id_t id) {
+    return ((unsigned)id < RT_ISR_COUNT) ? rt_isr_names[id] : "?";
+}
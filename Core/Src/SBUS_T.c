@@ -1,18 +1,19 @@
 #include "../Inc/SBUS_T.h"
+#include "../Inc/MEM_Cache.h"
+#include "../Inc/TimeBase.h"
+#include "../Inc/Capture.h"
 
 /************************ 全局变量 ************************/
 UART_HandleTypeDef *sbus_huart;          // SBUS串口句柄
 UART_HandleTypeDef *sbus_debug_huart;    // 调试串口句柄
 SBUS_Data_t sbus_data;                   // SBUS核心数据
+SBUS_Stats_t sbus_stats;                 // SBUS接收统计
 uint8_t sbus_speed = 0;                  // 映射后的速度值
+volatile uint32_t sbus_rx_stamp;         // 最近一次接收事件中断的TIMEBASE_CYCLES()（控制任务统计输入延迟）
 
 /************************ DMA接收缓冲区 ************************/
-// STM32H7需迁址到DMA可访问区域（0x24000000开始）
-#if SBUS_H_Vision==7
-uint8_t SBUS_RX[SBUS_DMA_RX_SIZE] __attribute__((section(".ram")));
-#else
-uint8_t SBUS_RX[SBUS_DMA_RX_SIZE];
-#endif
+// STM32H7放入RAM_D2不可缓存区（DMA_BUFFER，见MEM_Cache.h），DMA与CPU无需缓存维护
+uint8_t SBUS_RX[SBUS_DMA_RX_SIZE] DMA_BUFFER;
 
 /************************ 帧解析静态变量（状态机） ************************/
 static uint32_t dma_last_index = 0;      // 上一次解析的DMA索引
@@ -20,6 +21,8 @@ static uint8_t frame_buf[SBUS_PACKET_LENGTH]; // 单帧临时缓冲区
 static uint8_t frame_pos = 0;            // 当前帧接收位置
 static uint32_t frame_timeout = 0;       // 帧解析超时计数器
 static SBUS_FrameState frame_state = SBUS_SEEK_START; // 解析状态机
+static volatile uint32_t rx_epoch = 0;   // 接收重启次数（错误回调递增）
+static uint32_t rd_epoch = 0;            // 解析侧已同步的重启次数
 
 /************************ 私有函数实现 ************************/
 /**
@@ -41,9 +44,10 @@ static int mapValue(int value) {
  * @brief  SBUS帧解码（原有逻辑保留）
  * @param  packet: 25字节完整SBUS帧
  */
-static void SBUS_DecodePacket(uint8_t *packet) {
+FAST_CODE static void SBUS_DecodePacket(uint8_t *packet) {
     // 帧头/帧尾校验
     if (packet[0] != SBUS_STARTBYTE || packet[24] != SBUS_ENDBYTE) {
+        sbus_stats.format_errors++;
 #if SBUS_DEBUG_MODE
         ottohesl_uart(sbus_debug_huart, "SBUS帧格式错误\r\n");
 #endif
@@ -74,8 +78,9 @@ static void SBUS_DecodePacket(uint8_t *packet) {
     sbus_data.frame_lost = (sbus_data.flags & 0x20) ? 1 : 0;// bit5：丢帧标志
 
     // 更新状态
+    sbus_stats.frames++;
     sbus_data.new_data_available = 1;
-    sbus_data.last_update_time = HAL_GetTick();
+    sbus_data.last_update_us = TimeBase_From_Cycles(sbus_rx_stamp);
 }
 
 /**
@@ -109,13 +114,30 @@ static SBUS_Command_t SBUS_GetCommand(void) {
 
 /**
  * @brief  执行SBUS命令（原有逻辑保留）
+ * @note   1. 命令提交给指令仲裁器，由控制任务统一执行
+ *         2. 每帧都提交一次（仲裁器按请求时间判断过期），调试打印只在命令变化时输出，避免每帧占用调试串口
  */
 static void SBUS_ExecuteCommand(void) {
+#if SBUS_DEBUG_MODE
+    static int debug_last = -1;     // 上次打印的命令（-1=无，0=失联，SBUS_Command_t不取0）
+#endif
     // 失联保护
     if (sbus_data.failsafe) {
-        Fish_ExecuteCommand(CMD_STOP);
+        CMD_Release(CMD_SRC_SBUS);
+#if SBUS_DEBUG_MODE
+        if (debug_last != 0) {
+            ottohesl_uart(sbus_debug_huart, "SBUS失联，执行停止\r\n");
+            debug_last = 0;
+        }
+#endif
+        return;
+    }
+
+    // 自动驾驶模式下摇杆不参与控制，让出控制权给地面站/自动驾驶
+    if (SBUS_Auto_Mode()) {
+        CMD_Release(CMD_SRC_SBUS);
 #if SBUS_DEBUG_MODE
-        ottohesl_uart(sbus_debug_huart, "SBUS失联，执行停止\r\n");
+        debug_last = -1;
 #endif
         return;
     }
@@ -123,40 +145,40 @@ static void SBUS_ExecuteCommand(void) {
     SBUS_Command_t cmd = SBUS_GetCommand();
     switch(cmd) {
         case SBUS_CMD_FORWARD:
-            Fish_ExecuteCommand(CMD_FORWARD);
-#if SBUS_DEBUG_MODE
-            char speed_buf[32];
-            sprintf(speed_buf, "前进，速度：%d\r\n", sbus_speed);
-            ottohesl_uart(sbus_debug_huart, speed_buf);
-#endif
+            CMD_Submit(CMD_SRC_SBUS, CMD_FORWARD);
             break;
         case SBUS_CMD_TURN_LEFT:
-            Fish_ExecuteCommand(CMD_TURN_LEFT);
-#if SBUS_DEBUG_MODE
-            ottohesl_uart(sbus_debug_huart, "左转\r\n");
-#endif
+            CMD_Submit(CMD_SRC_SBUS, CMD_TURN_LEFT);
             break;
         case SBUS_CMD_TURN_RIGHT:
-            Fish_ExecuteCommand(CMD_TURN_RIGHT);
-#if SBUS_DEBUG_MODE
-            ottohesl_uart(sbus_debug_huart, "右转\r\n");
-#endif
+            CMD_Submit(CMD_SRC_SBUS, CMD_TURN_RIGHT);
             break;
         case SBUS_CMD_STOP:
-            Fish_ExecuteCommand(CMD_STOP);
-#if SBUS_DEBUG_MODE
-            ottohesl_uart(sbus_debug_huart, "停止\r\n");
-#endif
+            CMD_Submit(CMD_SRC_SBUS, CMD_STOP);
             break;
     }
+#if SBUS_DEBUG_MODE
+    if ((int)cmd != debug_last) {
+        char buf[32];
+        if (cmd == SBUS_CMD_FORWARD) {
+            FMT_Snprintf(buf, sizeof(buf), "前进，速度：%d\r\n", sbus_speed);
+            ottohesl_uart(sbus_debug_huart, buf);
+        } else {
+            ottohesl_uart(sbus_debug_huart, cmd == SBUS_CMD_TURN_LEFT ? "左转\r\n" :
+                                            cmd == SBUS_CMD_TURN_RIGHT ? "右转\r\n" : "停止\r\n");
+        }
+        debug_last = (int)cmd;
+    }
+#endif
 }
 
 /************************ 公开函数实现 ************************/
 /**
- * @brief  SBUS初始化（启动DMA循环接收）
+ * @brief  SBUS初始化（启动循环DMA+空闲中断接收）
  * @param  h_sbus: SBUS串口句柄
  * @param  h_debug: 调试串口句柄
- * @note   需在CubeMX中开启UART DMA接收（循环模式）
+ * @note   1. 需在CubeMX中开启USART1 RX DMA（循环模式）及USART1全局中断
+ *         2. 每帧之后的空闲及缓冲区半满/满都会进入SBUS_RxEventCallback唤醒SBUS任务
  */
 void SBUS_Init(UART_HandleTypeDef *h_sbus, UART_HandleTypeDef *h_debug) {
     // 初始化句柄
@@ -165,16 +187,17 @@ void SBUS_Init(UART_HandleTypeDef *h_sbus, UART_HandleTypeDef *h_debug) {
     
     // 初始化数据结构体
     memset(&sbus_data, 0, sizeof(SBUS_Data_t));
+    memset(&sbus_stats, 0, sizeof(SBUS_Stats_t));
     
-    // 启动DMA循环接收
-    HAL_StatusTypeDef ret = HAL_UART_Receive_DMA(sbus_huart, SBUS_RX, SBUS_DMA_RX_SIZE);
+    // 启动DMA循环接收（空闲中断）
+    HAL_StatusTypeDef ret = HAL_UARTEx_ReceiveToIdle_DMA(sbus_huart, SBUS_RX, SBUS_DMA_RX_SIZE);
     
     // 调试信息
 #if SBUS_DEBUG_MODE
     if (ret != HAL_OK) {
         ottohesl_uart(sbus_debug_huart, "SBUS DMA初始化失败\r\n");
-    } else if (sbus_huart->hdmarx->State != HAL_DMA_STATE_READY) {
-        ottohesl_uart(sbus_debug_huart, "SBUS DMA未就绪\r\n");
+    } else if (sbus_huart->hdmarx == NULL || sbus_huart->hdmarx->Init.Mode != DMA_CIRCULAR) {
+        ottohesl_uart(sbus_debug_huart, "SBUS DMA未配置为循环模式\r\n");
     } else {
         ottohesl_uart(sbus_debug_huart, "SBUS DMA初始化成功\r\n");
     }
@@ -182,17 +205,75 @@ void SBUS_Init(UART_HandleTypeDef *h_sbus, UART_HandleTypeDef *h_debug) {
 }
 
 /**
- * @brief  SBUS数据处理（核心函数，需在主循环调用）
+ * @brief  USART1接收事件回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @param  Size: DMA缓冲区中当前写入位置（解析时直接读DMA计数，这里只用于原始数据采集）
+ * @note   只记录时间并通知SBUS任务，耗时为常数（开启原始数据采集时另加拷贝，见Capture.c）
+ */
+FAST_CODE void SBUS_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart != sbus_huart) {
+        return;
+    }
+    sbus_rx_stamp = TIMEBASE_CYCLES();
+    Capture_Rx(CAPTURE_SRC_SBUS, SBUS_RX, SBUS_DMA_RX_SIZE, Size);
+    if (SBUS_TaskHandle != NULL) {
+        osThreadFlagsSet(SBUS_TaskHandle, SBUS_RX_FLAG);
+    }
+}
+
+/**
+ * @brief  USART1错误回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @note   溢出等阻塞性错误会中止DMA接收，此时从缓冲区起点重新启动，解析侧把读位置同步到起点并丢弃残帧
+ */
+void SBUS_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != sbus_huart || huart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    rx_epoch++;
+    sbus_stats.rx_restarts++;
+    HAL_UARTEx_ReceiveToIdle_DMA(sbus_huart, SBUS_RX, SBUS_DMA_RX_SIZE);
+}
+
+/**
+ * @brief  是否处于自动驾驶模式
+ * @retval true: 模式开关拨高且遥控未失联
+ * @note   失联时返回false，由失联保护执行停止
+ */
+bool SBUS_Auto_Mode(void) {
+    return !sbus_data.failsafe && sbus_data.channels[SBUS_MODE_CHANNEL] > SBUS_MODE_AUTO_MIN;
+}
+
+/**
+ * @brief  解码一帧完整的SBUS帧
+ * @param  packet: 25字节帧
+ * @note   与SBUS_Process中的解码相同（更新sbus_data与统计），不执行命令，供基准测试测量解码开销
+ */
+void SBUS_Decode_Frame(uint8_t *packet) {
+    SBUS_DecodePacket(packet);
+}
+
+/**
+ * @brief  SBUS数据处理（SBUS任务被接收事件唤醒或等待超时后调用）
  * @retval true: 解析到有效数据；false: 无有效数据
  * @note   1. 处理DMA环形缓冲区数据 2. 状态机解析SBUS帧 3. 执行命令 4. 超时检测
  */
-bool SBUS_Process(void) {
+FAST_CODE bool SBUS_Process(void) {
     bool has_new_data = false;
     uint32_t dma_curr_index = 0;
     uint32_t dma_data_len = 0;
 
     // 1. 关闭全局中断，防止DMA数据污染
     __disable_irq();
+
+    // 接收重启过：DMA从缓冲区起点重新写入，之前的残帧不可信
+    if (rx_epoch != rd_epoch) {
+        rd_epoch = rx_epoch;
+        dma_last_index = 0;
+        frame_pos = 0;
+        frame_timeout = 0;
+        frame_state = SBUS_SEEK_START;
+    }
     
     // 2. 计算DMA已接收数据长度（环形缓冲区）
     dma_curr_index = SBUS_DMA_RX_SIZE - __HAL_DMA_GET_COUNTER(sbus_huart->hdmarx);
@@ -259,10 +340,10 @@ bool SBUS_Process(void) {
         sbus_data.new_data_available = 0;
     }
 
-    // 7. 通信超时检测（100ms失联则停止）
-    if (HAL_GetTick() - sbus_data.last_update_time > SBUS_FAILSAFE_TIMEOUT) {
+    // 7. 通信超时检测（100ms失联则撤销遥控指令，无其他指令源时仲裁器执行停止）
+    if (TimeBase_Now_us() - sbus_data.last_update_us > TIMEBASE_MS(SBUS_FAILSAFE_TIMEOUT) && !sbus_data.failsafe) {
         sbus_data.failsafe = 1;
-        Fish_ExecuteCommand(CMD_STOP);
+        CMD_Release(CMD_SRC_SBUS);
 #if SBUS_DEBUG_MODE
         ottohesl_uart(sbus_debug_huart, "SBUS超时，执行停止\r\n");
 #endif
@@ -0,0 +1,373 @@
+/**
+ * @file       Telemetry.c
+ * @brief      二进制遥测协议（紧凑消息 + 硬件CRC32 + COBS分帧）
+ * @author     ottohesl
+ * @date       26-1-17
+ * @version    V1.0
+ * @note       1. 消息 = 消息头(类型/序号/时间戳) + 定长负载，结构体定义见Telemetry.h，全部小端
+ *             2. 消息后追加CRC32（STM32H7 CRC外设，与zlib.crc32一致），整体COBS编码，前后各加一个0x00
+ *             3. 帧经UART_TX写入调试串口，与printf文本共用；文本中不含0x00，上位机按0x00切分即可分离
+ *             4. 每类消息独立设置发送频率，由控制任务周期调用Telemetry_Process采样发送
+ *             5. 序号全局递增，发送缓冲区满时整帧丢弃但序号照常递增，上位机按序号间隔统计丢帧
+ *             6. 采样（Telemetry_Pack）与编码（Telemetry_Encode）单独开放，黑匣子按相同格式写入Flash
+ */
+#include "Telemetry.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "timers.h"
+#include "cmsis_os.h"
+#include "crc.h"
+#include "UART_TX.h"
+#include "JY901S.h"
+#include "SBUS_T.h"
+#include "GPS_T.h"
+#include "NAV_Filter.h"
+#include "Autopilot.h"
+#include "steering.h"
+#include "CMD_Arbiter.h"
+#include "BlackBox.h"
+#include "RT_Stats.h"
+#include "Start_Task.h"
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+#include "Power.h"
+#include "Executive.h"
+#include "Capture.h"
+
+/************************ 全局变量 ************************/
+TLM_Stats_t tlm_stats;                          // 遥测统计
+
+/************************ 私有变量 ************************/
+static uint16_t tlm_seq = 0;                    // 全局序号
+static uint16_t tlm_period[TLM_MSG_COUNT];      // 各类消息发送周期，ms（0=关闭）
+static uint32_t tlm_next[TLM_MSG_COUNT];        // 各类消息下次发送时间，ms
+
+// 默认发送频率（Hz），按115200波特率留出printf调试文本的余量
+static const uint16_t tlm_default_rate[TLM_MSG_COUNT] = {
+    [TLM_MSG_IMU]   = 50,
+    [TLM_MSG_RC]    = 10,
+    [TLM_MSG_GAIT]  = 20,
+    [TLM_MSG_SERVO] = 50,
+    [TLM_MSG_GPS]   = 5,
+    [TLM_MSG_TASK]  = 1,
+    [TLM_MSG_NAV]   = 10,
+    [TLM_MSG_ACK]   = 0,
+    [TLM_MSG_BB_DATA]   = 0,
+    [TLM_MSG_BB_STATUS] = 1,
+    [TLM_MSG_CPU]   = 1,
+    [TLM_MSG_POWER] = 1,
+    [TLM_MSG_INPUT] = 1,
+};
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  浮点按比例转int16（饱和）
+ */
+static int16_t TLM_Scale(float value, float scale) {
+    float v = value * scale;
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+/**
+ * @brief  COBS编码
+ * @param  src: 原始数据
+ * @param  len: 原始长度
+ * @param  dst: 输出缓冲区（至少len + len/254 + 1字节）
+ * @retval 编码后长度
+ * @note   每个码字节记录到下一个0x00（或满254个非零字节）的距离，编码结果不含0x00
+ */
+static uint32_t TLM_COBS_Encode(const uint8_t *src, uint32_t len, uint8_t *dst) {
+    uint32_t code_pos = 0;
+    uint32_t out = 1;
+    uint8_t code = 1;
+    for (uint32_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        } else {
+            dst[out++] = src[i];
+            if (++code == 0xFF) {
+                dst[code_pos] = code;
+                code_pos = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  按类型采样当前状态
+ * @param  type: 消息类型
+ * @param  payload: 输出负载（至少TLM_PAYLOAD_MAX字节，无对齐要求）
+ * @retval 负载长度；0=事件类消息或未知类型，不能采样
+ */
+uint8_t Telemetry_Pack(TLM_MsgType_t type, void *payload) {
+    switch (type) {
+        case TLM_MSG_IMU: {
+            TLM_IMU_t m;
+            const JG *g = &gyro_data.gyroscope;
+            for (int i = 0; i < 3; i++) {
+                m.accele[i] = TLM_Scale(g->accele[i], 100.0f);
+                m.gyro[i] = TLM_Scale(g->gyro[i], 10.0f);
+                m.angle[i] = TLM_Scale(g->angle[i], 100.0f);
+            }
+            m.temp = TLM_Scale(gyro_data.temp, 100.0f);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_RC: {
+            TLM_RC_t m;
+            memcpy(m.channels, sbus_data.channels, sizeof(m.channels));
+            m.flags = sbus_data.flags;
+            m.failsafe = sbus_data.failsafe;
+            m.frame_lost = sbus_data.frame_lost;
+            m.auto_mode = SBUS_Auto_Mode();
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_GAIT: {
+            TLM_Gait_t m;
+            m.state = (uint8_t)current_state;
+            m.command = (uint8_t)current_command;
+            m.speed = speed;
+            m.ap_active = ap_output.active;
+            m.wp_index = ap_output.wp_index;
+            m.yaw_rate = TLM_Scale(ap_output.yaw_rate, 100.0f);
+            m.heading_error = TLM_Scale(ap_output.heading_error, 100.0f);
+            m.distance = ap_output.distance;
+            m.cross_track = ap_output.cross_track;
+            m.source = (uint8_t)cmd_arbiter_stats.active;
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_SERVO: {
+            TLM_Servo_t m;
+            m.angle_body = servo_angle_body;
+            m.angle_tail = servo_angle_tail;
+            m.pulse_body = (uint16_t)__HAL_TIM_GET_COMPARE(&htim3, TIM_CHANNEL_1);
+            m.pulse_tail = (uint16_t)__HAL_TIM_GET_COMPARE(&htim2, TIM_CHANNEL_2);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_GPS: {
+            GPS_Data_t gps;
+            TLM_GPS_t m;
+            GPS_Get_Data(&gps);
+            m.latitude = gps.latitude;
+            m.longitude = gps.longitude;
+            m.altitude = gps.altitude;
+            m.utc_time = gps.utc_time;
+            m.speed = gps.speed;
+            m.course = gps.course;
+            m.hdop = gps.hdop;
+            m.pdop = gps.pdop;
+            m.fix_quality = gps.fix_quality;
+            m.satellites = gps.satellites;
+            m.is_valid = gps.is_valid;
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_TASK: {
+            TLM_Task_t m;
+            // 执行器布局下传感器句柄指向Control，对应槽位填0
+            const osThreadId_t tasks[TLM_TASK_MAX] = {
+                EXEC_ENABLE ? NULL : SBUS_TaskHandle, EXEC_ENABLE ? NULL : GPS_TaskHandle,
+                EXEC_ENABLE ? NULL : JY901S_TaskHandle, ControlHandle,
+                BlackBox_TaskHandle, (osThreadId_t)xTimerGetTimerDaemonTaskHandle()
+            };
+            for (int i = 0; i < TLM_TASK_MAX; i++) {
+                m.stack_free[i] = (tasks[i] != NULL) ? (uint16_t)osThreadGetStackSpace(tasks[i]) : 0;
+            }
+            m.uart_dropped = uart_tx_stats.dropped;
+            m.tlm_dropped = tlm_stats.dropped;
+            m.gps_overruns = gps_stats.ring_overruns;
+            m.control_cycles = control_stats.cycles;
+            m.control_cycles_max = control_stats.cycles_max;
+            for (int i = 0; i < TLM_TASK_INPUTS; i++) {
+                m.input_age_max[i] = control_stats.input_age_max[i];
+            }
+            // 切换次数与平均耗时取最近一个统计窗口（RT_Stats_Sample每秒计算一次，各采样方读同一份）
+            RT_Report_t rt;
+            RT_Stats_Get(&rt);
+            uint64_t rate = (rt.window_us != 0U) ? (uint64_t)rt.switches * 1000000U / rt.window_us : 0;
+            m.switch_cycles_avg = rt.switch_cycles_avg;
+            m.switch_cycles_max = os_switch_stats.cycles_max;
+            m.switches = (uint16_t)(rate > 0xFFFFU ? 0xFFFFU : rate);
+            m.control_jitter_max = (uint16_t)(control_stats.jitter_us_max > 0xFFFFU ? 0xFFFFU : control_stats.jitter_us_max);
+            m.stack_bytes = (uint16_t)OS_Task_Stack_Bytes();
+            m.control_misses = control_stats.deadline_misses;
+            m.uart_level_max = (uint16_t)uart_tx_stats.level_max;
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_NAV: {
+            NAV_State_t nav;
+            TLM_Nav_t m;
+            NAV_Get_State(&nav);
+            m.pos_n = nav.pos_n;
+            m.pos_e = nav.pos_e;
+            m.vel_n = nav.vel_n;
+            m.vel_e = nav.vel_e;
+            m.gps_updates = nav.gps_updates;
+            m.valid = nav.valid;
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_BB_STATUS: {
+            TLM_BB_Status_t m;
+            BlackBox_Get_Status(&m);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_CPU: {
+            TLM_CPU_t m;
+            RT_Stats_Get_Message(&m);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_POWER: {
+            // 睡眠占比按两次读取之差计算，黑匣子默认不记录该消息，以免与遥测分摊统计窗口
+            TLM_Power_t m;
+            Power_Get_Message(&m);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        case TLM_MSG_INPUT: {
+            TLM_Input_t m;
+            m.sbus_frames = sbus_stats.frames;
+            m.sbus_errors = sbus_stats.format_errors;
+            m.imu_frames = jy901s_stats.frames;
+            m.imu_errors = jy901s_stats.checksum_errors;
+            m.gps_sentences = gps_stats.sentences;
+            m.gps_errors = gps_stats.checksum_errors;
+            m.gps_bytes = gps_stats.rx_bytes;
+            m.capture_dropped = capture_stats.dropped;
+            m.imu_backlog_max = (uint16_t)(jy901s_stats.backlog_max > 0xFFFFU ? 0xFFFFU : jy901s_stats.backlog_max);
+            m.gps_backlog_max = (uint16_t)(gps_stats.backlog_max > 0xFFFFU ? 0xFFFFU : gps_stats.backlog_max);
+            memcpy(payload, &m, sizeof(m));
+            return sizeof(m);
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief  遥测初始化
+ * @note   需在MX_CRC_Init与UART_TX_Init之后调用
+ */
+void Telemetry_Init(void) {
+    memset(&tlm_stats, 0, sizeof(TLM_Stats_t));
+    tlm_seq = 0;
+    for (int i = 0; i < TLM_MSG_COUNT; i++) {
+        Telemetry_Set_Rate((TLM_MsgType_t)i, tlm_default_rate[i]);
+        tlm_next[i] = 0;
+    }
+}
+
+/**
+ * @brief  设置某类消息的发送频率
+ * @param  type: 消息类型
+ * @param  rate_hz: 频率，Hz（0=关闭）
+ * @note   实际频率不超过Telemetry_Process的调用频率（控制任务100Hz）
+ */
+void Telemetry_Set_Rate(TLM_MsgType_t type, uint16_t rate_hz) {
+    if ((unsigned)type >= TLM_MSG_COUNT) {
+        return;
+    }
+    if (rate_hz == 0) {
+        tlm_period[type] = 0;
+    } else {
+        tlm_period[type] = (rate_hz >= 1000) ? 1 : (uint16_t)(1000 / rate_hz);
+    }
+}
+
+/**
+ * @brief  打包并发送一条消息
+ * @param  type: 消息类型
+ * @param  payload: 负载
+ * @param  len: 负载长度（不超过TLM_PAYLOAD_MAX）
+ * @retval true: 已写入发送缓冲区；false: 负载过长或缓冲区满
+ * @note   只能在任务上下文调用（CRC外设计算时挂起调度器）
+ */
+bool Telemetry_Send(TLM_MsgType_t type, const void *payload, uint8_t len) {
+    uint8_t frame[TLM_FRAME_MAX];
+    if (len > TLM_PAYLOAD_MAX) {
+        return false;
+    }
+
+    // 前导0x00把之前的文本残段与本帧隔开
+    frame[0] = TLM_FRAME_DELIMITER;
+    uint16_t seq = __atomic_fetch_add(&tlm_seq, 1, __ATOMIC_RELAXED);
+    uint32_t frame_len = 1 + Telemetry_Encode(&frame[1], type, seq, payload, len);
+
+    if (UART_TX_Write(frame, frame_len) == 0) {
+        tlm_stats.dropped++;
+        return false;
+    }
+    tlm_stats.frames++;
+    tlm_stats.bytes += frame_len;
+    return true;
+}
+
+/**
+ * @brief  编码一帧
+ * @param  dst: 输出缓冲区（至少TLM_FRAME_MAX-1字节）
+ * @param  type: 消息类型
+ * @param  seq: 序号
+ * @param  payload: 负载
+ * @param  len: 负载长度（不超过TLM_PAYLOAD_MAX，调用方保证）
+ * @retval 编码后长度（含结尾分隔符）
+ * @note   只能在任务上下文调用（CRC外设计算时挂起调度器）
+ */
+uint32_t Telemetry_Encode(uint8_t *dst, TLM_MsgType_t type, uint16_t seq, const void *payload, uint8_t len) {
+    uint8_t raw[TLM_RAW_MAX];
+
+    // 1. 消息头 + 负载
+    TLM_Header_t header;
+    header.type = (uint8_t)type;
+    header.seq = seq;
+    header.time_us = TimeBase_Now_us();
+    memcpy(raw, &header, sizeof(header));
+    memcpy(raw + sizeof(header), payload, len);
+    uint32_t raw_len = sizeof(header) + len;
+
+    // 2. CRC32（小端）
+    uint32_t crc = CRC32_Calc(raw, raw_len);
+    memcpy(raw + raw_len, &crc, sizeof(crc));
+    raw_len += sizeof(crc);
+
+    // 3. COBS编码 + 结尾分隔符
+    uint32_t out_len = TLM_COBS_Encode(raw, raw_len, dst);
+    dst[out_len++] = TLM_FRAME_DELIMITER;
+    return out_len;
+}
+
+/**
+ * @brief  周期处理（控制任务调用）
+ * @param  now_ms: 当前时间，ms
+ * @note   到期的消息各发一条；落后超过一个周期时不补发，直接从当前时间重新计时
+ */
+FAST_CODE void Telemetry_Process(uint32_t now_ms) {
+    for (int i = 0; i < TLM_MSG_COUNT; i++) {
+        uint16_t period = tlm_period[i];
+        if (period == 0 || (int32_t)(now_ms - tlm_next[i]) < 0) {
+            continue;
+        }
+        uint8_t payload[TLM_PAYLOAD_MAX];
+        uint8_t len = Telemetry_Pack((TLM_MsgType_t)i, payload);
+        if (len != 0) {
+            Telemetry_Send((TLM_MsgType_t)i, payload, len);
+        }
+        tlm_next[i] += period;
+        if ((int32_t)(now_ms - tlm_next[i]) >= 0) {
+            tlm_next[i] = now_ms + period;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file       TimeBase.c
+ * @brief      64位微秒单调时基（32位自由运行定时器 + 溢出扩展）
+ * @author     ottohesl
+ * @date       26-1-22
+ * @version    V1.0
+ * @note       1. TIM24为32位定时器，预分频到1MHz，约71.6分钟溢出一次，溢出中断把高32位加一
+ *             2. 读取不关中断：先读高位、计数、溢出标志，高位在此期间变化则重读；
+ *                溢出已发生但中断还未处理（调用者关中断或处于更高优先级）时按溢出标志补一
+ *             3. 溢出中断设为最高优先级（0，不调用RTOS接口），任何读者都看不到“标志已清、高位未加”的中间状态
+ *             4. DWT周期计数（CPU时钟）与本时基同源，中断中只记32位DWT计数，任务中再换算为微秒时间戳
+ *             5. 溢出中断约71分钟一次，不计入RT_Stats中断统计
+ *             6. 换档（Power.c）后定时器时钟改变：重设预分频后软件更新立即装载，URS=1不置溢出标志，再写回原计数；
+ *                切换过程中计数按中间时钟走，误差为切换耗时量级（约百微秒），不破坏单调性
+ */
+#include "TimeBase.h"
+#include "MEM_Cache.h"
+
+/************************ 全局变量 ************************/
+volatile uint32_t timebase_sleep_cycles FAST_DATA;  // 睡眠期间DWT未计的周期（Power唤醒后补偿）
+
+/************************ 私有变量 ************************/
+static TIM_HandleTypeDef *tb_htim = NULL;           // 时基定时器句柄
+static volatile uint32_t tb_high FAST_DATA;         // 溢出次数（时间高32位）
+static uint32_t tb_cycles_per_us FAST_DATA = 1U;    // 每微秒CPU周期数
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  时基初始化
+ * @param  htim: 32位定时器句柄（CubeMX中配置为1MHz、ARR=0xFFFFFFFF、开启更新中断）
+ * @retval 无
+ * @note   开启DWT周期计数器（时间戳、运行时统计、各模块耗时共用，之后不再有模块清零或重开）；
+ *         调试器已开启时不清零计数
+ */
+void TimeBase_Init(TIM_HandleTypeDef *htim) {
+    tb_htim = htim;
+    tb_high = 0U;
+    tb_cycles_per_us = SystemCoreClock / TIMEBASE_HZ;
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0U) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->LAR = 0xC5ACCE55;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    __HAL_TIM_SET_COUNTER(htim, 0U);
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+    (void)HAL_TIM_Base_Start_IT(htim);
+}
+
+/**
+ * @brief  当前时间
+ * @retval 上电（TimeBase_Init）后的微秒数，初始化前为0
+ */
+FAST_CODE uint64_t TimeBase_Now_us(void) {
+    if (tb_htim == NULL) {
+        return 0U;
+    }
+    TIM_TypeDef *tim = tb_htim->Instance;
+    uint32_t high, low, pending;
+    do {
+        high = tb_high;
+        low = tim->CNT;
+        pending = tim->SR & TIM_SR_UIF;
+    } while (high != tb_high);
+    // 溢出未处理：计数已从0重新开始（低位较小）时补一；读计数后才溢出的（低位接近满）不补
+    if (pending != 0U && low < 0x80000000U) {
+        high++;
+    }
+    return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * @brief  DWT计数换算为时基微秒
+ * @param  cycles: 中断中记录的TIMEBASE_CYCLES()
+ * @retval 对应的时基微秒
+ */
+FAST_CODE uint64_t TimeBase_From_Cycles(uint32_t cycles) {
+    uint32_t now_cycles = TIMEBASE_CYCLES();
+    uint64_t now_us = TimeBase_Now_us();
+    return now_us - TimeBase_Cycles_To_us(now_cycles - cycles);
+}
+
+/**
+ * @brief  周期数换算为微秒
+ */
+FAST_CODE uint32_t TimeBase_Cycles_To_us(uint32_t cycles) {
+    return cycles / tb_cycles_per_us;
+}
+
+/**
+ * @brief  微秒换算为周期数
+ */
+FAST_CODE uint32_t TimeBase_us_To_Cycles(uint32_t us) {
+    return us * tb_cycles_per_us;
+}
+
+/**
+ * @brief  溢出回调（中断上下文）
+ * @param  htim: 定时器句柄
+ */
+void TimeBase_Overflow_Callback(TIM_HandleTypeDef *htim) {
+    if (htim == tb_htim) {
+        tb_high++;
+    }
+}
+
+/**
+ * @brief  系统时钟切换后重设时基定时器
+ * @param  timer_hz: 新的定时器输入时钟
+ * @retval 无
+ * @note   1. 需关中断调用（与读时基的中断、任务互斥），预分频写入后由软件更新立即生效，计数被清零后写回
+ *         2. 两档之间切换时定时器时钟均为整MHz，1MHz计数频率不变
+ */
+void TimeBase_Clock_Changed(uint32_t timer_hz) {
+    tb_cycles_per_us = SystemCoreClock / TIMEBASE_HZ;
+    if (tb_htim == NULL) {
+        return;
+    }
+    TIM_TypeDef *tim = tb_htim->Instance;
+    uint32_t psc = timer_hz / TIMEBASE_HZ - 1U;
+    uint32_t cnt = tim->CNT;
+    tb_htim->Init.Prescaler = psc;
+    tim->PSC = psc;
+    tim->CR1 |= TIM_CR1_URS;
+    tim->EGR = TIM_EGR_UG;
+    tim->CNT = cnt;
+}
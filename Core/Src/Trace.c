@@ -0,0 +1,320 @@
+/**
+ * @file       Trace.c
+ * @brief      调度事件记录（任务切换、队列、通知、中断与用户标记写入RAM环形缓冲区，经调试串口导出）
+ * @author     ottohesl
+ * @date       26-1-21
+ * @version    V1.0
+ * @note       1. 事件8字节（DWT时间戳+类型+编号+参数），缓冲区2048个共16KB，放在.bss（DTCM，0等待）；
+ *                写入函数放在ITCM，关中断后写一个事件，实测耗时在Trace_Init中测出，经TRACE_INFO上报
+ *             2. 平时环形覆盖；Trace_Trigger（控制周期卡顿或上行命令）后再记TRACE_POST_EVENTS个事件停止，
+ *                缓冲区里留下触发前约3/4、触发后约1/4的历史
+ *             3. 导出在黑匣子后台任务中进行：先发状态与名称表，再按从旧到新发送全部事件，最后再发一次状态，
+ *                随后清空重新记录。115200波特率下满缓冲导出约2s，期间黑匣子缓冲编程推迟（与黑匣子导出相同）
+ *             4. 时间戳为32位连续周期计数（TIMEBASE_CYCLES，DWT加睡眠补偿），550MHz下约7.8s回绕，
+ *                上位机按相邻事件展开（Tools/trace2json.py）；换档后周期频率改变，跨换档的时间线以TRACE_INFO中的主频换算会有偏差
+ *             5. recorded等统计在导出/停止时由写入位置换算，写入路径上不做额外计数
+ */
+#include "Trace.h"
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include "Telemetry.h"
+#include "RT_Stats.h"
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+
+/************************ 宏定义 ************************/
+#define TRACE_INDEX_MASK   (TRACE_EVENTS - 1U)
+#define TRACE_STATUS_MAX   (RT_TASK_MAX + 3)    // 名称表任务快照数组长度（与RT_Stats相同）
+#define TRACE_DUMP_RETRY   100                  // 导出时发送缓冲区满的最大重试次数（每次等2ms）
+#define TRACE_INIT_EVENTS  16                   // 初始化时测量写入耗时的事件数
+
+/************************ 全局变量 ************************/
+Trace_Stats_t trace_stats;
+
+/************************ 私有变量 ************************/
+static Trace_Event_t trace_buf[TRACE_EVENTS];       // 环形缓冲区
+static volatile uint32_t trace_head = 0;            // 下一个写入位置（本轮已记录的事件总数）
+static volatile uint32_t trace_stop_at = 0;         // 触发后停止的写入位置
+static volatile uint8_t trace_state = TRACE_STATE_RECORDING;
+static volatile bool trace_dump_pending = false;    // 导出请求
+static bool trace_stop_reported = false;            // 停止后是否已上报状态
+static TaskStatus_t trace_status[TRACE_STATUS_MAX];  // 名称表任务快照（黑匣子任务栈较小，不放在栈上）
+
+static const char *const trace_object_names[TRACE_OBJ_COUNT] = {
+    [TRACE_OBJ_INPUTS] = "Inputs",
+};
+
+static const char *const trace_marker_names[TRACE_MARK_COUNT] = {
+    [TRACE_MARK_CONTROL]       = "control",
+    [TRACE_MARK_UART_BLOCKING] = "uart_blocking",
+    [TRACE_MARK_NAV_UPDATE]    = "nav_update",
+    [TRACE_MARK_FLASH_PROGRAM] = "flash_program",
+};
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  缓冲区中的有效事件数
+ */
+static uint32_t Trace_Count(uint32_t head) {
+    return head < TRACE_EVENTS ? head : TRACE_EVENTS;
+}
+
+/**
+ * @brief  记录停止时刻的TimeBase与DWT对应关系（关中断中调用）
+ * @note   事件只带32位DWT计数，导出时上位机按此把最新的事件对齐到TimeBase时间
+ */
+FAST_CODE static void Trace_Sync(void) {
+    trace_stats.sync_cycles = TIMEBASE_CYCLES();
+    trace_stats.sync_us = TimeBase_Now_us();
+}
+
+/**
+ * @brief  清空缓冲区（调用者保证不在导出中）
+ */
+static void Trace_Reset(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    trace_head = 0;
+    trace_stop_at = 0;
+    trace_state = TRACE_STATE_RECORDING;
+    trace_stats.trigger = TRACE_TRIG_NONE;
+    trace_stop_reported = false;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  发送一条遥测消息，发送缓冲区满时等待
+ * @retval false=超时放弃
+ */
+static bool Trace_Send(TLM_MsgType_t type, const void *msg, uint8_t len) {
+    uint32_t retry = 0;
+    while (!Telemetry_Send(type, msg, len)) {
+        if (++retry > TRACE_DUMP_RETRY) {
+            return false;
+        }
+        osDelay(2);
+    }
+    return true;
+}
+
+/**
+ * @brief  发送记录器状态
+ * @param  events: 本次导出的事件数（非导出时为缓冲区中的事件数）
+ */
+static void Trace_Send_Info(uint16_t events) {
+    TLM_Trace_Info_t m;
+    m.cpu_hz = SystemCoreClock;
+    m.recorded = trace_stats.recorded;
+    m.events = events;
+    m.dumped = trace_stats.dumped;
+    m.event_cycles = trace_stats.event_cycles;
+    m.state = trace_state;
+    m.trigger = trace_stats.trigger;
+    m.sync_us = trace_stats.sync_us;
+    m.sync_cycles = trace_stats.sync_cycles;
+    (void)Trace_Send(TLM_MSG_TRACE_INFO, &m, sizeof(m));
+}
+
+/**
+ * @brief  发送一条名称
+ */
+static bool Trace_Send_Name(Trace_NameKind_t kind, uint8_t id, const char *name) {
+    TLM_Trace_Name_t m;
+    memset(&m, 0, sizeof(m));
+    m.kind = (uint8_t)kind;
+    m.id = id;
+    strncpy(m.name, name, sizeof(m.name));
+    return Trace_Send(TLM_MSG_TRACE_NAME, &m, sizeof(m));
+}
+
+/**
+ * @brief  发送名称表：任务号取内核TCB编号（与切换事件一致），中断/对象/标记取固定表
+ */
+static bool Trace_Send_Names(void) {
+    UBaseType_t n = uxTaskGetSystemState(trace_status, TRACE_STATUS_MAX, NULL);
+    for (UBaseType_t k = 0; k < n; k++) {
+        if (!Trace_Send_Name(TRACE_NAME_TASK, (uint8_t)trace_status[k].xTaskNumber, trace_status[k].pcTaskName)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < RT_ISR_COUNT; i++) {
+        if (!Trace_Send_Name(TRACE_NAME_ISR, (uint8_t)i, RT_ISR_Name((RT_ISR_Id_t)i))) {
+            return false;
+        }
+    }
+    for (int i = TRACE_OBJ_INPUTS; i < TRACE_OBJ_COUNT; i++) {
+        if (!Trace_Send_Name(TRACE_NAME_OBJECT, (uint8_t)i, trace_object_names[i])) {
+            return false;
+        }
+    }
+    for (int i = 0; i < TRACE_MARK_COUNT; i++) {
+        if (!Trace_Send_Name(TRACE_NAME_MARKER, (uint8_t)i, trace_marker_names[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief  按从旧到新发送缓冲区中的事件
+ * @param  head: 冻结时的写入位置
+ * @param  count: 事件数
+ */
+static void Trace_Send_Data(uint32_t head, uint32_t count) {
+    uint32_t first = head - count;
+    TLM_Trace_Data_t m;
+    memset(&m, 0, sizeof(m));
+    for (uint32_t i = 0; i < count; i += TLM_TRACE_EVENTS) {
+        uint32_t n = count - i;
+        if (n > TLM_TRACE_EVENTS) {
+            n = TLM_TRACE_EVENTS;
+        }
+        m.index = (uint16_t)i;
+        m.count = (uint8_t)n;
+        for (uint32_t k = 0; k < n; k++) {
+            memcpy(&m.events[k * sizeof(Trace_Event_t)], &trace_buf[(first + i + k) & TRACE_INDEX_MASK],
+                   sizeof(Trace_Event_t));
+        }
+        // 定长发送，最后一条不足TLM_TRACE_EVENTS个时其余为0（按count取有效事件）
+        if (!Trace_Send(TLM_MSG_TRACE_DATA, &m, sizeof(m))) {
+            return;
+        }
+        trace_stats.dumped = (uint16_t)(i + n);
+    }
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  调度事件记录初始化
+ * @retval 无
+ * @note   写入TRACE_INIT_EVENTS个标记测出单个事件的平均耗时（含调用开销），随后清空
+ */
+void Trace_Init(void) {
+    memset(&trace_stats, 0, sizeof(trace_stats));
+#if TRACE_ENABLE
+    uint32_t t0 = DWT->CYCCNT;
+    for (uint32_t i = 0; i < TRACE_INIT_EVENTS; i++) {
+        Trace_Event(TRACE_EV_MARK, TRACE_MARK_CONTROL, (uint16_t)i);
+    }
+    trace_stats.event_cycles = (uint16_t)((DWT->CYCCNT - t0) / TRACE_INIT_EVENTS);
+#endif
+    Trace_Reset();
+}
+
+/**
+ * @brief  写入一个事件
+ * @param  type: 事件类型Trace_EventType_t
+ * @param  id: 任务号/中断号/队列号/标记号
+ * @param  arg: 参数
+ * @retval 无
+ * @note   1. 关中断（PRIMASK）写入，可在任务、中断、内核临界区和调度器中调用，约十几条指令
+ *         2. 停止/导出中直接返回
+ */
+FAST_CODE void Trace_Event(uint8_t type, uint8_t id, uint16_t arg) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t state = trace_state;
+    if (state < TRACE_STATE_STOPPED) {
+        uint32_t head = trace_head;
+        Trace_Event_t *e = &trace_buf[head & TRACE_INDEX_MASK];
+        e->time = TIMEBASE_CYCLES();
+        e->type = type;
+        e->id = id;
+        e->arg = arg;
+        trace_head = ++head;
+        if (state == TRACE_STATE_TRIGGERED && head == trace_stop_at) {
+            trace_state = TRACE_STATE_STOPPED;
+            Trace_Sync();
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  触发
+ * @param  reason: 触发原因
+ * @retval 无
+ * @note   只有第一次触发生效，停止后的触发只计数，导出后重新开始记录才能再次触发
+ */
+void Trace_Trigger(Trace_Trigger_t reason) {
+#if TRACE_ENABLE
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    trace_stats.triggers++;
+    if (trace_state == TRACE_STATE_RECORDING) {
+        Trace_Event(TRACE_EV_TRIGGER, (uint8_t)reason, 0);
+        trace_stop_at = trace_head + TRACE_POST_EVENTS;
+        trace_stats.trigger = (uint8_t)reason;
+        trace_state = TRACE_STATE_TRIGGERED;
+    }
+    __set_PRIMASK(primask);
+#else
+    (void)reason;
+#endif
+}
+
+/**
+ * @brief  清空并重新开始记录
+ * @retval true=成功，false=正在导出
+ */
+bool Trace_Restart(void) {
+    if (trace_state == TRACE_STATE_DUMPING) {
+        return false;
+    }
+    Trace_Reset();
+    return true;
+}
+
+/**
+ * @brief  请求导出
+ * @retval true=已登记，false=上一个请求还未处理或正在导出
+ */
+bool Trace_Request_Dump(void) {
+    if (trace_dump_pending || trace_state == TRACE_STATE_DUMPING) {
+        return false;
+    }
+    trace_dump_pending = true;
+    osThreadFlagsSet(BlackBox_TaskHandle, TRACE_FLAG_DUMP);
+    return true;
+}
+
+/**
+ * @brief  后台任务处理
+ * @retval 无
+ * @note   1. 触发后停止时上报一次状态，上位机据此提示导出
+ *         2. 导出：冻结缓冲区（DUMPING，不再记录）-> 状态 -> 名称表 -> 事件 -> 状态 -> 重新记录
+ *         3. 发送超时（上位机未接收、发送缓冲区一直满）时放弃本次导出，同样重新记录
+ */
+void Trace_Service(void) {
+    if (trace_state == TRACE_STATE_STOPPED && !trace_stop_reported) {
+        trace_stop_reported = true;
+        trace_stats.recorded = trace_head;
+        Trace_Send_Info((uint16_t)Trace_Count(trace_head));
+    }
+    if (!trace_dump_pending) {
+        return;
+    }
+    trace_dump_pending = false;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (trace_state != TRACE_STATE_STOPPED) {
+        Trace_Sync();
+    }
+    trace_state = TRACE_STATE_DUMPING;
+    uint32_t head = trace_head;
+    __set_PRIMASK(primask);
+
+    uint16_t count = (uint16_t)Trace_Count(head);
+    trace_stats.recorded = head;
+    trace_stats.dumped = 0;
+    Trace_Send_Info(count);
+    if (Trace_Send_Names()) {
+        Trace_Send_Data(head, count);
+    }
+    Trace_Send_Info(count);
+    Trace_Reset();
+}
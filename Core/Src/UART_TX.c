@@ -0,0 +1,236 @@
+/**
+ * @file       UART_TX.c
+ * @brief      调试串口异步发送引擎（多生产者无锁环形缓冲区 + DMA链式发送）
+ * @author     ottohesl
+ * @date       26-1-16
+ * @version    V1.0
+ * @note       1. printf（_write）与ottohesl_uart*共用，调用方从不阻塞，空间不足整条丢弃并计数
+ *             2. 写入分三步：CAS预留空间 -> 拷贝 -> 最后一个写完的生产者提交，任务/中断均可调用
+ *             3. 预留头指针与正在写入的生产者数打包在一个32位字中，提交时不会把别人未写完的数据发出去
+ *             4. 发送完成中断里推进读指针并启动下一段连续数据，环绕处拆成两次DMA
+ *             5. 需开启TX DMA（普通模式）和串口全局中断（HAL在串口TC中断里才回调发送完成）
+ */
+#include "UART_TX.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "MEM_Cache.h"
+
+/************************ 宏定义 ************************/
+#define RING_MASK      (UART_TX_RING_SIZE - 1)
+#define STATE_HEAD(s)  ((uint16_t)((s) >> 16))      // 预留头指针（模65536）
+#define STATE_USERS(s) ((uint16_t)((s) & 0xFFFF))   // 正在写入的生产者数
+#define STATE(h, u)    (((uint32_t)(uint16_t)(h) << 16) | (uint16_t)(u))
+
+/************************ 全局变量 ************************/
+UART_TX_Stats_t uart_tx_stats;                      // 发送统计
+
+/************************ 环形缓冲区 ************************/
+// STM32H7放入RAM_D2不可缓存区（DMA_BUFFER，见MEM_Cache.h），DMA与CPU无需缓存维护
+static uint8_t tx_ring[UART_TX_RING_SIZE] DMA_BUFFER;
+// stdout行缓冲：newlib默认在第一次printf时从_sbrk堆malloc一块BUFSIZ缓冲，这里改为静态
+static char tx_stdout_buf[UART_TX_STDOUT_SIZE];
+
+/************************ 生产者/消费者索引 ************************/
+static UART_HandleTypeDef *tx_huart = NULL;         // 发送串口句柄
+static atomic_uint_least32_t tx_state;              // 预留头指针<<16 | 写入中的生产者数
+static atomic_uint_least16_t tx_commit;             // 已提交位置（之前的数据可发送）
+static atomic_uint_least16_t tx_tail;               // 读指针（DMA已发送完成的位置）
+static atomic_flag tx_busy = ATOMIC_FLAG_INIT;      // DMA占用标志（持有者负责启动发送）
+static volatile uint16_t tx_in_flight = 0;          // 当前DMA发送长度
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  提交位置只向前推进（可能被更晚预留的生产者抢先提交）
+ */
+static void UART_TX_Publish(uint16_t head) {
+    uint_least16_t commit = atomic_load(&tx_commit);
+    while ((int16_t)(head - commit) > 0) {
+        if (atomic_compare_exchange_weak(&tx_commit, &commit, head)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief  尝试启动一段DMA发送
+ * @note   1. 抢到busy标志的一方负责启动，抢不到说明DMA正在发送，发送完成中断会接着发
+ *         2. 无数据可发时释放标志后再检查一次，防止与刚提交的生产者错过
+ */
+FAST_CODE static void UART_TX_Kick(void) {
+    for (;;) {
+        if (atomic_flag_test_and_set(&tx_busy)) {
+            return;
+        }
+        uint16_t tail = atomic_load(&tx_tail);
+        uint16_t commit = atomic_load(&tx_commit);
+        if (commit == tail) {
+            atomic_flag_clear(&tx_busy);
+            if (atomic_load(&tx_commit) == tail) {
+                return;
+            }
+            continue;
+        }
+
+        // 只发连续的一段：不跨越缓冲区末尾，且不超过单次上限
+        uint16_t len = (uint16_t)(commit - tail);
+        uint16_t offset = tail & RING_MASK;
+        if (len > UART_TX_RING_SIZE - offset) {
+            len = UART_TX_RING_SIZE - offset;
+        }
+        if (len > UART_TX_CHUNK_MAX) {
+            len = UART_TX_CHUNK_MAX;
+        }
+        tx_in_flight = len;
+        if (HAL_UART_Transmit_DMA(tx_huart, &tx_ring[offset], len) != HAL_OK) {
+            // 串口被其他调用占用或出错：释放标志，等下一次写入或完成中断再试
+            uart_tx_stats.dma_errors++;
+            tx_in_flight = 0;
+            atomic_flag_clear(&tx_busy);
+        }
+        return;
+    }
+}
+
+/**
+ * @brief  结束当前DMA段并接着发送
+ * @param  ok: true=发送完成，false=出错（该段计为丢弃）
+ */
+static void UART_TX_Finish(bool ok) {
+    uint16_t len = tx_in_flight;
+    tx_in_flight = 0;
+    atomic_fetch_add(&tx_tail, len);
+    if (ok) {
+        uart_tx_stats.sent += len;
+    } else {
+        uart_tx_stats.dropped += len;
+    }
+    atomic_flag_clear(&tx_busy);
+    UART_TX_Kick();
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  发送引擎初始化
+ * @param  huart: 调试串口句柄
+ * @note   1. 需在CubeMX中开启该串口TX DMA（普通模式）及串口全局中断
+ *         2. 同时为stdout指定静态行缓冲，必须在第一次printf之前调用
+ */
+void UART_TX_Init(UART_HandleTypeDef *huart) {
+    tx_huart = huart;
+    setvbuf(stdout, tx_stdout_buf, _IOLBF, sizeof(tx_stdout_buf));
+    memset(&uart_tx_stats, 0, sizeof(UART_TX_Stats_t));
+    atomic_store(&tx_state, 0);
+    atomic_store(&tx_commit, 0);
+    atomic_store(&tx_tail, 0);
+    atomic_flag_clear(&tx_busy);
+    tx_in_flight = 0;
+}
+
+/**
+ * @brief  写入发送数据
+ * @param  data: 数据指针
+ * @param  len: 长度
+ * @retval 写入的字节数（0表示空间不足被丢弃或未初始化）
+ * @note   1. 不阻塞，任务和中断中均可调用
+ *         2. 一条数据要么整条写入，要么整条丢弃，不会在输出中出现半条
+ */
+FAST_CODE uint32_t UART_TX_Write(const void *data, uint32_t len) {
+    if (tx_huart == NULL || len == 0) {
+        return 0;
+    }
+    if (len > UART_TX_RING_SIZE) {
+        uart_tx_stats.dropped += len;
+        return 0;
+    }
+
+    // 1. 预留空间：头指针后移，同时登记一个写入中的生产者
+    uint_least32_t state = atomic_load(&tx_state);
+    uint16_t head;
+    uint32_t level;
+    do {
+        head = STATE_HEAD(state);
+        uint16_t used = (uint16_t)(head - atomic_load(&tx_tail));
+        level = used + len;
+        if (level > UART_TX_RING_SIZE) {
+            uart_tx_stats.dropped += len;
+            return 0;
+        }
+    } while (!atomic_compare_exchange_weak(&tx_state, &state,
+                                           STATE(head + len, STATE_USERS(state) + 1)));
+    // 水位只用于统计，并发写入时偶尔少记一次不影响
+    if (level > uart_tx_stats.level_max) {
+        uart_tx_stats.level_max = level;
+    }
+
+    // 2. 拷贝到预留区域（可能环绕）
+    const uint8_t *src = (const uint8_t *)data;
+    uint16_t offset = head & RING_MASK;
+    uint32_t first = UART_TX_RING_SIZE - offset;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&tx_ring[offset], src, first);
+    memcpy(&tx_ring[0], src + first, len - first);
+
+    // 3. 注销生产者；最后一个写完的生产者把当时的头指针整体提交
+    state = atomic_load(&tx_state);
+    while (!atomic_compare_exchange_weak(&tx_state, &state,
+                                         STATE(STATE_HEAD(state), STATE_USERS(state) - 1))) {
+    }
+    if (STATE_USERS(state) == 1) {
+        UART_TX_Publish(STATE_HEAD(state));
+    }
+    uart_tx_stats.queued += len;
+
+    UART_TX_Kick();
+    return len;
+}
+
+/**
+ * @brief  环形缓冲区剩余空间
+ * @retval 字节数（只是读取时刻的快照，随后的写入仍可能因空间不足被丢弃）
+ */
+uint32_t UART_TX_Free(void) {
+    uint16_t used = (uint16_t)(STATE_HEAD(atomic_load(&tx_state)) - atomic_load(&tx_tail));
+    return UART_TX_RING_SIZE - used;
+}
+
+/**
+ * @brief  是否为本模块管理的串口
+ */
+bool UART_TX_Owns(const UART_HandleTypeDef *huart) {
+    return huart != NULL && huart == tx_huart;
+}
+
+/**
+ * @brief  发送完成回调（中断上下文）
+ * @param  huart: 串口句柄
+ */
+FAST_CODE void UART_TX_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart != tx_huart) {
+        return;
+    }
+    UART_TX_Finish(true);
+}
+
+/**
+ * @brief  错误回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @note   只在有DMA发送进行中时处理，出错的一段计为丢弃
+ */
+void UART_TX_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != tx_huart || tx_in_flight == 0 || huart->gState != HAL_UART_STATE_READY) {
+        return;
+    }
+    UART_TX_Finish(false);
+}
+
+/**
+ * @brief  printf重定向（覆盖syscalls.c中的弱定义）
+ */
+int _write(int file, char *ptr, int len) {
+    (void)file;
+    UART_TX_Write(ptr, (uint32_t)len);
+    return len;
+}
@@ -0,0 +1,382 @@
+/**
+ * @file       Uplink.c
+ * @brief      地面站二进制命令上行（调试串口循环DMA+空闲中断接收，COBS分帧+CRC32校验）
+ * @author     ottohesl
+ * @date       26-1-18
+ * @version    V1.0
+ * @note       1. 与遥测共用调试串口：发送走UART_TX，接收走本模块，帧格式与遥测相同（0x00分隔的COBS帧+CRC32）
+ *             2. 中断中只搬运DMA写指针，分帧、校验、执行都在控制任务中完成，命令最迟在下一个控制周期生效
+ *             3. 运动命令提交给指令仲裁器（与遥控同一路径），地面站设定需周期重发，超时自动失效
+ *             4. 每条命令都经遥测ACK消息回送执行结果，上位机可据此重发
+ */
+#include "Uplink.h"
+#include <math.h>
+#include <string.h>
+#include "crc.h"
+#include "CMD_Arbiter.h"
+#include "Autopilot.h"
+#include "Telemetry.h"
+#include "steering.h"
+#include "BlackBox.h"
+#include "RT_Stats.h"
+#include "Trace.h"
+#include "Power.h"
+#include "Capture.h"
+#include "MEM_Cache.h"
+
+/************************ 宏定义 ************************/
+#define UPLINK_AMPLITUDE_MAX  60      // 摆动幅度上限（°）
+#define UPLINK_BIAS_MAX       45      // 转向偏置上限（°）
+#define UPLINK_RATE_MAX       100     // 遥测频率上限（Hz），即控制任务频率
+
+/************************ 全局变量 ************************/
+UPLINK_Stats_t uplink_stats;                    // 上行接收统计
+
+/************************ DMA接收缓冲区 ************************/
+// STM32H7放入RAM_D2不可缓存区（DMA_BUFFER，见MEM_Cache.h），DMA与CPU无需缓存维护
+static uint8_t uplink_rx[UPLINK_DMA_RX_SIZE] DMA_BUFFER;
+
+/************************ 中断与任务共享的索引 ************************/
+static UART_HandleTypeDef *uplink_huart = NULL;  // 接收串口句柄
+static volatile uint32_t dma_last_pos = 0;       // 中断中上一次的DMA位置（仅中断写）
+static volatile uint32_t rx_total = 0;           // 累计写入字节数（仅中断写，任务读）
+static volatile uint32_t rx_epoch = 0;           // 接收重启次数（仅中断写）
+static uint32_t rd_total = 0;                    // 累计已处理字节数（仅任务读写）
+static uint32_t rd_epoch = 0;                    // 任务已同步的重启次数
+
+/************************ 分帧与链路状态 ************************/
+static uint8_t frame_buf[UPLINK_FRAME_MAX];      // 当前帧（COBS编码）
+static uint8_t frame_len = 0;                    // 当前帧长度
+static bool frame_discard = false;               // 丢弃到下一个分隔符（超长或数据被覆盖）
+static uint32_t last_frame_time = 0;             // 最后一次收到有效帧的时间，ms
+static bool link_seen = false;                   // 是否收到过有效帧
+static UPLINK_Mode_t uplink_mode = UPLINK_MODE_MANUAL; // 地面站模式
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  启动循环DMA+空闲中断接收
+ */
+static HAL_StatusTypeDef Uplink_Start_Rx(void) {
+    dma_last_pos = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(uplink_huart, uplink_rx, UPLINK_DMA_RX_SIZE);
+}
+
+/**
+ * @brief  COBS原地解码
+ * @param  buf: 编码数据（解码结果写回同一缓冲区）
+ * @param  len: 编码长度
+ * @retval 解码长度，格式错误返回-1
+ */
+static int Uplink_COBS_Decode(uint8_t *buf, uint32_t len) {
+    uint32_t in = 0;
+    uint32_t out = 0;
+    while (in < len) {
+        uint8_t code = buf[in];
+        if (code == 0 || in + code > len) {
+            return -1;
+        }
+        in++;
+        for (uint8_t i = 1; i < code; i++) {
+            buf[out++] = buf[in++];
+        }
+        if (code != 0xFF && in < len) {
+            buf[out++] = 0;
+        }
+    }
+    return (int)out;
+}
+
+/**
+ * @brief  回送应答
+ */
+static void Uplink_Ack(const UPLINK_Header_t *header, UPLINK_Result_t result) {
+    TLM_Ack_t ack;
+    ack.cmd = header->type;
+    ack.seq = header->seq;
+    ack.result = (uint8_t)result;
+    Telemetry_Send(TLM_MSG_ACK, &ack, sizeof(ack));
+}
+
+/**
+ * @brief  执行一条命令
+ * @param  header: 命令头
+ * @param  payload: 负载
+ * @param  len: 负载长度
+ * @retval 执行结果
+ */
+static UPLINK_Result_t Uplink_Execute(const UPLINK_Header_t *header, const uint8_t *payload, uint32_t len) {
+    switch (header->type) {
+        case UPLINK_CMD_HEARTBEAT:
+            return (len == 0) ? UPLINK_OK : UPLINK_BAD_LENGTH;
+
+        case UPLINK_CMD_MODE: {
+            UPLINK_Mode_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.mode > UPLINK_MODE_AUTO) return UPLINK_BAD_VALUE;
+            uplink_mode = (UPLINK_Mode_t)m.mode;
+            if (uplink_mode == UPLINK_MODE_AUTO) {
+                // 切入自动：撤销手动设定，由自动驾驶接管
+                CMD_Release(CMD_SRC_UPLINK);
+            }
+            return UPLINK_OK;
+        }
+
+        case UPLINK_CMD_SETPOINT: {
+            UPLINK_Setpoint_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (!isfinite(m.yaw_rate) || m.speed > 10) return UPLINK_BAD_VALUE;
+            if (uplink_mode != UPLINK_MODE_MANUAL) return UPLINK_REJECTED;
+            CMD_Submit_Setpoint(CMD_SRC_UPLINK, m.yaw_rate, m.speed);
+            return UPLINK_OK;
+        }
+
+        case UPLINK_CMD_COMMAND: {
+            UPLINK_Command_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.cmd > CMD_TURN_RIGHT) return UPLINK_BAD_VALUE;
+            if (uplink_mode != UPLINK_MODE_MANUAL) return UPLINK_REJECTED;
+            CMD_Submit(CMD_SRC_UPLINK, (Command_t)m.cmd);
+            return UPLINK_OK;
+        }
+
+        case UPLINK_CMD_GAIT: {
+            UPLINK_Gait_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.swing_amplitude > UPLINK_AMPLITUDE_MAX || m.swing_speed < 1 || m.swing_speed > 10 ||
+                m.turn_body_bias > UPLINK_BIAS_MAX || m.turn_tail_bias > UPLINK_BIAS_MAX) {
+                return UPLINK_BAD_VALUE;
+            }
+            Set_Swing_Amplitude(m.swing_amplitude);
+            Set_Swing_Speed(m.swing_speed);
+            Set_Turn_Parameters(m.turn_body_bias, m.turn_tail_bias);
+            return UPLINK_OK;
+        }
+
+        case UPLINK_CMD_WP_CLEAR:
+            if (len != 0) return UPLINK_BAD_LENGTH;
+            AP_Clear_Waypoints();
+            return UPLINK_OK;
+
+        case UPLINK_CMD_WP_ADD: {
+            UPLINK_Waypoint_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.latitude < -900000000 || m.latitude > 900000000 ||
+                m.longitude < -1800000000 || m.longitude > 1800000000 ||
+                !isfinite(m.radius) || m.radius < 0.0f) {
+                return UPLINK_BAD_VALUE;
+            }
+            return AP_Add_Waypoint(m.latitude, m.longitude, m.radius) ? UPLINK_OK : UPLINK_REJECTED;
+        }
+
+        case UPLINK_CMD_TLM_RATE: {
+            UPLINK_Rate_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.type == 0 || m.type >= TLM_MSG_COUNT || m.type == TLM_MSG_ACK || m.type == TLM_MSG_BB_DATA ||
+                (m.type >= TLM_MSG_TRACE_DATA && m.type <= TLM_MSG_TRACE_NAME) || m.type == TLM_MSG_CAPTURE ||
+                m.rate_hz > UPLINK_RATE_MAX) {
+                return UPLINK_BAD_VALUE;
+            }
+            Telemetry_Set_Rate((TLM_MsgType_t)m.type, m.rate_hz);
+            return UPLINK_OK;
+        }
+
+        case UPLINK_CMD_BB_DUMP:
+            if (len != 0) return UPLINK_BAD_LENGTH;
+            return BlackBox_Request_Dump() ? UPLINK_OK : UPLINK_REJECTED;
+
+        case UPLINK_CMD_TOP:
+            if (len != 0) return UPLINK_BAD_LENGTH;
+            return RT_Stats_Request_Top() ? UPLINK_OK : UPLINK_REJECTED;
+
+        case UPLINK_CMD_TRACE: {
+            UPLINK_Trace_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            switch (m.op) {
+                case UPLINK_TRACE_DUMP:
+                    return Trace_Request_Dump() ? UPLINK_OK : UPLINK_REJECTED;
+                case UPLINK_TRACE_RESTART:
+                    return Trace_Restart() ? UPLINK_OK : UPLINK_REJECTED;
+                case UPLINK_TRACE_TRIGGER:
+                    Trace_Trigger(TRACE_TRIG_MANUAL);
+                    return UPLINK_OK;
+                default:
+                    return UPLINK_BAD_VALUE;
+            }
+        }
+
+        case UPLINK_CMD_POWER: {
+            UPLINK_Power_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.profile >= POWER_PROFILE_COUNT || m.sleep > 1) return UPLINK_BAD_VALUE;
+            Power_Set_Sleep(m.sleep != 0);
+            return Power_Request_Profile((Power_Profile_t)m.profile) ? UPLINK_OK : UPLINK_REJECTED;
+        }
+
+        case UPLINK_CMD_CAPTURE: {
+            UPLINK_Capture_Msg_t m;
+            if (len != sizeof(m)) return UPLINK_BAD_LENGTH;
+            memcpy(&m, payload, sizeof(m));
+            if (m.mask >= (1U << CAPTURE_SRC_COUNT)) return UPLINK_BAD_VALUE;
+            Capture_Set_Mask(m.mask);
+            return UPLINK_OK;
+        }
+
+        default:
+            return UPLINK_UNKNOWN;
+    }
+}
+
+/**
+ * @brief  处理一个完整帧（两个分隔符之间的数据）
+ * @param  now_ms: 当前时间，ms
+ */
+static void Uplink_Frame(uint32_t now_ms) {
+    int len = Uplink_COBS_Decode(frame_buf, frame_len);
+    if (len < (int)(sizeof(UPLINK_Header_t) + sizeof(uint32_t))) {
+        uplink_stats.crc_errors++;
+        return;
+    }
+    uint32_t body_len = (uint32_t)len - sizeof(uint32_t);
+    uint32_t crc;
+    memcpy(&crc, &frame_buf[body_len], sizeof(crc));
+    if (CRC32_Calc(frame_buf, body_len) != crc) {
+        uplink_stats.crc_errors++;
+        return;
+    }
+
+    UPLINK_Header_t header;
+    memcpy(&header, frame_buf, sizeof(header));
+    uplink_stats.frames++;
+    last_frame_time = now_ms;
+    link_seen = true;
+
+    UPLINK_Result_t result = Uplink_Execute(&header, &frame_buf[sizeof(header)], body_len - sizeof(header));
+    Uplink_Ack(&header, result);
+}
+
+/************************ 公开函数实现 ************************/
+/**
+ * @brief  上行接收初始化
+ * @param  huart: 调试串口句柄（与UART_TX发送共用）
+ * @note   需在CubeMX中开启该串口RX DMA（循环模式）及串口全局中断
+ */
+void Uplink_Init(UART_HandleTypeDef *huart) {
+    uplink_huart = huart;
+    memset(&uplink_stats, 0, sizeof(UPLINK_Stats_t));
+    rx_total = 0;
+    rx_epoch = 0;
+    rd_total = 0;
+    rd_epoch = 0;
+    frame_len = 0;
+    frame_discard = false;
+    link_seen = false;
+    uplink_mode = UPLINK_MODE_MANUAL;
+    Uplink_Start_Rx();
+}
+
+/**
+ * @brief  接收事件回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @param  Size: DMA缓冲区中当前写入位置
+ */
+FAST_CODE void Uplink_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart != uplink_huart) {
+        return;
+    }
+    uint32_t pos = (Size >= UPLINK_DMA_RX_SIZE) ? 0 : Size;
+    uint32_t last = dma_last_pos;
+    rx_total += (pos >= last) ? (pos - last) : (UPLINK_DMA_RX_SIZE + pos - last);
+    dma_last_pos = pos;
+}
+
+/**
+ * @brief  错误回调（中断上下文）
+ * @param  huart: 串口句柄
+ * @note   溢出等阻塞性错误会中止DMA接收，此时从缓冲区起点重新启动，任务侧丢弃残帧重新同步
+ */
+void Uplink_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart != uplink_huart || huart->RxState != HAL_UART_STATE_READY) {
+        return;
+    }
+    // 写指针对齐到缓冲区起点，与DMA从0开始写入保持一致
+    uint32_t rem = rx_total % UPLINK_DMA_RX_SIZE;
+    if (rem != 0) {
+        rx_total += UPLINK_DMA_RX_SIZE - rem;
+    }
+    rx_epoch++;
+    uplink_stats.rx_restarts++;
+    Uplink_Start_Rx();
+}
+
+/**
+ * @brief  上行处理（控制任务周期调用）
+ * @param  now_ms: 当前时间，ms
+ * @note   1. 从环形缓冲区读出新数据按0x00分帧，逐帧校验执行
+ *         2. 积压超过缓冲区长度说明已被DMA覆盖，跳到最新位置并丢弃残帧
+ */
+FAST_CODE void Uplink_Process(uint32_t now_ms) {
+    if (uplink_huart == NULL) {
+        return;
+    }
+    uint32_t epoch = rx_epoch;
+    uint32_t head = rx_total;
+    if (epoch != rd_epoch) {
+        // 接收重启过：之前的残帧和未读数据都不可信
+        rd_epoch = epoch;
+        rd_total = head;
+        frame_len = 0;
+        frame_discard = false;
+    }
+
+    uint32_t pending = head - rd_total;
+    if (pending > UPLINK_DMA_RX_SIZE) {
+        uplink_stats.ring_overruns++;
+        rd_total = head - UPLINK_DMA_RX_SIZE;
+        frame_len = 0;
+        frame_discard = true;
+        pending = UPLINK_DMA_RX_SIZE;
+    }
+    uplink_stats.rx_bytes += pending;
+
+    while (rd_total != head) {
+        uint8_t byte = uplink_rx[rd_total % UPLINK_DMA_RX_SIZE];
+        rd_total++;
+        if (byte == 0x00) {
+            if (!frame_discard && frame_len > 0) {
+                Uplink_Frame(now_ms);
+            }
+            frame_len = 0;
+            frame_discard = false;
+            continue;
+        }
+        if (frame_discard) {
+            continue;
+        }
+        if (frame_len >= UPLINK_FRAME_MAX) {
+            uplink_stats.oversize++;
+            frame_discard = true;
+            continue;
+        }
+        frame_buf[frame_len++] = byte;
+    }
+}
+
+/**
+ * @brief  地面站是否在线且处于自动模式
+ * @param  now_ms: 当前时间，ms
+ * @note   超过UPLINK_LINK_TIMEOUT未收到任何有效帧（含心跳）即视为断开
+ */
+bool Uplink_Auto_Mode(uint32_t now_ms) {
+    if (!link_seen || (int32_t)(now_ms - last_frame_time) > UPLINK_LINK_TIMEOUT) {
+        return false;
+    }
+    return uplink_mode == UPLINK_MODE_AUTO;
+}
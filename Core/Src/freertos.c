@@ -27,9 +27,16 @@
 /* USER CODE BEGIN Includes */
 #include "JY901S.h"
 #include"SBUS_T.h"
+#include "RT_Stats.h"
+#include "timers.h"
+#include "Trace.h"
+#include "event_groups.h"
+#include "Executive.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticTask_t osStaticThreadDef_t;
+typedef StaticEventGroup_t osStaticEventGroupDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
@@ -46,59 +53,131 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
-/* USER CODE END Variables */
-/* Definitions for SUBS_Task */
+// 任务控制块、栈和事件组存储全部静态分配（configSUPPORT_DYNAMIC_ALLOCATION=0，不链接heap_4），RAM占用在链接时确定：
+// 1. .bss位于DTCM（0等待、不经过D缓存），栈随之放在DTCM，DMA不访问任务栈
+// 2. 栈大小（字）按-fstack-usage统计的最深调用链加中断/FPU现场约一倍余量给出，
+//    运行中以遥测TASK消息的栈剩余最小值复核，剩余长期超过一半再缩小
+// 3. 空闲任务和定时器服务任务的内存由cmsis_os2.c中的vApplicationGetIdleTaskMemory/TimerTaskMemory静态提供
+OS_Switch_Stats_t os_switch_stats;          // 任务切换耗时统计（OS_Switch_Record写入）
+// RT_Stats统计窗口定时器：直接用xTimerCreateStatic创建，不放在FISH_H7.ioc中
+// （CubeMX生成的osTimerNew要从FreeRTOS堆分配回调记录，本工程不链接堆）
+static StaticTimer_t RT_StatsTimerBuffer;
+TimerHandle_t RT_StatsHandle;
+
+// 传感器任务不在CubeMX任务表中：多任务布局在这里创建，执行器布局（EXEC_ENABLE）不创建、不占栈，
+// 句柄指向承载执行器的Control任务，接收中断照常置位各自的线程标志
 osThreadId_t SBUS_TaskHandle;
+osThreadId_t GPS_TaskHandle;
+osThreadId_t JY901S_TaskHandle;
+#if !EXEC_ENABLE
+uint32_t SBUS_TaskBuffer[ 384 ];
+osStaticThreadDef_t SBUS_TaskControlBlock;
 const osThreadAttr_t SBUS_Task_attributes = {
   .name = "SBUS_Task",
-  .stack_size = 512 * 4,
-  .priority = (osPriority_t) osPriorityNormal,
+  .cb_mem = &SBUS_TaskControlBlock,
+  .cb_size = sizeof(SBUS_TaskControlBlock),
+  .stack_mem = &SBUS_TaskBuffer[0],
+  .stack_size = sizeof(SBUS_TaskBuffer),
+  .priority = (osPriority_t) osPriorityNormal2,
 };
-/* Definitions for GPS_Task */
-osThreadId_t GPS_TaskHandle;
+uint32_t GPS_TaskBuffer[ 384 ];
+osStaticThreadDef_t GPS_TaskControlBlock;
 const osThreadAttr_t GPS_Task_attributes = {
   .name = "GPS_Task",
-  .stack_size = 512 * 4,
-  .priority = (osPriority_t) osPriorityLow,
+  .cb_mem = &GPS_TaskControlBlock,
+  .cb_size = sizeof(GPS_TaskControlBlock),
+  .stack_mem = &GPS_TaskBuffer[0],
+  .stack_size = sizeof(GPS_TaskBuffer),
+  .priority = (osPriority_t) osPriorityBelowNormal,
 };
-/* Definitions for JY901S_Task */
-osThreadId_t JY901S_TaskHandle;
+uint32_t JY901S_TaskBuffer[ 512 ];
+osStaticThreadDef_t JY901S_TaskControlBlock;
 const osThreadAttr_t JY901S_Task_attributes = {
   .name = "JY901S_Task",
-  .stack_size = 512 * 4,
-  .priority = (osPriority_t) osPriorityLow,
+  .cb_mem = &JY901S_TaskControlBlock,
+  .cb_size = sizeof(JY901S_TaskControlBlock),
+  .stack_mem = &JY901S_TaskBuffer[0],
+  .stack_size = sizeof(JY901S_TaskBuffer),
+  .priority = (osPriority_t) osPriorityNormal1,
 };
+#endif
+
+/* USER CODE END Variables */
 /* Definitions for Control */
 osThreadId_t ControlHandle;
+uint32_t ControlBuffer[ 512 ];
+osStaticThreadDef_t ControlControlBlock;
 const osThreadAttr_t Control_attributes = {
   .name = "Control",
-  .stack_size = 512 * 4,
-  .priority = (osPriority_t) osPriorityLow,
+  .cb_mem = &ControlControlBlock,
+  .cb_size = sizeof(ControlControlBlock),
+  .stack_mem = &ControlBuffer[0],
+  .stack_size = sizeof(ControlBuffer),
+  .priority = (osPriority_t) osPriorityNormal,
 };
-/* Definitions for SBUS */
-osMessageQueueId_t SBUSHandle;
-const osMessageQueueAttr_t SBUS_attributes = {
-  .name = "SBUS"
+/* Definitions for BlackBox_Task */
+osThreadId_t BlackBox_TaskHandle;
+uint32_t BlackBox_TaskBuffer[ 384 ];
+osStaticThreadDef_t BlackBox_TaskControlBlock;
+const osThreadAttr_t BlackBox_Task_attributes = {
+  .name = "BlackBox_Task",
+  .cb_mem = &BlackBox_TaskControlBlock,
+  .cb_size = sizeof(BlackBox_TaskControlBlock),
+  .stack_mem = &BlackBox_TaskBuffer[0],
+  .stack_size = sizeof(BlackBox_TaskBuffer),
+  .priority = (osPriority_t) osPriorityIdle,
 };
-/* Definitions for JY901S */
-osMessageQueueId_t JY901SHandle;
-const osMessageQueueAttr_t JY901S_attributes = {
-  .name = "JY901S"
+/* Definitions for Inputs */
+osEventFlagsId_t InputsHandle;
+osStaticEventGroupDef_t InputsControlBlock;
+const osEventFlagsAttr_t Inputs_attributes = {
+  .name = "Inputs",
+  .cb_mem = &InputsControlBlock,
+  .cb_size = sizeof(InputsControlBlock),
 };
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
-
-/* USER CODE END FunctionPrototypes */
-
+void RT_Stats_Callback(void *argument);
+static void RT_Stats_Timer(TimerHandle_t timer);
+#if !EXEC_ENABLE
 void SBUS_Recevie(void *argument);
 void GPS_Receive(void *argument);
 void JY901S_Receive(void *argument);
+#endif
+
+/* USER CODE END FunctionPrototypes */
+
 void Start_Control(void *argument);
+void BlackBox_Write(void *argument);
 
 void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 
+/* Hook prototypes */
+void configureTimerForRunTimeStats(void);
+unsigned long getRunTimeCounterValue(void);
+
+/* USER CODE BEGIN 1 */
+/* Functions needed when configGENERATE_RUN_TIME_STATS is on */
+/**
+  * @brief  运行时统计时钟初始化（vTaskStartScheduler中调用）
+  * @note   TimeBase_Init已开启DWT，这里只在未开启时补开，不清零计数
+  */
+void configureTimerForRunTimeStats(void)
+{
+  if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0U) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  }
+}
+
+unsigned long getRunTimeCounterValue(void)
+{
+  return DWT->CYCCNT + timebase_sleep_cycles;
+}
+/* USER CODE END 1 */
+
 /**
   * @brief  FreeRTOS initialization
   * @param  None
@@ -119,116 +198,122 @@ void MX_FREERTOS_Init(void) {
 
   /* USER CODE BEGIN RTOS_TIMERS */
   /* start timers, add new ones, ... */
+  RT_StatsHandle = xTimerCreateStatic("RT_Stats", pdMS_TO_TICKS(RT_STATS_PERIOD_MS), pdTRUE, NULL,
+                                      RT_Stats_Timer, &RT_StatsTimerBuffer);
+  xTimerStart(RT_StatsHandle, 0);
   /* USER CODE END RTOS_TIMERS */
 
-  /* Create the queue(s) */
-  /* creation of SUBS */
-  SBUSHandle = osMessageQueueNew (16, sizeof(SBUS_Command_t*), &SBUS_attributes);
-
-  /* creation of JY901S */
-  JY901SHandle = osMessageQueueNew (16, sizeof(jy901*), &JY901S_attributes);
-
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
   /* USER CODE END RTOS_QUEUES */
 
   /* Create the thread(s) */
-  /* creation of SBUS_Task */
-  SBUS_TaskHandle = osThreadNew(SBUS_Recevie, NULL, &SBUS_Task_attributes);
-
-  /* creation of GPS_Task */
-  GPS_TaskHandle = osThreadNew(GPS_Receive, NULL, &GPS_Task_attributes);
-
-  /* creation of JY901S_Task */
-  JY901S_TaskHandle = osThreadNew(JY901S_Receive, NULL, &JY901S_Task_attributes);
-
   /* creation of Control */
   ControlHandle = osThreadNew(Start_Control, NULL, &Control_attributes);
 
+  /* creation of BlackBox_Task */
+  BlackBox_TaskHandle = osThreadNew(BlackBox_Write, NULL, &BlackBox_Task_attributes);
+
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+#if EXEC_ENABLE
+  SBUS_TaskHandle = ControlHandle;
+  GPS_TaskHandle = ControlHandle;
+  JY901S_TaskHandle = ControlHandle;
+#else
+  SBUS_TaskHandle = osThreadNew(SBUS_Recevie, NULL, &SBUS_Task_attributes);
+  GPS_TaskHandle = osThreadNew(GPS_Receive, NULL, &GPS_Task_attributes);
+  JY901S_TaskHandle = osThreadNew(JY901S_Receive, NULL, &JY901S_Task_attributes);
+#endif
   /* USER CODE END RTOS_THREADS */
 
+  /* Create the event(s) */
+  /* creation of Inputs */
+  InputsHandle = osEventFlagsNew(&Inputs_attributes);
+
   /* USER CODE BEGIN RTOS_EVENTS */
   /* add events, ... */
+  // 调度事件记录只记录设置了对象号的事件组
+  vEventGroupSetNumber(InputsHandle, TRACE_OBJ_INPUTS);
   /* USER CODE END RTOS_EVENTS */
 
 }
 
-/* USER CODE BEGIN Header_SUBS_Recevie */
-/**
-  * @brief  Function implementing the SUBS_Task thread.
-  * @param  argument: Not used
-  * @retval None
-  */
-/* USER CODE END Header_SUBS_Recevie */
-__weak void SBUS_Recevie(void *argument)
-{
-  /* USER CODE BEGIN SUBS_Recevie */
-  /* Infinite loop */
-  for(;;)
-  {
-    osDelay(1);
-  }
-  /* USER CODE END SUBS_Recevie */
-}
-
-/* USER CODE BEGIN Header_GPS_Receive */
+/* USER CODE BEGIN Header_Start_Control */
 /**
-* @brief Function implementing the GPS_Task thread.
+* @brief Function implementing the Control thread.
 * @param argument: Not used
 * @retval None
 */
-/* USER CODE END Header_GPS_Receive */
-__weak void GPS_Receive(void *argument)
+/* USER CODE END Header_Start_Control */
+__weak void Start_Control(void *argument)
 {
-  /* USER CODE BEGIN GPS_Receive */
+  /* USER CODE BEGIN Start_Control */
   /* Infinite loop */
   for(;;)
   {
     osDelay(1);
   }
-  /* USER CODE END GPS_Receive */
+  /* USER CODE END Start_Control */
 }
 
-/* USER CODE BEGIN Header_JY901S_Receive */
+/* USER CODE BEGIN Header_BlackBox_Write */
 /**
-* @brief Function implementing the JY901S_Task thread.
+* @brief Function implementing the BlackBox_Task thread.
 * @param argument: Not used
 * @retval None
 */
-/* USER CODE END Header_JY901S_Receive */
-__weak void JY901S_Receive(void *argument)
+/* USER CODE END Header_BlackBox_Write */
+__weak void BlackBox_Write(void *argument)
 {
-  /* USER CODE BEGIN JY901S_Receive */
+  /* USER CODE BEGIN BlackBox_Write */
   /* Infinite loop */
   for(;;)
   {
     osDelay(1);
   }
-  /* USER CODE END JY901S_Receive */
+  /* USER CODE END BlackBox_Write */
 }
 
-/* USER CODE BEGIN Header_Start_Control */
+/* Private application code --------------------------------------------------*/
+/* USER CODE BEGIN Application */
 /**
-* @brief Function implementing the Control thread.
-* @param argument: Not used
-* @retval None
-*/
-/* USER CODE END Header_Start_Control */
-__weak void Start_Control(void *argument)
+  * @brief  RT_Stats统计窗口定时器回调（定时器服务任务中执行），转到RT_Stats_Callback
+  */
+static void RT_Stats_Timer(TimerHandle_t timer)
 {
-  /* USER CODE BEGIN Start_Control */
-  /* Infinite loop */
-  for(;;)
-  {
-    osDelay(1);
+  (void)timer;
+  RT_Stats_Callback(NULL);
+}
+/**
+  * @brief  记录一次任务切换耗时（移植层PendSV退出前调用，见FreeRTOSConfig.h）
+  * @param  cycles: PendSV进入到退出的DWT周期
+  * @param  in_tcb: 换入任务
+  * @param  out_tcb: 换出任务，与换入相同说明仍是原任务，不计入
+  */
+void OS_Switch_Record(uint32_t cycles, void *in_tcb, void *out_tcb)
+{
+  if (in_tcb == out_tcb) {
+    return;
+  }
+  os_switch_stats.count++;
+  os_switch_stats.cycles_sum += cycles;
+  if (cycles > os_switch_stats.cycles_max) {
+    os_switch_stats.cycles_max = cycles;
   }
-  /* USER CODE END Start_Control */
 }
-
-/* Private application code --------------------------------------------------*/
-/* USER CODE BEGIN Application */
+/**
+  * @brief  全部任务栈的总字节数（含空闲与定时器服务任务，经遥测task消息上报，对比多任务与执行器布局）
+  */
+uint32_t OS_Task_Stack_Bytes(void)
+{
+  uint32_t bytes = sizeof(ControlBuffer) + sizeof(BlackBox_TaskBuffer)
+                 + (configMINIMAL_STACK_SIZE + configTIMER_TASK_STACK_DEPTH) * sizeof(StackType_t);
+#if !EXEC_ENABLE
+  bytes += sizeof(SBUS_TaskBuffer) + sizeof(GPS_TaskBuffer) + sizeof(JY901S_TaskBuffer);
+#endif
+  return bytes;
+}
 
 /* USER CODE END Application */
 
@@ -19,6 +19,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "cmsis_os.h"
+#include "crc.h"
 #include "dma.h"
 #include "tim.h"
 #include "usart.h"
@@ -29,9 +30,23 @@
 #include <stdio.h>
 #include <string.h>
 #include "steering.h"
-#include "sbus.h"
-#include "jy901s.h"
-#include "NMEA_ATGM336H.h"
+#include "SBUS_T.h"
+#include "JY901S.h"
+#include "GPS_T.h"
+#include "NAV_Filter.h"
+#include "Autopilot.h"
+#include "UART_TX.h"
+#include "Telemetry.h"
+#include "CMD_Arbiter.h"
+#include "Uplink.h"
+#include "FMT.h"
+#include "BlackBox.h"
+#include "MEM_Cache.h"
+#include "Trace.h"
+#include "TimeBase.h"
+#include "Power.h"
+#include "Capture.h"
+#include "Bench.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -41,10 +56,7 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-#define RX_BUFFER_SIZE 512
-static uint8_t uart6_rx_buffer[RX_BUFFER_SIZE];
-static uint16_t uart6_rx_index = 0;
-static uint8_t uart6_receiving = 0;
+
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -78,6 +90,7 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
+  MEM_Init();                   // MPU（RAM_D2不可缓存）+ I/D缓存，需在HAL_Init之前
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -106,17 +119,38 @@ int main(void)
   MX_USART3_UART_Init();
   MX_USART6_UART_Init();
   MX_TIM4_Init();
+  MX_CRC_Init();
+  MX_TIM24_Init();
   /* USER CODE BEGIN 2 */
+  TimeBase_Init(&htim24);       // 微秒时基，需在任何传感器/遥测时间戳之前启动
+  Power_Init();                 // 无节拍空闲睡眠与时钟档（默认性能档），需在TimeBase之后
   HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_2);
   HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
 
-  // SBUS_Control_Init(&huart1);
-  // GPS_Parser_Init();
-  // UART6_Receive_Start();
+  UART_TX_Init(&huart_debug);   // 调试串口异步发送，需在其他模块打印前初始化
+#if BENCH_ENABLE
+  Bench_Main();                 // 微基准测试镜像（CMake目标FISH_H7_bench）：传感器DMA与调度器不启动，不返回
+#endif
+  Capture_Init();               // 传感器原始数据采集（默认关闭），需在各传感器启动DMA接收之前
+  SBUS_Init(&huart1,&huart_debug);
 
 
   //Gyroscope_Rrate(&huart2);
   Gyroscope_Init(&huart_JY901S,&huart_debug);
+  GPS_Init(&huart_GPS,&huart_debug);
+  NAV_Init();
+  Trace_Init();                 // 调度事件记录（使用TimeBase_Init开启的DWT计数器）
+  AP_Init();
+  Telemetry_Init();
+  BlackBox_Init();              // 扫描记录区并擦除首个扇区（阻塞，需在调度器启动前）
+  CMD_Arbiter_Init();
+  Uplink_Init(&huart_debug);    // 地面站命令与遥测共用调试串口
+#if FMT_BENCH
+  FMT_Bench();                  // FMT与newlib浮点printf周期对比（CMake选项FISH_PRINTF_FLOAT）
+#endif
+#if MEM_BENCH
+  MEM_Bench();                  // 步态/NMEA解析关缓存与开缓存周期对比（CMake选项FISH_CACHE_BENCH）
+#endif
   //HAL_UART_Transmit(&huart3, (uint8_t*)"hall\n", sizeof("hall\n"), 100);
 
   /* USER CODE END 2 */
@@ -205,14 +239,6 @@ void SystemClock_Config(void)
 }
 
 /* USER CODE BEGIN 4 */
-void UART6_Receive_Start(void)
-{
-  uart6_rx_index = 0;
-  uart6_receiving = 1;
-  memset(uart6_rx_buffer, 0, RX_BUFFER_SIZE);
-  HAL_UART_Receive_IT(&huart6, &uart6_rx_buffer[uart6_rx_index], 1);
-}
-
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
   if (huart->Instance == USART1) {
@@ -222,63 +248,45 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
   {
     //jy901s_data_ready = 1; // 只是设置标志
   }
-  if (huart->Instance == USART6 && uart6_receiving) {
-
-    // 如果收到换行符，表示一条完整的NMEA语句接收完成
-    if (uart6_rx_buffer[uart6_rx_index] == '\n') {
-      // 确保字符串以null结尾
-      if (uart6_rx_index < RX_BUFFER_SIZE - 1) {
-        uart6_rx_buffer[uart6_rx_index + 1] = '\0';
-      } else {
-        uart6_rx_buffer[RX_BUFFER_SIZE - 1] = '\0';
-      }
-
-      // 打印原始数据用于调试
-      printf("Raw NMEA: %s", uart6_rx_buffer);
-
-      // 解析NMEA数据
-      GPS_Parse_NMEA((char*)uart6_rx_buffer);
-
-      // 获取解析后的GPS数据
-      GPS_Data_t gps_data;
-      GPS_Get_Data(&gps_data);
-
-      // 打印解析结果
-      if (gps_data.is_valid) {
-        printf("Valid GPS - Lat:%s%c, Lon:%s%c\n",
-               gps_data.latitude, gps_data.ns_indicator,
-               gps_data.longitude, gps_data.ew_indicator);
-      } else {
-        // printf("Inv alid GPS data or no signal\n");
-      }
-
-      // 重置接收缓冲区
-      uart6_rx_index = 0;
-      memset(uart6_rx_buffer, 0, RX_BUFFER_SIZE);
-    }
-    else if (uart6_rx_buffer[uart6_rx_index] == '\r') {
-      // 忽略回车符，不增加索引
-    }
-    else if (uart6_rx_buffer[uart6_rx_index] == '$') {
-      // 如果是新语句的开始，重置缓冲区
-      uart6_rx_index = 0;
-      memset(uart6_rx_buffer, 0, RX_BUFFER_SIZE);
-      uart6_rx_buffer[uart6_rx_index] = '$';
-      uart6_rx_index++;
-    }
-    else {
-      // 正常字符，增加索引
-      uart6_rx_index++;
-
-      // 防止缓冲区溢出
-      if (uart6_rx_index >= RX_BUFFER_SIZE - 1) {
-        uart6_rx_index = 0;  // 缓冲区满时重置
-        memset(uart6_rx_buffer, 0, RX_BUFFER_SIZE);
-      }
-    }
-
-    // 继续接收下一个字符
-    HAL_UART_Receive_IT(&huart6, &uart6_rx_buffer[uart6_rx_index], 1);
+}
+
+FAST_CODE void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  if (huart->Instance == USART1) {
+    SBUS_RxEventCallback(huart, Size);
+  }
+  if (huart->Instance == USART2) {
+    Gyroscope_RxEventCallback(huart, Size);
+  }
+  if (huart->Instance == USART6) {
+    GPS_RxEventCallback(huart, Size);
+  }
+  if (huart->Instance == USART3) {
+    Uplink_RxEventCallback(huart, Size);
+  }
+}
+
+FAST_CODE void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART3) {
+    UART_TX_TxCpltCallback(huart);
+  }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART1) {
+    SBUS_ErrorCallback(huart);
+  }
+  if (huart->Instance == USART2) {
+    Gyroscope_ErrorCallback(huart);
+  }
+  if (huart->Instance == USART6) {
+    GPS_ErrorCallback(huart);
+  }
+  if (huart->Instance == USART3) {
+    UART_TX_ErrorCallback(huart);
+    Uplink_ErrorCallback(huart);
   }
 }
 /* USER CODE END 4 */
@@ -301,7 +309,9 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     HAL_IncTick();
   }
   /* USER CODE BEGIN Callback 1 */
-
+  if (htim->Instance == TIM24) {
+    TimeBase_Overflow_Callback(htim);
+  }
   /* USER CODE END Callback 1 */
 }
 
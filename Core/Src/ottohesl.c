@@ -8,16 +8,21 @@
   ******************************************************************************
   * @note
   * 1. 调试模式通过宏 debug_mode/LCD 控制，关闭后无冗余代码开销
-  * 2. H7系列DMA无法访问0x20000000地址，需将缓存数组映射到0x24000000开始的SRAM2
+  * 2. H7系列DMA无法访问0x20000000地址，缓存数组用DMA_BUFFER放入RAM_D2（0x30000000，不可缓存）
   * 3. 依赖头文件 ottohesl.h（需定义 OTTOHESL_UART_BUFFER 缓存大小）
   * 4. 依赖LCD驱动函数（LCD_SetTextFont/LCD_SetColor等）、HAL库串口驱动
   ******************************************************************************
   *@更新日志              版本                      更新内容
   *2025/12/11           v1.0       封装串口、dma串口发送的集成函数，并配置调试模式
   *2025/12/23           v1.1
+ *2026/01/16           v1.2       UART_TX接管的串口改为写入异步发送环形缓冲区，格式化缓存改在栈上（可重入）
+ *2026/01/19           v1.3       格式化改用FMT_Vsnprintf，不再依赖newlib浮点printf（-u _printf_float）
+ *2026/01/20           v1.4       格式化缓存改用DMA_BUFFER放入RAM_D2不可缓存区（开启D缓存后DMA发送数据一致）
   *
  */
 #include "ottohesl.h"
+#include "MEM_Cache.h"
+#include "Trace.h"
 
 /**
  * @defgroup UART_DEBUG_CONFIG 串口调试配置宏
@@ -28,26 +33,57 @@
 #define LCD         0       /**< LCD调试模式开关：1=开启（显示HAL状态到1.54寸LCD），0=关闭 */
 /** @} */
 
+#if OTTOHESL_UART_TX
+/**
+  * @brief  格式化后写入UART_TX异步发送环形缓冲区
+  * @param  fmt: 格式化字符串
+  * @param  args: 可变参数列表
+  * @retval 无
+  * @note   1. 缓存在调用者栈上，多任务同时调用互不覆盖
+  *         2. 与轮询模式一致：末尾添加换行符，超长时发送"length error\n"
+  */
+static void ottohesl_uart_tx(const char *fmt, va_list args) {
+    char message[OTTOHESL_UART_BUFFER];
+    int len = FMT_Vsnprintf(message, sizeof(message) - 1, fmt, args);
+    if (len < 0 || len >= (int)sizeof(message) - 1) {
+        UART_TX_Write("length error\n", strlen("length error\n"));
+        return;
+    }
+    message[len++] = '\n';
+    UART_TX_Write(message, (uint32_t)len);
+}
+#endif
+
 /**
   * @brief  格式化串口发送函数（轮询模式：sprintf + HAL_UART_Transmit）
   * @param  huart: 串口句柄指针（如 &huart1）
-  * @param  fmt: 格式化字符串（支持%d/%s/%f等占位符，如 "temp: %.2f°C"）
+  * @param  fmt: 格式化字符串（支持%d/%u/%x/%s/%.Nf等占位符，如 "temp: %.2f°C"，完整列表见FMT.h）
   * @param  ...: 可变参数列表，匹配fmt中的占位符
   * @retval 无
-  * @note   1. 静态缓存区映射到SRAM2（.ram段），避免H7系列DMA地址限制
+  * @note   1. 静态缓存区用DMA_BUFFER放入RAM_D2不可缓存区，避免H7系列DMA地址限制
   *         2. 自动在发送内容末尾添加换行符\n，提升串口打印可读性
   *         3. 缓存溢出时发送"length error\n"错误提示，超时时间100ms
   *         4. debug_mode=1时，调用uart_debugger输出发送状态
   */
 void ottohesl_uart(UART_HandleTypeDef *huart, const char *fmt, ...) {
-    /* 静态缓存区：映射到链接脚本定义的.ram段（SRAM2，0x24000000开始），避免H7 DMA地址限制 */
-    static char message[OTTOHESL_UART_BUFFER] __attribute__((section(".ram")));
+#if OTTOHESL_UART_TX
+    /* 异步发送：UART_TX接管的串口写入环形缓冲区，不阻塞 */
+    if (UART_TX_Owns(huart)) {
+        va_list tx_args;
+        va_start(tx_args, fmt);
+        ottohesl_uart_tx(fmt, tx_args);
+        va_end(tx_args);
+        return;
+    }
+#endif
+    /* 静态缓存区：DMA_BUFFER放入链接脚本.dma_buffer段（RAM_D2，不可缓存），避免H7 DMA地址限制 */
+    static char message[OTTOHESL_UART_BUFFER] DMA_BUFFER;
     va_list args;            /* 可变参数列表 */
     /* 串口发送状态 */
 
     /* 1. 解析可变参数，格式化字符串到缓存 */
     va_start(args, fmt);
-    int len = vsnprintf(message, sizeof(message), fmt, args);
+    int len = FMT_Vsnprintf(message, sizeof(message), fmt, args);
     va_end(args);
 
     /* 2. 检查格式化结果：长度异常则发送错误提示 */
@@ -63,7 +99,9 @@ void ottohesl_uart(UART_HandleTypeDef *huart, const char *fmt, ...) {
     }
 
     /* 4. 轮询模式发送格式化数据 */
+    TRACE_BEGIN(TRACE_MARK_UART_BLOCKING);
     HAL_StatusTypeDef uart_tx_status = HAL_UART_Transmit(huart, (uint8_t *) message, len, 100);
+    TRACE_END(TRACE_MARK_UART_BLOCKING);
 
     /* 5. 调试模式：输出发送状态（串口/LCD） */
 #if debug_mode
@@ -74,32 +112,36 @@ void ottohesl_uart(UART_HandleTypeDef *huart, const char *fmt, ...) {
 /**
   * @brief  格式化串口发送函数（DMA模式：sprintf + HAL_UART_Transmit_DMA）
   * @param  huart: 串口句柄指针（如 &huart1）
-  * @param  fmt: 格式化字符串（支持%d/%s/%f等占位符）
+  * @param  fmt: 格式化字符串（支持%d/%u/%x/%s/%.Nf等占位符）
   * @param  ...: 可变参数列表，匹配fmt中的占位符
   * @retval 无
   * @attention 关键注意事项（H7系列必看）：
-  *           1. H7的DMA控制器无法直接访问0x20000000起始的SRAM1地址，需将缓存映射到0x24000000开始的SRAM2
-  *           2. 需在LD链接脚本末尾添加以下段定义，将.ram段映射到SRAM2：
-  *              @code
-  *              .sram_msg :
-  *              {
-  *                  . = ALIGN(4);
-  *                  *(.ram)           // 匹配代码中的__attribute__((section(".ram")))
-  *              } > RAM             // RAM段需指向SRAM2（0x24000000）
-  *              @endcode
+  *           1. H7的DMA控制器无法访问0x20000000起始的DTCM，缓存需放在DMA可访问的区域
+  *           2. 开启D缓存后DMA读到的可能是未写回的旧数据，缓存用DMA_BUFFER（MEM_Cache.h）放入
+  *              链接脚本.dma_buffer段（RAM_D2，0x30000000，MPU设为不可缓存），无需缓存维护
   * @note   1. 功能逻辑与轮询模式一致，仅发送接口替换为DMA（非阻塞）
   *         2. debug_mode=1时，调用uart_debugger输出DMA发送状态
   *         3. 缓存溢出时仍使用轮询模式发送错误提示
   */
 void ottohesl_uart_dma(UART_HandleTypeDef *huart, const char *fmt, ...) {
-    /* 静态缓存区：映射到SRAM2的.ram段，规避H7 DMA地址限制 */
-    static char message[OTTOHESL_UART_BUFFER] __attribute__((section(".ram")));
+#if OTTOHESL_UART_TX
+    /* UART_TX接管的串口本身就是DMA异步发送，与ottohesl_uart相同处理 */
+    if (UART_TX_Owns(huart)) {
+        va_list tx_args;
+        va_start(tx_args, fmt);
+        ottohesl_uart_tx(fmt, tx_args);
+        va_end(tx_args);
+        return;
+    }
+#endif
+    /* 静态缓存区：放入RAM_D2不可缓存区，规避H7 DMA地址限制与缓存一致性问题 */
+    static char message[OTTOHESL_UART_BUFFER] DMA_BUFFER;
     va_list args;            /* 可变参数列表 */
     /* DMA发送状态 */
 
     /* 1. 解析可变参数，格式化字符串到缓存 */
     va_start(args, fmt);
-    int len = vsnprintf(message, sizeof(message), fmt, args);
+    int len = FMT_Vsnprintf(message, sizeof(message), fmt, args);
     va_end(args);
 
     /* 2. 检查格式化结果：长度异常则发送错误提示（轮询模式） */
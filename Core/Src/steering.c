@@ -1,7 +1,16 @@
 
 #include "steering.h"
-#include <math.h>
+#include "arm_math.h"        // 步态正弦用arm_sin_f32（查表线性插值，比libm的sinf快，精度对整数度的舵机角度足够）
 #include <stdio.h>
+#include "MEM_Cache.h"
+#include "TimeBase.h"
+
+// 步态调试打印：状态机每个控制周期运行，打印会占满调试串口，只在台架调试时打开（FISH_DEBUG_MODE）
+#if FISH_DEBUG_MODE
+#define FISH_LOG(...) printf(__VA_ARGS__)
+#else
+#define FISH_LOG(...) ((void)0)
+#endif
 
 // 舵机脉冲宽度范围
 #define SERVO_MIN_PULSE 50
@@ -11,7 +20,7 @@ uint16_t servo_angle_tail = 90;  // 鱼尾舵机角度
 uint16_t servo_angle_body = 97;  // 鱼身舵机角度
 // 运动参数
 uint16_t swing_amplitude = 30;   // 摆动幅度
-uint16_t swing_speed = 10;       // 摆动速度
+uint16_t swing_speed = FISH_SPEED_DEFAULT; // 手动前进摆动速度档（退出设定时恢复）
 uint32_t swing_counter = 0;      // 摆动计数器
 
 // 转向参数
@@ -20,13 +29,13 @@ uint16_t turn_tail_bias = 10;        // 尾巴转向偏置角度（左转为正
 
 FishState_t current_state = STATE_STOP;
 Command_t current_command = CMD_STOP;  // 添加这行定义
-uint32_t state_start_time = 0;
+uint64_t state_start_time = 0;          // 状态开始时间（TimeBase微秒）
 
 static float prepare_progress = 0.0f;
 static uint32_t diff=0;
 //标志位，记录转向状态
 static uint32_t turn_start_counter = 0;
-static uint32_t turn_swing_start_time = 0; // 修正：添加摆动阶段开始时间变量
+static uint64_t turn_swing_start_time = 0; // 修正：添加摆动阶段开始时间变量（TimeBase微秒）
 // 标志是否处于左转准备阶段
 static uint8_t is_turn_prepare_phase = 0;
 
@@ -34,12 +43,14 @@ static uint8_t is_turn_done = 0;
 // 状态控制
 const uint32_t STATE_DURATION = 3575; // 5秒
 
-uint8_t speed=2;
+uint8_t speed=FISH_SPEED_DEFAULT;
+// 自动驾驶转向偏置（-1~1，正值向右），只作用于前进摆动
+static float steer_bias = 0.0f;
 
 
 
 // 新增：回中值状态变量
-static uint32_t return_start_time = 0;
+static uint64_t return_start_time = 0;
 const uint32_t RETURN_DURATION = 500;  // 回中值过渡时间（500ms）
 static uint16_t return_start_body_angle = 97;  // 回中值开始时的身体角度
 static uint16_t return_start_tail_angle = 90;  // 回中值开始时的尾巴角度
@@ -51,7 +62,7 @@ static uint8_t history_index = 0;
 
 // 新增：准备阶段进度控制
 
-static uint32_t prepare_start_time = 0;
+static uint64_t prepare_start_time = 0;
 const uint32_t PREPARE_DURATION = 700; // 准备阶段持续时间
 
 // 新增：保存前进时的最后角度
@@ -62,7 +73,7 @@ static uint16_t forward_final_tail_angle = 90;
 static uint8_t turn_executed = 0;
 static Command_t pending_command = CMD_FORWARD;
 
-void Set_Servo_Angle(TIM_HandleTypeDef *htim, uint32_t Channel, uint16_t angle)
+FAST_CODE void Set_Servo_Angle(TIM_HandleTypeDef *htim, uint32_t Channel, uint16_t angle)
 {
     uint16_t pulse_width;
 
@@ -81,9 +92,12 @@ void Set_Swing_Amplitude(uint16_t amplitude)
     swing_amplitude = amplitude;
 }
 
-void Set_Swing_Speed(uint16_t speed)
+void Set_Swing_Speed(uint16_t new_speed)
 {
-    swing_speed = speed;
+    if (new_speed < 1) new_speed = 1;
+    if (new_speed > 10) new_speed = 10;
+    swing_speed = new_speed;
+    speed = (uint8_t)new_speed;
 }
 
 void Set_Turn_Parameters(uint16_t body_bias, uint16_t tail_bias)
@@ -108,17 +122,17 @@ void Fish_Stop(void)
     is_turn_prepare_phase=1;
 }
 
-void Fish_Forward(void)
+FAST_CODE void Fish_Forward(void)
 {
-    printf("机械鱼前进\n");
+    FISH_LOG("机械鱼前进\n");
     // 计算正弦波角度
     float radian = swing_counter * 0.01f;
 
-    // 鱼身舵机：较小的幅度，基础相位
-    servo_angle_body = 97 + swing_amplitude * 0.6f * sinf(radian);
+    // 鱼身舵机：较小的幅度，基础相位（自动驾驶时摆动中值按转向偏置偏移）
+    servo_angle_body = 97 + steer_bias * turn_body_bias + swing_amplitude * 0.6f * arm_sin_f32(radian);
 
     // 鱼尾舵机：较大的幅度，滞后相位（身体先动，尾巴后动）
-    servo_angle_tail = 90 + swing_amplitude * 0.8f * sinf(radian - 1.57f);
+    servo_angle_tail = 90 + steer_bias * turn_tail_bias + swing_amplitude * 0.8f * arm_sin_f32(radian - 1.57f);
 
     // 限制角度范围
     if (servo_angle_body > 180) servo_angle_body = 180;
@@ -144,9 +158,9 @@ void Fish_TurnLeft_Prepare(void)
 {
 
     // 计算准备进度
-    printf("机械鱼准备右转\n");
-    uint32_t current_time = HAL_GetTick();
-    prepare_progress = (float)(current_time - prepare_start_time) / PREPARE_DURATION;
+    FISH_LOG("机械鱼准备右转\n");
+    uint64_t current_time = TimeBase_Now_us();
+    prepare_progress = (float)(current_time - prepare_start_time) / (float)TIMEBASE_MS(PREPARE_DURATION);
     if (prepare_progress > 1.0f) prepare_progress = 1.0f;
 
     // 修改：使用缓动函数（ease-in-out）使过渡更平滑
@@ -183,17 +197,14 @@ void Fish_TurnLeft_Prepare(void)
     // 保存身体角度历史
     body_angle_history[history_index] = servo_angle_body;
     history_index = (history_index + 1) % 10;
-
-    // 修改：减少延迟时间，使移动更流畅
-    HAL_Delay(5);
 }
 
 void Fish_TurnRight_Prepare(void)
 {
-    printf("机械鱼准备左转\n");
+    FISH_LOG("机械鱼准备左转\n");
 
-    uint32_t current_time = HAL_GetTick();
-    prepare_progress = (float)(current_time - prepare_start_time) / PREPARE_DURATION;
+    uint64_t current_time = TimeBase_Now_us();
+    prepare_progress = (float)(current_time - prepare_start_time) / (float)TIMEBASE_MS(PREPARE_DURATION);
     if (prepare_progress > 1.0f) prepare_progress = 1.0f;
 
     float ease_progress;
@@ -228,15 +239,14 @@ void Fish_TurnRight_Prepare(void)
 
     body_angle_history[history_index] = servo_angle_body;
     history_index = (history_index + 1) % 10;
-    HAL_Delay(5);
 }
 
 
 
 void Fish_TurnLeft_Swing(void)
 {
-    printf("机械鱼右转\n");
-    uint32_t current_time = HAL_GetTick();
+    FISH_LOG("机械鱼右转\n");
+    uint64_t current_time = TimeBase_Now_us();
 
 
     // 使用更快的正弦波角度（快速摆动）
@@ -249,14 +259,14 @@ void Fish_TurnLeft_Swing(void)
     // 修改：直接使用准备阶段结束时的角度作为起始点
     // 计算从准备阶段结束角度到摆动目标角度的过渡
 
-    float transition_progress = (float)(current_time - turn_swing_start_time) / 200.0f; // 减少过渡时间到200ms
+    float transition_progress = (float)(current_time - turn_swing_start_time) / (float)TIMEBASE_MS(200); // 减少过渡时间到200ms
     if (transition_progress > 1.0f) transition_progress = 1.0f;
 
     // 修改：使用线性过渡，避免缓动函数的初始缓慢
     float ease_transition = transition_progress; // 线性过渡
 
     // 鱼身舵机：从准备阶段角度平滑过渡到摆动角度
-    float body_sin = sinf(radian);
+    float body_sin = arm_sin_f32(radian);
     float body_amplitude = swing_amplitude * 0.5f;    //身体摆动的最大角度偏移量,控制身体左右摆动的范围大小
     float body_offset = 97 - body_bias; // 左转中值
 
@@ -272,7 +282,7 @@ void Fish_TurnLeft_Swing(void)
 
     // 修改：直接计算尾巴角度，不使用历史角度
     float tail_radian = radian; ; // 数字越大相位滞后越大
-    float tail_sin = sinf(tail_radian);
+    float tail_sin = arm_sin_f32(tail_radian);
     float tail_offset = 90 - tail_bias;
     float tail_amplitude_factor = 1.8f;
 
@@ -302,20 +312,17 @@ void Fish_TurnLeft_Swing(void)
     // 快速更新计数器（使摆动更快）
     static uint32_t last_counter = 0;
     swing_counter += 4;  // 增加步进值，使摆动更快
-    printf("左转摆动: 前值=%d, 当前值=%d\n", last_counter, swing_counter);
+    FISH_LOG("左转摆动: 前值=%lu, 当前值=%lu\n", (unsigned long)last_counter, (unsigned long)swing_counter);
     last_counter = swing_counter;
     if (swing_counter > 628) {
         swing_counter = 0;
     }
-
-    // 控制舵机运动速度（摆动阶段较快）
-    HAL_Delay(1);
 }
 
 void Fish_TurnRight_Swing (void)
 {
-    printf("机械鱼左转\n");
-    uint32_t current_time = HAL_GetTick();
+    FISH_LOG("机械鱼左转\n");
+    uint64_t current_time = TimeBase_Now_us();
 
     float radian = swing_counter * 0.01f;    //对应就是4.71弧度=3π/2 ≈ 270度 O°  1.57弧度=π/2
 
@@ -323,12 +330,12 @@ void Fish_TurnRight_Swing (void)
     float tail_bias = 15.0f;
 
 
-    float transition_progress = (float)(current_time - turn_swing_start_time) / 200.0f;
+    float transition_progress = (float)(current_time - turn_swing_start_time) / (float)TIMEBASE_MS(200);
     if (transition_progress > 1.0f) transition_progress = 1.0f;
 
     float ease_transition = transition_progress;
 
-   float body_sin = sinf(radian);   //3π/2 ≈ 270度 -->sin(4.71) = -1（正弦波最低点） radian = 0（sin = 0）  radian = 1.57（π/2，sin = 1）
+   float body_sin = arm_sin_f32(radian);   //3π/2 ≈ 270度 -->sin(4.71) = -1（正弦波最低点） radian = 0（sin = 0）  radian = 1.57（π/2，sin = 1）
     float body_amplitude = swing_amplitude * 0.5f;
     float body_offset = 97 + body_bias; // 右转中值（向右偏）
 
@@ -341,7 +348,7 @@ void Fish_TurnRight_Swing (void)
     history_index = (history_index + 1) % 10;
 
     float tail_radian = radian ;
-    float tail_sin = sinf(tail_radian);
+    float tail_sin = arm_sin_f32(tail_radian);
     float tail_offset = 90 + tail_bias; // 右转尾巴中值（向右偏）
     float tail_amplitude_factor = 1.8f;
 
@@ -369,22 +376,58 @@ void Fish_TurnRight_Swing (void)
 
     static uint32_t last_counter = 0;
     swing_counter += 4;  // 增加步进值，使摆动更快
-    printf("左转摆动: 前值=%d, 当前值=%d\n", last_counter, swing_counter);
+    FISH_LOG("左转摆动: 前值=%lu, 当前值=%lu\n", (unsigned long)last_counter, (unsigned long)swing_counter);
     last_counter = swing_counter;
 
     if (swing_counter > 628)
     {
-        printf("重置计数器: %d -> 0\n", swing_counter);
+        FISH_LOG("重置计数器: %lu -> 0\n", (unsigned long)swing_counter);
         swing_counter = 0;
     }
-    // 增加适当的延迟使运动更平滑
-   // HAL_Delay(5);
+}
+
+/**
+ * @brief  自动驾驶设定
+ * @param  yaw_rate: 偏航角速度设定，°/s，顺时针（右转）为正
+ * @param  swing_speed: 摆动速度档（1-10）
+ * @note   1. 连续转向通过偏移前进摆动的中值实现，±FISH_YAW_RATE_MAX对应±turn_body_bias
+ *         2. 手动转向仍走原有的准备+摆动状态机，不受此设定影响
+ */
+void Fish_Set_Setpoint(float yaw_rate, uint8_t swing_speed)
+{
+    float bias = yaw_rate / FISH_YAW_RATE_MAX;
+    if (bias > 1.0f) bias = 1.0f;
+    if (bias < -1.0f) bias = -1.0f;
+    steer_bias = bias;
+
+    if (swing_speed < 1) swing_speed = 1;
+    if (swing_speed > 10) swing_speed = 10;
+    speed = swing_speed;
+}
+
+// 退出自动驾驶：清除偏置，恢复手动速度档
+void Fish_Clear_Setpoint(void)
+{
+    steer_bias = 0.0f;
+    speed = (uint8_t)swing_speed;
+}
+
+/**
+ * @brief  进入转向：记录准备阶段起点与起始角度
+ * @param  now_us: 当前时间（TimeBase微秒）
+ * @note   准备阶段按prepare_progress（距起点的时间/PREPARE_DURATION）插值，每个控制周期前进一步，不再阻塞延时
+ */
+static void Fish_Turn_Start(uint64_t now_us)
+{
+    prepare_start_time = now_us;
+    forward_final_body_angle = servo_angle_body;
+    forward_final_tail_angle = servo_angle_tail;
 }
 
 // 执行命令函数
 void Fish_ExecuteCommand(Command_t cmd)
 {
-    uint32_t current_time = HAL_GetTick();
+    uint64_t current_time = TimeBase_Now_us();
     current_command = cmd;
 
     switch (cmd)
@@ -399,20 +442,26 @@ void Fish_ExecuteCommand(Command_t cmd)
 
     case CMD_TURN_LEFT:
             // 初始化左转状态
+        if (current_state != STATE_TURN_LEFT) {
+            Fish_Turn_Start(current_time);
+            FISH_LOG("左\n");
+        }
         current_state = STATE_TURN_LEFT;
-        printf("左\n");    //有
            break;
 
     case CMD_TURN_RIGHT:
+        if (current_state != STATE_TURN_RIGHT) {
+            Fish_Turn_Start(current_time);
+        }
         current_state = STATE_TURN_RIGHT;
         break;
     }
 }
 
 
-void Fish_StateMachine(void)
+FAST_CODE void Fish_StateMachine(void)
 {
-    uint32_t current_time = HAL_GetTick();
+    uint64_t current_time = TimeBase_Now_us();
 
 
     switch (current_state) {
@@ -456,14 +505,14 @@ void Fish_StateMachine(void)
             if (is_turn_prepare_phase==1) {
                 Fish_TurnRight_Prepare();
                 if (prepare_progress >= 1.0f) {
-                    printf("准备结束\n");
+                    FISH_LOG("准备结束\n");
                     is_turn_prepare_phase = 2;
                     turn_start_counter = 157;
                     turn_swing_start_time = current_time;
                     swing_counter = 157;
                 }
             } if (is_turn_prepare_phase==2) {
-                printf("开始左转");
+                FISH_LOG("开始左转\n");
                 Fish_TurnRight_Swing();
                 uint32_t diff;
 
@@ -480,7 +529,7 @@ void Fish_StateMachine(void)
                     turn_executed = 1;
                     diff=0;
                 }
-                printf("diff=%d  标志位=%d\n", diff,is_turn_prepare_phase);
+                FISH_LOG("diff=%lu  标志位=%u\n", (unsigned long)diff, is_turn_prepare_phase);
             }
             break;
 
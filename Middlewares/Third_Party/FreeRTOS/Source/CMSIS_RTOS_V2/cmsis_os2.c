@@ -465,7 +465,7 @@ osThreadId_t osThreadNew (osThreadFunc_t func, void *argument, const osThreadAtt
         prio = (UBaseType_t)attr->priority;
       }
 
-      if ((prio < osPriorityIdle) || (prio > osPriorityISR) || ((attr->attr_bits & osThreadJoinable) == osThreadJoinable)) {
+      if ((prio < osPriorityIdle) || (prio > OS2_PRIORITY_MAX) || ((attr->attr_bits & osThreadJoinable) == osThreadJoinable)) {
         return (NULL);
       }
 
@@ -572,7 +572,7 @@ osStatus_t osThreadSetPriority (osThreadId_t thread_id, osPriority_t priority) {
   if (IS_IRQ()) {
     stat = osErrorISR;
   }
-  else if ((hTask == NULL) || (priority < osPriorityIdle) || (priority > osPriorityISR)) {
+  else if ((hTask == NULL) || (priority < osPriorityIdle) || (priority > OS2_PRIORITY_MAX)) {
     stat = osErrorParameter;
   }
   else {
@@ -84,6 +84,21 @@
 #define configUSE_OS2_MUTEX                   configUSE_MUTEXES
 #endif
 
+/*
+  Option to run with fewer than 56 FreeRTOS priorities (e.g. 32 for port optimised
+  task selection). Thread priorities above configMAX_PRIORITIES - 1 are then rejected
+  by osThreadNew and osThreadSetPriority.
+*/
+#ifndef configUSE_OS2_REDUCED_PRIORITIES
+#define configUSE_OS2_REDUCED_PRIORITIES      0
+#endif
+
+#if (configUSE_OS2_REDUCED_PRIORITIES == 1)
+#define OS2_PRIORITY_MAX                      ((osPriority_t)(configMAX_PRIORITIES - 1))
+#else
+#define OS2_PRIORITY_MAX                      osPriorityISR
+#endif
+
 
 /*
   CMSIS-RTOS2 FreeRTOS configuration check (FreeRTOSConfig.h).
@@ -290,7 +305,7 @@
   #error "Definition configUSE_16_BIT_TICKS must be zero to implement CMSIS-RTOS2 API."
 #endif
 
-#if (configMAX_PRIORITIES != 56)
+#if (configMAX_PRIORITIES != 56) && (configUSE_OS2_REDUCED_PRIORITIES == 0)
   /*
     CMSIS-RTOS2 defines 56 different priorities (see osPriority_t) and portable CMSIS-RTOS2
     implementation should implement the same number of priorities.
@@ -298,7 +313,7 @@
   */
   #error "Definition configMAX_PRIORITIES must equal 56 to implement Thread Management API."
 #endif
-#if (configUSE_PORT_OPTIMISED_TASK_SELECTION != 0)
+#if (configUSE_PORT_OPTIMISED_TASK_SELECTION != 0) && (configUSE_OS2_REDUCED_PRIORITIES == 0)
   /*
     CMSIS-RTOS2 requires handling of 56 different priorities (see osPriority_t) while FreeRTOS port
     optimised selection for Cortex core only handles 32 different priorities.
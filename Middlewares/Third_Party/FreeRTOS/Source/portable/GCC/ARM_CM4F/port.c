@@ -47,6 +47,13 @@
 	#define portNVIC_SYSTICK_CLK_BIT	( 0 )
 #endif
 
+/* Set configRECORD_SWITCH_CYCLES to 1 to have PendSV pass its DWT cycle count
+from entry to exit, with the incoming and outgoing TCBs, to
+OS_Switch_Record() just before it returns. */
+#ifndef configRECORD_SWITCH_CYCLES
+	#define configRECORD_SWITCH_CYCLES 0
+#endif
+
 /* Constants required to manipulate the core.  Registers first... */
 #define portNVIC_SYSTICK_CTRL_REG			( * ( ( volatile uint32_t * ) 0xe000e010 ) )
 #define portNVIC_SYSTICK_LOAD_REG			( * ( ( volatile uint32_t * ) 0xe000e014 ) )
@@ -434,6 +441,10 @@ void xPortPendSVHandler( void )
 
 	__asm volatile
 	(
+	#if( configRECORD_SWITCH_CYCLES == 1 )
+	"	ldr r12, pxDwtCyccntConst			\n" /* Entry time, read before any FPU instruction triggers lazy stacking. */
+	"	ldr r12, [r12]						\n"
+	#endif
 	"	mrs r0, psp							\n"
 	"	isb									\n"
 	"										\n"
@@ -447,7 +458,11 @@ void xPortPendSVHandler( void )
 	"	stmdb r0!, {r4-r11, r14}			\n" /* Save the core registers. */
 	"	str r0, [r2]						\n" /* Save the new top of stack into the first member of the TCB. */
 	"										\n"
+	#if( configRECORD_SWITCH_CYCLES == 1 )
+	"	stmdb sp!, {r0, r2, r3, r12}		\n" /* Also keep the outgoing TCB and the entry time. */
+	#else
 	"	stmdb sp!, {r0, r3}					\n"
+	#endif
 	"	mov r0, %0 							\n"
 	"	msr basepri, r0						\n"
 	"	dsb									\n"
@@ -455,7 +470,11 @@ void xPortPendSVHandler( void )
 	"	bl vTaskSwitchContext				\n"
 	"	mov r0, #0							\n"
 	"	msr basepri, r0						\n"
+	#if( configRECORD_SWITCH_CYCLES == 1 )
+	"	ldmia sp!, {r0, r2, r3, r12}		\n"
+	#else
 	"	ldmia sp!, {r0, r3}					\n"
+	#endif
 	"										\n"
 	"	ldr r1, [r3]						\n" /* The first item in pxCurrentTCB is the task top of stack. */
 	"	ldr r0, [r1]						\n"
@@ -469,6 +488,15 @@ void xPortPendSVHandler( void )
 	"	msr psp, r0							\n"
 	"	isb									\n"
 	"										\n"
+	#if( configRECORD_SWITCH_CYCLES == 1 )
+	"	ldr r0, pxDwtCyccntConst			\n" /* Exit time. */
+	"	ldr r0, [r0]						\n"
+	"	sub r0, r0, r12						\n" /* OS_Switch_Record( cycles, r1 = incoming TCB, r2 = outgoing TCB ). */
+	"	push {r3, r14}						\n"
+	"	bl OS_Switch_Record					\n"
+	"	pop {r3, r14}						\n"
+	"										\n"
+	#endif
 	#ifdef WORKAROUND_PMU_CM001 /* XMC4000 specific errata workaround. */
 		#if WORKAROUND_PMU_CM001 == 1
 	"			push { r14 }				\n"
@@ -480,6 +508,9 @@ void xPortPendSVHandler( void )
 	"										\n"
 	"	.align 4							\n"
 	"pxCurrentTCBConst: .word pxCurrentTCB	\n"
+	#if( configRECORD_SWITCH_CYCLES == 1 )
+	"pxDwtCyccntConst: .word 0xE0001004		\n" /* DWT->CYCCNT */
+	#endif
 	::"i"(configMAX_SYSCALL_INTERRUPT_PRIORITY)
 	);
 }
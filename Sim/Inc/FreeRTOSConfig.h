@@ -0,0 +1,28 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef SIM_FREERTOS_CONFIG_H
+#define SIM_FREERTOS_CONFIG_H
+
+// 仿真沿用固件的内核配置（优先级、静态分配、trace宏、运行时统计），只改与硬件相关的几项：
+// 1. 不用无节拍空闲：空闲钩子（Sim_Clock.c）把虚拟时间推进到下一个事件，节拍照常逐个投递
+// 2. 切换耗时/运行时统计读仿真DWT（Sim_DWT），不访问0xE0001004
+// 3. 断言失败打印位置后退出，不死循环
+#include "../../Core/Inc/FreeRTOSConfig.h"
+
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                  0
+#undef configPRE_SLEEP_PROCESSING
+#undef configPOST_SLEEP_PROCESSING
+#undef configUSE_IDLE_HOOK
+#define configUSE_IDLE_HOOK                      1
+
+#undef OS_DWT_CYCCNT
+#define OS_DWT_CYCCNT                            (DWT->CYCCNT)
+
+void Sim_Assert(const char *file, int line);
+#undef configASSERT
+#define configASSERT(x) if ((x) == 0) { Sim_Assert(__FILE__, __LINE__); }
+
+#endif //SIM_FREERTOS_CONFIG_H
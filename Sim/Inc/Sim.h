@@ -0,0 +1,79 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef SIM_H
+#define SIM_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "stm32h7xx_hal.h"
+
+// 主机仿真（FISH_H7_sim）各模块之间的接口：
+// Sim_Clock.c虚拟时间与中断投递，port.c任务线程，Sim_UART.c串口，Sim_HAL.c定时器/Flash/CRC，Sim_Main.c命令行与报告
+
+/************************ 仿真参数 ************************/
+#define SIM_NS_PER_US         1000ULL
+#define SIM_NS_PER_MS         1000000ULL
+#define SIM_NS_PER_S          1000000000ULL
+#define SIM_TICK_NS           SIM_NS_PER_MS   // 内核节拍与HAL节拍周期（configTICK_RATE_HZ=1000）
+#define SIM_DEFAULT_S         10U             // 没有文件输入且未指定时长时的仿真时长，s
+#define SIM_DRAIN_MS          2000U           // 文件输入全部送完后继续运行的时间（处理积压、失联保护），ms
+#define SIM_NEVER             UINT64_MAX
+
+/************************ 结构体定义 ************************/
+typedef struct {
+    uint64_t duration_ns;               // 调度器启动后运行的虚拟时长，SIM_NEVER=不自动结束（伪终端输入，Ctrl-C结束）
+    double speed;                       // 0=尽快运行，>0=按实际时间的倍速运行（伪终端/设备输入时为1）
+    double cpu_scale;                   // 主机执行时间计入DWT周期的倍数，0=DWT只随虚拟时间前进（完全确定）
+} Sim_Config_t;
+
+/************************ 函数声明 ************************/
+// 虚拟时间（Sim_Clock.c）
+void Sim_Clock_Init(const Sim_Config_t *cfg);
+void Sim_Clock_Start(void);                     // 调度器启动：串口输入与仿真时长从此开始计时
+uint64_t Sim_Now_ns(void);
+uint64_t Sim_Wall_ns(void);                     // 主机单调时钟
+void Sim_Step(uint64_t limit_ns);               // 前进到下一个事件（节拍/串口/limit）并投递到期中断
+void Sim_Busy_Wait_ns(uint64_t ns);             // 忙等（HAL_Delay、Flash擦写），期间中断与高优先级任务照常运行
+void Sim_Run_Isrs(void);                        // 投递到期的仿真中断（port.c在解除屏蔽时调用）
+void Sim_Request_Stop(void);                    // 在下一个事件点结束（信号处理中调用）
+uint64_t Sim_Tick_Count(void);                  // 已投递的节拍数
+uint64_t Sim_Start_ns(void);                    // 调度器启动时刻
+
+// 调度（port.c）
+void Sim_Port_Init(void);                       // 复位线程调用：持有仿真锁，之后才能调用内核接口
+bool Sim_Irq_Masked(void);                      // 当前线程屏蔽了中断（PRIMASK/临界区）
+bool Sim_Scheduler_Running(void);
+uint64_t Sim_Task_Run_ns(void *task);           // 任务累计运行的虚拟时间
+void *Sim_Stack_Alloc(size_t size);             // 4GB以下的线程栈（固件把指针当作32位地址）
+
+// 串口（Sim_UART.c）
+bool Sim_UART_Source(USART_TypeDef *usart, const char *spec);   // 接收源：文件[,period=ms][,burst=N][,loop]或设备
+bool Sim_UART_Sink(USART_TypeDef *usart, const char *path);     // 发送去向
+bool Sim_UART_Replay(const char *spec);                         // 回放采集文件（Tools/capture.py）：文件[,scale=X]
+const char *Sim_UART_Pty(USART_TypeDef *usart);                 // 收发都接到新建的伪终端，返回从端路径
+void Sim_UART_Start(uint64_t now_ns);
+uint64_t Sim_UART_Next_ns(void);                // 下一个接收事件时刻，SIM_NEVER=无
+uint64_t Sim_UART_Inputs_ns(void);              // 文件输入全部送完所需时长（从调度器启动算起），SIM_NEVER=有循环/设备输入
+bool Sim_UART_Realtime(void);                   // 有伪终端/设备输入，需按实际时间运行
+void Sim_UART_Run(uint64_t now_ns);             // 投递到期的接收/发送完成事件（中断上下文）
+void Sim_UART_Report(FILE *f, uint64_t wall_ns);
+
+// 定时器、Flash、CRC（Sim_HAL.c）
+void Sim_HAL_Init(void);
+bool Sim_Servo_Log(const char *path);
+bool Sim_Flash_Image(const char *path);         // 从文件载入Flash记录区，结束时写回
+void Sim_TIM_Advance(uint64_t now_ns);          // 更新TIM24计数（虚拟微秒），溢出时置更新标志
+void Sim_TIM_Run(void);                         // TIM24更新中断（中断上下文）
+void Sim_HAL_Finish(void);
+void Sim_HAL_Report(FILE *f);
+
+// 时钟档（Sim_Power.c）
+void Sim_Power_Idle(uint64_t idle_ns);           // 空闲钩子跳过的虚拟时间（睡眠开启时计为睡眠）
+void Sim_Power_Report(FILE *f);
+
+/************************ 全局变量声明 ************************/
+extern Sim_Config_t sim_config;
+
+#endif //SIM_H
@@ -0,0 +1,48 @@
+//
+// Created by ottohesl on 26-1-29.
+//
+
+#ifndef SIM_TEST_H
+#define SIM_TEST_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// 主机测试运行器FISH_H7_test_host（入口Src/Sim_Test.c，用例在Test/下）：直接调用固件模块，对照参考实现或参考值，
+// 由CTest运行（ctest --test-dir build/Sim），命令行与输出格式同GoogleTest
+
+/************************ 结构体定义 ************************/
+// 测试用例（用SIM_TEST注册，不要直接定义）
+typedef struct {
+    const char *name;                   // 用例名（--gtest_filter按名称匹配）
+    void (*run)(void);
+} Sim_Test_Case_t;
+
+/************************ 注册宏 ************************/
+// 注册一个用例：用例表放在sim_tests段，各文件中的用例由链接器汇总（与BENCH_CASE相同）
+#define SIM_TEST(id)                                                                        \
+    static void sim_test_##id(void);                                                        \
+    static const Sim_Test_Case_t sim_test_case_##id = {#id, sim_test_##id};                 \
+    static const Sim_Test_Case_t *const sim_test_ref_##id                                   \
+        __attribute__((used, section("sim_tests"))) = &sim_test_case_##id;                  \
+    static void sim_test_##id(void)
+
+// 检查条件，失败时打印位置与说明并记为失败，用例继续执行（同EXPECT_*）
+#define SIM_CHECK(cond, ...)                                                                \
+    do {                                                                                    \
+        if (!(cond)) {                                                                      \
+            Sim_Test_Fail(__FILE__, __LINE__, #cond);                                       \
+            fprintf(stdout, "  " __VA_ARGS__);                                              \
+            fputc('\n', stdout);                                                            \
+        }                                                                                   \
+    } while (0)
+
+/************************ 函数声明 ************************/
+// 记一次失败（SIM_CHECK调用）
+void Sim_Test_Fail(const char *file, int line, const char *expr);
+// 本用例到目前为止的失败次数（一个用例内逐项检查时用来截断输出）
+uint32_t Sim_Test_Failures(void);
+// 用例的附加结果（打印在用例行之后，如对照样本数、耗时）
+void Sim_Test_Note(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#endif //SIM_TEST_H
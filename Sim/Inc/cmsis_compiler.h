@@ -0,0 +1,124 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef SIM_CMSIS_COMPILER_H
+#define SIM_CMSIS_COMPILER_H
+#include <stdint.h>
+
+// 主机仿真用的CMSIS编译器抽象层：替代Drivers/CMSIS/Include/cmsis_compiler.h（其中的内联汇编只能在ARM上编译），
+// 仿真包含路径中Sim/Inc排在最前，arm_math.h与cmsis_os2.c包含到的都是本文件
+// 1. 中断屏蔽只是一个标志：仿真中断只在Sim_Step里投递，屏蔽期间到期的中断与切换请求推迟到解除屏蔽时执行
+// 2. IPSR非0表示正在执行仿真中断（cmsis_os2.c据此选择FromISR接口）
+
+/************************ 编译器属性 ************************/
+#ifndef __ASM
+#define __ASM                  __asm
+#endif
+#ifndef __INLINE
+#define __INLINE               inline
+#endif
+#ifndef __STATIC_INLINE
+#define __STATIC_INLINE        static inline
+#endif
+#ifndef __STATIC_FORCEINLINE
+#define __STATIC_FORCEINLINE   __attribute__((always_inline)) static inline
+#endif
+#ifndef __NO_RETURN
+#define __NO_RETURN            __attribute__((__noreturn__))
+#endif
+#ifndef __USED
+#define __USED                 __attribute__((used))
+#endif
+#ifndef __WEAK
+#define __WEAK                 __attribute__((weak))
+#endif
+#ifndef __weak
+#define __weak                 __attribute__((weak))
+#endif
+#ifndef __PACKED
+#define __PACKED               __attribute__((packed, aligned(1)))
+#endif
+#ifndef __PACKED_STRUCT
+#define __PACKED_STRUCT        struct __attribute__((packed, aligned(1)))
+#endif
+#ifndef __ALIGNED
+#define __ALIGNED(x)           __attribute__((aligned(x)))
+#endif
+#ifndef __RESTRICT
+#define __RESTRICT             __restrict
+#endif
+#ifndef __COMPILER_BARRIER
+#define __COMPILER_BARRIER()   __asm volatile("" ::: "memory")
+#endif
+
+/************************ 仿真中断状态 ************************/
+extern volatile uint32_t sim_primask;   // 1=屏蔽仿真中断（__disable_irq）
+extern volatile uint32_t sim_ipsr;      // 非0=正在执行仿真中断
+extern volatile uint32_t sim_pend;      // 屏蔽期间推迟的切换/中断（SIM_PEND_*）
+#define SIM_PEND_YIELD   (1UL << 0)     // 任务切换请求（PendSV）
+#define SIM_PEND_ISR     (1UL << 1)     // 到期的仿真中断
+void Sim_Irq_Unmasked(void);            // 解除屏蔽后执行推迟的中断与切换（port.c）
+
+/************************ 内核寄存器与指令 ************************/
+__STATIC_FORCEINLINE void __disable_irq(void) { sim_primask = 1U; }
+__STATIC_FORCEINLINE void __enable_irq(void) {
+    sim_primask = 0U;
+    if (sim_pend != 0U) {
+        Sim_Irq_Unmasked();
+    }
+}
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void) { return sim_primask; }
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t primask) {
+    sim_primask = primask & 1U;
+    if (sim_primask == 0U && sim_pend != 0U) {
+        Sim_Irq_Unmasked();
+    }
+}
+__STATIC_FORCEINLINE uint32_t __get_BASEPRI(void) { return 0U; }
+__STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basepri) { (void)basepri; }
+__STATIC_FORCEINLINE uint32_t __get_IPSR(void) { return sim_ipsr; }
+__STATIC_FORCEINLINE void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_FORCEINLINE void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_FORCEINLINE void __ISB(void) { __COMPILER_BARRIER(); }
+__STATIC_FORCEINLINE void __NOP(void) { __COMPILER_BARRIER(); }
+__STATIC_FORCEINLINE void __WFI(void) { __COMPILER_BARRIER(); }
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value) {
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+__STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2) {
+    op2 %= 32U;
+    return (op2 == 0U) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+}
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value) {
+    uint32_t result = 0U;
+    for (int i = 0; i < 32; i++) {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+    return result;
+}
+__STATIC_FORCEINLINE int32_t __SSAT(int32_t val, uint32_t sat) {
+    if (sat >= 1U && sat <= 32U) {
+        const int32_t max = (int32_t)((1U << (sat - 1U)) - 1U);
+        const int32_t min = -1 - max;
+        if (val > max) {
+            return max;
+        } else if (val < min) {
+            return min;
+        }
+    }
+    return val;
+}
+__STATIC_FORCEINLINE uint32_t __USAT(int32_t val, uint32_t sat) {
+    if (sat <= 31U) {
+        const uint32_t max = ((1U << sat) - 1U);
+        if (val > (int32_t)max) {
+            return max;
+        } else if (val < 0) {
+            return 0U;
+        }
+    }
+    return (uint32_t)val;
+}
+
+#endif //SIM_CMSIS_COMPILER_H
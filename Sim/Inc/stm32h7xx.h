@@ -0,0 +1,11 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef SIM_STM32H7XX_H
+#define SIM_STM32H7XX_H
+
+// CMSIS设备头（FreeRTOSConfig.h的CMSIS_device_header，cmsis_os2.c经freertos_os2.h包含）：仿真中即HAL替身
+#include "stm32h7xx_hal.h"
+
+#endif //SIM_STM32H7XX_H
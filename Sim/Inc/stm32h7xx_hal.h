@@ -0,0 +1,245 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef SIM_STM32H7XX_HAL_H
+#define SIM_STM32H7XX_HAL_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+// 主机仿真用的HAL替身：只提供应用层（Core/Src、Task_Link）实际用到的类型、宏与函数，
+// 外设寄存器是普通结构体，由Sim_HAL.c/Sim_UART.c按虚拟时间更新，行为见各函数注释
+// 1. DWT->CYCCNT每次读取时按虚拟时间与主机实际执行时间重新计算（Sim_Clock.c）
+// 2. TIM24->CNT为虚拟时间微秒（TimeBase），其余定时器只记录比较值，舵机比较值变化写入CSV
+// 3. 串口收发、DMA计数、Flash擦写与CRC均为软件模型，不访问真实外设
+
+/************************ 通用定义 ************************/
+#define __IO                  volatile
+#define UNUSED(X)             (void)(X)
+#define HAL_MAX_DELAY         0xFFFFFFFFU
+
+typedef enum {
+    HAL_OK       = 0x00U,
+    HAL_ERROR    = 0x01U,
+    HAL_BUSY     = 0x02U,
+    HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    HAL_UNLOCKED = 0x00U,
+    HAL_LOCKED   = 0x01U
+} HAL_LockTypeDef;
+
+extern uint32_t SystemCoreClock;
+
+/************************ 内核调试单元 ************************/
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+    __IO uint32_t LAR;
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+} SysTick_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk        (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1UL << 24)
+
+// 每次取DWT都刷新CYCCNT（读到的是当前仿真周期计数，写入的值作为新的计数起点）
+DWT_Type *Sim_DWT(void);
+extern CoreDebug_Type sim_core_debug;
+extern SysTick_Type sim_systick;
+#define DWT                   (Sim_DWT())
+#define CoreDebug             (&sim_core_debug)
+#define SysTick               (&sim_systick)
+
+// 中断优先级由仿真按屏蔽状态统一处理，设置为空
+typedef int32_t IRQn_Type;
+__STATIC_INLINE void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority) { (void)IRQn; (void)priority; }
+
+// 主机上没有数据缓存，维护操作为空
+__STATIC_INLINE void SCB_CleanDCache_by_Addr(void *addr, int32_t dsize) { (void)addr; (void)dsize; }
+__STATIC_INLINE void SCB_InvalidateDCache_by_Addr(void *addr, int32_t dsize) { (void)addr; (void)dsize; }
+__STATIC_INLINE void SCB_CleanInvalidateDCache_by_Addr(void *addr, int32_t dsize) { (void)addr; (void)dsize; }
+
+/************************ 定时器 ************************/
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t CounterMode;
+    uint32_t Period;
+    uint32_t ClockDivision;
+    uint32_t RepetitionCounter;
+    uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+extern TIM_TypeDef sim_tim2, sim_tim3, sim_tim4, sim_tim23, sim_tim24;
+#define TIM2                  (&sim_tim2)
+#define TIM3                  (&sim_tim3)
+#define TIM4                  (&sim_tim4)
+#define TIM23                 (&sim_tim23)
+#define TIM24                 (&sim_tim24)
+
+#define TIM_CHANNEL_1         0x00000000U
+#define TIM_CHANNEL_2         0x00000004U
+#define TIM_CHANNEL_3         0x00000008U
+#define TIM_CHANNEL_4         0x0000000CU
+#define TIM_SR_UIF            (1UL << 0)
+#define TIM_FLAG_UPDATE       TIM_SR_UIF
+#define TIM_EGR_UG            (1UL << 0)
+#define TIM_CR1_CEN           (1UL << 0)
+#define TIM_CR1_URS           (1UL << 2)
+
+void Sim_TIM_Set_Compare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t compare);
+__IO uint32_t *Sim_TIM_CCR(TIM_HandleTypeDef *htim, uint32_t channel);
+void Sim_TIM_Set_Counter(TIM_HandleTypeDef *htim, uint32_t counter);
+#define __HAL_TIM_SET_COMPARE(h, ch, v)   Sim_TIM_Set_Compare((h), (ch), (v))
+#define __HAL_TIM_GET_COMPARE(h, ch)      (*Sim_TIM_CCR((h), (ch)))
+#define __HAL_TIM_SET_COUNTER(h, v)       Sim_TIM_Set_Counter((h), (v))
+#define __HAL_TIM_GET_COUNTER(h)          ((h)->Instance->CNT)
+#define __HAL_TIM_CLEAR_FLAG(h, f)        ((h)->Instance->SR &= ~(f))
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t channel);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+
+/************************ DMA ************************/
+typedef enum {
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY  = 0x02U,
+    HAL_DMA_STATE_ERROR = 0x03U,
+    HAL_DMA_STATE_ABORT = 0x04U
+} HAL_DMA_StateTypeDef;
+
+typedef struct {
+    uint32_t Mode;
+} DMA_InitTypeDef;
+
+typedef struct {
+    void *Instance;
+    DMA_InitTypeDef Init;
+    __IO HAL_DMA_StateTypeDef State;
+    __IO uint32_t NDTR;                 // 剩余传输数（循环接收时为缓冲区长度减写入位置）
+} DMA_HandleTypeDef;
+
+#define DMA_NORMAL            0x00000000U
+#define DMA_CIRCULAR          0x00000100U
+#define __HAL_DMA_GET_COUNTER(h)          ((h)->NDTR)
+#define __HAL_DMA_SET_COUNTER(h, v)       ((h)->NDTR = (v))
+
+/************************ 串口 ************************/
+typedef struct {
+    uint32_t id;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+} UART_InitTypeDef;
+
+typedef enum {
+    HAL_UART_STATE_RESET      = 0x00U,
+    HAL_UART_STATE_READY      = 0x20U,
+    HAL_UART_STATE_BUSY       = 0x24U,
+    HAL_UART_STATE_BUSY_TX    = 0x21U,
+    HAL_UART_STATE_BUSY_RX    = 0x22U,
+    HAL_UART_STATE_ERROR      = 0xE0U
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    DMA_HandleTypeDef *hdmarx;
+    DMA_HandleTypeDef *hdmatx;
+    __IO HAL_UART_StateTypeDef gState;
+    __IO HAL_UART_StateTypeDef RxState;
+    __IO uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+extern USART_TypeDef sim_usart1, sim_usart2, sim_usart3, sim_usart6;
+#define USART1                (&sim_usart1)
+#define USART2                (&sim_usart2)
+#define USART3                (&sim_usart3)
+#define USART6                (&sim_usart6)
+
+#define UART_WORDLENGTH_8B    0x00000000U
+#define UART_WORDLENGTH_9B    0x00001000U
+#define UART_STOPBITS_1       0x00000000U
+#define UART_STOPBITS_2       0x00002000U
+#define UART_PARITY_NONE      0x00000000U
+#define UART_PARITY_EVEN      0x00000400U
+#define __HAL_UART_CLEAR_OREFLAG(h)       ((void)(h))   // 仿真串口接收停止时丢弃数据，不产生溢出标志
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+/************************ Flash ************************/
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Banks;
+    uint32_t Sector;
+    uint32_t NbSectors;
+    uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+#define FLASH_BANK1_BASE              0x08000000U
+#define FLASH_SECTOR_SIZE             0x00020000U
+#define FLASH_NB_32BITWORD_IN_FLASHWORD 8U
+#define FLASH_TYPEERASE_SECTORS       0x00U
+#define FLASH_TYPEPROGRAM_FLASHWORD   0x01U
+#define FLASH_BANK_1                  0x01U
+#define FLASH_VOLTAGE_RANGE_3         0x20U
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t FlashAddress, uint32_t DataAddress);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError);
+
+/************************ CRC ************************/
+typedef struct {
+    void *Instance;
+} CRC_HandleTypeDef;
+
+/************************ 系统 ************************/
+HAL_StatusTypeDef HAL_Init(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+#endif //SIM_STM32H7XX_HAL_H
@@ -0,0 +1,363 @@
+/**
+ * @file       Sim_Bench.c
+ * @brief      微基准测试主机运行器：命令行与输出格式同Google Benchmark，用例与板上镜像FISH_H7_bench相同
+ * @author     ottohesl
+ * @date       26-1-27
+ * @version    V1.0
+ * @note       1. 用法：FISH_H7_bench_host [--benchmark_filter=正则] [--benchmark_repetitions=N] [--benchmark_min_time=秒]
+ *                [--benchmark_format=console|json] [--benchmark_out=文件] [--benchmark_report_aggregates_only=true]
+ *                [--benchmark_list_tests]
+ *             2. 每个用例先预热BENCH_WARMUP次；每次重复中反复“setup（不计时）+ batch次run（计时）”，计时累计到min_time为止，
+ *                得到该次重复的单次调用耗时；各次重复再取最小/中位/最大，作为_min/_median/_max聚合行
+ *             3. 计时用CLOCK_MONOTONIC并扣除一次空测量的开销；运行器单线程、不让出CPU，CPU时间按实际时间报告
+ *             4. 主机不能关缓存：冷缓存与关缓存用例在每次测量前写一遍SIM_BENCH_EVICT字节的缓冲区，把被测数据挤出缓存
+ *             5. 外设用仿真的句柄与寄存器模型（Sim_HAL.c），不启动调度器与虚拟时间；结果与构建类型有关，
+ *                建立基线与比较时用同一构建类型（建议-DCMAKE_BUILD_TYPE=Release），Tools/bench.py读取JSON输出
+ */
+#define _GNU_SOURCE
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "Sim.h"
+#include "main.h"
+#include "usart.h"
+#include "tim.h"
+#include "TimeBase.h"
+#include "Bench.h"
+
+/************************ 运行参数 ************************/
+#define SIM_BENCH_REPS_MAX    64U             // 重复次数上限
+#define SIM_BENCH_ITERS_MAX   10000000U       // 单次重复的测量次数上限
+#define SIM_BENCH_EVICT       (32U * 1024U * 1024U)   // 冷缓存时写入的字节数（大于常见的末级缓存）
+#define SIM_BENCH_PS_PER_NS   1000.0
+
+/************************ 结构体定义 ************************/
+typedef struct {
+    const char *filter;                 // 用例名正则（扩展正则，部分匹配）
+    uint32_t repetitions;
+    double min_time_s;
+    bool json;                          // 标准输出格式
+    const char *out;                    // 另写一份JSON
+    bool aggregates_only;
+    bool list;
+} Sim_Bench_Options_t;
+
+typedef struct {
+    const Bench_Case_t *c;
+    uint32_t reps;
+    uint32_t ps[SIM_BENCH_REPS_MAX];    // 每次重复的单次调用耗时（皮秒）
+    uint64_t iters[SIM_BENCH_REPS_MAX]; // 每次重复的测量次数（乘batch为调用次数）
+    Bench_Result_t result;              // 各次重复的最小/中位/最大（皮秒）
+} Sim_Bench_Run_t;
+
+/************************ 私有变量 ************************/
+static Sim_Bench_Options_t bench_opt = {
+    .filter = ".",
+    .repetitions = 5U,
+    .min_time_s = 0.05,
+};
+static uint8_t bench_evict[SIM_BENCH_EVICT];
+static const char *const bench_cache_names[] = {"warm", "cold", "off"};
+
+/************************ 私有函数实现 ************************/
+static uint64_t Sim_Bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  空测量的开销（两次读时钟之间，取多次最小值）
+ */
+static uint64_t Sim_Bench_Overhead(void) {
+    uint64_t best = UINT64_MAX;
+    for (uint32_t i = 0; i < 1000U; i++) {
+        uint64_t t0 = Sim_Bench_ns();
+        uint64_t t = Sim_Bench_ns() - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief  把被测数据挤出缓存（写满一个比末级缓存大的缓冲区）
+ */
+static void Sim_Bench_Evict(void) {
+    memset(bench_evict, (int)(bench_sink & 0xFFU), sizeof(bench_evict));
+    bench_sink = bench_evict[bench_sink % sizeof(bench_evict)];
+}
+
+/**
+ * @brief  测量一次：setup（不计时） -> 缓存准备 -> batch次run
+ * @retval 本次测量的纳秒数（已扣除计时开销）
+ */
+static uint64_t Sim_Bench_Measure(const Bench_Case_t *c, uint32_t batch, uint64_t overhead) {
+    if (c->setup != NULL) {
+        c->setup();
+    }
+    if (c->cache != BENCH_CACHE_WARM) {
+        Sim_Bench_Evict();
+    }
+    uint64_t t0 = Sim_Bench_ns();
+    for (uint32_t i = 0; i < batch; i++) {
+        c->run();
+    }
+    uint64_t t = Sim_Bench_ns() - t0;
+    return (t > overhead) ? t - overhead : 0U;
+}
+
+/**
+ * @brief  运行一个用例的全部重复
+ */
+static void Sim_Bench_Run_Case(Sim_Bench_Run_t *run, uint64_t overhead) {
+    const Bench_Case_t *c = run->c;
+    uint32_t batch = (c->batch == 0U) ? 1U : c->batch;
+    uint64_t min_ns = (uint64_t)(bench_opt.min_time_s * 1e9);
+    uint32_t samples[SIM_BENCH_REPS_MAX];
+
+    for (uint32_t i = 0; i < BENCH_WARMUP; i++) {
+        (void)Sim_Bench_Measure(c, batch, overhead);
+    }
+    run->reps = bench_opt.repetitions;
+    for (uint32_t r = 0; r < run->reps; r++) {
+        uint64_t total = 0;
+        uint64_t iters = 0;
+        // 计时累计不足（开销扣到0的极短内核）时按墙钟时间兜底结束
+        uint64_t deadline = Sim_Bench_ns() + min_ns * 20U + 1000000000ULL;
+        while ((total < min_ns || iters == 0U) && iters < SIM_BENCH_ITERS_MAX && Sim_Bench_ns() < deadline) {
+            total += Sim_Bench_Measure(c, batch, overhead);
+            iters++;
+        }
+        double ps = (double)total * SIM_BENCH_PS_PER_NS / ((double)iters * batch);
+        run->ps[r] = (ps > (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)(ps + 0.5);
+        run->iters[r] = iters;
+        samples[r] = run->ps[r];
+    }
+    Bench_Summary(samples, run->reps, &run->result);
+    run->result.overhead = (uint32_t)overhead;
+}
+
+/**
+ * @brief  一行控制台输出（名称、实际时间、CPU时间、迭代次数）
+ */
+static void Sim_Bench_Console_Row(FILE *f, const char *name, const char *suffix, uint32_t ps, uint64_t calls) {
+    char full[96];
+    snprintf(full, sizeof(full), "%s%s", name, suffix);
+    double ns = ps / SIM_BENCH_PS_PER_NS;
+    fprintf(f, "%-40s %10.2f ns %12.2f ns %12llu\n", full, ns, ns, (unsigned long long)calls);
+}
+
+static void Sim_Bench_Console(FILE *f, Sim_Bench_Run_t *runs, uint32_t n) {
+    static const char line[] = "-----------------------------------------------------------------------------------\n";
+    fprintf(f, "Run on (%ld X host CPU)\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(f, "%s%-40s %14s %16s %13s\n%s", line, "Benchmark", "Time", "CPU", "Iterations", line);
+    for (uint32_t i = 0; i < n; i++) {
+        Sim_Bench_Run_t *run = &runs[i];
+        uint32_t batch = (run->c->batch == 0U) ? 1U : run->c->batch;
+        uint64_t calls = 0;
+        for (uint32_t r = 0; r < run->reps; r++) {
+            calls += run->iters[r] * batch;
+            if (!bench_opt.aggregates_only) {
+                Sim_Bench_Console_Row(f, run->c->name, "", run->ps[r], run->iters[r] * batch);
+            }
+        }
+        Sim_Bench_Console_Row(f, run->c->name, "_min", run->result.min, calls / run->reps);
+        Sim_Bench_Console_Row(f, run->c->name, "_median", run->result.median, calls / run->reps);
+        Sim_Bench_Console_Row(f, run->c->name, "_max", run->result.max, calls / run->reps);
+    }
+}
+
+/**
+ * @brief  一条JSON记录（重复或聚合）
+ */
+static void Sim_Bench_Json_Row(FILE *f, const Sim_Bench_Run_t *run, uint32_t family, const char *aggregate,
+                               int32_t rep, uint32_t ps, uint64_t calls, bool *first) {
+    double ns = ps / SIM_BENCH_PS_PER_NS;
+    fprintf(f, "%s    {\n", *first ? "" : ",\n");
+    *first = false;
+    if (aggregate != NULL) {
+        fprintf(f, "      \"name\": \"%s_%s\",\n", run->c->name, aggregate);
+    } else {
+        fprintf(f, "      \"name\": \"%s\",\n", run->c->name);
+    }
+    fprintf(f, "      \"family_index\": %u,\n      \"per_family_instance_index\": 0,\n", family);
+    fprintf(f, "      \"run_name\": \"%s\",\n", run->c->name);
+    fprintf(f, "      \"run_type\": \"%s\",\n", (aggregate != NULL) ? "aggregate" : "iteration");
+    fprintf(f, "      \"repetitions\": %u,\n", run->reps);
+    if (aggregate != NULL) {
+        fprintf(f, "      \"threads\": 1,\n      \"aggregate_name\": \"%s\",\n      \"aggregate_unit\": \"time\",\n",
+                aggregate);
+    } else {
+        fprintf(f, "      \"repetition_index\": %d,\n      \"threads\": 1,\n", rep);
+    }
+    fprintf(f, "      \"iterations\": %llu,\n", (unsigned long long)calls);
+    fprintf(f, "      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\",\n", ns, ns);
+    fprintf(f, "      \"batch\": %u,\n      \"cache\": \"%s\"\n    }",
+            (unsigned)((run->c->batch == 0U) ? 1U : run->c->batch), bench_cache_names[run->c->cache]);
+}
+
+static void Sim_Bench_Json(FILE *f, Sim_Bench_Run_t *runs, uint32_t n, const char *exe) {
+    char host[64] = "";
+    char date[32] = "";
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+    gethostname(host, sizeof(host) - 1U);
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n    \"host_name\": \"%s\",\n    \"executable\": \"%s\",\n", date, host, exe);
+    fprintf(f, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef __OPTIMIZE__
+    fprintf(f, "    \"library_build_type\": \"release\",\n");
+#else
+    fprintf(f, "    \"library_build_type\": \"debug\",\n");
+#endif
+    fprintf(f, "    \"bench_warmup\": %u,\n    \"timer_overhead_ns\": %u\n  },\n  \"benchmarks\": [\n",
+            (unsigned)BENCH_WARMUP, (n > 0U) ? runs[0].result.overhead : 0U);
+    bool first = true;
+    for (uint32_t i = 0; i < n; i++) {
+        const Sim_Bench_Run_t *run = &runs[i];
+        uint32_t batch = (run->c->batch == 0U) ? 1U : run->c->batch;
+        uint64_t calls = 0;
+        for (uint32_t r = 0; r < run->reps; r++) {
+            calls += run->iters[r] * batch;
+            if (!bench_opt.aggregates_only) {
+                Sim_Bench_Json_Row(f, run, i, NULL, (int32_t)r, run->ps[r], run->iters[r] * batch, &first);
+            }
+        }
+        Sim_Bench_Json_Row(f, run, i, "min", -1, run->result.min, calls / run->reps, &first);
+        Sim_Bench_Json_Row(f, run, i, "median", -1, run->result.median, calls / run->reps, &first);
+        Sim_Bench_Json_Row(f, run, i, "max", -1, run->result.max, calls / run->reps, &first);
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+static void Sim_Bench_Usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --benchmark_filter=REGEX            run cases whose name matches (default: all)\n"
+            "  --benchmark_repetitions=N           repetitions per case (default 5, max %u)\n"
+            "  --benchmark_min_time=SECONDS        timed time per repetition (default 0.05)\n"
+            "  --benchmark_format=console|json     stdout format\n"
+            "  --benchmark_out=FILE                also write JSON to FILE\n"
+            "  --benchmark_report_aggregates_only=true|false\n"
+            "  --benchmark_list_tests              print case names and exit\n",
+            prog, SIM_BENCH_REPS_MAX);
+}
+
+/**
+ * @brief  解析--name=value形式的参数
+ * @retval 值（不是该参数时返回NULL）
+ */
+static const char *Sim_Bench_Arg(const char *arg, const char *name) {
+    size_t n = strlen(name);
+    if (strncmp(arg, name, n) != 0) {
+        return NULL;
+    }
+    if (arg[n] == '=') {
+        return arg + n + 1;
+    }
+    return (arg[n] == '\0') ? "true" : NULL;
+}
+
+static bool Sim_Bench_Parse(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *v;
+        if ((v = Sim_Bench_Arg(argv[i], "--benchmark_filter")) != NULL) {
+            bench_opt.filter = v;
+        } else if ((v = Sim_Bench_Arg(argv[i], "--benchmark_repetitions")) != NULL) {
+            bench_opt.repetitions = (uint32_t)strtoul(v, NULL, 0);
+            if (bench_opt.repetitions == 0U || bench_opt.repetitions > SIM_BENCH_REPS_MAX) {
+                fprintf(stderr, "bench: repetitions must be 1..%u\n", SIM_BENCH_REPS_MAX);
+                return false;
+            }
+        } else if ((v = Sim_Bench_Arg(argv[i], "--benchmark_min_time")) != NULL) {
+            bench_opt.min_time_s = strtod(v, NULL);     // 允许带后缀s（新版Google Benchmark写法）
+        } else if ((v = Sim_Bench_Arg(argv[i], "--benchmark_format")) != NULL) {
+            if (strcmp(v, "json") != 0 && strcmp(v, "console") != 0) {
+                fprintf(stderr, "bench: unsupported format %s\n", v);
+                return false;
+            }
+            bench_opt.json = strcmp(v, "json") == 0;
+        } else if ((v = Sim_Bench_Arg(argv[i], "--benchmark_out")) != NULL) {
+            bench_opt.out = v;
+        } else if ((v = Sim_Bench_Arg(argv[i], "--benchmark_report_aggregates_only")) != NULL) {
+            bench_opt.aggregates_only = strcmp(v, "true") == 0;
+        } else if (Sim_Bench_Arg(argv[i], "--benchmark_list_tests") != NULL) {
+            bench_opt.list = true;
+        } else {
+            Sim_Bench_Usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/************************ 入口 ************************/
+int main(int argc, char **argv) {
+    if (!Sim_Bench_Parse(argc, argv)) {
+        return 2;
+    }
+    regex_t re;
+    if (regcomp(&re, bench_opt.filter, REG_EXTENDED | REG_NOSUB) != 0) {
+        fprintf(stderr, "bench: bad filter %s\n", bench_opt.filter);
+        return 2;
+    }
+
+    // 与main.c相同的外设初始化（只建立句柄与寄存器模型，传感器DMA不启动）
+    Sim_HAL_Init();
+    MX_TIM2_Init();
+    MX_TIM3_Init();
+    MX_USART1_UART_Init();
+    MX_USART2_UART_Init();
+    MX_USART3_UART_Init();
+    MX_USART6_UART_Init();
+    MX_TIM4_Init();
+    MX_TIM24_Init();
+    TimeBase_Init(&htim24);
+
+    uint32_t count;
+    const Bench_Case_t *const *cases = Bench_Cases(&count);
+    Sim_Bench_Run_t *runs = calloc(count > 0U ? count : 1U, sizeof(Sim_Bench_Run_t));
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (regexec(&re, cases[i]->name, 0, NULL, 0) == 0) {
+            runs[n++].c = cases[i];
+        }
+    }
+    regfree(&re);
+    if (bench_opt.list) {
+        for (uint32_t i = 0; i < n; i++) {
+            printf("%s\n", runs[i].c->name);
+        }
+        return 0;
+    }
+    if (n == 0U) {
+        fprintf(stderr, "bench: no case matches %s\n", bench_opt.filter);
+        return 1;
+    }
+
+    uint64_t overhead = Sim_Bench_Overhead();
+    for (uint32_t i = 0; i < n; i++) {
+        Sim_Bench_Run_Case(&runs[i], overhead);
+    }
+    if (bench_opt.json) {
+        Sim_Bench_Json(stdout, runs, n, argv[0]);
+    } else {
+        Sim_Bench_Console(stdout, runs, n);
+    }
+    if (bench_opt.out != NULL) {
+        FILE *f = fopen(bench_opt.out, "w");
+        if (f == NULL) {
+            perror(bench_opt.out);
+            return 1;
+        }
+        Sim_Bench_Json(f, runs, n, argv[0]);
+        fclose(f);
+    }
+    free(runs);
+    return 0;
+}
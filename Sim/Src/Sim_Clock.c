@@ -0,0 +1,251 @@
+/**
+ * @file       Sim_Clock.c
+ * @brief      仿真虚拟时间：事件推进、节拍与中断投递、DWT周期计数、HAL节拍
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 固件代码不消耗虚拟时间，时间只在Sim_Step中前进：跳到下一个节拍/串口事件/忙等结束中最早的一个，
+ *                然后以中断上下文投递到期的串口事件、HAL节拍（TIM23）与内核节拍（SysTick），有切换请求时切换任务
+ *             2. Sim_Step由空闲钩子（无任务就绪）和忙等（HAL_Delay、Flash擦写）调用，
+ *                忙等期间高优先级任务照常抢占，与硬件上的行为一致
+ *             3. DWT->CYCCNT = 虚拟时间按当前主频累计的周期 + 主机执行时间×cpu_scale×550MHz，
+ *                主机执行时间计入后运行时统计/控制耗时能反映代码开销，cpu_scale=0时全部结果完全确定；
+ *                换档（Sim_Power.c）只改变虚拟时间的累计速率，计数连续
+ *             4. speed>0时按实际时间节拍运行（伪终端等实时输入），否则尽快运行
+ */
+#include <stdlib.h>
+#include <time.h>
+#include "Sim.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "RT_Stats.h"
+
+/************************ 全局变量 ************************/
+Sim_Config_t sim_config = {
+    .duration_ns = SIM_NEVER,
+    .speed = 0.0,
+    .cpu_scale = 1.0,
+};
+uint32_t SystemCoreClock = 550000000U;
+CoreDebug_Type sim_core_debug;
+SysTick_Type sim_systick;
+
+/************************ 仿真参数 ************************/
+#define SIM_CPU_MHZ           550U            // 主机执行时间折算周期的主频（代码周期数与时钟档无关）
+
+/************************ 私有变量 ************************/
+static DWT_Type sim_dwt;
+static uint32_t dwt_last = 0;               // 上次读出的计数（与之不同说明固件写过计数）
+static uint32_t dwt_offset = 0;             // 固件写入计数造成的偏移
+static uint64_t cpu_t0 = 0;                 // 主机CPU时间起点，ns
+static uint64_t dwt_virt_ns = 0;            // 已累计到DWT的虚拟时间
+static uint64_t dwt_virt_mcycles = 0;       // 虚拟时间对应的周期数×1000
+static uint64_t sim_now_ns = 0;             // 虚拟时间
+static uint64_t sim_next_tick_ns = SIM_TICK_NS;
+static uint64_t sim_ticks = 0;
+static volatile bool sim_stop = false;
+static uint64_t sim_start_ns = 0;           // 调度器启动时刻
+static uint64_t sim_end_ns = SIM_NEVER;     // 结束时刻
+static uint64_t pace_wall0 = 0;             // 实时运行的起点
+static uint64_t pace_virt0 = 0;
+
+extern void SysTick_Handler(void);
+
+/************************ 私有函数实现 ************************/
+static uint64_t Sim_Clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * SIM_NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief  按实际时间节拍运行：等到下一个事件对应的主机时刻
+ */
+static void Sim_Pace(uint64_t next_ns) {
+    if (sim_config.speed <= 0.0) {
+        return;
+    }
+    uint64_t due = pace_wall0 + (uint64_t)((double)(next_ns - pace_virt0) / sim_config.speed);
+    uint64_t wall = Sim_Wall_ns();
+    if (due > wall) {
+        uint64_t d = due - wall;
+        struct timespec ts = {.tv_sec = (time_t)(d / SIM_NS_PER_S), .tv_nsec = (long)(d % SIM_NS_PER_S)};
+        nanosleep(&ts, NULL);
+    }
+}
+
+/**
+ * @brief  到达结束时刻：结束调度器，复位线程随后输出报告
+ */
+static void Sim_End(void) {
+    if (Sim_Scheduler_Running()) {
+        vTaskEndScheduler();
+    }
+    fprintf(stderr, "sim: stopped before the scheduler started\n");
+    exit(1);
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  仿真时钟初始化
+ * @param  cfg: 运行参数（复制保存）
+ */
+void Sim_Clock_Init(const Sim_Config_t *cfg) {
+    sim_config = *cfg;
+    cpu_t0 = Sim_Clock_ns(CLOCK_PROCESS_CPUTIME_ID);
+    pace_wall0 = Sim_Wall_ns();
+    pace_virt0 = 0;
+    sim_systick.LOAD = SystemCoreClock / configTICK_RATE_HZ - 1U;
+    sim_systick.CTRL = 0x7U;
+}
+
+/**
+ * @brief  调度器启动（port.c）：串口输入从此刻开始计时
+ */
+void Sim_Clock_Start(void) {
+    sim_start_ns = sim_now_ns;
+    if (sim_config.duration_ns != SIM_NEVER) {
+        sim_end_ns = sim_now_ns + sim_config.duration_ns;
+    }
+    Sim_UART_Start(sim_now_ns);
+}
+
+uint64_t Sim_Now_ns(void) {
+    return sim_now_ns;
+}
+
+uint64_t Sim_Wall_ns(void) {
+    return Sim_Clock_ns(CLOCK_MONOTONIC);
+}
+
+uint64_t Sim_Tick_Count(void) {
+    return sim_ticks;
+}
+
+uint64_t Sim_Start_ns(void) {
+    return sim_start_ns;
+}
+
+void Sim_Request_Stop(void) {
+    sim_stop = true;
+}
+
+/**
+ * @brief  刷新并返回DWT（固件对CYCCNT的写入在下一次访问时生效）
+ */
+DWT_Type *Sim_DWT(void) {
+    if (sim_dwt.CYCCNT != dwt_last) {
+        dwt_offset += sim_dwt.CYCCNT - dwt_last;
+    }
+    dwt_virt_mcycles += (sim_now_ns - dwt_virt_ns) * (SystemCoreClock / 1000000U);
+    dwt_virt_ns = sim_now_ns;
+    uint64_t cycles = dwt_virt_mcycles / SIM_NS_PER_US;
+    if (sim_config.cpu_scale > 0.0) {
+        double cpu_ns = (double)(Sim_Clock_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu_t0) * sim_config.cpu_scale;
+        cycles += (uint64_t)(cpu_ns * SIM_CPU_MHZ / SIM_NS_PER_US);
+    }
+    uint32_t raw = (uint32_t)cycles;
+    dwt_last = raw + dwt_offset;
+    sim_dwt.CYCCNT = dwt_last;
+    return &sim_dwt;
+}
+
+/**
+ * @brief  前进到下一个事件（不投递中断）
+ * @param  limit_ns: 最多前进到的时刻
+ */
+static void Sim_Advance(uint64_t limit_ns) {
+    uint64_t next = limit_ns;
+    if (sim_next_tick_ns < next) {
+        next = sim_next_tick_ns;
+    }
+    uint64_t dev = Sim_UART_Next_ns();
+    if (dev < next) {
+        next = dev;
+    }
+    if (sim_end_ns < next) {
+        next = sim_end_ns;
+    }
+    if (next < sim_now_ns) {
+        next = sim_now_ns;
+    }
+    Sim_Pace(next);
+    sim_now_ns = next;
+    Sim_TIM_Advance(next);
+    if (sim_stop || sim_now_ns >= sim_end_ns) {
+        Sim_End();
+    }
+}
+
+/**
+ * @brief  前进到下一个事件并投递到期中断
+ * @param  limit_ns: 最多前进到的时刻（忙等结束），SIM_NEVER=只由事件决定
+ * @note   屏蔽中断期间调用只推进时间，中断在解除屏蔽时投递
+ */
+void Sim_Step(uint64_t limit_ns) {
+    Sim_Advance(limit_ns);
+    sim_pend |= SIM_PEND_ISR;
+    Sim_Irq_Unmasked();
+}
+
+/**
+ * @brief  忙等（HAL_Delay、Flash擦写/编程）
+ * @param  ns: 等待时长
+ */
+void Sim_Busy_Wait_ns(uint64_t ns) {
+    uint64_t target = sim_now_ns + ns;
+    while (sim_now_ns < target) {
+        Sim_Step(target);
+    }
+}
+
+/**
+ * @brief  投递到期的仿真中断（串口、TIM24、HAL节拍、内核节拍）
+ * @note   由Sim_Irq_Unmasked在未屏蔽时调用，切换请求在中断全部返回后执行
+ */
+void Sim_Run_Isrs(void) {
+    sim_ipsr = 1U;
+    Sim_TIM_Run();
+    Sim_UART_Run(sim_now_ns);
+    while (sim_now_ns >= sim_next_tick_ns) {
+        sim_next_tick_ns += SIM_TICK_NS;
+        sim_ticks++;
+        {
+            RT_ISR_ENTER(RT_ISR_TIM23);
+            RT_ISR_EXIT(RT_ISR_TIM23);
+        }
+        SysTick_Handler();
+    }
+    sim_ipsr = 0U;
+}
+
+/**
+ * @brief  空闲钩子：没有任务就绪，时间直接跳到下一个事件（跳过的时长计为睡眠）
+ */
+void vApplicationIdleHook(void) {
+    uint64_t t0 = sim_now_ns;
+    Sim_Advance(SIM_NEVER);
+    Sim_Power_Idle(sim_now_ns - t0);
+    sim_pend |= SIM_PEND_ISR;
+    Sim_Irq_Unmasked();
+}
+
+/************************ HAL ************************/
+HAL_StatusTypeDef HAL_Init(void) {
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void) {
+    return (uint32_t)(sim_now_ns / SIM_NS_PER_MS);
+}
+
+/**
+ * @brief  阻塞延时（与HAL相同，不足1ms的部分按1ms补足）
+ */
+void HAL_Delay(uint32_t Delay) {
+    uint64_t ms = Delay;
+    if (Delay < HAL_MAX_DELAY) {
+        ms++;
+    }
+    Sim_Busy_Wait_ns(ms * SIM_NS_PER_MS);
+}
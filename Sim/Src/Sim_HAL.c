@@ -0,0 +1,444 @@
+/**
+ * @file       Sim_HAL.c
+ * @brief      仿真外设：句柄与MX初始化、定时器（舵机比较值记录、TIM24时基）、Flash、CRC、HAL回调
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 舵机PWM比较值每次变化写一行CSV：time_us,timer,channel,compare（time_us为虚拟时间）
+ *             2. TIM24计数即虚拟时间微秒，32位回绕时置更新标志并在中断中调用HAL_TIM_PeriodElapsedCallback
+ *             3. Flash记录区映射在与芯片相同的地址（BB_FLASH_BASE），固件按地址直接读取；
+ *                编程只能把1写成0，编程/擦除按典型耗时忙等，可选从文件载入并在结束时写回
+ *             4. CRC32_Calc为软件实现，结果与硬件CRC外设（及zlib.crc32）一致
+ *             5. 主机没有需要维护的数据缓存，MEM_Cache.c的维护接口为空
+ *             6. HAL回调与main.c相同，仿真入口与基准测试运行器（Sim_Bench.c）共用
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "Sim.h"
+#include "usart.h"
+#include "tim.h"
+#include "crc.h"
+#include "BlackBox.h"
+#include "MEM_Cache.h"
+#include "SBUS_T.h"
+#include "JY901S.h"
+#include "GPS_T.h"
+#include "UART_TX.h"
+#include "Uplink.h"
+#include "TimeBase.h"
+
+/************************ 仿真参数 ************************/
+#define SIM_FLASH_SIZE        (BB_SECTOR_COUNT * BB_SECTOR_SIZE)
+#define SIM_FLASH_PROGRAM_US  20U             // 一个Flash字（32字节）编程耗时
+#define SIM_FLASH_ERASE_MS    500U            // 一个128KB扇区擦除耗时
+
+/************************ 全局变量 ************************/
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+UART_HandleTypeDef huart3;
+UART_HandleTypeDef huart6;
+TIM_HandleTypeDef htim2;
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim4;
+TIM_HandleTypeDef htim24;
+CRC_HandleTypeDef hcrc;
+USART_TypeDef sim_usart1 = {1U}, sim_usart2 = {2U}, sim_usart3 = {3U}, sim_usart6 = {6U};
+TIM_TypeDef sim_tim2, sim_tim3, sim_tim4, sim_tim23, sim_tim24;
+
+/************************ 私有变量 ************************/
+static DMA_HandleTypeDef sim_dma_rx[4];
+static DMA_HandleTypeDef sim_dma_tx[4];
+static FILE *servo_file = NULL;
+static uint64_t servo_updates = 0;
+static uint64_t tim24_base_us = 0;          // TIM24计数为0时的虚拟微秒
+static uint64_t tim24_wraps = 0;            // 已发生的32位回绕
+static bool tim24_started = false;
+static uint8_t *flash_mem = NULL;
+static const char *flash_path = NULL;
+static bool flash_unlocked = false;
+static uint64_t flash_programs = 0;
+static uint64_t flash_erases = 0;
+static uint64_t flash_errors = 0;
+static uint32_t crc_table[256];
+
+/************************ 私有函数实现 ************************/
+static void Sim_UART_Handle_Init(UART_HandleTypeDef *huart, USART_TypeDef *usart, uint32_t index,
+                                 uint32_t baud, uint32_t stop, uint32_t parity) {
+    memset(huart, 0, sizeof(*huart));
+    huart->Instance = usart;
+    huart->Init.BaudRate = baud;
+    huart->Init.WordLength = UART_WORDLENGTH_8B;
+    huart->Init.StopBits = stop;
+    huart->Init.Parity = parity;
+    sim_dma_rx[index].Init.Mode = DMA_CIRCULAR;
+    sim_dma_rx[index].State = HAL_DMA_STATE_READY;
+    sim_dma_tx[index].Init.Mode = DMA_NORMAL;
+    sim_dma_tx[index].State = HAL_DMA_STATE_READY;
+    huart->hdmarx = &sim_dma_rx[index];
+    huart->hdmatx = &sim_dma_tx[index];
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+}
+
+static const char *Sim_TIM_Name(const TIM_TypeDef *tim) {
+    if (tim == TIM2) {
+        return "tim2";
+    } else if (tim == TIM3) {
+        return "tim3";
+    } else if (tim == TIM4) {
+        return "tim4";
+    } else if (tim == TIM24) {
+        return "tim24";
+    }
+    return "tim";
+}
+
+static bool Sim_Flash_Range(uint32_t addr, uint32_t len) {
+    return addr >= BB_FLASH_BASE && (uint64_t)addr + len <= (uint64_t)BB_FLASH_BASE + SIM_FLASH_SIZE;
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  映射Flash记录区（与芯片相同的地址，初始为擦除状态），建立CRC表
+ */
+void Sim_HAL_Init(void) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_FIXED_NOREPLACE
+    flags |= MAP_FIXED_NOREPLACE;
+#endif
+    void *p = mmap((void *)(uintptr_t)BB_FLASH_BASE, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p != (void *)(uintptr_t)BB_FLASH_BASE) {
+        fprintf(stderr, "sim: cannot map flash at 0x%08X\n", BB_FLASH_BASE);
+        exit(1);
+    }
+    flash_mem = p;
+    memset(flash_mem, 0xFF, SIM_FLASH_SIZE);
+
+    for (uint32_t i = 0; i < 256U; i++) {
+        uint32_t c = i;
+        for (uint32_t k = 0; k < 8U; k++) {
+            c = (c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+}
+
+/**
+ * @brief  舵机比较值记录到CSV
+ */
+bool Sim_Servo_Log(const char *path) {
+    servo_file = fopen(path, "w");
+    if (servo_file == NULL) {
+        fprintf(stderr, "sim: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    fprintf(servo_file, "time_us,timer,channel,compare\n");
+    return true;
+}
+
+/**
+ * @brief  从文件载入Flash记录区（文件不存在时为擦除状态），结束时写回
+ */
+bool Sim_Flash_Image(const char *path) {
+    flash_path = path;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return errno == ENOENT;
+    }
+    size_t n = fread(flash_mem, 1, SIM_FLASH_SIZE, f);
+    fclose(f);
+    return n == SIM_FLASH_SIZE;
+}
+
+/**
+ * @brief  更新TIM24计数
+ * @param  now_ns: 虚拟时间
+ */
+void Sim_TIM_Advance(uint64_t now_ns) {
+    uint64_t count = now_ns / SIM_NS_PER_US - tim24_base_us;
+    sim_tim24.CNT = (uint32_t)count;
+    if ((count >> 32) > tim24_wraps) {
+        tim24_wraps = count >> 32;
+        sim_tim24.SR |= TIM_SR_UIF;
+    }
+}
+
+/**
+ * @brief  TIM24更新中断（中断上下文）
+ */
+void Sim_TIM_Run(void) {
+    if (tim24_started && (sim_tim24.SR & TIM_SR_UIF) != 0U) {
+        sim_tim24.SR &= ~TIM_SR_UIF;
+        HAL_TIM_PeriodElapsedCallback(&htim24);
+    }
+}
+
+void Sim_HAL_Finish(void) {
+    if (servo_file != NULL) {
+        fclose(servo_file);
+        servo_file = NULL;
+    }
+    if (flash_path != NULL) {
+        FILE *f = fopen(flash_path, "wb");
+        if (f == NULL || fwrite(flash_mem, 1, SIM_FLASH_SIZE, f) != SIM_FLASH_SIZE) {
+            fprintf(stderr, "sim: cannot write %s\n", flash_path);
+        }
+        if (f != NULL) {
+            fclose(f);
+        }
+    }
+}
+
+void Sim_HAL_Report(FILE *f) {
+    fprintf(f, "  \"servo\": {\"updates\": %llu, \"tail\": %u, \"body\": %u},\n",
+            (unsigned long long)servo_updates, (unsigned)sim_tim2.CCR2, (unsigned)sim_tim3.CCR1);
+    fprintf(f, "  \"flash\": {\"programs\": %llu, \"erases\": %llu, \"errors\": %llu},\n",
+            (unsigned long long)flash_programs, (unsigned long long)flash_erases,
+            (unsigned long long)flash_errors);
+}
+
+/************************ MX初始化 ************************/
+void MX_USART1_UART_Init(void) {
+    Sim_UART_Handle_Init(&huart1, USART1, 0U, 100000U, UART_STOPBITS_2, UART_PARITY_EVEN);
+}
+
+void MX_USART2_UART_Init(void) {
+    Sim_UART_Handle_Init(&huart2, USART2, 1U, 115200U, UART_STOPBITS_1, UART_PARITY_NONE);
+}
+
+void MX_USART3_UART_Init(void) {
+    Sim_UART_Handle_Init(&huart3, USART3, 2U, 115200U, UART_STOPBITS_1, UART_PARITY_NONE);
+}
+
+void MX_USART6_UART_Init(void) {
+    Sim_UART_Handle_Init(&huart6, USART6, 3U, 9600U, UART_STOPBITS_1, UART_PARITY_NONE);
+}
+
+void MX_TIM2_Init(void) {
+    htim2.Instance = TIM2;
+    htim2.Init.Prescaler = 2750 - 1;
+    htim2.Init.Period = 2000 - 1;
+}
+
+void MX_TIM3_Init(void) {
+    htim3.Instance = TIM3;
+    htim3.Init.Prescaler = 2750 - 1;
+    htim3.Init.Period = 2000 - 1;
+}
+
+void MX_TIM4_Init(void) {
+    htim4.Instance = TIM4;
+    htim4.Init.Prescaler = 275 - 1;
+    htim4.Init.Period = 10000 - 1;
+}
+
+void MX_TIM24_Init(void) {
+    htim24.Instance = TIM24;
+    htim24.Init.Prescaler = 275 - 1;
+    htim24.Init.Period = 4294967295U;
+}
+
+void MX_CRC_Init(void) {
+    hcrc.Instance = NULL;
+}
+
+/************************ 定时器 ************************/
+__IO uint32_t *Sim_TIM_CCR(TIM_HandleTypeDef *htim, uint32_t channel) {
+    TIM_TypeDef *tim = htim->Instance;
+    switch (channel) {
+        case TIM_CHANNEL_1: return &tim->CCR1;
+        case TIM_CHANNEL_2: return &tim->CCR2;
+        case TIM_CHANNEL_3: return &tim->CCR3;
+        default:            return &tim->CCR4;
+    }
+}
+
+/**
+ * @brief  设置比较值，变化时记录一行CSV
+ */
+void Sim_TIM_Set_Compare(TIM_HandleTypeDef *htim, uint32_t channel, uint32_t compare) {
+    __IO uint32_t *ccr = Sim_TIM_CCR(htim, channel);
+    if (*ccr == compare) {
+        return;
+    }
+    *ccr = compare;
+    servo_updates++;
+    if (servo_file != NULL) {
+        fprintf(servo_file, "%llu,%s,%u,%u\n", (unsigned long long)(Sim_Now_ns() / SIM_NS_PER_US),
+                Sim_TIM_Name(htim->Instance), (unsigned)(channel / 4U + 1U), (unsigned)compare);
+    }
+}
+
+/**
+ * @brief  设置计数（TIM24为时基：记录计数起点）
+ */
+void Sim_TIM_Set_Counter(TIM_HandleTypeDef *htim, uint32_t counter) {
+    if (htim->Instance == TIM24) {
+        tim24_base_us = Sim_Now_ns() / SIM_NS_PER_US - counter;
+        tim24_wraps = 0U;
+    }
+    htim->Instance->CNT = counter;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    if (htim->Instance == TIM24) {
+        tim24_started = true;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t channel) {
+    (void)channel;
+    htim->Instance->CR1 |= TIM_CR1_CEN;
+    return HAL_OK;
+}
+
+/************************ Flash ************************/
+HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    flash_unlocked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void) {
+    flash_unlocked = false;
+    return HAL_OK;
+}
+
+/**
+ * @brief  编程一个Flash字（32字节，只能把1写成0）
+ * @param  FlashAddress: 目标地址（32字节对齐）
+ * @param  DataAddress: 源数据地址（4GB以下，见Sim_Stack_Alloc）
+ */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t FlashAddress, uint32_t DataAddress) {
+    const uint32_t bytes = FLASH_NB_32BITWORD_IN_FLASHWORD * 4U;
+    if (TypeProgram != FLASH_TYPEPROGRAM_FLASHWORD || !flash_unlocked ||
+        (FlashAddress % bytes) != 0U || !Sim_Flash_Range(FlashAddress, bytes)) {
+        flash_errors++;
+        return HAL_ERROR;
+    }
+    uint8_t *dst = &flash_mem[FlashAddress - BB_FLASH_BASE];
+    const uint8_t *src = (const uint8_t *)(uintptr_t)DataAddress;
+    for (uint32_t i = 0; i < bytes; i++) {
+        dst[i] &= src[i];
+    }
+    flash_programs++;
+    Sim_Busy_Wait_ns((uint64_t)SIM_FLASH_PROGRAM_US * SIM_NS_PER_US);
+    return HAL_OK;
+}
+
+/**
+ * @brief  按扇区擦除（扇区号按Bank1每扇区128KB换算地址）
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError) {
+    *SectorError = 0xFFFFFFFFU;
+    if (!flash_unlocked || pEraseInit->TypeErase != FLASH_TYPEERASE_SECTORS) {
+        flash_errors++;
+        return HAL_ERROR;
+    }
+    for (uint32_t i = 0; i < pEraseInit->NbSectors; i++) {
+        uint32_t sector = pEraseInit->Sector + i;
+        uint32_t addr = FLASH_BANK1_BASE + sector * FLASH_SECTOR_SIZE;
+        if (!Sim_Flash_Range(addr, FLASH_SECTOR_SIZE)) {
+            *SectorError = sector;
+            flash_errors++;
+            return HAL_ERROR;
+        }
+        Sim_Busy_Wait_ns((uint64_t)SIM_FLASH_ERASE_MS * SIM_NS_PER_MS);
+        memset(&flash_mem[addr - BB_FLASH_BASE], 0xFF, FLASH_SECTOR_SIZE);
+        flash_erases++;
+    }
+    return HAL_OK;
+}
+
+/************************ 缓存 ************************/
+void MEM_Init(void) {
+}
+
+void MEM_DCache_Clean(const void *addr, uint32_t len) {
+    (void)addr;
+    (void)len;
+}
+
+void MEM_DCache_Invalidate(void *addr, uint32_t len) {
+    (void)addr;
+    (void)len;
+}
+
+void MEM_DCache_Clean_Invalidate(void *addr, uint32_t len) {
+    (void)addr;
+    (void)len;
+}
+
+/************************ CRC ************************/
+/**
+ * @brief  标准CRC-32（软件查表，与crc.c的硬件实现结果一致）
+ */
+uint32_t CRC32_Calc(const uint8_t *data, uint32_t len) {
+    uint32_t crc = 0xFFFFFFFFU;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+/************************ HAL回调（与main.c相同） ************************/
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart->Instance == USART1) {
+        SBUS_RxEventCallback(huart, Size);
+    }
+    if (huart->Instance == USART2) {
+        Gyroscope_RxEventCallback(huart, Size);
+    }
+    if (huart->Instance == USART6) {
+        GPS_RxEventCallback(huart, Size);
+    }
+    if (huart->Instance == USART3) {
+        Uplink_RxEventCallback(huart, Size);
+    }
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART3) {
+        UART_TX_TxCpltCallback(huart);
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART1) {
+        SBUS_ErrorCallback(huart);
+    }
+    if (huart->Instance == USART2) {
+        Gyroscope_ErrorCallback(huart);
+    }
+    if (huart->Instance == USART6) {
+        GPS_ErrorCallback(huart);
+    }
+    if (huart->Instance == USART3) {
+        UART_TX_ErrorCallback(huart);
+        Uplink_ErrorCallback(huart);
+    }
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+    if (htim->Instance == TIM24) {
+        TimeBase_Overflow_Callback(htim);
+    }
+}
+
+void Error_Handler(void) {
+    fprintf(stderr, "sim: Error_Handler\n");
+    abort();
+}
+
+void Sim_Assert(const char *file, int line) {
+    fprintf(stderr, "sim: assertion failed at %s:%d\n", file, line);
+    abort();
+}
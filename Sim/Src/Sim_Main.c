@@ -0,0 +1,406 @@
+/**
+ * @file       Sim_Main.c
+ * @brief      主机仿真入口：命令行、复位线程（与main.c相同的初始化顺序）、结束报告
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 用法：FISH_H7_sim [--sbus F] [--imu F] [--gps F] [--replay F] [--link F | --pty] [--tlm F] [--servo F]
+ *                [--flash F] [--no-blackbox] [--capture MASK] [--duration S] [--speed X] [--cpu-scale X] [--report F]
+ *                输入文件格式为串口原始字节，可追加,period=ms,burst=N,loop；--replay回放Tools/capture.py录制的采集文件
+ *                （按录制时刻，,scale=X缩放）；--pty把调试串口接到新建的伪终端，Tools/uplink.py、telemetry.py直接打开打印出的从端路径
+ *             2. 固件printf经UART_TX（_write）从调试串口发出，与硬件相同；仿真自身的提示写stderr，
+ *                结束报告（JSON）写--report（默认标准输出）
+ *             3. 固件把栈上变量地址当作32位整数传递，复位线程与任务线程都运行在4GB以下的栈上，进程主线程只等待
+ *             4. 仿真时长：--duration，否则文件输入送完后再运行SIM_DRAIN_MS，无文件输入时SIM_DEFAULT_S，
+ *                伪终端/设备输入时不自动结束（Ctrl-C）
+ */
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Sim.h"
+#include "main.h"
+#include "cmsis_os.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "usart.h"
+#include "tim.h"
+#include "crc.h"
+#include "Start_Task.h"
+#include "SBUS_T.h"
+#include "JY901S.h"
+#include "GPS_T.h"
+#include "NAV_Filter.h"
+#include "Autopilot.h"
+#include "UART_TX.h"
+#include "Telemetry.h"
+#include "CMD_Arbiter.h"
+#include "Uplink.h"
+#include "BlackBox.h"
+#include "Trace.h"
+#include "TimeBase.h"
+#include "Power.h"
+#include "Executive.h"
+#include "RT_Stats.h"
+#include "Capture.h"
+
+/************************ 仿真参数 ************************/
+#define SIM_RESET_STACK       (1024U * 1024U) // 复位线程栈
+#define SIM_TASKS_MAX         16U
+
+/************************ 结构体定义 ************************/
+typedef struct {
+    const char *sbus;                   // USART1接收源
+    const char *imu;                    // USART2接收源
+    const char *gps;                    // USART6接收源
+    const char *replay;                 // 采集文件（USART1/2/6接收源）
+    const char *link;                   // USART3接收源（上行命令）
+    const char *tlm;                    // USART3发送去向（遥测/printf）
+    const char *servo;                  // 舵机比较值CSV
+    const char *flash;                  // Flash记录区镜像
+    const char *report;                 // 结束报告
+    bool pty;                           // USART3接伪终端
+    bool no_blackbox;                   // 不初始化黑匣子（不记录，与记录时的控制抖动对比）
+    uint8_t capture;                    // 上电即开启的原始数据采集源（Capture_Source_t位）
+    bool duration_set;
+    Sim_Config_t cfg;
+} Sim_Options_t;
+
+/************************ 私有变量 ************************/
+static Sim_Options_t sim_opt = {
+    .report = "-",
+    .cfg = {.duration_ns = SIM_NEVER, .speed = -1.0, .cpu_scale = 1.0},
+};
+static int sim_exit_code = 0;
+
+extern int _write(int file, char *ptr, int len);
+extern void MX_FREERTOS_Init(void);
+
+/************************ 私有函数实现 ************************/
+static void Sim_Usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --sbus FILE[,period=ms][,burst=N][,loop]   USART1 (SBUS) input\n"
+            "  --imu FILE[,...]       USART2 (JY901S) input\n"
+            "  --gps FILE[,...]       USART6 (GPS) input\n"
+            "  --replay FILE[,scale=X]  replay a capture file into USART1/2/6 (X = time scale, 0 = line rate)\n"
+            "  --link FILE[,...]      USART3 input (uplink commands)\n"
+            "  --tlm FILE             USART3 output (telemetry and printf), '-' = stdout\n"
+            "  --pty                  connect USART3 to a new pseudo-terminal\n"
+            "  --servo FILE           servo compare value log (CSV)\n"
+            "  --flash FILE           black box flash image (loaded if present, written at exit)\n"
+            "  --no-blackbox          leave the black box off (baseline for its control-loop cost)\n"
+            "  --capture MASK         enable raw sensor capture at boot (bit 0 SBUS, 1 IMU, 2 GPS)\n"
+            "  --duration SECONDS     virtual run time after the scheduler starts\n"
+            "  --speed X              run at X times real time (default: as fast as possible)\n"
+            "  --cpu-scale X          host CPU time added to DWT cycles (0 = fully deterministic)\n"
+            "  --report FILE          JSON run report, '-' = stdout (default)\n",
+            prog);
+}
+
+static bool Sim_Parse(int argc, char **argv) {
+    enum { OPT_SBUS = 1, OPT_IMU, OPT_GPS, OPT_REPLAY, OPT_LINK, OPT_TLM, OPT_PTY, OPT_SERVO, OPT_FLASH,
+           OPT_NO_BLACKBOX, OPT_CAPTURE, OPT_DURATION, OPT_SPEED, OPT_CPU_SCALE, OPT_REPORT, OPT_HELP };
+    static const struct option longopts[] = {
+        {"sbus", required_argument, NULL, OPT_SBUS},
+        {"imu", required_argument, NULL, OPT_IMU},
+        {"gps", required_argument, NULL, OPT_GPS},
+        {"replay", required_argument, NULL, OPT_REPLAY},
+        {"link", required_argument, NULL, OPT_LINK},
+        {"tlm", required_argument, NULL, OPT_TLM},
+        {"pty", no_argument, NULL, OPT_PTY},
+        {"servo", required_argument, NULL, OPT_SERVO},
+        {"flash", required_argument, NULL, OPT_FLASH},
+        {"no-blackbox", no_argument, NULL, OPT_NO_BLACKBOX},
+        {"capture", required_argument, NULL, OPT_CAPTURE},
+        {"duration", required_argument, NULL, OPT_DURATION},
+        {"speed", required_argument, NULL, OPT_SPEED},
+        {"cpu-scale", required_argument, NULL, OPT_CPU_SCALE},
+        {"report", required_argument, NULL, OPT_REPORT},
+        {"help", no_argument, NULL, OPT_HELP},
+        {NULL, 0, NULL, 0},
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "", longopts, NULL)) != -1) {
+        switch (c) {
+            case OPT_SBUS:      sim_opt.sbus = optarg; break;
+            case OPT_IMU:       sim_opt.imu = optarg; break;
+            case OPT_GPS:       sim_opt.gps = optarg; break;
+            case OPT_REPLAY:    sim_opt.replay = optarg; break;
+            case OPT_LINK:      sim_opt.link = optarg; break;
+            case OPT_TLM:       sim_opt.tlm = optarg; break;
+            case OPT_PTY:       sim_opt.pty = true; break;
+            case OPT_SERVO:     sim_opt.servo = optarg; break;
+            case OPT_FLASH:     sim_opt.flash = optarg; break;
+            case OPT_NO_BLACKBOX: sim_opt.no_blackbox = true; break;
+            case OPT_CAPTURE:   sim_opt.capture = (uint8_t)strtoul(optarg, NULL, 0); break;
+            case OPT_DURATION:
+                sim_opt.cfg.duration_ns = (uint64_t)(strtod(optarg, NULL) * (double)SIM_NS_PER_S);
+                sim_opt.duration_set = true;
+                break;
+            case OPT_SPEED:     sim_opt.cfg.speed = strtod(optarg, NULL); break;
+            case OPT_CPU_SCALE: sim_opt.cfg.cpu_scale = strtod(optarg, NULL); break;
+            case OPT_REPORT:    sim_opt.report = optarg; break;
+            default:
+                Sim_Usage(argv[0]);
+                return false;
+        }
+    }
+    if (optind != argc || (sim_opt.pty && (sim_opt.link != NULL || sim_opt.tlm != NULL))) {
+        Sim_Usage(argv[0]);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief  打开输入输出并确定仿真时长与运行速度
+ */
+static bool Sim_Setup(void) {
+    bool ok = true;
+    if (sim_opt.sbus != NULL) ok = ok && Sim_UART_Source(USART1, sim_opt.sbus);
+    if (sim_opt.imu != NULL)  ok = ok && Sim_UART_Source(USART2, sim_opt.imu);
+    if (sim_opt.gps != NULL)  ok = ok && Sim_UART_Source(USART6, sim_opt.gps);
+    if (sim_opt.replay != NULL) ok = ok && Sim_UART_Replay(sim_opt.replay);
+    if (sim_opt.link != NULL) ok = ok && Sim_UART_Source(USART3, sim_opt.link);
+    if (sim_opt.tlm != NULL)  ok = ok && Sim_UART_Sink(USART3, sim_opt.tlm);
+    if (sim_opt.servo != NULL) ok = ok && Sim_Servo_Log(sim_opt.servo);
+    if (sim_opt.flash != NULL && ok && !Sim_Flash_Image(sim_opt.flash)) {
+        fprintf(stderr, "sim: %s: not a %u-byte flash image\n", sim_opt.flash, BB_SECTOR_COUNT * BB_SECTOR_SIZE);
+        ok = false;
+    }
+    if (ok && sim_opt.pty) {
+        const char *name = Sim_UART_Pty(USART3);
+        if (name == NULL) {
+            fprintf(stderr, "sim: cannot create pseudo-terminal\n");
+            return false;
+        }
+        fprintf(stderr, "sim: USART3 on %s\n", name);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    Sim_Config_t *cfg = &sim_opt.cfg;
+    bool realtime = Sim_UART_Realtime();
+    if (!sim_opt.duration_set) {
+        uint64_t inputs = Sim_UART_Inputs_ns();
+        if (realtime) {
+            cfg->duration_ns = SIM_NEVER;
+        } else if (inputs == 0U || inputs == SIM_NEVER) {
+            cfg->duration_ns = (uint64_t)SIM_DEFAULT_S * SIM_NS_PER_S;
+        } else {
+            cfg->duration_ns = inputs + (uint64_t)SIM_DRAIN_MS * SIM_NS_PER_MS;
+        }
+    }
+    if (cfg->speed < 0.0) {
+        cfg->speed = realtime ? 1.0 : 0.0;
+    }
+    return true;
+}
+
+/**
+ * @brief  固件的stdout写到调试串口（UART_TX的_write），与newlib的重定向相同
+ */
+static ssize_t Sim_Stdout_Write(void *cookie, const char *buf, size_t size) {
+    (void)cookie;
+    return _write(1, (char *)buf, (int)size);
+}
+
+static void Sim_Report(FILE *f, uint64_t wall_ns) {
+    uint64_t virt_ns = Sim_Now_ns() - Sim_Start_ns();
+    fprintf(f, "{\n");
+    fprintf(f, "  \"timing\": {\"virtual_s\": %.6f, \"wall_s\": %.6f, \"ratio\": %.2f, \"ticks\": %llu},\n",
+            (double)virt_ns / SIM_NS_PER_S, (double)wall_ns / SIM_NS_PER_S,
+            (wall_ns != 0U) ? (double)virt_ns / (double)wall_ns : 0.0, (unsigned long long)Sim_Tick_Count());
+    Sim_UART_Report(f, wall_ns);
+    Sim_HAL_Report(f);
+    Sim_Power_Report(f);
+
+    static TaskStatus_t tasks[SIM_TASKS_MAX];
+    static RT_Report_t rt;
+    RT_Stats_Get(&rt);
+    UBaseType_t n = uxTaskGetSystemState(tasks, SIM_TASKS_MAX, NULL);
+    fprintf(f, "  \"tasks\": [\n");
+    for (UBaseType_t i = 0; i < n; i++) {
+        // run：整个运行期间的虚拟时间占比（忙等/空闲）；load：RT_Stats最近一个窗口按DWT算的占用（含主机执行时间）
+        uint64_t run_ns = Sim_Task_Run_ns(tasks[i].xHandle);
+        uint32_t load = 0;
+        for (uint32_t k = 0; k < RT_TASK_MAX; k++) {
+            if (rt.task[k].name != NULL && strcmp(rt.task[k].name, tasks[i].pcTaskName) == 0) {
+                load = rt.task[k].load;
+            }
+        }
+        fprintf(f, "    {\"name\": \"%s\", \"priority\": %lu, \"run_ms\": %.3f, \"run\": %.2f, \"load\": %.2f}%s\n",
+                tasks[i].pcTaskName, (unsigned long)tasks[i].uxCurrentPriority, (double)run_ns / SIM_NS_PER_MS,
+                (virt_ns != 0U) ? 100.0 * (double)run_ns / (double)virt_ns : 0.0, load / 100.0,
+                (i + 1U < n) ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+
+#if EXEC_ENABLE
+    const Exec_Job_t *jobs = NULL;
+    uint32_t jobs_n = Exec_Get_Jobs(&jobs);
+    fprintf(f, "  \"exec\": [\n");
+    for (uint32_t i = 0; i < jobs_n; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"runs\": %u, \"overruns\": %u, \"cycles_max\": %u, \"wait_us_max\": %u}%s\n",
+                jobs[i].name, (unsigned)exec_stats[i].runs, (unsigned)exec_stats[i].overruns,
+                (unsigned)exec_stats[i].cycles_max, (unsigned)exec_stats[i].wait_us_max,
+                (i + 1U < jobs_n) ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+#endif
+
+    fprintf(f, "  \"control\": {\"cycles_max\": %u, \"jitter_us_max\": %u, \"deadline_misses\": %u, "
+               "\"input_age_max\": [%u, %u, %u]},\n",
+            (unsigned)control_stats.cycles_max, (unsigned)control_stats.jitter_us_max,
+            (unsigned)control_stats.deadline_misses,
+            (unsigned)control_stats.input_age_max[INPUT_IMU], (unsigned)control_stats.input_age_max[INPUT_RC],
+            (unsigned)control_stats.input_age_max[INPUT_GPS]);
+    fprintf(f, "  \"switch\": {\"count\": %u, \"cycles_avg\": %u, \"cycles_max\": %u},\n",
+            (unsigned)os_switch_stats.count,
+            (unsigned)((os_switch_stats.count != 0U) ? os_switch_stats.cycles_sum / os_switch_stats.count : 0U),
+            (unsigned)os_switch_stats.cycles_max);
+    fprintf(f, "  \"input_age_us_max\": {\"imu\": %u, \"rc\": %u, \"gps\": %u},\n",
+            (unsigned)TimeBase_Cycles_To_us(control_stats.input_age_max[INPUT_IMU]),
+            (unsigned)TimeBase_Cycles_To_us(control_stats.input_age_max[INPUT_RC]),
+            (unsigned)TimeBase_Cycles_To_us(control_stats.input_age_max[INPUT_GPS]));
+    fprintf(f, "  \"sbus\": {\"frames\": %u, \"format_errors\": %u, \"failsafe\": %u, \"frame_lost\": %u, "
+               "\"rx_restarts\": %u},\n",
+            (unsigned)sbus_stats.frames, (unsigned)sbus_stats.format_errors,
+            (unsigned)sbus_data.failsafe, (unsigned)sbus_data.frame_lost, (unsigned)sbus_stats.rx_restarts);
+    fprintf(f, "  \"imu\": {\"frames\": %u, \"checksum_errors\": %u, \"backlog_max\": %u, \"rx_restarts\": %u},\n",
+            (unsigned)jy901s_stats.frames, (unsigned)jy901s_stats.checksum_errors,
+            (unsigned)jy901s_stats.backlog_max, (unsigned)jy901s_stats.rx_restarts);
+    fprintf(f, "  \"gps\": {\"rx_bytes\": %u, \"sentences\": %u, \"checksum_errors\": %u, \"binary_frames\": %u, "
+               "\"overflows\": %u, \"ring_overruns\": %u, \"backlog_max\": %u, \"rx_restarts\": %u},\n",
+            (unsigned)gps_stats.rx_bytes, (unsigned)gps_stats.sentences, (unsigned)gps_stats.checksum_errors,
+            (unsigned)gps_stats.binary_frames, (unsigned)gps_stats.overflows, (unsigned)gps_stats.ring_overruns,
+            (unsigned)gps_stats.backlog_max, (unsigned)gps_stats.rx_restarts);
+    fprintf(f, "  \"capture\": {\"mask\": %u, \"bytes\": [%u, %u, %u], \"chunks\": %u, \"sent\": %u, "
+               "\"dropped\": %u, \"pending_max\": %u},\n",
+            (unsigned)Capture_Get_Mask(), (unsigned)capture_stats.bytes[CAPTURE_SRC_SBUS],
+            (unsigned)capture_stats.bytes[CAPTURE_SRC_IMU], (unsigned)capture_stats.bytes[CAPTURE_SRC_GPS],
+            (unsigned)capture_stats.chunks, (unsigned)capture_stats.sent, (unsigned)capture_stats.dropped,
+            (unsigned)capture_stats.pending_max);
+    fprintf(f, "  \"nav\": {\"valid\": %s, \"gps_updates\": %u, \"predict_steps\": %u, "
+               "\"predict_cycles_max\": %u, \"update_cycles_max\": %u},\n",
+            nav_state.valid ? "true" : "false", (unsigned)nav_state.gps_updates, (unsigned)nav_state.predict_steps,
+            (unsigned)nav_state.predict_cycles_max, (unsigned)nav_state.update_cycles_max);
+    fprintf(f, "  \"uplink\": {\"rx_bytes\": %u, \"frames\": %u, \"crc_errors\": %u, \"oversize\": %u, "
+               "\"ring_overruns\": %u, \"rx_restarts\": %u},\n",
+            (unsigned)uplink_stats.rx_bytes, (unsigned)uplink_stats.frames, (unsigned)uplink_stats.crc_errors,
+            (unsigned)uplink_stats.oversize, (unsigned)uplink_stats.ring_overruns,
+            (unsigned)uplink_stats.rx_restarts);
+    fprintf(f, "  \"cmd_arbiter\": {\"active\": %u, \"switches\": %u},\n",
+            (unsigned)cmd_arbiter_stats.active, (unsigned)cmd_arbiter_stats.switches);
+    fprintf(f, "  \"uart_tx\": {\"queued\": %u, \"sent\": %u, \"dropped\": %u, \"dma_errors\": %u, "
+               "\"level_max\": %u},\n",
+            (unsigned)uart_tx_stats.queued, (unsigned)uart_tx_stats.sent, (unsigned)uart_tx_stats.dropped,
+            (unsigned)uart_tx_stats.dma_errors, (unsigned)uart_tx_stats.level_max);
+    fprintf(f, "  \"telemetry\": {\"frames\": %u, \"bytes\": %u, \"dropped\": %u},\n",
+            (unsigned)tlm_stats.frames, (unsigned)tlm_stats.bytes, (unsigned)tlm_stats.dropped);
+    fprintf(f, "  \"blackbox\": {\"records\": %u, \"dropped\": %u, \"lost_bytes\": %u, \"flash_bytes\": %u, "
+               "\"flash_errors\": %u, \"erases\": %u}\n",
+            (unsigned)bb_stats.records, (unsigned)bb_stats.dropped, (unsigned)bb_stats.lost_bytes,
+            (unsigned)bb_stats.flash_bytes, (unsigned)bb_stats.flash_errors, (unsigned)bb_stats.erases);
+    fprintf(f, "}\n");
+}
+
+/**
+ * @brief  复位线程：与main.c相同的外设与模块初始化，启动调度器，结束后输出报告
+ */
+static void *Sim_Reset(void *arg) {
+    (void)arg;
+    Sim_Port_Init();
+    Sim_HAL_Init();
+    if (!Sim_Setup()) {
+        sim_exit_code = 2;
+        return NULL;
+    }
+    Sim_Clock_Init(&sim_opt.cfg);
+    static const cookie_io_functions_t stdout_io = {.write = Sim_Stdout_Write};
+    stdout = fopencookie(NULL, "w", stdout_io);
+
+    HAL_Init();
+    MX_TIM2_Init();
+    MX_TIM3_Init();
+    MX_USART1_UART_Init();
+    MX_USART2_UART_Init();
+    MX_USART3_UART_Init();
+    MX_USART6_UART_Init();
+    MX_TIM4_Init();
+    MX_CRC_Init();
+    MX_TIM24_Init();
+
+    TimeBase_Init(&htim24);
+    Power_Init();
+    HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_2);
+    HAL_TIM_PWM_Start(&htim3, TIM_CHANNEL_1);
+    UART_TX_Init(&huart_debug);
+    Capture_Init();
+    Capture_Set_Mask(sim_opt.capture);
+    SBUS_Init(&huart1, &huart_debug);
+    Gyroscope_Init(&huart_JY901S, &huart_debug);
+    GPS_Init(&huart_GPS, &huart_debug);
+    NAV_Init();
+    Trace_Init();
+    AP_Init();
+    Telemetry_Init();
+    if (!sim_opt.no_blackbox) {
+        BlackBox_Init();
+    }
+    CMD_Arbiter_Init();
+    Uplink_Init(&huart_debug);
+
+    uint64_t wall0 = Sim_Wall_ns();
+    osKernelInitialize();
+    MX_FREERTOS_Init();
+    osKernelStart();
+    uint64_t wall_ns = Sim_Wall_ns() - wall0;
+
+    fflush(stdout);
+    Sim_HAL_Finish();
+    FILE *f = (strcmp(sim_opt.report, "-") == 0) ? fdopen(dup(STDOUT_FILENO), "w") : fopen(sim_opt.report, "w");
+    if (f == NULL) {
+        fprintf(stderr, "sim: cannot write report %s\n", sim_opt.report);
+        sim_exit_code = 1;
+        return NULL;
+    }
+    Sim_Report(f, wall_ns);
+    fclose(f);
+    return NULL;
+}
+
+static void Sim_Signal(int sig) {
+    (void)sig;
+    Sim_Request_Stop();
+}
+
+/************************ 入口 ************************/
+int main(int argc, char **argv) {
+    if (!Sim_Parse(argc, argv)) {
+        return 2;
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = Sim_Signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t reset;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, Sim_Stack_Alloc(SIM_RESET_STACK), SIM_RESET_STACK);
+    if (pthread_create(&reset, &attr, Sim_Reset, NULL) != 0) {
+        fprintf(stderr, "sim: pthread_create failed\n");
+        return 1;
+    }
+    pthread_join(reset, NULL);
+    // 任务线程仍阻塞在各自的条件变量上，直接结束进程
+    _exit(sim_exit_code);
+}
@@ -0,0 +1,145 @@
+/**
+ * @file       Sim_Power.c
+ * @brief      仿真功耗管理：与Power.h接口相同，时钟档只改变主频，空闲跳过的虚拟时间计为睡眠
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 换档仍由黑匣子后台任务执行（上行POWER命令 → Power_Request_Profile → Power_Service），
+ *                挂起调度器忙等SIM_POWER_SWITCH_US模拟PLL重锁，随后改SystemCoreClock并通知TimeBase；
+ *                仿真DWT按当前主频累计虚拟时间对应的周期，换档前后计数连续
+ *             2. 没有WFI：空闲钩子每次把时间跳到下一个事件，跳过的时长在睡眠开启时计入power_stats，
+ *                遥测POWER消息的睡眠占比即虚拟CPU空闲占比
+ *             3. 舵机PWM只记录比较值，不模拟计数频率，换档不重设PWM定时器预分频
+ */
+#include "Power.h"
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include "TimeBase.h"
+#include "Sim.h"
+
+/************************ 仿真参数 ************************/
+#define SIM_POWER_SWITCH_US   120U            // 换档耗时（切HSI、PLL重锁、切回）
+
+/************************ 全局变量 ************************/
+Power_Stats_t power_stats;
+
+/************************ 私有变量 ************************/
+static const uint32_t power_hz[POWER_PROFILE_COUNT] = {
+    [POWER_PROFILE_PERFORMANCE] = 550000000U,
+    [POWER_PROFILE_ECONOMY]     = 160000000U,
+};
+static const uint8_t power_vos[POWER_PROFILE_COUNT] = {
+    [POWER_PROFILE_PERFORMANCE] = 0U,
+    [POWER_PROFILE_ECONOMY]     = 3U,
+};
+static Power_Profile_t power_profile = POWER_PROFILE_PERFORMANCE;
+static volatile Power_Profile_t power_request = POWER_PROFILE_PERFORMANCE;
+static volatile bool power_switch_pending = false;
+static uint32_t power_window_sleeps;                // 最近一个统计窗口的睡眠次数
+static uint16_t power_window_sleep;                 // 最近一个统计窗口的睡眠占比，0.01%
+static volatile bool power_sleep_enable = true;
+
+/************************ 公有函数实现 ************************/
+void Power_Init(void) {
+    memset(&power_stats, 0, sizeof(power_stats));
+    power_profile = POWER_PROFILE_PERFORMANCE;
+    power_sleep_enable = true;
+}
+
+bool Power_Request_Profile(Power_Profile_t profile) {
+    if ((unsigned)profile >= POWER_PROFILE_COUNT || power_switch_pending) {
+        return false;
+    }
+    if (profile == power_profile) {
+        return true;
+    }
+    power_request = profile;
+    power_switch_pending = true;
+    osThreadFlagsSet(BlackBox_TaskHandle, POWER_FLAG_SWITCH);
+    return true;
+}
+
+void Power_Set_Sleep(bool enable) {
+    power_sleep_enable = enable;
+}
+
+Power_Profile_t Power_Get_Profile(void) {
+    return power_profile;
+}
+
+/**
+ * @brief  后台任务处理：执行换档请求
+ * @note   定时器时钟 = HCLK = SYSCLK/2（与Power.c相同），TimeBase据此重设预分频与周期换算
+ */
+void Power_Service(void) {
+    if (!power_switch_pending) {
+        return;
+    }
+    Power_Profile_t profile = power_request;
+    vTaskSuspendAll();
+    uint64_t t0 = TimeBase_Now_us();
+    Sim_Busy_Wait_ns((uint64_t)SIM_POWER_SWITCH_US * SIM_NS_PER_US);
+    __disable_irq();
+    SystemCoreClock = power_hz[profile];
+    SysTick->LOAD = SystemCoreClock / configTICK_RATE_HZ - 1U;
+    TimeBase_Clock_Changed(SystemCoreClock / 2U);
+    __enable_irq();
+    power_stats.switch_us = (uint32_t)(TimeBase_Now_us() - t0);
+    (void)xTaskResumeAll();
+
+    power_profile = profile;
+    power_stats.switches++;
+    power_switch_pending = false;
+}
+
+/**
+ * @brief  仿真空闲（Sim_Clock.c的空闲钩子调用）：睡眠开启时把跳过的时长计为一次睡眠
+ * @param  idle_ns: 本次跳过的虚拟时间
+ */
+void Sim_Power_Idle(uint64_t idle_ns) {
+    if (!power_sleep_enable || idle_ns == 0U) {
+        return;
+    }
+    power_stats.sleeps++;
+    power_stats.sleep_us += idle_ns / SIM_NS_PER_US;
+}
+
+void Power_Sample(void) {
+    static uint64_t last_us = 0, last_sleep_us = 0;
+    static uint32_t last_sleeps = 0;
+    uint64_t now_us = TimeBase_Now_us();
+    uint64_t window = now_us - last_us;
+    uint64_t slept = power_stats.sleep_us - last_sleep_us;
+    uint32_t sleeps = power_stats.sleeps;
+
+    vTaskSuspendAll();
+    power_window_sleeps = sleeps - last_sleeps;
+    power_window_sleep = (window != 0U) ? (uint16_t)(slept * 10000U / window) : 0U;
+    (void)xTaskResumeAll();
+    last_us = now_us;
+    last_sleep_us += slept;
+    last_sleeps = sleeps;
+}
+
+void Power_Get_Message(TLM_Power_t *msg) {
+    msg->cpu_hz = SystemCoreClock;
+    vTaskSuspendAll();
+    msg->sleeps = power_window_sleeps;
+    msg->sleep = power_window_sleep;
+    (void)xTaskResumeAll();
+    msg->switch_us = (uint16_t)(power_stats.switch_us > 0xFFFFU ? 0xFFFFU : power_stats.switch_us);
+    msg->switches = (uint16_t)power_stats.switches;
+    msg->profile = (uint8_t)power_profile;
+    msg->sleep_enable = power_sleep_enable ? 1U : 0U;
+    msg->vos = power_vos[power_profile];
+}
+
+void Sim_Power_Report(FILE *f) {
+    fprintf(f, "  \"power\": {\"profile\": %u, \"cpu_hz\": %u, \"sleeps\": %u, \"sleep_us\": %llu, "
+               "\"switches\": %u},\n",
+            (unsigned)power_profile, (unsigned)SystemCoreClock, (unsigned)power_stats.sleeps,
+            (unsigned long long)power_stats.sleep_us, (unsigned)power_stats.switches);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file       Sim_Test.c
+ * @brief      主机测试运行器：命令行与输出格式同GoogleTest，用例在Sim/Test/下用SIM_TEST注册
+ * @author     ottohesl
+ * @date       26-1-29
+ * @version    V1.0
+ * @note       1. 用法：FISH_H7_test_host [--gtest_filter=正则] [--gtest_list_tests]
+ *             2. 用例之间不复位固件模块的静态状态，需要干净状态的用例自行调用模块的初始化函数
+ *             3. 外设用仿真的句柄与寄存器模型（Sim_HAL.c），不启动调度器与虚拟时间（同FISH_H7_bench_host）
+ *             4. 有用例失败时退出码为1，CTest据此判定（顶层CMakeLists.txt中FISH_SIM分支开启enable_testing）
+ */
+#define _GNU_SOURCE
+#include <regex.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Sim.h"
+#include "Sim_Test.h"
+#include "main.h"
+#include "usart.h"
+#include "tim.h"
+#include "TimeBase.h"
+
+/************************ 外部变量 ************************/
+// 链接器为sim_tests段生成的起止符号
+extern const Sim_Test_Case_t *const __start_sim_tests[];
+extern const Sim_Test_Case_t *const __stop_sim_tests[];
+
+/************************ 私有变量 ************************/
+static uint32_t test_failures = 0;      // 当前用例的失败次数
+
+/************************ 公开函数实现 ************************/
+void Sim_Test_Fail(const char *file, int line, const char *expr) {
+    test_failures++;
+    fprintf(stdout, "%s:%d: Failure\n  check: %s\n", file, line, expr);
+}
+
+uint32_t Sim_Test_Failures(void) {
+    return test_failures;
+}
+
+void Sim_Test_Note(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fputs("  ", stdout);
+    vfprintf(stdout, fmt, args);
+    fputc('\n', stdout);
+    va_end(args);
+}
+
+/************************ 私有函数实现 ************************/
+static uint64_t Sim_Test_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+static void Sim_Test_Usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --gtest_filter=REGEX     run tests whose name matches (default: all)\n"
+            "  --gtest_list_tests       print test names and exit\n",
+            prog);
+}
+
+/************************ 入口 ************************/
+int main(int argc, char **argv) {
+    const char *filter = ".";
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--gtest_filter=", 15) == 0) {
+            filter = argv[i] + 15;
+        } else if (strcmp(argv[i], "--gtest_list_tests") == 0) {
+            list = true;
+        } else {
+            Sim_Test_Usage(argv[0]);
+            return 2;
+        }
+    }
+    regex_t re;
+    if (regcomp(&re, filter, REG_EXTENDED | REG_NOSUB) != 0) {
+        fprintf(stderr, "test: bad filter %s\n", filter);
+        return 2;
+    }
+
+    // 与main.c相同的外设初始化（只建立句柄与寄存器模型，传感器DMA不启动）
+    Sim_HAL_Init();
+    MX_TIM2_Init();
+    MX_TIM3_Init();
+    MX_USART1_UART_Init();
+    MX_USART2_UART_Init();
+    MX_USART3_UART_Init();
+    MX_USART6_UART_Init();
+    MX_TIM4_Init();
+    MX_TIM24_Init();
+    TimeBase_Init(&htim24);
+
+    const Sim_Test_Case_t *const *cases = __start_sim_tests;
+    uint32_t count = (uint32_t)(__stop_sim_tests - __start_sim_tests);
+    const Sim_Test_Case_t **run = calloc(count > 0U ? count : 1U, sizeof(*run));
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (regexec(&re, cases[i]->name, 0, NULL, 0) == 0) {
+            run[n++] = cases[i];
+        }
+    }
+    regfree(&re);
+    if (list) {
+        for (uint32_t i = 0; i < n; i++) {
+            printf("%s\n", run[i]->name);
+        }
+        free(run);
+        return 0;
+    }
+
+    printf("[==========] Running %u tests.\n", n);
+    uint32_t failed = 0;
+    uint64_t t_all = Sim_Test_ms();
+    for (uint32_t i = 0; i < n; i++) {
+        printf("[ RUN      ] %s\n", run[i]->name);
+        fflush(stdout);
+        test_failures = 0;
+        uint64_t t0 = Sim_Test_ms();
+        run[i]->run();
+        uint64_t ms = Sim_Test_ms() - t0;
+        if (test_failures == 0U) {
+            printf("[       OK ] %s (%llu ms)\n", run[i]->name, (unsigned long long)ms);
+        } else {
+            printf("[  FAILED  ] %s (%llu ms, %u failures)\n", run[i]->name, (unsigned long long)ms,
+                   test_failures);
+            failed++;
+        }
+        fflush(stdout);
+    }
+    printf("[==========] %u tests ran. (%llu ms total)\n", n, (unsigned long long)(Sim_Test_ms() - t_all));
+    printf("[  PASSED  ] %u tests.\n", n - failed);
+    if (failed != 0U) {
+        printf("[  FAILED  ] %u tests.\n", failed);
+    }
+    free(run);
+    return (failed != 0U) ? 1 : 0;
+}
@@ -0,0 +1,748 @@
+/**
+ * @file       Sim_UART.c
+ * @brief      仿真串口：循环DMA+空闲接收、阻塞/DMA发送，输入来自文件或伪终端，输出到文件或伪终端
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 接收按HAL的循环DMA语义写入固件缓冲区：写到一半/写满时以DMA中断投递半满/满事件，
+ *                一段数据写完后以串口中断投递空闲事件（Size为写入位置），__HAL_DMA_GET_COUNTER返回剩余数
+ *             2. 文件输入按“每period毫秒一段burst字节”送出（默认值按各传感器的帧长与帧率），从调度器启动时开始；
+ *                每段按线路速率逐字节到达（Sim_UART_Wire_ns），只在经过半满/满位置与一段结束时产生事件，
+ *                一段结束后线路空闲一个字符时间才投递空闲事件（下一段紧接着开始则没有空闲事件，同硬件）；
+ *                上一段还在线上时下一段顺延到其结束。伪终端/设备输入在每个事件点非阻塞读取，需要按实际时间运行
+ *             3. DMA发送立即写到输出，按波特率算出的线上时间之后投递发送完成（USART3中断）；
+ *                阻塞发送同样忙等线上时间（中断中/屏蔽期间不等）
+ *             4. 输出非阻塞，对端来不及读时丢弃并计数
+ *             5. 采集文件回放（--replay，格式见Tools/capture.py）：各源的数据块按录制时刻（乘scale）开始送入对应串口，
+ *                同样按线路速率到达，前一块还在线上时顺延；scale=0即按线路速率尽快送出
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Sim.h"
+#include "RT_Stats.h"
+#include <termios.h>                // 定义CR1等宏，放在外设结构体定义之后
+
+/************************ 仿真参数 ************************/
+#define SIM_UART_N            4U
+#define SIM_UART_READ_MAX     256U            // 伪终端/设备每个事件点最多读取的字节数
+#define SIM_CAPTURE_MAGIC     "FCAP"          // 采集文件头（与Tools/capture.py一致）
+#define SIM_CAPTURE_VERSION   1U
+#define SIM_CAPTURE_SOURCES   3U              // 源编号0~2：SBUS/IMU/GPS（Capture_Source_t）
+
+/************************ 结构体定义 ************************/
+typedef struct {
+    USART_TypeDef *usart;
+    const char *name;
+    RT_ISR_Id_t dma_isr;                // 接收DMA中断（半满/满）
+    RT_ISR_Id_t uart_isr;               // 串口中断（空闲/发送完成）
+    uint32_t period_ms;                 // 文件输入默认节奏
+    uint32_t burst;
+    uint32_t byte_ns;                   // 固件初始化后的单字节线上时间（估算回放时长用）
+
+    UART_HandleTypeDef *huart;          // 接收已启动的句柄
+    uint8_t *buf;                       // 固件的循环接收缓冲区
+    uint16_t size;
+    uint16_t pos;                       // DMA写入位置
+    bool rx_active;
+
+    int src_fd;                         // 伪终端/设备输入，-1=无
+    uint8_t *data;                      // 文件输入内容
+    size_t len;
+    size_t off;
+    bool loop;
+    uint64_t period_ns;
+    uint32_t chunk;
+    uint64_t next_ns;                   // 下一段输入的开始时刻（不早于上一段结束），SIM_NEVER=无
+    const uint8_t *wire;                // 正在线上的一段，NULL=线路上没有数据
+    uint32_t wire_len;
+    uint32_t wire_done;                 // 已到达（写入DMA缓冲区）的字节数
+    uint64_t wire_start_ns;             // 这一段第一个字节的起始时刻
+    uint64_t idle_ns;                   // 待投递的空闲事件时刻，SIM_NEVER=无
+    uint64_t *rec_ns;                   // 回放：各块相对录制起点的时刻（已乘scale），NULL=不是回放输入
+    uint32_t *rec_len;                  // 回放：各块字节数
+    size_t rec_n;
+    size_t rec_i;
+    uint64_t rec_start_ns;              // 回放起点（调度器启动）
+
+    int sink_fd;                        // 发送去向，-1=丢弃
+
+    UART_HandleTypeDef *tx_huart;       // DMA发送中的句柄
+    uint64_t tx_done_ns;
+
+    uint64_t rx_bytes;                  // 写入DMA缓冲区的字节
+    uint64_t rx_dropped;                // 接收未启动时到达的字节
+    uint64_t rx_events;                 // 投递的接收事件（半满/满/空闲）
+    uint64_t tx_bytes;
+    uint64_t tx_dropped;                // 输出来不及读而丢弃的字节
+} Sim_UART_t;
+
+/************************ 私有变量 ************************/
+static Sim_UART_t sim_uart[SIM_UART_N] = {
+    {.usart = USART1, .name = "usart1_sbus", .dma_isr = RT_ISR_DMA1_S4, .uart_isr = RT_ISR_USART1,
+     .period_ms = 14U, .burst = 25U, .byte_ns = 120000U, .src_fd = -1, .sink_fd = -1, .next_ns = SIM_NEVER,
+     .idle_ns = SIM_NEVER},
+    {.usart = USART2, .name = "usart2_imu", .dma_isr = RT_ISR_DMA1_S0, .uart_isr = RT_ISR_USART2,
+     .period_ms = 10U, .burst = 44U, .byte_ns = 86806U, .src_fd = -1, .sink_fd = -1, .next_ns = SIM_NEVER,
+     .idle_ns = SIM_NEVER},
+    {.usart = USART3, .name = "usart3_link", .dma_isr = RT_ISR_DMA1_S3, .uart_isr = RT_ISR_USART3,
+     .period_ms = 20U, .burst = 64U, .byte_ns = 86806U, .src_fd = -1, .sink_fd = -1, .next_ns = SIM_NEVER,
+     .idle_ns = SIM_NEVER},
+    {.usart = USART6, .name = "usart6_gps", .dma_isr = RT_ISR_DMA1_S2, .uart_isr = RT_ISR_USART6,
+     .period_ms = 100U, .burst = 512U, .byte_ns = 86806U, .src_fd = -1, .sink_fd = -1, .next_ns = SIM_NEVER,
+     .idle_ns = SIM_NEVER},
+};
+static char sim_pty_name[64];
+// 采集文件源编号 -> 串口
+static USART_TypeDef *const sim_capture_usart[SIM_CAPTURE_SOURCES] = {USART1, USART2, USART6};
+static const char *sim_replay_path = NULL;
+static double sim_replay_scale = 1.0;
+static uint64_t sim_replay_chunks = 0;
+static uint64_t sim_replay_span_ns = 0;             // 录制时长（未乘scale）
+
+/************************ 私有函数实现 ************************/
+static Sim_UART_t *Sim_UART_Of(const USART_TypeDef *usart) {
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        if (sim_uart[i].usart == usart) {
+            return &sim_uart[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  每个字符的位数（起始位+8数据位+校验位+停止位）
+ */
+static uint32_t Sim_UART_Bits(const UART_HandleTypeDef *huart) {
+    uint32_t bits = 10U;
+    if (huart->Init.Parity != UART_PARITY_NONE) {
+        bits++;
+    }
+    if (huart->Init.StopBits == UART_STOPBITS_2) {
+        bits++;
+    }
+    return bits;
+}
+
+static uint32_t Sim_UART_Baud(const UART_HandleTypeDef *huart) {
+    return (huart->Init.BaudRate != 0U) ? huart->Init.BaudRate : 115200U;
+}
+
+/**
+ * @brief  线上传输时间（向上取整：按时间反算已到达的字节数时，到这一时刻正好到达bytes个）
+ */
+static uint64_t Sim_UART_Wire_ns(const UART_HandleTypeDef *huart, uint32_t bytes) {
+    uint64_t baud = Sim_UART_Baud(huart);
+    return ((uint64_t)bytes * Sim_UART_Bits(huart) * SIM_NS_PER_S + baud - 1U) / baud;
+}
+
+/**
+ * @brief  接收方向的线上时间（接收未启动时按默认的单字节时间）
+ */
+static uint64_t Sim_UART_Rx_ns(const Sim_UART_t *u, uint32_t bytes) {
+    return (u->huart != NULL) ? Sim_UART_Wire_ns(u->huart, bytes) : (uint64_t)bytes * u->byte_ns;
+}
+
+/**
+ * @brief  一段时间内线上到达的字节数（Sim_UART_Rx_ns的反函数）
+ */
+static uint64_t Sim_UART_Rx_Bytes(const Sim_UART_t *u, uint64_t elapsed_ns) {
+    if (u->huart == NULL) {
+        return elapsed_ns / u->byte_ns;
+    }
+    return elapsed_ns * Sim_UART_Baud(u->huart) / ((uint64_t)Sim_UART_Bits(u->huart) * SIM_NS_PER_S);
+}
+
+/**
+ * @brief  写到输出（非阻塞，来不及读的部分丢弃）
+ */
+static void Sim_UART_Write(Sim_UART_t *u, const uint8_t *data, uint32_t len) {
+    u->tx_bytes += len;
+    if (u->sink_fd < 0) {
+        return;
+    }
+    while (len > 0U) {
+        ssize_t n = write(u->sink_fd, data, len);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            u->tx_dropped += len;
+            return;
+        }
+        data += n;
+        len -= (uint32_t)n;
+    }
+}
+
+/**
+ * @brief  投递一次接收事件（中断上下文）
+ */
+static void Sim_UART_Event(Sim_UART_t *u, RT_ISR_Id_t id, uint16_t size) {
+    RT_ISR_ENTER(id);
+    u->rx_events++;
+    HAL_UARTEx_RxEventCallback(u->huart, size);
+    RT_ISR_EXIT(id);
+}
+
+/**
+ * @brief  数据按循环DMA写入固件缓冲区，经过半满/满时投递DMA事件
+ */
+static void Sim_UART_Fill(Sim_UART_t *u, const uint8_t *data, size_t len) {
+    if (!u->rx_active) {
+        u->rx_dropped += len;
+        return;
+    }
+    uint16_t half = u->size / 2U;
+    while (len > 0U) {
+        uint16_t boundary = (u->pos < half) ? half : u->size;
+        size_t n = boundary - u->pos;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&u->buf[u->pos], data, n);
+        u->pos += (uint16_t)n;
+        data += n;
+        len -= n;
+        u->rx_bytes += n;
+        if (u->pos == u->size) {
+            u->pos = 0U;
+        }
+        u->huart->hdmarx->NDTR = u->size - u->pos;
+        if (u->pos == half) {
+            Sim_UART_Event(u, u->dma_isr, half);
+        } else if (u->pos == 0U) {
+            Sim_UART_Event(u, u->dma_isr, u->size);
+        }
+    }
+}
+
+/**
+ * @brief  线路空闲：与HAL相同，计数为0（刚好写满回绕）或等于缓冲区长度时不回调
+ */
+static void Sim_UART_Idle(Sim_UART_t *u) {
+    if (!u->rx_active) {
+        return;
+    }
+    uint32_t remaining = u->huart->hdmarx->NDTR;
+    if (remaining > 0U && remaining < u->size) {
+        Sim_UART_Event(u, u->uart_isr, u->pos);
+    }
+}
+
+/**
+ * @brief  一段数据立即写入并投递空闲事件（伪终端/设备输入，读到时已在线上传完）
+ */
+static void Sim_UART_Receive(Sim_UART_t *u, const uint8_t *data, size_t len) {
+    Sim_UART_Fill(u, data, len);
+    Sim_UART_Idle(u);
+}
+
+/**
+ * @brief  下一段输入开始上线：取出数据，算出再下一段的开始时刻
+ */
+static void Sim_UART_Wire_Begin(Sim_UART_t *u) {
+    uint32_t n;
+    if (u->rec_ns != NULL) {
+        n = u->rec_len[u->rec_i];
+        u->wire = &u->data[u->off];
+        u->off += n;
+        u->rec_i++;
+    } else {
+        n = (u->len - u->off > u->chunk) ? u->chunk : (uint32_t)(u->len - u->off);
+        u->wire = &u->data[u->off];
+        u->off += n;
+    }
+    u->wire_len = n;
+    u->wire_done = 0U;
+    u->wire_start_ns = u->next_ns;
+    // 线路在空闲事件之前又有数据：没有空闲
+    u->idle_ns = SIM_NEVER;
+
+    if (u->rec_ns != NULL) {
+        u->next_ns = (u->rec_i < u->rec_n) ? u->rec_start_ns + u->rec_ns[u->rec_i] : SIM_NEVER;
+    } else if (u->off < u->len) {
+        u->next_ns += u->period_ns;
+    } else if (u->loop) {
+        u->off = 0U;
+        u->next_ns += u->period_ns;
+    } else {
+        u->next_ns = SIM_NEVER;
+    }
+}
+
+/**
+ * @brief  线上这一段推进到now_ns：写入已到达的字节，整段到达后安排空闲事件，下一段不早于此时开始
+ */
+static void Sim_UART_Wire_Advance(Sim_UART_t *u, uint64_t now_ns) {
+    uint64_t arrived = Sim_UART_Rx_Bytes(u, now_ns - u->wire_start_ns);
+    uint32_t k = (arrived < u->wire_len) ? (uint32_t)arrived : u->wire_len;
+    if (k > u->wire_done) {
+        Sim_UART_Fill(u, &u->wire[u->wire_done], k - u->wire_done);
+        u->wire_done = k;
+    }
+    if (u->wire_done == u->wire_len) {
+        uint64_t end = u->wire_start_ns + Sim_UART_Rx_ns(u, u->wire_len);
+        u->wire = NULL;
+        u->idle_ns = end + Sim_UART_Rx_ns(u, 1U);
+        if (u->next_ns < end) {
+            u->next_ns = end;
+        }
+    }
+}
+
+/**
+ * @brief  线上这一段的下一个事件：经过DMA半满/满位置或整段到达
+ */
+static uint64_t Sim_UART_Wire_Next_ns(const Sim_UART_t *u) {
+    uint32_t target = u->wire_len;
+    if (u->rx_active) {
+        uint16_t half = u->size / 2U;
+        uint32_t boundary = (u->pos < half) ? half : u->size;
+        if (u->wire_done + boundary - u->pos < target) {
+            target = u->wire_done + boundary - u->pos;
+        }
+    }
+    return u->wire_start_ns + Sim_UART_Rx_ns(u, target);
+}
+
+/**
+ * @brief  打开接收源：普通文件整体读入，其余（伪终端/FIFO/设备）非阻塞读取
+ */
+static bool Sim_UART_Open_Source(Sim_UART_t *u, const char *path) {
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "sim: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        u->data = malloc((size_t)st.st_size + 1U);
+        ssize_t n = (u->data != NULL) ? read(fd, u->data, (size_t)st.st_size) : -1;
+        close(fd);
+        if (n < 0) {
+            fprintf(stderr, "sim: %s: read failed\n", path);
+            return false;
+        }
+        u->len = (size_t)n;
+        return true;
+    }
+    if (isatty(fd)) {
+        struct termios tio;
+        if (tcgetattr(fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+    }
+    u->src_fd = fd;
+    return true;
+}
+
+/************************ 公有函数实现 ************************/
+/**
+ * @brief  添加接收源
+ * @param  usart: 串口
+ * @param  spec: 路径[,period=毫秒][,burst=字节][,loop]（period/burst/loop只对普通文件有效）
+ * @retval false=无法打开或参数错误
+ */
+bool Sim_UART_Source(USART_TypeDef *usart, const char *spec) {
+    Sim_UART_t *u = Sim_UART_Of(usart);
+    char *copy = strdup(spec);
+    char *save = NULL;
+    char *path = strtok_r(copy, ",", &save);
+    if (u == NULL || path == NULL) {
+        free(copy);
+        return false;
+    }
+    u->period_ns = (uint64_t)u->period_ms * SIM_NS_PER_MS;
+    u->chunk = u->burst;
+    for (char *opt = strtok_r(NULL, ",", &save); opt != NULL; opt = strtok_r(NULL, ",", &save)) {
+        if (strncmp(opt, "period=", 7) == 0) {
+            u->period_ns = (uint64_t)(strtod(opt + 7, NULL) * (double)SIM_NS_PER_MS);
+        } else if (strncmp(opt, "burst=", 6) == 0) {
+            u->chunk = (uint32_t)strtoul(opt + 6, NULL, 0);
+        } else if (strcmp(opt, "loop") == 0) {
+            u->loop = true;
+        } else {
+            fprintf(stderr, "sim: unknown source option '%s'\n", opt);
+            free(copy);
+            return false;
+        }
+    }
+    bool ok = (u->period_ns != 0U && u->chunk != 0U) && Sim_UART_Open_Source(u, path);
+    free(copy);
+    return ok;
+}
+
+/**
+ * @brief  回放采集文件：各源的数据块作为对应串口的输入
+ * @param  spec: 路径[,scale=X]（X为录制时间的倍数，0=按线路速率尽快送出）
+ * @retval false=无法打开、格式错误或对应串口已有输入
+ * @note   文件格式：头"FCAP" u16版本 u16保留 u64起点us；之后每块 u64相对时刻us u8源 u8保留 u16长度 + 数据（小端）
+ */
+bool Sim_UART_Replay(const char *spec) {
+    char *copy = strdup(spec);
+    char *save = NULL;
+    char *path = strtok_r(copy, ",", &save);
+    for (char *opt = strtok_r(NULL, ",", &save); opt != NULL; opt = strtok_r(NULL, ",", &save)) {
+        if (strncmp(opt, "scale=", 6) == 0) {
+            sim_replay_scale = strtod(opt + 6, NULL);
+        } else {
+            fprintf(stderr, "sim: unknown replay option '%s'\n", opt);
+            free(copy);
+            return false;
+        }
+    }
+    FILE *f = (path != NULL && sim_replay_scale >= 0.0) ? fopen(path, "rb") : NULL;
+    if (f == NULL) {
+        fprintf(stderr, "sim: cannot replay %s\n", spec);
+        free(copy);
+        return false;
+    }
+    sim_replay_path = strdup(path);
+    free(copy);
+
+    uint8_t header[16];
+    uint16_t version = 0;
+    if (fread(header, 1, sizeof(header), f) == sizeof(header)) {
+        memcpy(&version, &header[4], sizeof(version));
+    }
+    if (memcmp(header, SIM_CAPTURE_MAGIC, 4) != 0 || version != SIM_CAPTURE_VERSION) {
+        fprintf(stderr, "sim: %s: not a version %u capture file\n", sim_replay_path, SIM_CAPTURE_VERSION);
+        fclose(f);
+        return false;
+    }
+    for (uint32_t s = 0; s < SIM_CAPTURE_SOURCES; s++) {
+        Sim_UART_t *u = Sim_UART_Of(sim_capture_usart[s]);
+        if (u->data != NULL || u->src_fd >= 0) {
+            fprintf(stderr, "sim: %s already has an input, cannot replay into it\n", u->name);
+            fclose(f);
+            return false;
+        }
+    }
+
+    // 逐块读入：数据接到对应串口的输入末尾，时刻与长度另存
+    uint8_t rec[12];
+    bool ok = true;
+    while (ok && fread(rec, 1, sizeof(rec), f) == sizeof(rec)) {
+        uint64_t t_us;
+        uint16_t len;
+        memcpy(&t_us, &rec[0], sizeof(t_us));
+        memcpy(&len, &rec[10], sizeof(len));
+        if (rec[8] >= SIM_CAPTURE_SOURCES || len == 0U) {
+            fprintf(stderr, "sim: %s: bad chunk at offset %ld\n", sim_replay_path, ftell(f) - (long)sizeof(rec));
+            ok = false;
+            break;
+        }
+        Sim_UART_t *u = Sim_UART_Of(sim_capture_usart[rec[8]]);
+        u->data = realloc(u->data, u->len + len);
+        u->rec_ns = realloc(u->rec_ns, (u->rec_n + 1U) * sizeof(uint64_t));
+        u->rec_len = realloc(u->rec_len, (u->rec_n + 1U) * sizeof(uint32_t));
+        if (u->data == NULL || u->rec_ns == NULL || u->rec_len == NULL ||
+            fread(&u->data[u->len], 1, len, f) != len) {
+            fprintf(stderr, "sim: %s: truncated chunk\n", sim_replay_path);
+            ok = false;
+            break;
+        }
+        u->len += len;
+        u->rec_ns[u->rec_n] = (uint64_t)((double)t_us * (double)SIM_NS_PER_US * sim_replay_scale);
+        u->rec_len[u->rec_n] = len;
+        u->rec_n++;
+        sim_replay_chunks++;
+        if (t_us * SIM_NS_PER_US > sim_replay_span_ns) {
+            sim_replay_span_ns = t_us * SIM_NS_PER_US;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+/**
+ * @brief  设置发送去向
+ * @param  path: 输出文件（截断）或设备，"-"为标准输出
+ */
+bool Sim_UART_Sink(USART_TypeDef *usart, const char *path) {
+    Sim_UART_t *u = Sim_UART_Of(usart);
+    if (u == NULL) {
+        return false;
+    }
+    int fd = (strcmp(path, "-") == 0) ? dup(STDOUT_FILENO)
+                                      : open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "sim: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    u->sink_fd = fd;
+    return true;
+}
+
+/**
+ * @brief  新建伪终端，串口收发都接到主端
+ * @retval 从端路径（地面站/脚本打开它），失败返回NULL
+ * @note   从端保持打开，没有对端连接时主端读写不会出错
+ */
+const char *Sim_UART_Pty(USART_TypeDef *usart) {
+    Sim_UART_t *u = Sim_UART_Of(usart);
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (u == NULL || fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        return NULL;
+    }
+    snprintf(sim_pty_name, sizeof(sim_pty_name), "%s", ptsname(fd));
+    int slave = open(sim_pty_name, O_RDWR | O_NOCTTY);
+    if (slave >= 0) {
+        struct termios tio;
+        if (tcgetattr(slave, &tio) == 0) {
+            cfmakeraw(&tio);
+            tcsetattr(slave, TCSANOW, &tio);
+        }
+    }
+    u->src_fd = fd;
+    u->sink_fd = fd;
+    return sim_pty_name;
+}
+
+/**
+ * @brief  调度器启动：文件输入从此刻开始按节奏送出
+ */
+void Sim_UART_Start(uint64_t now_ns) {
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        Sim_UART_t *u = &sim_uart[i];
+        if (u->rec_n > 0U) {
+            u->rec_start_ns = now_ns;
+            u->next_ns = now_ns + u->rec_ns[0];
+        } else if (u->data != NULL && u->len > 0U) {
+            u->next_ns = now_ns + u->period_ns;
+        }
+    }
+}
+
+/**
+ * @brief  下一个串口事件（文件输入/发送完成）
+ */
+uint64_t Sim_UART_Next_ns(void) {
+    uint64_t next = SIM_NEVER;
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        const Sim_UART_t *u = &sim_uart[i];
+        uint64_t rx = (u->wire != NULL) ? Sim_UART_Wire_Next_ns(u) : u->next_ns;
+        if (rx < next) {
+            next = rx;
+        }
+        if (u->idle_ns < next) {
+            next = u->idle_ns;
+        }
+        if (u->tx_huart != NULL && u->tx_done_ns < next) {
+            next = u->tx_done_ns;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief  文件输入全部送完所需的时长
+ */
+uint64_t Sim_UART_Inputs_ns(void) {
+    uint64_t longest = 0;
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        const Sim_UART_t *u = &sim_uart[i];
+        if (u->src_fd >= 0 || (u->data != NULL && u->loop)) {
+            return SIM_NEVER;
+        }
+        if (u->rec_n > 0U) {
+            // 回放：录制时刻与线上时间取大（按线路速率送出时由后者决定）
+            uint64_t d = u->rec_ns[u->rec_n - 1U];
+            uint64_t wire = (uint64_t)u->len * u->byte_ns;
+            d = (wire > d) ? wire : d;
+            if (d > longest) {
+                longest = d;
+            }
+        } else if (u->data != NULL && u->len > 0U) {
+            // 按节奏与线上时间取大（burst超过一个周期的线上时间时顺延）
+            uint64_t chunks = (u->len + u->chunk - 1U) / u->chunk;
+            uint64_t d = chunks * u->period_ns;
+            uint64_t wire = (uint64_t)u->len * u->byte_ns + (uint64_t)chunks * u->byte_ns;
+            d = (wire > d) ? wire : d;
+            if (d > longest) {
+                longest = d;
+            }
+        }
+    }
+    return longest;
+}
+
+bool Sim_UART_Realtime(void) {
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        if (sim_uart[i].src_fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief  投递到期的串口事件（中断上下文）
+ * @param  now_ns: 当前虚拟时间
+ */
+void Sim_UART_Run(uint64_t now_ns) {
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        Sim_UART_t *u = &sim_uart[i];
+
+        if (u->tx_huart != NULL && now_ns >= u->tx_done_ns) {
+            UART_HandleTypeDef *huart = u->tx_huart;
+            u->tx_huart = NULL;
+            huart->gState = HAL_UART_STATE_READY;
+            if (huart->hdmatx != NULL) {
+                huart->hdmatx->State = HAL_DMA_STATE_READY;
+            }
+            RT_ISR_ENTER(u->uart_isr);
+            HAL_UART_TxCpltCallback(huart);
+            RT_ISR_EXIT(u->uart_isr);
+        }
+
+        // 文件/回放输入：按时间顺序处理到期的空闲事件、下一段开始与线上字节到达
+        for (;;) {
+            if (u->wire != NULL) {
+                Sim_UART_Wire_Advance(u, now_ns);
+                if (u->wire != NULL) {
+                    break;
+                }
+            }
+            if (u->idle_ns <= now_ns && u->idle_ns <= u->next_ns) {
+                u->idle_ns = SIM_NEVER;
+                Sim_UART_Idle(u);
+            } else if (u->next_ns <= now_ns) {
+                Sim_UART_Wire_Begin(u);
+            } else {
+                break;
+            }
+        }
+
+        if (u->src_fd >= 0) {
+            uint8_t tmp[SIM_UART_READ_MAX];
+            ssize_t n = read(u->src_fd, tmp, sizeof(tmp));
+            if (n > 0) {
+                Sim_UART_Receive(u, tmp, (size_t)n);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  各串口收发统计与回放进度（JSON对象成员）
+ * @param  wall_ns: 调度器运行的主机时间（回放吞吐量）
+ */
+void Sim_UART_Report(FILE *f, uint64_t wall_ns) {
+    fprintf(f, "  \"uart\": {\n");
+    for (uint32_t i = 0; i < SIM_UART_N; i++) {
+        const Sim_UART_t *u = &sim_uart[i];
+        fprintf(f, "    \"%s\": {\"rx_bytes\": %llu, \"rx_dropped\": %llu, \"rx_events\": %llu, "
+                   "\"tx_bytes\": %llu, \"tx_dropped\": %llu}%s\n",
+                u->name, (unsigned long long)u->rx_bytes, (unsigned long long)u->rx_dropped,
+                (unsigned long long)u->rx_events, (unsigned long long)u->tx_bytes,
+                (unsigned long long)u->tx_dropped, (i + 1U < SIM_UART_N) ? "," : "");
+    }
+    fprintf(f, "  },\n");
+    if (sim_replay_path != NULL) {
+        uint64_t done = 0, bytes = 0;
+        for (uint32_t s = 0; s < SIM_CAPTURE_SOURCES; s++) {
+            const Sim_UART_t *u = Sim_UART_Of(sim_capture_usart[s]);
+            done += u->rec_i;
+            bytes += u->off;
+        }
+        fprintf(f, "  \"replay\": {\"file\": \"%s\", \"scale\": %g, \"span_s\": %.3f, \"chunks\": %llu, "
+                   "\"chunks_sent\": %llu, \"bytes_sent\": %llu, \"bytes_per_wall_s\": %.0f},\n",
+                sim_replay_path, sim_replay_scale, (double)sim_replay_span_ns / SIM_NS_PER_S,
+                (unsigned long long)sim_replay_chunks, (unsigned long long)done, (unsigned long long)bytes,
+                (wall_ns != 0U) ? (double)bytes * SIM_NS_PER_S / (double)wall_ns : 0.0);
+    }
+}
+
+/************************ HAL ************************/
+/**
+ * @brief  串口初始化（只更新波特率等参数，停止接收）
+ */
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    Sim_UART_t *u = Sim_UART_Of(huart->Instance);
+    if (u == NULL) {
+        return HAL_ERROR;
+    }
+    if (u->huart == huart) {
+        u->rx_active = false;
+    }
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+/**
+ * @brief  阻塞发送：写到输出并忙等线上时间
+ */
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    Sim_UART_t *u = Sim_UART_Of(huart->Instance);
+    if (u == NULL || pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    Sim_UART_Write(u, pData, Size);
+    if (sim_ipsr == 0U && !Sim_Irq_Masked()) {
+        huart->gState = HAL_UART_STATE_BUSY_TX;
+        Sim_Busy_Wait_ns(Sim_UART_Wire_ns(huart, Size));
+        huart->gState = HAL_UART_STATE_READY;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief  DMA发送：立即写到输出，线上时间后投递发送完成
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+    Sim_UART_t *u = Sim_UART_Of(huart->Instance);
+    if (u == NULL || pData == NULL || Size == 0U) {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY || u->tx_huart != NULL) {
+        return HAL_BUSY;
+    }
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    if (huart->hdmatx != NULL) {
+        huart->hdmatx->State = HAL_DMA_STATE_BUSY;
+    }
+    Sim_UART_Write(u, pData, Size);
+    u->tx_huart = huart;
+    u->tx_done_ns = Sim_Now_ns() + Sim_UART_Wire_ns(huart, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    (void)huart;
+    (void)pData;
+    (void)Size;
+    return HAL_OK;
+}
+
+/**
+ * @brief  启动循环DMA+空闲接收
+ */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    Sim_UART_t *u = Sim_UART_Of(huart->Instance);
+    if (u == NULL || pData == NULL || Size < 2U || huart->hdmarx == NULL) {
+        return HAL_ERROR;
+    }
+    if (huart->RxState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    u->huart = huart;
+    u->buf = pData;
+    u->size = Size;
+    u->pos = 0U;
+    u->rx_active = true;
+    huart->hdmarx->NDTR = Size;
+    return HAL_OK;
+}
@@ -0,0 +1,264 @@
+/**
+ * @file       Test_FMT.c
+ * @brief      格式化库测试：FMT_F32/FMT_Snprintf对照C库snprintf逐字节比较
+ * @author     ottohesl
+ * @date       26-1-29
+ * @version    V1.0
+ * @note       1. fmt_f32_*：FMT_F32(v, N)对照snprintf("%.Nf", (double)v)，N取0-9；样本为随机位模式、全范围等步长位模式、
+ *                二进制小数（十进制舍入恰为一半的点及其前后相邻的float）、十进制网格的半点、次正规数、FLT_MAX与inf/nan
+ *             2. fmt_snprintf_spec：随机组合标志、宽度、精度（含*与负值）、转换符与缓冲区大小（含截断和size=0），
+ *                比较返回值与缓冲区内容；%f精度限0-9（FMT上限），不用l修饰（主机long为64位，板上与int相同）
+ *             3. 参考为主机glibc的snprintf（正确舍入），板上newlib浮点printf同样正确舍入，两者对%f输出一致
+ */
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+#include "Sim_Test.h"
+#include "FMT.h"
+
+/************************ 宏定义 ************************/
+#define FMT_RANDOM_SAMPLES    1000000U        // 随机位模式样本数
+#define FMT_STRIDE            65521U          // 全范围位模式步长（素数，约6.5万个样本）
+#define FMT_SPEC_SAMPLES      200000U         // 随机格式样本数
+#define FMT_TEST_BUF          96U
+#define FMT_REPORT_MAX        10U             // 每个用例最多打印的不一致样本数
+
+/************************ 私有变量 ************************/
+static uint32_t fmt_rng = 0x9E3779B9U;
+static uint32_t fmt_checked = 0;                // 当前用例已比较的样本数
+static uint32_t fmt_mismatches = 0;             // 当前用例不一致的样本数
+
+/************************ 私有函数实现 ************************/
+static uint32_t Test_Rand(void) {
+    fmt_rng ^= fmt_rng << 13;
+    fmt_rng ^= fmt_rng >> 17;
+    fmt_rng ^= fmt_rng << 5;
+    return fmt_rng;
+}
+
+static float Test_Bits(uint32_t bits) {
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+static void Test_Begin(void) {
+    fmt_checked = 0;
+    fmt_mismatches = 0;
+}
+
+/**
+ * @brief  FMT_F32对照snprintf("%.Nf")
+ */
+static void Test_F32(float v, uint8_t decimals) {
+    char got[FMT_F32_BUF];
+    char want[FMT_TEST_BUF];
+    uint32_t len = FMT_F32(got, v, decimals);
+    int want_len = snprintf(want, sizeof(want), "%.*f", decimals, (double)v);
+    fmt_checked++;
+    if (strcmp(got, want) != 0 || len != (uint32_t)want_len) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        if (++fmt_mismatches <= FMT_REPORT_MAX) {
+            SIM_CHECK(false, "0x%08X %%.%uf: FMT \"%s\" (%u), snprintf \"%s\" (%d)", bits, decimals, got, len,
+                      want, want_len);
+        }
+    }
+}
+
+/**
+ * @brief  一个值及其前后相邻的float在所有小数位数下比较
+ */
+static void Test_F32_Around(float v) {
+    const float near[3] = {nextafterf(v, -INFINITY), v, nextafterf(v, INFINITY)};
+    for (uint32_t i = 0; i < 3U; i++) {
+        for (uint8_t n = 0; n <= FMT_F32_DECIMALS_MAX; n++) {
+            Test_F32(near[i], n);
+        }
+    }
+}
+
+static void Test_End(const char *what) {
+    SIM_CHECK(fmt_mismatches == 0U, "%u of %u %s differ", fmt_mismatches, fmt_checked, what);
+    Sim_Test_Note("%u %s compared", fmt_checked, what);
+}
+
+// 按格式中*的个数转发参数（宽度、精度在值之前）
+#define TEST_CALL(fn, buf, size, f, star_w, star_p, w, p, v)                                  \
+    ((star_w) && (star_p) ? fn(buf, size, f, w, p, v)                                         \
+     : (star_w)           ? fn(buf, size, f, w, v)                                            \
+     : (star_p)           ? fn(buf, size, f, p, v)                                            \
+                          : fn(buf, size, f, v))
+
+/************************ 测试用例 ************************/
+SIM_TEST(fmt_f32_random) {
+    Test_Begin();
+    fmt_rng = 0x9E3779B9U;
+    for (uint32_t i = 0; i < FMT_RANDOM_SAMPLES; i++) {
+        Test_F32(Test_Bits(Test_Rand()), (uint8_t)(i % (FMT_F32_DECIMALS_MAX + 1U)));
+    }
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFULL; bits += FMT_STRIDE) {
+        for (uint8_t n = 0; n <= FMT_F32_DECIMALS_MAX; n++) {
+            Test_F32(Test_Bits((uint32_t)bits), n);
+        }
+    }
+    Test_End("bit patterns");
+}
+
+SIM_TEST(fmt_f32_ties) {
+    Test_Begin();
+    // 二进制小数m/2^j：j≤N时十进制展开在N位内结束，j略大于N时第N+1位起恰为5000…，舍入走“一半”分支
+    for (uint32_t j = 1; j <= 24U; j++) {
+        for (uint32_t m = 1; m < 64U; m += 2U) {
+            for (uint32_t scale = 0; scale < 4U; scale++) {
+                float v = ldexpf((float)(m + (scale << 6)), -(int)j);
+                Test_F32_Around(v);
+                Test_F32_Around(-v);
+            }
+        }
+    }
+    // 十进制网格的半点：k.5×10^-N取最近的float，舍入结果取决于float误差的方向
+    for (uint8_t n = 0; n <= FMT_F32_DECIMALS_MAX; n++) {
+        for (uint32_t k = 0; k < 2000U; k++) {
+            float v = (float)(((double)k + 0.5) / pow(10.0, n));
+            for (uint32_t i = 0; i < 3U; i++) {
+                Test_F32(v, n);
+                v = nextafterf(v, INFINITY);
+            }
+        }
+    }
+    // 整数部分进位（9.995→10.00、999999.5→1000000）
+    static const float carries[] = {0.5f, 1.5f, 2.5f, 9.5f, 9.995f, 99.9999f, 999999.5f, 16777215.0f, 0.9999999f};
+    for (uint32_t i = 0; i < sizeof(carries) / sizeof(carries[0]); i++) {
+        Test_F32_Around(carries[i]);
+        Test_F32_Around(-carries[i]);
+    }
+    Test_End("ties");
+}
+
+SIM_TEST(fmt_f32_edges) {
+    static const uint32_t edges[] = {
+        0x00000000U, 0x80000000U,               // ±0
+        0x00000001U, 0x00000002U, 0x007FFFFFU,  // 次正规数
+        0x00800000U, 0x00800001U,               // FLT_MIN
+        0x3F800000U, 0x4B800000U, 0x4F800000U,  // 1、2^24、2^32
+        0x5F800000U, 0x7E800000U, 0x7F000000U,  // 2^64、2^126、2^127
+        0x7F7FFFFFU, 0xFF7FFFFFU,               // ±FLT_MAX
+        0x7F800000U, 0xFF800000U,               // ±inf
+        0x7FC00000U, 0xFFC00000U, 0x7F800001U,  // nan（含负号与信号nan）
+        0x3F000000U, 0x33800000U, 0x1F800000U,  // 0.5、2^-24、2^-64（k>63直接舍去的分支）
+    };
+    Test_Begin();
+    for (uint32_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        for (uint8_t n = 0; n <= FMT_F32_DECIMALS_MAX; n++) {
+            Test_F32(Test_Bits(edges[i]), n);
+        }
+    }
+    // 2的每个幂（整数部分为1-5组9位十进制）
+    for (int e = -149; e <= 127; e++) {
+        Test_F32_Around(ldexpf(1.0f, e));
+    }
+    // 超出上限的小数位数按9处理
+    char buf[FMT_F32_BUF];
+    FMT_F32(buf, 1.0f / 3.0f, 12);
+    SIM_CHECK(strcmp(buf, "0.333333343") == 0, "decimals>9 gave \"%s\"", buf);
+    Test_End("edge values");
+}
+
+SIM_TEST(fmt_snprintf_spec) {
+    static const char flags_set[] = "-0+ ";
+    static const char convs[] = "diuxXfFcs";
+    static const char *const strs[] = {"", "a", "Fish", "H7 telemetry", "abcdefghijklmnopqrstuvwxyz"};
+    static const int32_t ints[] = {0, 1, -1, 7, -42, 255, 65535, INT_MAX, INT_MIN, 1000000000};
+    char f[32];
+    char got[FMT_TEST_BUF];
+    char want[FMT_TEST_BUF];
+
+    Test_Begin();
+    fmt_rng = 0x2545F491U;
+    for (uint32_t i = 0; i < FMT_SPEC_SAMPLES; i++) {
+        char conv = convs[Test_Rand() % (sizeof(convs) - 1U)];
+        bool is_float = (conv == 'f' || conv == 'F');
+        bool is_text = (conv == 'c' || conv == 's');
+
+        // 1. 格式：前缀文字 + %[标志][宽度][.精度]转换符 + 后缀文字（含%%）
+        uint32_t n = 0;
+        if (Test_Rand() & 1U) {
+            n += (uint32_t)snprintf(&f[n], sizeof(f) - n, "v=");
+        }
+        f[n++] = '%';
+        uint32_t flag_bits = Test_Rand() & 0xFU;
+        for (uint32_t b = 0; b < 4U; b++) {
+            // 0标志用于%c/%s在C标准中未定义，不比较
+            if ((flag_bits & (1U << b)) != 0U && !(is_text && flags_set[b] == '0')) {
+                f[n++] = flags_set[b];
+            }
+        }
+        bool star_w = false, star_p = false;
+        int w = 0, p = 0;
+        switch (Test_Rand() % 3U) {
+            case 0: break;
+            case 1: n += (uint32_t)snprintf(&f[n], sizeof(f) - n, "%u", (unsigned)(Test_Rand() % 24U)); break;
+            default: star_w = true; w = (int)(Test_Rand() % 41U) - 20; f[n++] = '*'; break;
+        }
+        uint32_t p_max = is_float ? (FMT_F32_DECIMALS_MAX + 1U) : 16U;
+        switch (Test_Rand() % 3U) {
+            case 0: break;
+            case 1: n += (uint32_t)snprintf(&f[n], sizeof(f) - n, ".%u", (unsigned)(Test_Rand() % p_max)); break;
+            default:
+                star_p = true;
+                p = (int)(Test_Rand() % (p_max + 2U)) - 2;
+                f[n++] = '.';
+                f[n++] = '*';
+                break;
+        }
+        f[n++] = conv;
+        if (Test_Rand() & 1U) {
+            n += (uint32_t)snprintf(&f[n], sizeof(f) - n, " %%|");
+        }
+        f[n] = '\0';
+
+        // 2. 缓冲区大小（包括0和截断）与参数
+        uint32_t size = (Test_Rand() & 3U) == 0U ? Test_Rand() % 12U : sizeof(got);
+        memset(got, 0x55, sizeof(got));
+        memset(want, 0x55, sizeof(want));
+        int got_len, want_len;
+        if (is_float) {
+            float v;
+            switch (Test_Rand() % 4U) {
+                case 0: v = Test_Bits(Test_Rand()); break;
+                case 1: v = (float)((int32_t)(Test_Rand() % 2000001U) - 1000000) / 1000.0f; break;
+                case 2: v = ldexpf((float)(Test_Rand() % 64U), -(int)(Test_Rand() % 12U)); break;
+                default: v = (Test_Rand() & 1U) ? INFINITY : -NAN; break;
+            }
+            got_len = TEST_CALL(FMT_Snprintf, got, size, f, star_w, star_p, w, p, (double)v);
+            want_len = TEST_CALL(snprintf, want, size, f, star_w, star_p, w, p, (double)v);
+        } else if (conv == 's') {
+            const char *s = strs[Test_Rand() % (sizeof(strs) / sizeof(strs[0]))];
+            got_len = TEST_CALL(FMT_Snprintf, got, size, f, star_w, star_p, w, p, s);
+            want_len = TEST_CALL(snprintf, want, size, f, star_w, star_p, w, p, s);
+        } else {
+            int v;
+            if (conv == 'c') {
+                v = ' ' + (int)(Test_Rand() % 95U);
+            } else if (Test_Rand() & 1U) {
+                v = ints[Test_Rand() % (sizeof(ints) / sizeof(ints[0]))];
+            } else {
+                v = (int)Test_Rand();
+            }
+            got_len = TEST_CALL(FMT_Snprintf, got, size, f, star_w, star_p, w, p, v);
+            want_len = TEST_CALL(snprintf, want, size, f, star_w, star_p, w, p, v);
+        }
+
+        // 3. 返回值与缓冲区（含size之后未被改写的部分）逐字节比较
+        fmt_checked++;
+        if (got_len != want_len || memcmp(got, want, sizeof(got)) != 0) {
+            if (++fmt_mismatches <= FMT_REPORT_MAX) {
+                SIM_CHECK(false, "\"%s\" size %u w %d p %d: FMT \"%.*s\" (%d), snprintf \"%.*s\" (%d)", f, size, w, p,
+                          (int)(size ? size : 1U) - 1, got, got_len, (int)(size ? size : 1U) - 1, want, want_len);
+            }
+        }
+    }
+    Test_End("formats");
+}
@@ -0,0 +1,439 @@
+/**
+ * @file       Test_NMEA.c
+ * @brief      NMEA解析器测试：单遍扫描解析（NMEA_Scan/GPS_Parse_NMEA）对照参考值与按C库实现的参考解析
+ * @author     ottohesl
+ * @date       26-1-29
+ * @version    V1.0
+ * @note       1. nmea_known：规范示例与ATGM336H格式（GN、5位小数分、3位小数秒）的语句，逐字段对照手算的参考值
+ *             2. nmea_corpus：固定种子生成的语句语料（GGA/RMC/GSA/GSV/VTG/ZDA，GP/GN/BD/GB，空字段、错误校验、
+ *                小写十六进制、缺'*'、截断、超长），每条语句同时送入固件解析器与参考解析，比较返回值、错误计数和定位数据；
+ *                参考解析按逗号切分且保留空字段（原strtok解析器会合并连续逗号，空字段之后全部错位，不能作为参考），
+ *                数值用strtod换算
+ *             3. 参考解析同样保持“空字段不更新”的语义：两边的定位数据都是跨语句累积的状态
+ *             4. casic_navpv：手工组帧的CASIC NAV-PV逐字节送入CASIC_Parse_Byte，pDop只进pdop、不冒充HDOP
+ */
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Sim_Test.h"
+#include "NMEA_ATGM336H.h"
+#include "CASIC_ATGM336H.h"
+
+/************************ 宏定义 ************************/
+#define NMEA_CORPUS_SIZE      20000U          // 语料条数
+#define NMEA_SENTENCE_BUF     160U            // 语料语句缓冲区（含超长语句）
+#define NMEA_REPORT_MAX       10U             // 每个用例最多打印的不一致语句数
+
+/************************ 结构体定义 ************************/
+// 参考解析的状态（与GPS_Data_t的定位字段对应）
+typedef struct {
+    GPS_Data_t data;
+    uint32_t errors;
+} NMEA_Ref_t;
+
+/************************ 私有变量 ************************/
+static uint32_t nmea_rng = 0x2545F491U;
+
+/************************ 参考解析 ************************/
+static uint32_t Test_Rand(void) {
+    nmea_rng ^= nmea_rng << 13;
+    nmea_rng ^= nmea_rng >> 17;
+    nmea_rng ^= nmea_rng << 5;
+    return nmea_rng;
+}
+
+static uint32_t Test_Rand_Range(uint32_t n) {
+    return Test_Rand() % n;
+}
+
+/**
+ * @brief  参考校验：'$'开头，'*'在NMEA_MAX_LENGTH以内，后跟两位十六进制（大小写均可）且等于异或和，语句ID至少5字符
+ */
+static bool Ref_Checksum(const char *s) {
+    if (s[0] != '$') {
+        return false;
+    }
+    const char *star = strchr(s, '*');
+    if (star == NULL || star - s > NMEA_MAX_LENGTH || star - s < 6) {
+        return false;
+    }
+    if (!isxdigit((unsigned char)star[1]) || !isxdigit((unsigned char)star[2])) {
+        return false;
+    }
+    uint8_t sum = 0;
+    for (const char *p = s + 1; p < star; p++) {
+        sum ^= (uint8_t)*p;
+    }
+    char hex[3] = {star[1], star[2], '\0'};
+    return sum == (uint8_t)strtoul(hex, NULL, 16);
+}
+
+/**
+ * @brief  按逗号切分（保留空字段），到'*'为止
+ * @retval 字段数（最多NMEA_MAX_FIELDS）
+ */
+static uint32_t Ref_Split(const char *s, char fields[][NMEA_SENTENCE_BUF]) {
+    uint32_t n = 0;
+    const char *p = s + 1;
+    while (n < NMEA_MAX_FIELDS) {
+        size_t len = strcspn(p, ",*");
+        memcpy(fields[n], p, len);
+        fields[n][len] = '\0';
+        n++;
+        if (p[len] != ',') {
+            break;
+        }
+        p += len + 1;
+    }
+    return n;
+}
+
+/**
+ * @brief  数值字段：以数字开头（可带负号）才算非空，截断到decimals位小数后放大
+ */
+static bool Ref_Fixed(const char *f, uint32_t decimals, double *out) {
+    const char *d = (f[0] == '-') ? f + 1 : f;
+    if (!isdigit((unsigned char)d[0]) && !(d[0] == '.' && isdigit((unsigned char)d[1]))) {
+        return false;
+    }
+    double scale = pow(10.0, decimals);
+    *out = trunc(strtod(f, NULL) * scale + ((f[0] == '-') ? -1e-6 : 1e-6)) / scale;
+    return true;
+}
+
+static void Ref_Coordinate(const char *f, const char *hemi, int32_t *out) {
+    double v;
+    if (!Ref_Fixed(f, 5, &v) || v < 0.0) {
+        return;
+    }
+    double degrees = floor(v / 100.0);
+    double value = degrees * 1e7 + (v - degrees * 100.0) * 1e7 / 60.0;
+    int32_t r = (int32_t)llround(value);
+    *out = (hemi[0] == 'S' || hemi[0] == 'W') ? -r : r;
+}
+
+static void Ref_Time(const char *f, uint32_t *out) {
+    double v;
+    if (!Ref_Fixed(f, 3, &v) || v < 0.0) {
+        return;
+    }
+    uint64_t ms = (uint64_t)llround(v * 1000.0);
+    uint64_t hh = ms / 10000000U;
+    uint64_t mm = (ms / 100000U) % 100U;
+    *out = (uint32_t)((hh * 3600U + mm * 60U) * 1000U + ms % 100000U);
+}
+
+/**
+ * @brief  参考解析一条语句（更新ref状态）
+ * @retval 本条语句给出有效定位
+ */
+static uint8_t Ref_Parse(NMEA_Ref_t *ref, const char *s) {
+    static char f[NMEA_MAX_FIELDS][NMEA_SENTENCE_BUF];
+    GPS_Data_t *d = &ref->data;
+    double v;
+
+    d->is_valid = 0;
+    if (!Ref_Checksum(s)) {
+        ref->errors++;
+        return 0;
+    }
+    uint32_t n = Ref_Split(s, f);
+    bool gga = strncmp(f[0], "GPGGA", 5) == 0 || strncmp(f[0], "GNGGA", 5) == 0;
+    bool rmc = strncmp(f[0], "GPRMC", 5) == 0 || strncmp(f[0], "GNRMC", 5) == 0;
+    if ((!gga && !rmc) || n < 10) {
+        return 0;
+    }
+    Ref_Time(f[1], &d->utc_time);
+    if (gga) {
+        Ref_Coordinate(f[2], f[3], &d->latitude);
+        Ref_Coordinate(f[4], f[5], &d->longitude);
+        d->fix_quality = Ref_Fixed(f[6], 0, &v) ? (uint8_t)v : 0U;
+        if (Ref_Fixed(f[7], 0, &v)) d->satellites = (uint8_t)v;
+        if (Ref_Fixed(f[8], 2, &v)) d->hdop = (uint16_t)llround(v * 100.0);
+        if (Ref_Fixed(f[9], 2, &v)) d->altitude = (int32_t)llround(v * 100.0);
+        d->status = (d->fix_quality != 0U) ? 'A' : 'V';
+    } else {
+        d->status = (f[2][0] != '\0') ? f[2][0] : ',';
+        Ref_Coordinate(f[3], f[4], &d->latitude);
+        Ref_Coordinate(f[5], f[6], &d->longitude);
+        if (Ref_Fixed(f[7], 3, &v) && v >= 0.0) d->speed = (uint16_t)llround(v * 51.4444);
+        if (Ref_Fixed(f[8], 2, &v) && v >= 0.0) d->course = (uint16_t)llround(v * 100.0);
+        if (Ref_Fixed(f[9], 0, &v)) d->utc_date = (uint32_t)v;
+    }
+    d->is_valid = (d->status == 'A');
+    return d->is_valid;
+}
+
+/************************ 对照 ************************/
+/**
+ * @brief  比较固件解析结果与参考（坐标与速度允许1个最低位的换算舍入差）
+ * @retval 不一致的字段名，一致返回NULL
+ */
+static const char *Test_Compare(const GPS_Data_t *a, const GPS_Data_t *b) {
+    if (labs((long)a->latitude - (long)b->latitude) > 1) return "latitude";
+    if (labs((long)a->longitude - (long)b->longitude) > 1) return "longitude";
+    if (a->altitude != b->altitude) return "altitude";
+    if (a->utc_time != b->utc_time) return "utc_time";
+    if (a->utc_date != b->utc_date) return "utc_date";
+    if (abs((int)a->speed - (int)b->speed) > 1) return "speed";
+    if (a->course != b->course) return "course";
+    if (a->hdop != b->hdop) return "hdop";
+    if (a->pdop != b->pdop) return "pdop";
+    if (a->fix_quality != b->fix_quality) return "fix_quality";
+    if (a->satellites != b->satellites) return "satellites";
+    if (a->is_valid != b->is_valid) return "is_valid";
+    // 空状态字段时固件取到的是下一个字段的分隔符，只比较有意义的状态
+    if (a->status != b->status && (a->status == 'A' || b->status == 'A')) return "status";
+    return NULL;
+}
+
+/************************ 语料生成 ************************/
+/**
+ * @brief  写一个字段（先写分隔符，empty时留空）
+ */
+static char *Gen_Field(char *p, bool empty, const char *fmt, double value) {
+    *p++ = ',';
+    return empty ? p : p + sprintf(p, fmt, value);
+}
+
+static char *Gen_Text(char *p, bool empty, const char *text) {
+    *p++ = ',';
+    return empty ? p : stpcpy(p, text);
+}
+
+/**
+ * @brief  生成一条语句（含各种错误形态），返回写入的字符串
+ */
+static const char *Gen_Sentence(char *buf) {
+    static const char *const talkers[] = {"GP", "GN", "BD", "GB"};
+    static const char *const types[] = {"GGA", "RMC", "GGA", "RMC", "GSA", "GSV", "VTG", "ZDA"};
+    const char *talker = talkers[Test_Rand_Range(4)];
+    const char *type = types[Test_Rand_Range(8)];
+    uint32_t empty_pct = (Test_Rand_Range(4) == 0) ? 30U : 3U;   // 四分之一的语句有较多空字段
+#define E() (Test_Rand_Range(100) < empty_pct)
+    char *p = buf + sprintf(buf, "$%s%s", talker, type);
+
+    double lat = Test_Rand_Range(90) * 100.0 + Test_Rand_Range(6000000) / 100000.0;
+    double lon = Test_Rand_Range(180) * 100.0 + Test_Rand_Range(6000000) / 100000.0;
+    double t = Test_Rand_Range(24) * 10000.0 + Test_Rand_Range(60) * 100.0 + Test_Rand_Range(60000) / 1000.0;
+    const char *lat_fmt = Test_Rand_Range(2) ? "%010.5f" : "%09.4f";
+    const char *lon_fmt = Test_Rand_Range(2) ? "%011.5f" : "%010.4f";
+    const char *t_fmt = Test_Rand_Range(2) ? "%010.3f" : "%09.2f";
+    if (strcmp(type, "GGA") == 0) {
+        p = Gen_Field(p, E(), t_fmt, t);
+        p = Gen_Field(p, E(), lat_fmt, lat);
+        p = Gen_Text(p, E(), Test_Rand_Range(2) ? "N" : "S");
+        p = Gen_Field(p, E(), lon_fmt, lon);
+        p = Gen_Text(p, E(), Test_Rand_Range(2) ? "E" : "W");
+        p = Gen_Field(p, E(), "%.0f", (double)Test_Rand_Range(7));
+        p = Gen_Field(p, E(), "%02.0f", (double)Test_Rand_Range(40));
+        p = Gen_Field(p, E(), Test_Rand_Range(2) ? "%.1f" : "%.2f", Test_Rand_Range(9999) / 100.0);
+        p = Gen_Field(p, E(), "%.1f", ((double)Test_Rand_Range(200000) - 10000.0) / 10.0);
+        p += sprintf(p, ",M,%.1f,M,,", Test_Rand_Range(1000) / 10.0);
+    } else if (strcmp(type, "RMC") == 0) {
+        p = Gen_Field(p, E(), t_fmt, t);
+        p = Gen_Text(p, E(), Test_Rand_Range(4) ? "A" : "V");
+        p = Gen_Field(p, E(), lat_fmt, lat);
+        p = Gen_Text(p, E(), Test_Rand_Range(2) ? "N" : "S");
+        p = Gen_Field(p, E(), lon_fmt, lon);
+        p = Gen_Text(p, E(), Test_Rand_Range(2) ? "E" : "W");
+        p = Gen_Field(p, E(), Test_Rand_Range(2) ? "%.3f" : "%.1f", Test_Rand_Range(100000) / 1000.0);
+        p = Gen_Field(p, E(), Test_Rand_Range(2) ? "%.2f" : "%.1f", Test_Rand_Range(36000) / 100.0);
+        p = Gen_Field(p, E(), "%06.0f", (Test_Rand_Range(28) + 1) * 10000.0 + (Test_Rand_Range(12) + 1) * 100.0 +
+                                            Test_Rand_Range(100));
+        p += sprintf(p, ",,,%s", Test_Rand_Range(2) ? "A" : "D");
+    } else {
+        // 不解析的语句：随机个数的字段（GSV可超出NMEA_MAX_FIELDS与NMEA_MAX_LENGTH）
+        uint32_t n = 3U + Test_Rand_Range(strcmp(type, "GSV") == 0 ? 30U : 12U);
+        for (uint32_t i = 0; i < n; i++) {
+            p = Gen_Field(p, E(), "%.0f", (double)Test_Rand_Range(400));
+        }
+    }
+#undef E
+    *p = '\0';
+    // 少数语句截成不足10个字段（走字段数检查）
+    if (Test_Rand_Range(50) == 0) {
+        char *c = buf;
+        for (uint32_t i = 0; i < 6U && c != NULL; i++) {
+            c = strchr(c + 1, ',');
+        }
+        if (c != NULL) {
+            *c = '\0';
+            p = c;
+        }
+    }
+
+    uint8_t sum = 0;
+    for (const char *c = buf + 1; c < p; c++) {
+        sum ^= (uint8_t)*c;
+    }
+    uint32_t form = Test_Rand_Range(100);
+    if (form < 5) {
+        p += sprintf(p, "*%02X", sum ^ (1U << Test_Rand_Range(8)));     // 校验和错误
+    } else if (form < 10) {
+        p += sprintf(p, "*%02x", sum);                                  // 小写十六进制
+    } else if (form < 12) {
+        p += sprintf(p, "%02X", sum);                                   // 缺'*'
+    } else if (form < 14) {
+        p += sprintf(p, "*%X", sum & 0x0FU);                            // 校验和只有一位
+    } else if (form < 16) {
+        p += sprintf(p, "*%02X", sum);
+        buf[1 + Test_Rand_Range((uint32_t)(p - buf - 1))] = (char)('!' + Test_Rand_Range(90));   // 传输中改了一个字符
+    } else {
+        p += sprintf(p, "*%02X", sum);
+    }
+    if (Test_Rand_Range(2)) {
+        strcpy(p, "\r\n");
+    }
+    return buf;
+}
+
+/************************ 用例 ************************/
+/**
+ * @brief  规范示例与实测语句，对照手算参考值
+ */
+SIM_TEST(nmea_known) {
+    GPS_Data_t d;
+
+    GPS_Parser_Init();
+    // NMEA 0183规范中的GGA示例：48°07.038'N 11°31.000'E，12:35:19，8颗星，HDOP 0.9，海拔545.4m
+    SIM_CHECK(GPS_Parse_NMEA("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n") == 1,
+              "GGA example rejected");
+    GPS_Get_Data(&d);
+    SIM_CHECK(d.latitude == 481173000, "latitude %ld", (long)d.latitude);
+    SIM_CHECK(d.longitude == 115166667, "longitude %ld", (long)d.longitude);
+    SIM_CHECK(d.utc_time == 45319000U, "utc_time %lu", (unsigned long)d.utc_time);
+    SIM_CHECK(d.fix_quality == 1U && d.satellites == 8U, "quality %u sats %u", d.fix_quality, d.satellites);
+    SIM_CHECK(d.hdop == 90U, "hdop %u", d.hdop);
+    SIM_CHECK(d.altitude == 54540, "altitude %ld", (long)d.altitude);
+
+    // 规范中的RMC示例：22.4节（1152cm/s）、航向84.4°、1994-03-23
+    SIM_CHECK(GPS_Parse_NMEA("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n") == 1,
+              "RMC example rejected");
+    GPS_Get_Data(&d);
+    SIM_CHECK(d.speed == 1152U, "speed %u", d.speed);
+    SIM_CHECK(d.course == 8440U, "course %u", d.course);
+    SIM_CHECK(d.utc_date == 230394U, "utc_date %lu", (unsigned long)d.utc_date);
+
+    // ATGM336H格式（GN，5位小数分，南纬西经，3位小数秒）
+    SIM_CHECK(GPS_Parse_NMEA("$GNGGA,235959.999,3348.12345,S,15112.67890,W,2,12,0.955,-12.3,M,0.0,M,,*6A") == 1,
+              "GNGGA rejected");
+    GPS_Get_Data(&d);
+    SIM_CHECK(d.latitude == -338020575, "latitude %ld", (long)d.latitude);
+    SIM_CHECK(d.longitude == -1512113150, "longitude %ld", (long)d.longitude);
+    SIM_CHECK(d.utc_time == 86399999U, "utc_time %lu", (unsigned long)d.utc_time);
+    SIM_CHECK(d.hdop == 95U, "hdop %u (extra decimals truncate)", d.hdop);
+    SIM_CHECK(d.altitude == -1230, "altitude %ld", (long)d.altitude);
+
+    // 空字段不覆盖上一次的值；未定位时无效
+    SIM_CHECK(GPS_Parse_NMEA("$GNGGA,000001.000,,,,,0,00,,,M,,M,,*67") == 0, "no-fix GGA valid");
+    GPS_Get_Data(&d);
+    SIM_CHECK(d.latitude == -338020575 && d.hdop == 95U, "empty fields overwrote lat %ld hdop %u",
+              (long)d.latitude, d.hdop);
+    SIM_CHECK(d.utc_time == 1000U && d.fix_quality == 0U && d.status == 'V', "time %lu quality %u status %c",
+              (unsigned long)d.utc_time, d.fix_quality, d.status);
+
+    // 小写校验和可用；错误校验、缺'*'、非十六进制计入错误
+    uint32_t errors = GPS_Parse_Errors();
+    SIM_CHECK(GPS_Parse_NMEA("$GPRMC,123520,V,,,,,,,230394,,,N*5b") == 0, "void RMC valid");
+    SIM_CHECK(GPS_Parse_Errors() == errors, "lowercase checksum rejected");
+    SIM_CHECK(GPS_Parse_NMEA("$GPRMC,123520,V,,,,,,,230394,,,N*5C") == 0 && GPS_Parse_Errors() == errors + 1U,
+              "bad checksum accepted");
+    SIM_CHECK(GPS_Parse_NMEA("$GPRMC,123520,V,,,,,,,230394,,,N5B") == 0 && GPS_Parse_Errors() == errors + 2U,
+              "missing '*' accepted");
+    SIM_CHECK(GPS_Parse_NMEA("$GPRMC,123520,V,,,,,,,230394,,,N*5G") == 0 && GPS_Parse_Errors() == errors + 3U,
+              "non-hex checksum accepted");
+    SIM_CHECK(GPS_Check_Checksum("$GPGSV,3,1,12,01,40,083,46*73") == 0 && GPS_Check_Checksum("$GPGSV,1,1,00*79"),
+              "GPS_Check_Checksum");
+    // 校验和在'*'后或第一位后截断
+    SIM_CHECK(GPS_Check_Checksum("$GPGSV,1,1,00*") == 0 && GPS_Check_Checksum("$GPGSV,1,1,00*7") == 0,
+              "truncated checksum accepted");
+}
+
+/**
+ * @brief  语料对照：固件解析器与参考解析逐条比较
+ */
+SIM_TEST(nmea_corpus) {
+    static char buf[NMEA_SENTENCE_BUF * 2];
+    NMEA_Ref_t ref;
+    GPS_Data_t d;
+    uint32_t valid = 0;
+    uint32_t mismatches = 0;
+
+    GPS_Parser_Init();
+    memset(&ref, 0, sizeof(ref));
+    ref.data.status = 'V';
+    nmea_rng = 0x2545F491U;
+    for (uint32_t i = 0; i < NMEA_CORPUS_SIZE; i++) {
+        const char *s = Gen_Sentence(buf);
+        uint8_t got = GPS_Parse_NMEA(s);
+        uint8_t want = Ref_Parse(&ref, s);
+        GPS_Get_Data(&d);
+        const char *field = Test_Compare(&d, &ref.data);
+        if (got != want || GPS_Parse_Errors() != ref.errors || field != NULL) {
+            if (++mismatches <= NMEA_REPORT_MAX) {
+                SIM_CHECK(false, "#%u %s: ret %u/%u errors %lu/%lu field %s", i, s, got, want,
+                          (unsigned long)GPS_Parse_Errors(), (unsigned long)ref.errors, field ? field : "-");
+            }
+            // 从参考状态重新同步，后续语句各自比较
+            GPS_Set_Data(&ref.data);
+        }
+        valid += want;
+    }
+    SIM_CHECK(mismatches == 0U, "%u of %u sentences differ", mismatches, NMEA_CORPUS_SIZE);
+    SIM_CHECK(valid > NMEA_CORPUS_SIZE / 10U && ref.errors > NMEA_CORPUS_SIZE / 20U,
+              "corpus lacks coverage: %u fixes, %lu errors", valid, (unsigned long)ref.errors);
+    Sim_Test_Note("%u sentences, %u fixes, %lu rejected", NMEA_CORPUS_SIZE, valid, (unsigned long)ref.errors);
+}
+
+/**
+ * @brief  CASIC NAV-PV：组帧、校验、解码，PDOP写入pdop，hdop置0
+ */
+SIM_TEST(casic_navpv) {
+    uint8_t frame[6 + CASIC_NAV_PV_LENGTH + 4] = {CASIC_HEAD_1, CASIC_HEAD_2, CASIC_NAV_PV_LENGTH, 0,
+                                                  CASIC_CLASS_NAV, CASIC_ID_NAV_PV};
+    uint8_t *p = &frame[6];
+    const float pdop = 1.6f, height = 12.5f, speed = 1.25f, heading = -90.0f;
+    const double lon = 151.2113150, lat = -33.8020575;
+    GPS_Data_t d = {.hdop = 90, .utc_time = 45319000U};
+
+    p[4] = 7;                                   // posValid：3D
+    p[7] = 11;                                  // numSV
+    memcpy(&p[12], &pdop, sizeof(pdop));
+    memcpy(&p[16], &lon, sizeof(lon));
+    memcpy(&p[24], &lat, sizeof(lat));
+    memcpy(&p[32], &height, sizeof(height));
+    memcpy(&p[64], &speed, sizeof(speed));
+    memcpy(&p[68], &heading, sizeof(heading));
+    uint32_t sum = ((uint32_t)CASIC_ID_NAV_PV << 24) + ((uint32_t)CASIC_CLASS_NAV << 16) + CASIC_NAV_PV_LENGTH;
+    for (uint32_t i = 0; i < CASIC_NAV_PV_LENGTH; i += 4) {
+        uint32_t word;
+        memcpy(&word, &p[i], sizeof(word));
+        sum += word;
+    }
+    memcpy(&frame[6 + CASIC_NAV_PV_LENGTH], &sum, sizeof(sum));
+
+    uint8_t done = 0;
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        done = CASIC_Parse_Byte(frame[i]);
+        SIM_CHECK(done == (i == sizeof(frame) - 1U), "byte %u: frame complete %u", i, done);
+    }
+    SIM_CHECK(CASIC_Decode_NavPV(&d) == 1, "NAV-PV fix rejected");
+    SIM_CHECK(d.pdop == 160U, "pdop %u", d.pdop);
+    SIM_CHECK(d.hdop == 0U, "hdop %u (NAV-PV has no HDOP)", d.hdop);
+    SIM_CHECK(labs((long)d.latitude + 338020575L) <= 1 && labs((long)d.longitude - 1512113150L) <= 1,
+              "lat %ld lon %ld", (long)d.latitude, (long)d.longitude);
+    SIM_CHECK(d.altitude == 1250 && d.speed == 125U && d.course == 27000U, "alt %ld speed %u course %u",
+              (long)d.altitude, d.speed, d.course);
+    SIM_CHECK(d.satellites == 11U && d.status == 'A' && d.utc_time == 45319000U, "sats %u status %c utc %lu",
+              d.satellites, d.status, (unsigned long)d.utc_time);
+
+    // 校验错误的帧不算完整帧
+    frame[6 + 12] ^= 0x01U;
+    done = 0;
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        done |= CASIC_Parse_Byte(frame[i]);
+    }
+    SIM_CHECK(done == 0U, "corrupted NAV-PV accepted");
+}
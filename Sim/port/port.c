@@ -0,0 +1,300 @@
+/**
+ * @file       port.c
+ * @brief      FreeRTOS主机仿真移植层（虚拟时间，每个任务一个主机线程）
+ * @author     ottohesl
+ * @date       26-1-25
+ * @version    V1.0
+ * @note       1. 全局只有一把仿真锁，持有者就是当前运行的任务（或复位线程），其余线程都在各自的条件变量上等待，
+ *                任务切换 = vTaskSwitchContext选出下一个任务后把运行权交给它的线程，自己等待再次被选中
+ *             2. 线程记录放在FreeRTOS为任务分配的栈缓冲区顶端，pxPortInitialiseStack返回记录下方的地址，
+ *                由TCB第一个成员（pxTopOfStack）找回；任务实际运行在4GB以下另行分配的主机栈上
+ *             3. 中断只在Sim_Step中投递（Sim_Clock.c），屏蔽（PRIMASK/BASEPRI/临界区）期间到期的中断和
+ *                切换请求记在sim_pend，解除屏蔽时执行，与PendSV在临界区退出后才进入的行为一致
+ *             4. 代码本身不消耗虚拟时间，只有空闲钩子与忙等推进时间，所以同样的输入得到同样的调度结果
+ *             5. 切换耗时与固件PendSV口径一致：从Sim_Switch进入到换入线程恢复运行的DWT周期（含主机线程交接），
+ *                交给OS_Switch_Record，仍是原任务时不计入；cpu_scale=0时为0
+ */
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "Sim.h"
+
+/************************ 移植参数 ************************/
+#define SIM_THREAD_STACK      (256U * 1024U)  // 任务线程主机栈（printf/格式化在任务中执行）
+#define SIM_STACK_HINT        0x40000000UL    // 线程栈映射的建议地址（不支持MAP_32BIT的主机）
+
+/************************ 结构体定义 ************************/
+typedef struct {
+    pthread_cond_t cond;                // 运行权到来时通知
+    pthread_t thread;
+    TaskFunction_t code;                // 任务入口
+    void *param;
+    volatile bool run;                  // 被调度器选中
+    uint64_t run_ns;                    // 累计运行的虚拟时间（忙等/空闲跳过的时长）
+} Sim_Thread_t;
+
+/************************ 全局变量 ************************/
+volatile uint32_t sim_primask = 0;      // __disable_irq
+volatile uint32_t sim_ipsr = 0;         // 正在执行仿真中断
+volatile uint32_t sim_pend = 0;         // 推迟的中断/切换
+
+/************************ 私有变量 ************************/
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread Sim_Thread_t *sim_self = NULL;      // 本线程的记录
+static Sim_Thread_t sim_reset;                      // 复位线程（初始化、启动调度器、结束后输出报告）
+static volatile uint32_t sim_nesting = 0;           // 临界区嵌套（切换只发生在0层，无需按任务保存）
+static volatile uint32_t sim_basepri = 0;           // portDISABLE_INTERRUPTS
+static volatile bool sim_running = false;
+static uint64_t sim_switch_ns = 0;                  // 上次任务切换的虚拟时刻
+static uint32_t sim_switch_entry = 0;               // 进行中的切换开始时的DWT计数
+static void *sim_switch_out = NULL;                 // 进行中的切换换出的任务，NULL=无
+
+extern void * volatile pxCurrentTCB;
+
+/************************ 私有函数实现 ************************/
+/**
+ * @brief  由TCB找到任务线程记录（TCB第一个成员是pxPortInitialiseStack的返回值）
+ */
+static Sim_Thread_t *Sim_Thread_Of(void *tcb) {
+    StackType_t *top = *(StackType_t * volatile *)tcb;
+    return (Sim_Thread_t *)(top + 1);
+}
+
+/**
+ * @brief  等待本线程再次被选中（释放仿真锁）
+ */
+static void Sim_Wait_Run(Sim_Thread_t *self) {
+    while (!self->run) {
+        pthread_cond_wait(&self->cond, &sim_lock);
+    }
+}
+
+/**
+ * @brief  把运行权交给另一个线程，自己等待
+ */
+static void Sim_Hand_Over(Sim_Thread_t *self, Sim_Thread_t *next) {
+    self->run = false;
+    next->run = true;
+    pthread_cond_signal(&next->cond);
+    Sim_Wait_Run(self);
+}
+
+/**
+ * @brief  换入的任务恢复运行：记录进行中切换的耗时（对应PendSV退出）
+ */
+static void Sim_Switch_Done(void) {
+    if (sim_switch_out != NULL) {
+        OS_Switch_Record(OS_DWT_CYCCNT - sim_switch_entry, pxCurrentTCB, sim_switch_out);
+        sim_switch_out = NULL;
+    }
+}
+
+/**
+ * @brief  任务切换（PendSV）：选出最高优先级就绪任务并切换到其线程
+ */
+static void Sim_Switch(void) {
+    uint32_t entry = OS_DWT_CYCCNT;
+    Sim_Thread_t *self = sim_self;
+    uint64_t now = Sim_Now_ns();
+    self->run_ns += now - sim_switch_ns;
+    sim_switch_ns = now;
+    sim_pend &= ~SIM_PEND_YIELD;
+    sim_switch_entry = entry;
+    sim_switch_out = pxCurrentTCB;
+    vTaskSwitchContext();
+    Sim_Thread_t *next = Sim_Thread_Of(pxCurrentTCB);
+    if (next != self) {
+        Sim_Hand_Over(self, next);
+    }
+    Sim_Switch_Done();
+}
+
+/**
+ * @brief  任务线程入口：第一次被选中后运行任务函数
+ */
+static void *Sim_Thread_Entry(void *arg) {
+    Sim_Thread_t *self = arg;
+    pthread_mutex_lock(&sim_lock);
+    sim_self = self;
+    Sim_Wait_Run(self);
+    Sim_Switch_Done();
+    self->code(self->param);
+    fprintf(stderr, "sim: task function returned\n");
+    abort();
+}
+
+/************************ 移植接口 ************************/
+/**
+ * @brief  初始化任务栈：在栈缓冲区顶端放线程记录并创建线程（第一次被调度前不运行）
+ * @param  pxTopOfStack: 栈顶（已按portBYTE_ALIGNMENT对齐）
+ * @param  pxCode: 任务入口
+ * @param  pvParameters: 入口参数
+ * @retval 保存到TCB的栈顶，紧挨线程记录的下方
+ */
+StackType_t *pxPortInitialiseStack(StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters) {
+    uintptr_t addr = ((uintptr_t)pxTopOfStack - sizeof(Sim_Thread_t)) & ~(uintptr_t)15U;
+    Sim_Thread_t *rec = (Sim_Thread_t *)addr;
+    memset(rec, 0, sizeof(*rec));
+    pthread_cond_init(&rec->cond, NULL);
+    rec->code = pxCode;
+    rec->param = pvParameters;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, Sim_Stack_Alloc(SIM_THREAD_STACK), SIM_THREAD_STACK);
+    if (pthread_create(&rec->thread, &attr, Sim_Thread_Entry, rec) != 0) {
+        fprintf(stderr, "sim: pthread_create failed\n");
+        abort();
+    }
+    pthread_attr_destroy(&attr);
+    return (StackType_t *)rec - 1;
+}
+
+/**
+ * @brief  启动调度器：运行第一个任务，复位线程等到vTaskEndScheduler才返回
+ */
+BaseType_t xPortStartScheduler(void) {
+    sim_nesting = 0;
+    sim_basepri = 0;
+    sim_primask = 0;
+    sim_running = true;
+    Sim_Clock_Start();
+    sim_switch_ns = Sim_Now_ns();
+    Sim_Hand_Over(sim_self, Sim_Thread_Of(pxCurrentTCB));
+    return pdTRUE;
+}
+
+/**
+ * @brief  结束调度器：运行权交回复位线程，调用者不再返回
+ */
+void vPortEndScheduler(void) {
+    sim_self->run_ns += Sim_Now_ns() - sim_switch_ns;
+    sim_running = false;
+    sim_pend = 0;
+    Sim_Hand_Over(sim_self, &sim_reset);
+}
+
+/**
+ * @brief  任务请求切换，屏蔽期间或中断中推迟
+ */
+void vPortYield(void) {
+    if (!sim_running) {
+        return;
+    }
+    sim_pend |= SIM_PEND_YIELD;
+    Sim_Irq_Unmasked();
+}
+
+void vPortEnterCritical(void) {
+    sim_basepri = 1U;
+    sim_nesting++;
+}
+
+void vPortExitCritical(void) {
+    configASSERT(sim_nesting != 0U);
+    sim_nesting--;
+    if (sim_nesting == 0U) {
+        sim_basepri = 0U;
+        if (sim_pend != 0U) {
+            Sim_Irq_Unmasked();
+        }
+    }
+}
+
+uint32_t ulPortSetInterruptMask(void) {
+    uint32_t old = sim_basepri;
+    sim_basepri = 1U;
+    return old;
+}
+
+void vPortClearInterruptMask(uint32_t mask) {
+    sim_basepri = mask;
+    if (mask == 0U && sim_pend != 0U) {
+        Sim_Irq_Unmasked();
+    }
+}
+
+/**
+ * @brief  节拍中断（cmsis_os2.c的SysTick_Handler调用）
+ */
+void xPortSysTickHandler(void) {
+    if (xTaskIncrementTick() != pdFALSE) {
+        sim_pend |= SIM_PEND_YIELD;
+    }
+}
+
+/************************ 仿真接口 ************************/
+/**
+ * @brief  解除屏蔽：执行推迟的中断，再执行推迟的任务切换
+ * @note   中断上下文中不切换（中断返回时由Sim_Step处理）
+ */
+void Sim_Irq_Unmasked(void) {
+    if (sim_ipsr != 0U || Sim_Irq_Masked()) {
+        return;
+    }
+    if ((sim_pend & SIM_PEND_ISR) != 0U) {
+        sim_pend &= ~SIM_PEND_ISR;
+        Sim_Run_Isrs();
+    }
+    if ((sim_pend & SIM_PEND_YIELD) != 0U && sim_running) {
+        Sim_Switch();
+    }
+}
+
+/**
+ * @brief  复位线程初始化：持有仿真锁，作为调度器启动前与结束后的运行线程
+ * @note   仿真线程不接收SIGINT/SIGTERM，由进程主线程处理
+ */
+void Sim_Port_Init(void) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    pthread_mutex_lock(&sim_lock);
+    pthread_cond_init(&sim_reset.cond, NULL);
+    sim_reset.thread = pthread_self();
+    sim_self = &sim_reset;
+}
+
+bool Sim_Irq_Masked(void) {
+    return sim_primask != 0U || sim_basepri != 0U || sim_nesting != 0U;
+}
+
+/**
+ * @brief  任务累计运行的虚拟时间
+ * @param  task: 任务句柄（TCB）
+ * @note   代码本身不耗虚拟时间，结果即忙等（HAL_Delay、Flash擦写、阻塞发送）时长，空闲任务为空闲时长
+ */
+uint64_t Sim_Task_Run_ns(void *task) {
+    return Sim_Thread_Of(task)->run_ns;
+}
+
+bool Sim_Scheduler_Running(void) {
+    return sim_running;
+}
+
+/**
+ * @brief  分配4GB以下的线程栈
+ * @param  size: 字节数
+ * @note   固件按32位地址传递指针（如HAL_FLASH_Program的源地址），局部变量所在的栈必须在4GB以下，
+ *         程序本身以-no-pie链接，静态数据同样在低地址
+ */
+void *Sim_Stack_Alloc(size_t size) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#ifdef MAP_32BIT
+    flags |= MAP_32BIT;
+#endif
+    void *p = mmap((void *)SIM_STACK_HINT, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED || (uint64_t)(uintptr_t)p + size > 0x100000000ULL) {
+        fprintf(stderr, "sim: cannot map thread stack below 4GB\n");
+        abort();
+    }
+    return p;
+}
@@ -0,0 +1,86 @@
+//
+// Created by ottohesl on 26-1-25.
+//
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+// 主机仿真移植层（虚拟时间）：每个FreeRTOS任务对应一个主机线程，任意时刻只有持有仿真锁的一个线程在运行，
+// 任务切换即交接仿真锁，节拍与外设中断由Sim_Step按虚拟时间投递（Sim/Src/Sim_Clock.c），详见port.c
+// 1. 临界区只是嵌套计数：仿真中断只在Sim_Step中投递，临界区/屏蔽期间的中断与切换推迟到退出时
+// 2. 就绪位图用主机的前导零指令，与ARM_CM4F移植相同的32级优先级限制
+
+/************************ 类型定义 ************************/
+#define portCHAR                char
+#define portFLOAT               float
+#define portDOUBLE              double
+#define portLONG                long
+#define portSHORT               short
+#define portSTACK_TYPE          unsigned long
+#define portBASE_TYPE           long
+#define portPOINTER_SIZE_TYPE   uintptr_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t TickType_t;
+#define portMAX_DELAY           (TickType_t)0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY           (TickType_t)0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+#endif
+
+/************************ 架构参数 ************************/
+#define portSTACK_GROWTH        (-1)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT      8
+#define portNOP()
+#define portINLINE              inline
+#define portFORCE_INLINE        inline __attribute__((always_inline))
+#define portMEMORY_BARRIER()    __asm volatile("" ::: "memory")
+
+/************************ 调度与临界区 ************************/
+void vPortYield(void);
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+uint32_t ulPortSetInterruptMask(void);
+void vPortClearInterruptMask(uint32_t mask);
+
+#define portYIELD()                             vPortYield()
+#define portEND_SWITCHING_ISR(xSwitchRequired)  do { if ((xSwitchRequired) != pdFALSE) { sim_pend |= SIM_PEND_YIELD; } } while (0)
+#define portYIELD_FROM_ISR(x)                   portEND_SWITCHING_ISR(x)
+#define portSET_INTERRUPT_MASK_FROM_ISR()       ulPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)    vPortClearInterruptMask(x)
+#define portDISABLE_INTERRUPTS()                (void)ulPortSetInterruptMask()
+#define portENABLE_INTERRUPTS()                 vPortClearInterruptMask(0U)
+#define portENTER_CRITICAL()                    vPortEnterCritical()
+#define portEXIT_CRITICAL()                     vPortExitCritical()
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters)       void vFunction(void *pvParameters)
+
+/************************ 优化的任务选择 ************************/
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+#if (configMAX_PRIORITIES > 32)
+#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 32.
+#endif
+#define portRECORD_READY_PRIORITY(uxPriority, uxReadyPriorities) (uxReadyPriorities) |= (1UL << (uxPriority))
+#define portRESET_READY_PRIORITY(uxPriority, uxReadyPriorities)  (uxReadyPriorities) &= ~(1UL << (uxPriority))
+#define portGET_HIGHEST_PRIORITY(uxTopPriority, uxReadyPriorities) \
+    uxTopPriority = (UBaseType_t)(63 - __builtin_clzl((unsigned long)(uxReadyPriorities)))
+#endif
+
+/************************ 中断上下文 ************************/
+static portFORCE_INLINE BaseType_t xPortIsInsideInterrupt(void) {
+    return (sim_ipsr != 0U) ? 1 : 0;
+}
+
+#endif //PORTMACRO_H
@@ -5,54 +5,265 @@
 #include "ottohesl.h"
 #include <stdio.h>
 #include"SBUS_T.h"
+#include "GPS_T.h"
+#include "NAV_Filter.h"
+#include "Autopilot.h"
+#include "steering.h"
 #include "Start_Task.h"
+#include "Telemetry.h"
+#include "CMD_Arbiter.h"
+#include "Uplink.h"
+#include "BlackBox.h"
+#include "MEM_Cache.h"
+#include "RT_Stats.h"
+#include "Trace.h"
+#include "TimeBase.h"
+#include "Power.h"
+#include "Executive.h"
+#include "Capture.h"
+
+Control_Stats_t control_stats FAST_DATA;     // 控制周期耗时
+static volatile uint32_t input_stamp[INPUT_COUNT] FAST_DATA;  // 各输入最近一次被处理的数据对应的接收中断周期计数
+static uint64_t jy901s_last_us = 0;                 // 上一组IMU采样的时间戳（导航预测步长）
+static uint64_t control_last_start_us = 0;          // 上一个控制周期的起点（0=尚未运行）
+static bool control_aligned = false;                // 已有按节拍释放的周期起点（任务启动后的第一个周期不是）
+
+/**
+ * @brief  登记一个已处理的输入：记录其接收中断时刻并置位Inputs事件组
+ * @param  id: 输入编号
+ * @param  stamp: 接收中断中记录的TIMEBASE_CYCLES()
+ */
+static void Input_Post(Input_Id_t id, uint32_t stamp) {
+    input_stamp[id] = stamp;
+    osEventFlagsSet(InputsHandle, 1U << id);
+}
+
+/************************ 实时工作（多任务布局与执行器共用） ************************/
+// 以下各函数运行到完成、不阻塞：多任务布局中由各任务在被通知后调用，执行器下作为作业调用
+
+// 遥控：解析SBUS帧并提交仲裁器（等待超时也调用一次，检测失联）
+static void SBUS_Job(uint32_t release_ms) {
+    (void)release_ms;
+    if (SBUS_Process()) {
+        Input_Post(INPUT_RC, sbus_rx_stamp);
+    }
+}
+
+// GPS：解析定位，交给导航滤波（校正在JY901S工作中执行）
+static void GPS_Job(uint32_t release_ms) {
+    (void)release_ms;
+    if (GPS_Process()) {
+        GPS_Data_t gps;
+        GPS_Get_Data(&gps);
+        NAV_Post_GPS(&gps);
+        Input_Post(INPUT_GPS, gps_rx_stamp);
+    }
+}
+
+// 姿态：解析JY901S，导航滤波预测一步（dt取相邻两组采样的时间戳之差），有新GPS定位则紧接着校正
+static void JY901S_Job(uint32_t release_ms) {
+    (void)release_ms;
+    jy901 *gyro = &gyro_data;
+    if (Gyroscope_Process()) {
+        uint64_t now_us = gyro->time_us;
+        TRACE_BEGIN(TRACE_MARK_NAV_UPDATE);
+        NAV_Predict(gyro, (float)(now_us - jy901s_last_us) * 1e-6f);
+        NAV_Update();
+        TRACE_END(TRACE_MARK_NAV_UPDATE);
+        jy901s_last_us = now_us;
+        //ottohesl_uart(&huart3,"%f,%f,%f",gyro_data.gyroscope.angle[0],gyro_data.gyroscope.angle[1],gyro_data.gyroscope.angle[2]);
+        Input_Post(INPUT_IMU, jy901s_rx_stamp);
+    }
+}
+
+/**
+ * @brief  控制周期开始：卡顿触发、起点抖动、取走输入并统计输入延迟
+ * @retval 周期起点的TIMEBASE_CYCLES()
+ */
+static FAST_CODE uint32_t Control_Begin(void) {
+    // 跨越空闲睡眠的周期差用连续周期计数，起点间隔用时基微秒（与换档后的主频无关）
+    uint32_t start = TIMEBASE_CYCLES();
+    uint64_t start_us = TimeBase_Now_us();
+    TRACE_BEGIN(TRACE_MARK_CONTROL);
+    if (control_last_start_us != 0U) {
+        // 周期起点间隔过长（被更高优先级任务/中断或阻塞调用推迟）：触发调度事件记录，保留卡顿前后的历史
+        uint64_t interval = start_us - control_last_start_us;
+        if (interval > TIMEBASE_MS(CONTROL_PERIOD_MS) * TRACE_LATE_PERCENT / 100U) {
+            Trace_Trigger(TRACE_TRIG_CONTROL_LATE);
+        }
+        // 起点抖动：相邻两次起点间隔与控制周期之差的绝对值；第一个周期在任务启动时开始（不在节拍边界），
+        // 它与第二个周期的间隔只反映启动相位，不计入
+        if (control_aligned) {
+            uint64_t period = TIMEBASE_MS(CONTROL_PERIOD_MS);
+            uint64_t jitter = (interval > period) ? interval - period : period - interval;
+            if (jitter > control_stats.jitter_us_max) {
+                control_stats.jitter_us_max = (uint32_t)jitter;
+            }
+        }
+        control_aligned = true;
+    }
+    control_last_start_us = start_us;
+    // 取走上个周期以来到达的输入（数据本身直接读各模块），统计各输入从接收中断到被本周期读到的延迟
+    uint32_t inputs = osEventFlagsClear(InputsHandle, INPUT_EVT_ALL);
+    if ((inputs & osFlagsError) == 0U) {
+        for (int i = 0; i < INPUT_COUNT; i++) {
+            if ((inputs & (1U << i)) == 0U) {
+                continue;
+            }
+            uint32_t age = start - input_stamp[i];
+            if (age > control_stats.input_age_max[i]) {
+                control_stats.input_age_max[i] = age;
+            }
+        }
+    }
+    return start;
+}
+
+/**
+ * @brief  控制周期结束：记录耗时，统计截止时间错过
+ * @param  start: Control_Begin的返回值
+ * @param  tick: 本周期的理想起点（内核节拍），截止时间为下一个周期起点
+ */
+static FAST_CODE void Control_End(uint32_t start, uint32_t tick) {
+    TRACE_END(TRACE_MARK_CONTROL);
+    uint32_t cycles = TIMEBASE_CYCLES() - start;
+    control_stats.cycles = cycles;
+    if (cycles > control_stats.cycles_max) {
+        control_stats.cycles_max = cycles;
+    }
+    if (osKernelGetTickCount() - tick >= CONTROL_PERIOD_MS) {
+        control_stats.deadline_misses++;
+    }
+}
+
+/**
+ * @brief  控制：地面站命令、自动驾驶、指令仲裁、步态状态机
+ * @param  tick: 本周期的理想起点（内核节拍）
+ */
+static FAST_CODE void Control_Step(uint32_t tick) {
+    static bool auto_mode = false;
+    NAV_State_t nav;
+    AP_Output_t ap;
+
+    // 地面站命令：运动设定提交到仲裁器，参数/航点直接生效
+    Uplink_Process(tick);
+
+    if (SBUS_Auto_Mode() || Uplink_Auto_Mode(tick)) {
+        // 自动驾驶：刚切入时从第一个航点重新开始
+        if (!auto_mode) {
+            AP_Restart();
+            auto_mode = true;
+        }
+        NAV_Get_State(&nav);
+        AP_Step(&nav, NAV_Get_Heading(&gyro_data), &ap);
+        if (ap.active) {
+            CMD_Submit_Setpoint(CMD_SRC_AUTO, ap.yaw_rate, ap.speed);
+        } else {
+            CMD_Submit(CMD_SRC_AUTO, CMD_STOP);
+        }
+    } else if (auto_mode) {
+        // 退出自动驾驶：撤销自动指令，无其他指令源时仲裁器执行停止
+        CMD_Release(CMD_SRC_AUTO);
+        auto_mode = false;
+    }
+
+    // 指令仲裁：遥控 > 地面站 > 自动驾驶，选中的指令在本周期执行
+    CMD_Arbiter_Run(TimeBase_Now_us());
+
+    // 步态状态机按固定控制周期运行
+    Fish_StateMachine();
+}
+
+// 输出：遥测按各消息频率采样本周期的状态，黑匣子把同样的采样写入RAM缓冲，由后台任务编程到Flash
+static FAST_CODE void Output_Job(uint32_t tick) {
+    Telemetry_Process(tick);
+    BlackBox_Process(tick);
+}
+
+#if EXEC_ENABLE
+/************************ 执行器布局 ************************/
+// 控制作业：与多任务布局的控制周期相同，遥测/黑匣子采样拆成下一个作业（同一节拍释放，优先级低一档）
+static FAST_CODE void Control_Job(uint32_t tick) {
+    uint32_t start = Control_Begin();
+    Control_Step(tick);
+    Control_End(start, tick);
+}
+
+// 作业表：优先级沿用多任务布局的速率单调分配，事件超时与各任务的等待超时相同
+static const Exec_Job_t control_jobs[] = {
+    //  名称          入口          优先级  周期（ms）           事件              超时（ms）
+    {"rc",          SBUS_Job,     26,     0,                  SBUS_RX_FLAG,     SBUS_WAIT_MS},
+    {"imu",         JY901S_Job,   25,     0,                  JY901S_RX_FLAG,   JY901S_WAIT_MS},
+    {"control",     Control_Job,  24,     CONTROL_PERIOD_MS,  0,                0},
+    {"telemetry",   Output_Job,   23,     CONTROL_PERIOD_MS,  0,                0},
+    {"gps",         GPS_Job,      16,     0,                  GPS_RX_FLAG,      GPS_WAIT_MS},
+};
+
+// Control任务即执行器的承载任务：各接收中断的线程标志置到本任务上（freertos.c中句柄指向ControlHandle）
+FAST_CODE void Start_Control(void *argument)
+{
+    jy901s_last_us = TimeBase_Now_us();
+    Exec_Run(control_jobs, sizeof(control_jobs) / sizeof(control_jobs[0]));
+}
+#else
+/************************ 多任务布局 ************************/
 void SBUS_Recevie(void *argument) {
-    SBUS_Command_t *Command;
     for(;;)
     {
-        if(SBUS_Process()==sbus_data.new_data_available){
-            osMessageQueuePut( SBUSHandle, &Command, 0,osWaitForever);
-        }
-        osDelay(1);
+        // 等待USART1空闲中断（每帧一次），超时也处理一次以检测遥控失联
+        osThreadFlagsWait(SBUS_RX_FLAG, osFlagsWaitAny, SBUS_WAIT_MS);
+        SBUS_Job(osKernelGetTickCount());
     }
 }
 void GPS_Receive(void *argument) {
     for(;;)
     {
-        osDelay(1);
+        // 等待USART6空闲/半满中断通知，超时也处理一次防止漏事件
+        osThreadFlagsWait(GPS_RX_FLAG, osFlagsWaitAny, GPS_WAIT_MS);
+        GPS_Job(osKernelGetTickCount());
     }
 }
 void JY901S_Receive(void *argument){
-    jy901 *gyro = &gyro_data;
+    jy901s_last_us = TimeBase_Now_us();
     for(;;)
     {
-        
-        if (Gyroscope_Process()) {
-            //ottohesl_uart(&huart3,"%f,%f,%f",gyro_data.gyroscope.angle[0],gyro_data.gyroscope.angle[1],gyro_data.gyroscope.angle[2]);
-            osMessageQueuePut(JY901SHandle,&gyro, 0, 0);
-        }
-        osDelay(10);
+        // 等待USART2空闲中断（每组输出一次），超时也处理一次以统计传感器无数据
+        osThreadFlagsWait(JY901S_RX_FLAG, osFlagsWaitAny, JY901S_WAIT_MS);
+        JY901S_Job(osKernelGetTickCount());
     }
 }
-void Start_Control(void *argument)
+FAST_CODE void Start_Control(void *argument)
 {
-    jy901 *gyro;
-    SBUS_Command_t *cmd;
+    uint32_t tick = osKernelGetTickCount();
     for(;;)
     {
-        if (osMessageQueueGet(JY901SHandle,&gyro,0,osWaitForever)==osOK) {
-            //开始处理姿态
-            //ottohesl_uart(&huart_debug,"开始处理文件！");
-            
-            ottohesl_uart(&huart_debug,"%f,%f,%f",gyro->gyroscope.angle[0],gyro->gyroscope.angle[1],gyro->gyroscope.angle[2]);
-        }
-        if(osMessageQueueGet( SBUSHandle, &cmd, 0,osWaitForever) ==osOK){
-            //开始处理SBUS命令
-            Fish_ExecuteCommand();
-            //ottohesl_uart(&huart_debug,"收到SBUS命令！");
-
-        }
-        osDelay(1);
+        uint32_t start = Control_Begin();
+        Control_Step(tick);
+        Output_Job(tick);
+        Control_End(start, tick);
+        tick += CONTROL_PERIOD_MS;
+        osDelayUntil(tick);
     }
 
 }
+#endif
+void BlackBox_Write(void *argument) {
+    for(;;)
+    {
+        // 控制任务交出缓冲/导出/换档/原始数据采集时通知，超时也处理一次（预擦除、FULL恢复）
+        osThreadFlagsWait(BB_FLAG_WRITE | TRACE_FLAG_DUMP | POWER_FLAG_SWITCH | CAPTURE_FLAG_DRAIN,
+                          osFlagsWaitAny, BB_SERVICE_PERIOD_MS);
+        BlackBox_Service();
+        // 调度事件记录：触发停止后上报状态，有请求时导出
+        Trace_Service();
+        // 时钟换档（等PWM空档，挂起调度器约百微秒）
+        Power_Service();
+        // 原始数据采集：发送缓冲区中的数据块（调试串口有余量时）
+        Capture_Service();
+    }
+}
+void RT_Stats_Callback(void *argument) {
+    // 运行时统计窗口结束：采样各任务/中断占用、任务切换与睡眠统计（定时器服务任务中执行）
+    RT_Stats_Sample();
+    Power_Sample();
+}
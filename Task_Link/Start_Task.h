@@ -1,9 +1,54 @@
 
 #ifndef START_TASK_H
 #define START_TASK_H
+#include <stdint.h>
 
+#define CONTROL_PERIOD_MS   10      // 控制任务周期（ms），与AP_CONTROL_DT一致
 
+// 任务与FPU：移植层按任务是否实际执行过浮点指令决定切换时是否保存s16-s31，任务属性中无需声明。
+// 用到浮点的任务（Control：步态/自动驾驶，JY901S：导航滤波，GPS：二进制协议解码）每次切换多压栈34个字，
+// 栈预算按扩展帧计；SBUS与BlackBox任务基本只做整数运算
 
+// 任务优先级（速率单调：周期/截止时间越短优先级越高，同周期的生产者高于消费者），
+// Control/BlackBox在FISH_H7.ioc中设置，SBUS/JY901S/GPS在freertos.c的USER CODE中创建（执行器布局不创建）：
+//   任务        优先级              唤醒方式                          周期/截止时间
+//   SBUS        Normal2(26)         USART1空闲中断线程标志            7ms（高速模式帧间隔）
+//   JY901S      Normal1(25)         USART2空闲中断线程标志            10ms（100Hz输出）
+//   Control     Normal(24)          osDelayUntil周期                  10ms（CONTROL_PERIOD_MS）
+//   GPS         BelowNormal(16)     USART6空闲中断线程标志            100ms（10Hz定位）
+//   定时器服务  2                   软件定时器                        1s（RT_Stats窗口）
+//   BlackBox    Idle(1)             控制任务线程标志/超时             后台（Flash编程/擦除、Trace导出、时钟换档）
+// 传感器任务只在接收中断通知后运行，等待超时只用于失联检测与兜底，不轮询；
+// 解析出新数据后置位Inputs事件组，控制周期开始时取走并统计各输入从中断到被读到的延迟（上界约一个控制周期）
+// 执行器布局（EXEC_ENABLE，Executive.h）：上面三个传感器任务与Control合并为Control任务中的作业表
+// （rc/imu/control/telemetry/gps，优先级同上，遥测采样拆为独立作业），只占Control一个栈；
+// SBUS/JY901S/GPS_TaskHandle指向Control，接收中断的线程标志原样置位，各标志位不重叠
+#define SBUS_WAIT_MS        20      // SBUS任务等待超时（ms），遥控失联在SBUS_FAILSAFE_TIMEOUT+该值内发现
+#define JY901S_WAIT_MS      100     // JY901S任务等待超时（ms），超时后Gyroscope_Process统计无数据
+#define GPS_WAIT_MS         100     // GPS任务等待超时（ms）
 
+// 输入编号（Inputs事件组的位号，顺序与遥测task消息input_age_max一致）
+typedef enum {
+    INPUT_IMU = 0,                  // JY901S姿态（已完成导航预测）
+    INPUT_RC,                       // SBUS遥控帧（已提交仲裁器）
+    INPUT_GPS,                      // GPS定位（已交给导航滤波）
+    INPUT_COUNT
+} Input_Id_t;
+
+#define INPUT_EVT_IMU       (1U << INPUT_IMU)
+#define INPUT_EVT_RC        (1U << INPUT_RC)
+#define INPUT_EVT_GPS       (1U << INPUT_GPS)
+#define INPUT_EVT_ALL       (INPUT_EVT_IMU | INPUT_EVT_RC | INPUT_EVT_GPS)
+
+// 控制周期耗时（DWT周期，从唤醒到osDelayUntil之前，经遥测task消息上报；执行器下不含遥测/黑匣子采样作业）
+typedef struct {
+    volatile uint32_t cycles;           // 最近一个周期
+    volatile uint32_t cycles_max;       // 最大值
+    volatile uint32_t jitter_us_max;    // 相邻两个周期起点间隔与CONTROL_PERIOD_MS之差的最大绝对值，us
+    volatile uint32_t input_age_max[INPUT_COUNT]; // 各输入从接收中断到被控制周期读到的最大延迟
+    volatile uint32_t deadline_misses;  // 结束时已过下一个周期起点（超出截止时间）的周期数
+} Control_Stats_t;
+
+extern Control_Stats_t control_stats;
 
 #endif //START_TASK_H
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+"""
+黑匣子导出工具（对应固件 Core/Inc/BlackBox.h）
+
+经上行命令BB_DUMP（0x89）触发导出，收集遥测BB_DATA消息（每条一个32字节Flash字），
+按扇区写入代数从旧到新拼接成记录流。记录流与遥测抓包格式相同，直接交给tlm2csv.py：
+    python3 bbdump.py /dev/ttyUSB0 -o flight.bin
+    python3 tlm2csv.py flight.bin -o flight_csv
+也可以处理事先保存的串口抓包（抓包期间用uplink.py以外的方式触发了导出）：
+    python3 bbdump.py --capture dump_capture.bin -o flight.bin
+"""
+import argparse
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder  # noqa: E402
+from uplink import Uplink, CMD_BB_DUMP, open_port  # noqa: E402
+
+WORD = 32
+SECTOR_HEADER = struct.Struct("<8I")    # magic generation session erase_count boot_tick reserved[2] crc
+MAGIC = 0x58424246
+STATE_NAMES = ["off", "recording", "full", "flush", "dumping"]
+IDLE_TIMEOUT = 5.0                      # 导出中超过该时间没有新数据视为结束（s）
+
+
+class Assembler:
+    """收集BB_DATA/BB_STATUS消息并拼接记录流"""
+
+    def __init__(self):
+        self.sectors = {}               # generation -> {offset: 32字节}
+        self.status = None
+        self.done = False
+        self.last_data = time.monotonic()
+
+    def feed(self, msg):
+        if msg.name == "bb_data":
+            self.sectors.setdefault(msg.fields["generation"], {})[msg.fields["offset"]] = msg.fields["data"]
+            self.last_data = time.monotonic()
+        elif msg.name == "bb_status":
+            self.status = msg.fields
+            # 导出完成后固件立即补发一条状态（此时已回到记录状态）
+            if self.sectors and STATE_NAMES[min(msg.fields["state"], 4)] not in ("flush", "dumping"):
+                self.done = True
+
+    def received_words(self):
+        return sum(len(words) for words in self.sectors.values())
+
+    def assemble(self):
+        """返回(记录流, 每个扇区的摘要列表)"""
+        stream = bytearray()
+        report = []
+        last_session = None
+        for gen in sorted(self.sectors):
+            words = self.sectors[gen]
+            header = words.get(0)
+            session = erase_count = None
+            if header is not None:
+                magic, _, session, erase_count, *_ = SECTOR_HEADER.unpack(header)
+                if magic != MAGIC:
+                    session = erase_count = None
+            end = max(words) + WORD
+            missing = sum(1 for off in range(WORD, end, WORD) if off not in words)
+            # 会话切换处上一次上电的最后一帧可能不完整，插入分隔符让解码器重新同步
+            if last_session is not None and session != last_session:
+                stream += b"\x00"
+            last_session = session
+            for off in range(WORD, end, WORD):
+                stream += words.get(off, b"\x00" * WORD)
+            report.append((gen, session, erase_count, end - WORD, missing))
+        return bytes(stream), report
+
+
+def collect_live(port, baud):
+    asm = Assembler()
+    link = Uplink(open_port(port, baud), on_message=asm.feed)
+    result = link.send(CMD_BB_DUMP)
+    if result != "ok":
+        sys.exit(f"bb-dump: {result or 'no ack'}")
+    last_report = 0.0
+    while not asm.done and time.monotonic() - asm.last_data < IDLE_TIMEOUT:
+        link.poll(0.2)
+        now = time.monotonic()
+        if now - last_report > 1.0:
+            last_report = now
+            print(f"\r{asm.received_words() * WORD // 1024} KiB", end="", file=sys.stderr, flush=True)
+    print(file=sys.stderr)
+    os.close(link.fd)
+    return asm
+
+
+def collect_capture(path):
+    asm = Assembler()
+    decoder = Decoder()
+    with open(path, "rb") as f:
+        while True:
+            data = f.read(64 * 1024)
+            if not data:
+                break
+            for msg in decoder.feed(data):
+                asm.feed(msg)
+    return asm
+
+
+def main():
+    parser = argparse.ArgumentParser(description="download the on-board flash black box")
+    parser.add_argument("port", nargs="?", help="serial device or pty path")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--capture", help="read an existing raw capture instead of a live port")
+    parser.add_argument("-o", "--out", default="blackbox.bin", help="output record stream")
+    args = parser.parse_args()
+    if not args.port and not args.capture:
+        parser.error("need a port or --capture")
+
+    asm = collect_capture(args.capture) if args.capture else collect_live(args.port, args.baud)
+    if not asm.sectors:
+        sys.exit("no black box data received")
+    stream, report = asm.assemble()
+    with open(args.out, "wb") as f:
+        f.write(stream)
+
+    print(f"{'gen':>6} {'session':>8} {'erases':>7} {'bytes':>8} {'missing':>8}")
+    for gen, session, erase_count, size, missing in report:
+        print(f"{gen:>6} {session if session is not None else '?':>8} "
+              f"{erase_count if erase_count is not None else '?':>7} {size:>8} {missing:>8}")
+    words = asm.received_words()
+    if asm.status:
+        st = asm.status
+        print(f"received {words} words ({words * WORD} bytes), board sent {st['dump_words']}; "
+              f"records={st['records']} dropped={st['dropped']} erases={st['erases']} "
+              f"erase_ms_max={st['erase_ms_max']}")
+    else:
+        print(f"received {words} words ({words * WORD} bytes), no final status (dump incomplete?)")
+    print(f"wrote {len(stream)} bytes to {args.out}; decode with: python3 tlm2csv.py {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+黑匣子记录率与控制抖动检查（对应固件 Core/Inc/BlackBox.h，在主机仿真的Flash模型上运行）
+
+每个负载场景（输入数据流同stress.py）运行三次FISH_H7_sim（--cpu-scale 0，结果确定）：
+    base   --no-blackbox，不记录，作为控制抖动的基线
+    clean  默认记录频率，记录区初始为擦除状态
+    dirty  默认记录频率，记录区初始全部为0（每个扇区都要擦除：启动时擦除首个扇区，鱼停止时预擦除后面的扇区，
+           擦除期间后台任务不能编程，记录靠RAM环形缓冲接住）
+clean/dirty的判定：
+    记录率（写入缓冲的记录条数/虚拟时间）不低于--min-rate，丢弃、未写入Flash的字节数、编程/擦除失败均为0；
+    控制周期起点抖动与错过截止时间次数不超过base（--jitter-us为允许的差值）；
+    结束时的Flash镜像按扇区代数拼接后解码：无CRC错误、序号连续，未编程的记录不超过一个缓冲。
+用法：
+    python3 bbrate.py                                         # idle与worst_case场景，每次10s虚拟时间
+    python3 bbrate.py --scenario nominal --duration 30 --min-rate 200
+    python3 bbrate.py --sim build/Sim/Sim/FISH_H7_sim         # CTest以此方式运行（Sim/CMakeLists.txt）
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+import tempfile
+from types import SimpleNamespace
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import CRC, HEADER, Decoder  # noqa: E402
+from stress import SCENARIOS, SIM, run_sim  # noqa: E402
+
+SECTOR_SIZE = 128 * 1024                # 与BlackBox.h一致
+SECTOR_COUNT = 4
+BUFFER_SIZE = 1024
+WORD = 32
+SECTOR_HEADER = struct.Struct("<8I")    # magic generation session erase_count boot_tick reserved[2] crc
+MAGIC = 0x58424246
+FRAME_MIN = HEADER.size + CRC.size + 2  # 最短的记录帧（空负载 + COBS开销 + 分隔符）
+
+
+def read_image(path):
+    """Flash镜像按扇区写入代数从旧到新拼接，解码记录流，返回解码器统计"""
+    with open(path, "rb") as f:
+        image = f.read()
+    sectors = []
+    for slot in range(SECTOR_COUNT):
+        sector = image[slot * SECTOR_SIZE:(slot + 1) * SECTOR_SIZE]
+        magic, generation = SECTOR_HEADER.unpack_from(sector)[:2]
+        if magic == MAGIC:
+            # 去掉末尾未编程（全0xFF）的Flash字；最后一帧若只写了一部分，没有分隔符，解码器不计入
+            end = SECTOR_SIZE
+            while end > WORD and sector[end - WORD:end] == b"\xff" * WORD:
+                end -= WORD
+            sectors.append((generation, sector[WORD:end]))
+    decoder = Decoder()
+    decoder.feed(b"".join(data for _, data in sorted(sectors)))
+    return decoder.stats
+
+
+def run(scenario, args, workdir, mode):
+    """运行一次，返回 (报告, 解码统计或None)"""
+    sim_args = []
+    image = os.path.join(workdir, f"{scenario}_{mode}.img")
+    if mode == "base":
+        sim_args.append("--no-blackbox")
+    else:
+        if mode == "dirty":
+            with open(image, "wb") as f:
+                f.write(bytes(SECTOR_SIZE * SECTOR_COUNT))
+        sim_args += ["--flash", image]
+    metrics, _ = run_sim(scenario, SimpleNamespace(sim=args.sim, duration=args.duration, cpu_scale=0), workdir,
+                         sim_args)
+    with open(os.path.join(workdir, f"{scenario}_report.json")) as f:
+        report = json.load(f)
+    report["metrics"] = metrics
+    return report, (read_image(image) if mode != "base" else None)
+
+
+def check(mode, report, stats, base, args):
+    """返回[(检查项, 值, 要求, 是否通过)]"""
+    bb = report["blackbox"]
+    m, b = report["metrics"], base["metrics"]
+    rate = bb["records"] / report["timing"]["virtual_s"]
+    unflushed = bb["records"] - stats.frames
+    rows = [
+        ("records_per_s", round(rate, 1), f">= {args.min_rate:g}", rate >= args.min_rate),
+        ("dropped", bb["dropped"], "0", bb["dropped"] == 0),
+        ("lost_bytes", bb["lost_bytes"], "0", bb["lost_bytes"] == 0),
+        ("flash_errors", bb["flash_errors"], "0", bb["flash_errors"] == 0),
+        ("jitter_us", m["jitter_us"], f"<= {b['jitter_us'] + args.jitter_us:g}",
+         m["jitter_us"] <= b["jitter_us"] + args.jitter_us),
+        ("deadline_misses", m["deadline_misses"], f"<= {b['deadline_misses']}",
+         m["deadline_misses"] <= b["deadline_misses"]),
+        ("flash_records", stats.frames, f">= {bb['records'] - BUFFER_SIZE // FRAME_MIN}",
+         0 <= unflushed <= BUFFER_SIZE // FRAME_MIN),
+        ("flash_seq_gaps", stats.seq_gaps, "0", stats.seq_gaps == 0),
+        ("flash_crc_errors", stats.crc_errors, "0", stats.crc_errors == 0),
+    ]
+    if mode == "dirty":
+        rows.append(("erases", bb["erases"], ">= 1", bb["erases"] >= 1))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="check black box record rate and control jitter on the simulated flash")
+    parser.add_argument("--sim", default=SIM, help="FISH_H7_sim binary")
+    parser.add_argument("--scenario", action="append", help="stress.py load scenario (default: idle and worst_case)")
+    parser.add_argument("--duration", type=float, default=10.0, help="virtual seconds per run")
+    parser.add_argument("--min-rate", type=float, default=200.0, help="minimum records per second")
+    parser.add_argument("--jitter-us", type=float, default=0.0, help="allowed control jitter above the baseline, us")
+    args = parser.parse_args()
+
+    if not os.access(args.sim, os.X_OK):
+        raise SystemExit(f"{args.sim}: not found (build with cmake --preset Sim, or pass --sim)")
+    scenarios = args.scenario or ["idle", "worst_case"]
+    for name in scenarios:
+        if name not in SCENARIOS:
+            raise SystemExit(f"unknown scenario {name} (see 'stress.py list')")
+
+    failed = []
+    with tempfile.TemporaryDirectory(prefix="bbrate_") as workdir:
+        for name in scenarios:
+            base, _ = run(name, args, workdir, "base")
+            for mode in ("clean", "dirty"):
+                report, stats = run(name, args, workdir, mode)
+                rows = check(mode, report, stats, base, args)
+                ok = all(r[3] for r in rows)
+                print(f"{name} / {mode}: {'PASS' if ok else 'FAIL'}")
+                for key, value, need, good in rows:
+                    print(f"   {key:<18} {value:>10} {need:>12}  {'ok' if good else 'FAIL'}")
+                if not ok:
+                    failed.append(f"{name}/{mode}")
+    print(f"\n{2 * len(scenarios) - len(failed)}/{2 * len(scenarios)} runs passed"
+          + (f", failed: {' '.join(failed)}" if failed else ""))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
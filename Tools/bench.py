@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+微基准测试结果读取与基线比较（对应固件 Core/Inc/Bench.h）
+
+板上镜像FISH_H7_bench在调试串口逐行输出（每轮之间间隔BENCH_PERIOD_MS）：
+    BENCH,begin,轮次,CPU频率,测量次数
+    BENCH,用例,warm|cold|off,batch,最小,中位,最大       # 单次调用的CPU周期
+    BENCH,end,轮次
+主机运行器FISH_H7_bench_host按Google Benchmark的JSON格式输出（--benchmark_out=文件）。
+本工具把板上输出整理成同样的JSON（多出cycles字段），比较时按用例名对照中位数：
+
+用法：
+    python3 bench.py read /dev/ttyUSB0 -o board.json --rounds 3      # 读取3轮，各用例取各轮中位数的中位数
+    python3 bench.py read board.log -o board.json                    # 从已保存的串口日志整理
+    FISH_H7_bench_host --benchmark_out=host.json                     # 主机结果（建议Release构建）
+    python3 bench.py compare base.json board.json --threshold 5      # 中位数变慢超过5%的用例记为回退，退出码1
+两侧都有cycles（都是板上结果）时按周期比较，否则按纳秒比较；板上与主机的结果不应互相比较。
+"""
+import argparse
+import json
+import os
+import select
+import statistics
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from uplink import open_port  # noqa: E402
+
+CACHE_MODES = ("warm", "cold", "off")
+
+
+# ---------------------------------------------------------------- 板上输出
+class BoardParser:
+    """逐行解析BENCH输出，按轮次收集各用例的最小/中位/最大周期"""
+
+    def __init__(self):
+        self.rounds = []            # 已结束的轮次：{用例: (cache, batch, min, median, max)}
+        self.current = None
+        self.cpu_hz = None
+        self.runs = None
+
+    def feed(self, line):
+        """处理一行，返回True表示一轮结束"""
+        fields = line.strip().split(",")
+        if len(fields) < 3 or fields[0] != "BENCH":
+            return False
+        try:
+            if fields[1] == "begin" and len(fields) == 5:
+                self.cpu_hz, self.runs = int(fields[3]), int(fields[4])
+                self.current = {}
+            elif fields[1] == "end":
+                if self.current:
+                    self.rounds.append(self.current)
+                self.current = None
+                return True
+            elif self.current is not None and len(fields) == 7 and fields[2] in CACHE_MODES:
+                self.current[fields[1]] = (fields[2], int(fields[3]), int(fields[4]), int(fields[5]), int(fields[6]))
+        except ValueError:
+            pass                    # 串口上偶发的残行
+        return False
+
+    def to_json(self, source):
+        """多轮合并：最小取最小，中位取各轮中位数的中位数，最大取最大"""
+        names = []
+        for r in self.rounds:
+            names += [n for n in r if n not in names]
+        ns_per_cycle = 1e9 / self.cpu_hz if self.cpu_hz else 0.0
+        benchmarks = []
+        for index, name in enumerate(names):
+            rows = [r[name] for r in self.rounds if name in r]
+            cache, batch = rows[0][0], rows[0][1]
+            values = {
+                "min": min(row[2] for row in rows),
+                "median": statistics.median(row[3] for row in rows),
+                "max": max(row[4] for row in rows),
+            }
+            for aggregate, cycles in values.items():
+                benchmarks.append({
+                    "name": f"{name}_{aggregate}",
+                    "family_index": index,
+                    "per_family_instance_index": 0,
+                    "run_name": name,
+                    "run_type": "aggregate",
+                    "repetitions": len(rows) * (self.runs or 1),
+                    "threads": 1,
+                    "aggregate_name": aggregate,
+                    "aggregate_unit": "time",
+                    "iterations": len(rows) * (self.runs or 1) * batch,
+                    "real_time": cycles * ns_per_cycle,
+                    "cpu_time": cycles * ns_per_cycle,
+                    "time_unit": "ns",
+                    "cycles": cycles,
+                    "batch": batch,
+                    "cache": cache,
+                })
+        return {
+            "context": {
+                "date": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+                "host_name": "FISH_H7_bench",
+                "executable": source,
+                "num_cpus": 1,
+                "mhz_per_cpu": (self.cpu_hz or 0) // 1_000_000,
+                "rounds": len(self.rounds),
+                "runs_per_round": self.runs,
+            },
+            "benchmarks": benchmarks,
+        }
+
+
+def read_board(source, rounds, baud, timeout):
+    """从串口或日志文件读取BENCH输出"""
+    parser = BoardParser()
+    if not os.path.exists(source) or os.path.isfile(source):
+        with open(source, "r", errors="replace") as f:
+            for line in f:
+                parser.feed(line)
+        return parser
+    fd = open_port(source, baud)
+    buf = b""
+    deadline = time.monotonic() + timeout
+    try:
+        while len(parser.rounds) < rounds and time.monotonic() < deadline:
+            ready, _, _ = select.select([fd], [], [], 0.5)
+            if not ready:
+                continue
+            buf += os.read(fd, 4096)
+            *lines, buf = buf.split(b"\n")
+            for line in lines:
+                text = line.decode("ascii", errors="replace")
+                if parser.feed(text):
+                    print(f"round {len(parser.rounds)}/{rounds} done", file=sys.stderr)
+    finally:
+        os.close(fd)
+    return parser
+
+
+# ---------------------------------------------------------------- 比较
+def load(path):
+    """读取JSON（主机或板上整理结果）或板上原始日志，返回 {用例: (中位数, 单位)}"""
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+    try:
+        data = json.loads(text)
+    except json.JSONDecodeError:
+        parser = BoardParser()
+        for line in text.splitlines():
+            parser.feed(line)
+        if not parser.rounds:
+            raise SystemExit(f"{path}: neither benchmark JSON nor a BENCH log")
+        data = parser.to_json(path)
+    medians = {}
+    for b in data.get("benchmarks", []):
+        if b.get("run_type") != "aggregate" or b.get("aggregate_name") != "median":
+            continue
+        name = b.get("run_name", b["name"])
+        if "cycles" in b:
+            medians[name] = (b["cycles"], b["real_time"])
+        else:
+            medians[name] = (None, b["real_time"])
+    return medians
+
+
+def compare(base_path, cur_path, threshold):
+    base, cur = load(base_path), load(cur_path)
+    common = [n for n in base if n in cur]
+    if not common:
+        raise SystemExit("no benchmark in common")
+    use_cycles = all(base[n][0] is not None and cur[n][0] is not None for n in common)
+    unit = "cycles" if use_cycles else "ns"
+    print(f"{'Benchmark':<32} {'base':>12} {'current':>12} {'change':>9}  ({unit}, median)")
+    regressions = 0
+    for name in common:
+        b = base[name][0] if use_cycles else base[name][1]
+        c = cur[name][0] if use_cycles else cur[name][1]
+        change = (c - b) / b * 100.0 if b else 0.0
+        mark = ""
+        if change > threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif change < -threshold:
+            mark = "  improved"
+        print(f"{name:<32} {b:>12.2f} {c:>12.2f} {change:>+8.1f}%{mark}")
+    for name in base:
+        if name not in cur:
+            print(f"{name:<32} missing from {cur_path}")
+    for name in cur:
+        if name not in base:
+            print(f"{name:<32} new (no baseline)")
+    print(f"{regressions} regression(s) over {threshold:g}%")
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="collect and compare FISH_H7 microbenchmark results")
+    sub = parser.add_subparsers(dest="command", required=True)
+    p = sub.add_parser("read", help="read BENCH lines from the board (or a saved log) into JSON")
+    p.add_argument("source", help="serial port of the debug UART, or a saved log file")
+    p.add_argument("-o", "--output", help="JSON output (default: stdout)")
+    p.add_argument("--rounds", type=int, default=1, help="rounds to collect from a serial port")
+    p.add_argument("--baud", type=int, default=115200)
+    p.add_argument("--timeout", type=float, default=120.0, help="give up after this many seconds")
+    p = sub.add_parser("compare", help="compare median times against a baseline")
+    p.add_argument("baseline", help="baseline JSON or BENCH log")
+    p.add_argument("current", help="current JSON or BENCH log")
+    p.add_argument("--threshold", type=float, default=5.0, help="regression threshold in percent")
+    args = parser.parse_args()
+
+    if args.command == "read":
+        board = read_board(args.source, args.rounds, args.baud, args.timeout)
+        if not board.rounds:
+            raise SystemExit("no complete BENCH round received")
+        text = json.dumps(board.to_json(args.source), indent=2) + "\n"
+        if args.output:
+            with open(args.output, "w") as f:
+                f.write(text)
+        else:
+            sys.stdout.write(text)
+        return 0
+    return compare(args.baseline, args.current, args.threshold)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
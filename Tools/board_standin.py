@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+"""
+无板测试用的串口替身：创建一个pty，按固件Uplink.c的规则解析上行命令并回送ACK，
+同时以20Hz输出步态遥测（含生效指令源）和少量printf文本，用于联调uplink.py/tlm2csv.py。
+步态遥测同时按黑匣子格式记入内存中的"Flash"，收到BB_DUMP后逐字导出，用于联调bbdump.py。
+每秒发送一条CPU占用消息（固定的示例数值），收到TOP后打印同格式的top文本，用于联调uplink.py top。
+收到TRACE dump后导出一段合成的调度事件（控制周期、姿态DMA中断、队列读写），用于联调trace2json.py。
+每秒发送一条POWER消息，收到POWER命令后按时钟档换算CPU占用与睡眠占比，用于联调powerbench.py。
+收到CAPTURE命令后按选择的源输出合成的原始数据块（SBUS帧、JY901S姿态帧、NMEA语句），用于联调capture.py。
+
+用法：
+    python3 board_standin.py            # 打印pty路径，例如 /dev/pts/5
+    python3 uplink.py /dev/pts/5 setpoint --yaw-rate 10 --speed 4 --repeat 10
+    python3 bbdump.py /dev/pts/5 -o flight.bin
+    python3 uplink.py /dev/pts/5 top
+    python3 trace2json.py /dev/pts/5 -o trace.json
+    python3 powerbench.py /dev/pts/5 --settle 1 --window 2 --current-cmd "echo 0"
+    python3 capture.py record /dev/pts/5 -o run.fcap --sources imu gps --duration 5
+"""
+import os
+import select
+import struct
+import sys
+import time
+import tty
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import encode_frame, unpack_frame, MESSAGES  # noqa: E402
+from uplink import (HEADER, PAYLOADS, CMD_HEARTBEAT, CMD_MODE, CMD_SETPOINT, CMD_COMMAND,  # noqa: E402
+                    CMD_GAIT, CMD_WP_CLEAR, CMD_WP_ADD, CMD_TLM_RATE, CMD_BB_DUMP, CMD_TOP,
+                    CMD_TRACE, CMD_POWER, CMD_CAPTURE)
+
+OK, BAD_LENGTH, BAD_VALUE, REJECTED, UNKNOWN = range(5)
+UPLINK_TIMEOUT = 0.5        # 与CMD_UPLINK_TIMEOUT一致
+LINK_TIMEOUT = 1.0          # 与UPLINK_LINK_TIMEOUT一致
+MAX_WAYPOINTS = 32          # 与AP_MAX_WAYPOINTS一致
+SRC_UPLINK, SRC_AUTO, SRC_NONE = 1, 2, 3
+BB_WORD = 32                # 与BB_WORD_SIZE一致
+BB_SECTOR = 128 * 1024      # 与BB_SECTOR_SIZE一致
+BB_MAGIC = 0x58424246       # 与BB_MAGIC一致
+BB_RECORDING, BB_DUMPING = 1, 4
+# 示例运行时统计（名称, 优先级, CPU占用0.01%, 栈剩余字节），顺序与CPU消息一致
+CPU_TASKS = [("SBUS_Task", 26, 120, 900), ("GPS_Task", 16, 310, 1020), ("JY901S_Task", 25, 840, 1180),
+             ("Control", 24, 1250, 760), ("BlackBox_Task", 1, 60, 980), ("Tmr Svc", 2, 40, 520),
+             ("IDLE", 0, 7380, 400)]
+CPU_ISRS = [("DMA1_S0 imu_rx", 45, 200), ("DMA1_S1 dbg_tx", 30, 120), ("DMA1_S2 gps_rx", 12, 20),
+            ("DMA1_S3 dbg_rx", 5, 10), ("DMA1_S4 rc_rx", 10, 140), ("USART1 rc", 9, 70),
+            ("USART2 imu", 14, 100), ("USART3", 38, 150), ("USART6", 8, 20), ("TIM23 hal_tick", 22, 1000)]
+STATS_CYCLES = 18000
+CPU_HZ = 550_000_000
+PROFILE_HZ = [550_000_000, 160_000_000]     # 与power_clocks一致：性能档/节能档CPU频率
+PROFILE_VOS = [0, 3]
+SLEEP_WAKEUPS = 420                         # 示例：空闲睡眠时每秒唤醒次数（串口空闲中断、DMA、控制周期）
+SWITCH_US = 95                              # 示例换档耗时
+TRACE_EVENT = struct.Struct("<IBBH")    # 与Trace_Event_t一致
+TRACE_PER_MSG = 5                       # 与TLM_TRACE_EVENTS一致
+TRACE_MARKERS = ["control", "uart_blocking", "nav_update", "flash_program"]
+TRACE_OBJECTS = {1: "Inputs"}
+CAPTURE_BYTES = 54                      # 与TLM_CAPTURE_BYTES一致
+
+
+class BlackBox:
+    """内存中的记录区：按固件规则写扇区头和32字节Flash字"""
+
+    def __init__(self):
+        self.sectors = []           # [(generation, bytearray)]
+        self.pending = bytearray()  # 未满一个Flash字的数据
+        self.records = 0
+        self.generation = 0
+
+    def _new_sector(self):
+        self.generation += 1
+        head = struct.pack("<7I", BB_MAGIC, self.generation, 1, 1, 0, 0, 0)
+        self.sectors.append((self.generation, bytearray(head + struct.pack("<I", zlib.crc32(head)))))
+
+    def record(self, frame: bytes):
+        self.records += 1
+        self.pending += frame
+        while len(self.pending) >= BB_WORD:
+            if not self.sectors or len(self.sectors[-1][1]) >= BB_SECTOR:
+                self._new_sector()
+            self.sectors[-1][1].extend(self.pending[:BB_WORD])
+            del self.pending[:BB_WORD]
+
+    def words(self):
+        for gen, data in self.sectors:
+            for off in range(0, len(data), BB_WORD):
+                yield gen, off, bytes(data[off:off + BB_WORD])
+
+
+class Board:
+    def __init__(self):
+        self.mode = 0
+        self.setpoint = None            # (yaw_rate, speed, time)
+        self.command = 0
+        self.gait = (30, 2, 20, 10)
+        self.waypoints = []
+        self.rates = {}
+        self.last_frame = None
+        self.dump_request = False
+        self.top_request = False
+        self.trace_request = False
+        self.profile = 0
+        self.sleep = 1
+        self.switches = 0
+        self.capture = 0
+        self.capture_offset = [0, 0, 0]
+
+    def execute(self, cmd, payload):
+        fmt = PAYLOADS.get(cmd)
+        if fmt is None:
+            return UNKNOWN
+        if len(payload) != fmt.size:
+            return BAD_LENGTH
+        v = fmt.unpack(payload)
+        if cmd == CMD_HEARTBEAT:
+            return OK
+        if cmd == CMD_MODE:
+            if v[0] > 1:
+                return BAD_VALUE
+            self.mode = v[0]
+            if self.mode == 1:
+                self.setpoint = None
+            return OK
+        if cmd == CMD_SETPOINT:
+            if v[0] != v[0] or v[1] > 10:
+                return BAD_VALUE
+            if self.mode != 0:
+                return REJECTED
+            self.setpoint = (v[0], v[1], time.monotonic())
+            return OK
+        if cmd == CMD_COMMAND:
+            if v[0] > 3:
+                return BAD_VALUE
+            if self.mode != 0:
+                return REJECTED
+            self.command = v[0]
+            self.setpoint = (0.0, 0 if v[0] == 0 else self.gait[1], time.monotonic())
+            return OK
+        if cmd == CMD_GAIT:
+            amp, speed, body, tail = v
+            if amp > 60 or not 1 <= speed <= 10 or body > 45 or tail > 45:
+                return BAD_VALUE
+            self.gait = v
+            return OK
+        if cmd == CMD_WP_CLEAR:
+            self.waypoints.clear()
+            return OK
+        if cmd == CMD_WP_ADD:
+            if len(self.waypoints) >= MAX_WAYPOINTS:
+                return REJECTED
+            self.waypoints.append(v)
+            return OK
+        if cmd == CMD_BB_DUMP:
+            self.dump_request = True
+            return OK
+        if cmd == CMD_TOP:
+            if self.top_request:
+                return REJECTED
+            self.top_request = True
+            return OK
+        if cmd == CMD_TRACE:
+            if v[0] > 2:
+                return BAD_VALUE
+            if v[0] == 0:
+                if self.trace_request:
+                    return REJECTED
+                self.trace_request = True
+            return OK
+        if cmd == CMD_POWER:
+            if v[0] >= len(PROFILE_HZ) or v[1] > 1:
+                return BAD_VALUE
+            self.sleep = v[1]
+            if v[0] != self.profile:
+                self.profile = v[0]
+                self.switches += 1
+            return OK
+        if cmd == CMD_CAPTURE:
+            if v[0] >= 8:
+                return BAD_VALUE
+            self.capture = v[0]
+            return OK
+        if cmd == CMD_TLM_RATE:
+            if v[0] == 0 or v[0] not in MESSAGES or v[0] in (0x08, 0x09, 0x0C, 0x0D, 0x0E, 0x10) or v[1] > 100:
+                return BAD_VALUE
+            self.rates[v[0]] = v[1]
+            return OK
+        return UNKNOWN
+
+    def source(self, now):
+        link = self.last_frame is not None and now - self.last_frame <= LINK_TIMEOUT
+        if self.mode == 0 and self.setpoint and now - self.setpoint[2] <= UPLINK_TIMEOUT:
+            return SRC_UPLINK
+        if self.mode == 1 and link:
+            return SRC_AUTO
+        return SRC_NONE
+
+
+def cpu_loads(cpu_hz):
+    """示例任务占用按CPU频率换算（工作量固定，频率越低占用越高），空闲任务取剩余"""
+    busy = [min(10000, t[2] * CPU_HZ // cpu_hz) for t in CPU_TASKS[:-1]]
+    return busy + [max(0, 10000 - sum(busy))]
+
+
+def cpu_payload(cpu_hz=CPU_HZ):
+    isrs = [min(10000, v[1] * CPU_HZ // cpu_hz) for v in CPU_ISRS]
+    return struct.pack("<24HI", *cpu_loads(cpu_hz), *[t[3] for t in CPU_TASKS], *isrs, STATS_CYCLES)
+
+
+def power_payload(board):
+    """POWER消息：睡眠占比取空闲任务占用的97%（其余为进出睡眠与短空闲），关闭睡眠时为0"""
+    cpu_hz = PROFILE_HZ[board.profile]
+    idle = cpu_loads(cpu_hz)[-1]
+    sleep = idle * 97 // 100 if board.sleep else 0
+    sleeps = SLEEP_WAKEUPS if board.sleep else 0
+    return struct.pack("<2I3H3B", cpu_hz, sleeps, sleep, SWITCH_US if board.switches else 0,
+                       board.switches, board.profile, board.sleep, PROFILE_VOS[board.profile])
+
+
+def trace_events():
+    """合成40ms的调度事件：1kHz姿态空闲中断通知JY901S任务，10ms控制周期，第三个周期卡顿后触发"""
+    events = []
+    cycles_per_us = CPU_HZ // 1_000_000
+    idle, jy901s, control = 7, 3, 4
+    t = 0x100000000 - 2000 * cycles_per_us   # 从回绕前2ms开始，检验上位机展开
+    for ms in range(40):
+        base = t + ms * 1000 * cycles_per_us
+
+        def ev(us, typ, ident, arg=0):
+            events.append(TRACE_EVENT.pack((base + us * cycles_per_us) & 0xFFFFFFFF, typ, ident, arg))
+
+        ev(0, 3, 6)                     # ISR_ENTER USART2（空闲）
+        ev(2, 10, jy901s, 1)            # NOTIFY JY901S_RX_FLAG
+        ev(3, 4, 6)                     # ISR_EXIT
+        ev(4, 2, idle)
+        ev(5, 1, jy901s, 25)
+        ev(6, 12, 2)                    # nav_update
+        ev(40, 13, 2)
+        ev(41, 15, 1, 1)                # FLAGS_SET Inputs INPUT_EVT_IMU
+        ev(42, 2, jy901s)
+        if ms % 10 == 0:
+            late = 500 if ms == 20 else 0
+            if late:
+                ev(43, 14, 1)           # TRIGGER control_late
+            ev(44 + late, 1, control, 24)
+            ev(45 + late, 12, 0)        # control span
+            ev(200 + late, 13, 0)
+            ev(201 + late, 2, control)
+        ev(202 + late if ms % 10 == 0 else 43, 1, idle, 0)
+    return events
+
+
+def capture_data(source, tick):
+    """一个50ms遥测周期内到达的合成原始数据：SBUS 3帧、JY901S 5组角度帧、每秒一条GPRMC"""
+    if source == 0:
+        frame = bytes([0x0F]) + bytes((tick + i) & 0xFF for i in range(22)) + b"\x00\x00"
+        return frame * 3
+    if source == 1:
+        out = b""
+        for i in range(5):
+            body = bytes([0x55, 0x53]) + struct.pack("<4h", 0, 0, (tick * 5 + i) % 32768, 0)
+            out += body + bytes([sum(body) & 0xFF])
+        return out
+    if tick % 20:
+        return b""
+    body = f"GPRMC,{tick // 20 % 86400:06d}.00,A,3001.0000,N,12001.0000,E,0.5,90.0,010126,,,A".encode()
+    x = 0
+    for c in body:
+        x ^= c
+    return b"$" + body + f"*{x:02X}\r\n".encode()
+
+
+def trace_names():
+    names = [(0, i + 1, t[0]) for i, t in enumerate(CPU_TASKS)]
+    names += [(1, i, v[0]) for i, v in enumerate(CPU_ISRS)]
+    names += [(2, q, label) for q, label in TRACE_OBJECTS.items()]
+    names += [(3, i, label) for i, label in enumerate(TRACE_MARKERS)]
+    return [struct.pack("<2B16s", kind, ident, label.encode()[:16]) for kind, ident, label in names]
+
+
+def top_text(now_ms):
+    """与固件RT_Print_Top相同格式的top文本"""
+    lines = [f"\r\ntop - {now_ms} ms, window 550000000 cycles, stats {STATS_CYCLES} cycles\r\n",
+             f"  {'TASK':<16} {'PRI':>3} S {'CPU%':>7} {'STACK':>6}\r\n"]
+    for name, prio, load, stack in CPU_TASKS:
+        state = "X" if name == "Tmr Svc" else "B" if name != "IDLE" else "R"
+        lines.append(f"  {name:<16} {prio:>3} {state} {load // 100:>3}.{load % 100:02}% {stack:>6}\r\n")
+    lines.append(f"  {'ISR':<16} {'':>5} {'CPU%':>7} {'COUNT':>6}\r\n")
+    for name, load, count in CPU_ISRS:
+        lines.append(f"  {name:<16} {'':>5} {load // 100:>3}.{load % 100:02}% {count:>6}\r\n")
+    tasks = sum(t[2] for t in CPU_TASKS)
+    isrs = sum(v[1] for v in CPU_ISRS)
+    lines.append(f"  tasks {tasks // 100}.{tasks % 100:02}% (incl. isr {isrs // 100}.{isrs % 100:02}%)\r\n")
+    return "".join(lines).encode()
+
+
+def main():
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    print(os.ttyname(slave), flush=True)
+    board = Board()
+    bb = BlackBox()
+    buf = bytearray()
+    seq = 0
+    t0 = time.monotonic()
+    next_tlm = t0
+    next_cpu = t0 + 1.0
+    tick = 0
+
+    def send(msg_type, payload):
+        nonlocal seq
+        now_us = int((time.monotonic() - t0) * 1e6)
+        frame = encode_frame(msg_type, seq, now_us, payload)
+        os.write(master, frame)
+        seq = (seq + 1) & 0xFFFF
+        return frame
+
+    def bb_status(state):
+        return struct.pack("<6I2H2B", 1, bb.generation, bb.records, 0, sum(len(d) for _, d in bb.sectors),
+                           bb_sent, 1, 0, state, len(bb.sectors) - 1)
+
+    bb_sent = 0
+
+    while True:
+        ready, _, _ = select.select([master], [], [], max(0.0, next_tlm - time.monotonic()))
+        if ready:
+            try:
+                buf += os.read(master, 4096)
+            except OSError:
+                continue
+            while (idx := buf.find(0)) >= 0:
+                chunk = bytes(buf[:idx])
+                del buf[:idx + 1]
+                body = unpack_frame(chunk) if chunk else None
+                if body is None or len(body) < HEADER.size:
+                    continue
+                cmd, cmd_seq = HEADER.unpack_from(body)
+                board.last_frame = time.monotonic()
+                result = board.execute(cmd, body[HEADER.size:])
+                send(0x08, struct.pack("<BHB", cmd, cmd_seq, result))
+        now = time.monotonic()
+        if now >= next_tlm:
+            next_tlm += 0.05
+            src = board.source(now)
+            sp = board.setpoint if src == SRC_UPLINK else None
+            speed = sp[1] if sp else 0
+            state = 1 if speed else 0
+            yaw = int((sp[0] if sp else 0.0) * 100)
+            yaw = max(-32768, min(32767, yaw))
+            frame = send(0x03, struct.pack("<5B2h2fB", state, state, speed or board.gait[1], src == SRC_AUTO,
+                                           0, yaw, 0, 0.0, 0.0, src))
+            bb.record(frame[1:])    # 黑匣子只保存结尾分隔符
+            tick += 1
+            for source in range(3):
+                # 原始数据采集：与固件相同按TLM_CAPTURE_BYTES切块，带流偏移和32位时间
+                if not board.capture & (1 << source):
+                    continue
+                data = capture_data(source, tick)
+                time_us = int((now - t0) * 1e6) & 0xFFFFFFFF
+                for i in range(0, len(data), CAPTURE_BYTES):
+                    part = data[i:i + CAPTURE_BYTES]
+                    send(0x10, struct.pack("<2I2B", board.capture_offset[source], time_us, source, len(part)) + part)
+                    board.capture_offset[source] += len(part)
+            if board.dump_request:
+                # 导出：逐字发送BB_DATA，结束后补发一条状态；pty缓冲有限，写满时等待
+                board.dump_request = False
+                bb_sent = 0
+                for gen, off, word in bb.words():
+                    payload = struct.pack("<II", gen, off) + word
+                    while True:
+                        try:
+                            send(0x09, payload)
+                            break
+                        except BlockingIOError:
+                            time.sleep(0.01)
+                    bb_sent += 1
+                send(0x0A, bb_status(BB_RECORDING))
+            if board.trace_request:
+                # 调度事件导出：状态 -> 名称表 -> 事件（每条5个）-> 状态
+                board.trace_request = False
+                events = trace_events()
+                n = len(events)
+
+                # 停止记录时刻：最后一个事件后1us，合成事件的第一个事件取TimeBase上电后1s
+                first, last = TRACE_EVENT.unpack(events[0])[0], TRACE_EVENT.unpack(events[-1])[0]
+                sync_cycles = (last + CPU_HZ // 1_000_000) & 0xFFFFFFFF
+                sync_us = 1_000_000 + ((sync_cycles - first) & 0xFFFFFFFF) * 1_000_000 // CPU_HZ
+
+                def trace_info(dumped, state):
+                    return struct.pack("<2I3H2BQI", CPU_HZ, n, n, dumped, 32, state, 1, sync_us, sync_cycles)
+
+                payloads = [(0x0D, trace_info(0, 3))] + [(0x0E, p) for p in trace_names()]
+                for i in range(0, n, TRACE_PER_MSG):
+                    chunk = events[i:i + TRACE_PER_MSG]
+                    payloads.append((0x0C, struct.pack("<HBB40s", i, len(chunk), 0, b"".join(chunk))))
+                payloads.append((0x0D, trace_info(n, 3)))
+                for msg_type, payload in payloads:
+                    while True:
+                        try:
+                            send(msg_type, payload)
+                            break
+                        except BlockingIOError:
+                            time.sleep(0.01)
+            if state:
+                os.write(master, "机械鱼前进\n".encode())
+            if now >= next_cpu:
+                # 统计窗口结束：CPU消息，有请求时再打印top文本
+                next_cpu += 1.0
+                send(0x0B, cpu_payload(PROFILE_HZ[board.profile]))
+                send(0x0F, power_payload(board))
+                if board.top_request:
+                    board.top_request = False
+                    os.write(master, top_text(int((now - t0) * 1000)))
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,487 @@
+#!/usr/bin/env python3
+"""
+传感器原始数据采集：录制、检查与回放（对应固件 Core/Inc/Capture.h）
+
+固件在SBUS/JY901S/GPS的接收事件中断里把DMA环形缓冲区的新字节打上TimeBase时间戳，经遥测CAPTURE消息（0x10）发出；
+本工具把这些数据块整理为采集文件，再按录制时刻回放到仿真或板子，对比解析结果。
+
+采集文件格式（小端）：
+    文件头16字节：magic "FCAP"，version u16 = 1，reserved u16，start_us u64（第一块的固件TimeBase微秒）
+    之后每块12字节头 + 数据：time_us u64（相对start_us），source u8（0=SBUS 1=IMU 2=GPS），reserved u8，len u16
+
+用法：
+    python3 capture.py record /dev/ttyUSB0 -o run.fcap --sources imu gps --duration 60   # 开启采集并录制，结束时关闭
+    python3 capture.py convert tlm.bin -o run.fcap        # 从调试串口原始抓包（或仿真--tlm输出）提取
+    python3 capture.py stats run.fcap                     # 参考解析：各源字节数、帧数、校验错误、时长
+    python3 capture.py split run.fcap -o dir              # 各源导出为原始字节（仿真--sbus/--imu/--gps的输入格式）
+    python3 capture.py replay run.fcap --imu /dev/ttyUSB1 --gps /dev/ttyUSB2 --link /dev/ttyUSB0 --speed 1
+    FISH_H7_sim --replay run.fcap                         # 仿真回放（,scale=0按线路速率尽快送出）
+板上回放（回环）：USB串口适配器的TX接到对应传感器串口的RX（传感器断开），--speed 0为按线路速率尽快送出；
+SBUS为100000波特8E2且电平反相，需经反相器接入。--link给出调试串口时，回放前后读取遥测INPUT/TASK消息，
+报告固件解码的帧数、校验错误与最大输入延迟，并与本工具对采集文件的参考解析对照。
+三路同时采集的数据量接近115200波特的上限，缺口（按流偏移发现）在录制结束时报告，回放时按缺口原样跳过。
+"""
+import argparse
+import fcntl
+import os
+import select
+import struct
+import sys
+import termios
+import threading
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder  # noqa: E402
+from uplink import Uplink, CMD_CAPTURE, CAPTURE_SOURCES, open_port  # noqa: E402
+
+MAGIC = b"FCAP"
+VERSION = 1
+FILE_HEADER = struct.Struct("<4sHHQ")
+CHUNK_HEADER = struct.Struct("<QBBH")
+SOURCES = ["sbus", "imu", "gps"]                # 与Capture_Source_t一致
+# 各传感器串口参数（与usart.c一致，GPS为CASIC配置之后）：波特率、校验、停止位
+LINES = {"sbus": (100000, "E", 2), "imu": (115200, "N", 1), "gps": (115200, "N", 1)}
+CPU_HZ = 550_000_000                           # 收到POWER消息前按性能档换算输入延迟
+READ_CHUNK = 64 * 1024
+
+
+# ---------------------------------------------------------------- 采集文件
+class CaptureWriter:
+    """按到达顺序写数据块，文件头中的start_us取第一块的时刻"""
+
+    def __init__(self, path):
+        self.f = open(path, "wb")
+        self.start_us = None
+        self.chunks = 0
+        self.bytes = [0] * len(SOURCES)
+
+    def add(self, time_us, source, data):
+        if self.start_us is None:
+            self.start_us = time_us
+            self.f.write(FILE_HEADER.pack(MAGIC, VERSION, 0, time_us))
+        self.f.write(CHUNK_HEADER.pack(max(0, time_us - self.start_us), source, 0, len(data)) + data)
+        self.chunks += 1
+        self.bytes[source] += len(data)
+
+    def close(self):
+        if self.start_us is None:
+            self.f.write(FILE_HEADER.pack(MAGIC, VERSION, 0, 0))
+        self.f.close()
+
+
+def read_capture(path):
+    """读取采集文件，返回(start_us, [(time_us, source, data), ...])"""
+    with open(path, "rb") as f:
+        raw = f.read()
+    if len(raw) < FILE_HEADER.size:
+        raise ValueError(f"{path}: too short")
+    magic, version, _, start_us = FILE_HEADER.unpack_from(raw)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError(f"{path}: not a version {VERSION} capture file")
+    chunks = []
+    pos = FILE_HEADER.size
+    while pos + CHUNK_HEADER.size <= len(raw):
+        t, source, _, n = CHUNK_HEADER.unpack_from(raw, pos)
+        pos += CHUNK_HEADER.size
+        if source >= len(SOURCES) or pos + n > len(raw):
+            raise ValueError(f"{path}: bad chunk at offset {pos - CHUNK_HEADER.size}")
+        chunks.append((t, source, raw[pos:pos + n]))
+        pos += n
+    return start_us, chunks
+
+
+class Extractor:
+    """CAPTURE消息 -> 采集文件：展开32位时间戳，按流偏移统计缺口"""
+
+    def __init__(self, writer):
+        self.writer = writer
+        self.next_offset = [None] * len(SOURCES)
+        self.gaps = [0] * len(SOURCES)          # 缺口次数
+        self.gap_bytes = [0] * len(SOURCES)     # 缺失字节数
+        self.restarts = 0                       # 流偏移倒退（固件重启）次数
+
+    def feed(self, msg):
+        if msg.name != "capture":
+            return
+        fl = msg.fields
+        source, data = fl["source"], fl["data"][:fl["len"]]
+        if source >= len(SOURCES) or not data:
+            return
+        # 数据块时刻不晚于消息头时刻，按消息头的高位展开
+        time_us = msg.time_us - ((msg.time_us - fl["time_us"]) & 0xFFFFFFFF)
+        expected = self.next_offset[source]
+        if expected is not None and fl["offset"] != expected:
+            if fl["offset"] > expected:
+                self.gaps[source] += 1
+                self.gap_bytes[source] += fl["offset"] - expected
+            else:
+                self.restarts += 1
+        self.next_offset[source] = fl["offset"] + len(data)
+        self.writer.add(time_us, source, data)
+
+    def summary(self):
+        w = self.writer
+        lines = [f"chunks: {w.chunks}"]
+        for i, name in enumerate(SOURCES):
+            if w.bytes[i] or self.gap_bytes[i]:
+                lines.append(f"  {name:4s} bytes {w.bytes[i]:8d}  gaps {self.gaps[i]:4d} ({self.gap_bytes[i]} bytes lost)")
+        if self.restarts:
+            lines.append(f"  stream restarted {self.restarts} times (firmware reset during recording?)")
+        return "\n".join(lines)
+
+
+# ---------------------------------------------------------------- 参考解析（与固件状态机相同的判定）
+class SbusRef:
+    """SBUS：0x0F起始的25字节帧，帧尾0x00"""
+
+    def __init__(self):
+        self.frames = self.errors = 0
+        self._buf = bytearray()
+
+    def feed(self, data):
+        for b in data:
+            if not self._buf:
+                if b == 0x0F:
+                    self._buf.append(b)
+                continue
+            self._buf.append(b)
+            if len(self._buf) == 25:
+                if self._buf[24] == 0x00:
+                    self.frames += 1
+                else:
+                    self.errors += 1
+                self._buf.clear()
+
+
+class Jy901sRef:
+    """JY901S：0x55 + 类型(0x51~0x54/0x59) + 8字节数据 + 和校验"""
+
+    def __init__(self):
+        self.frames = self.errors = 0
+        self._buf = bytearray()
+
+    def feed(self, data):
+        for b in data:
+            if not self._buf:
+                if b == 0x55:
+                    self._buf.append(b)
+                continue
+            if len(self._buf) == 1 and not (0x51 <= b <= 0x54 or b == 0x59):
+                self._buf.clear()
+                continue
+            self._buf.append(b)
+            if len(self._buf) == 11:
+                if sum(self._buf[:10]) & 0xFF == self._buf[10]:
+                    self.frames += 1
+                else:
+                    self.errors += 1
+                self._buf.clear()
+
+
+class NmeaRef:
+    """NMEA：'$'开始、'\\n'结束，'*'后两位十六进制为'$'与'*'之间的异或"""
+
+    def __init__(self):
+        self.frames = self.errors = 0
+        self._buf = None
+
+    def feed(self, data):
+        for b in data:
+            if b == ord("$"):
+                self._buf = bytearray()
+            elif self._buf is None or b == ord("\r"):
+                continue
+            elif b == ord("\n"):
+                self._check(bytes(self._buf))
+                self._buf = None
+            elif len(self._buf) >= 95:
+                self._buf = None
+            else:
+                self._buf.append(b)
+
+    def _check(self, body):
+        self.frames += 1
+        star = body.find(b"*")
+        ok = False
+        if star >= 5 and len(body) >= star + 3:
+            x = 0
+            for c in body[:star]:
+                x ^= c
+            try:
+                ok = x == int(body[star + 1:star + 3], 16)
+            except ValueError:
+                ok = False
+        self.errors += not ok
+
+
+def reference(chunks):
+    """对采集文件做参考解析，返回{源: (字节数, 块数, 帧数, 错误数)}"""
+    parsers = [SbusRef(), Jy901sRef(), NmeaRef()]
+    counts = [[0, 0] for _ in SOURCES]
+    for _, source, data in chunks:
+        parsers[source].feed(data)
+        counts[source][0] += len(data)
+        counts[source][1] += 1
+    return {SOURCES[i]: (counts[i][0], counts[i][1], parsers[i].frames, parsers[i].errors)
+            for i in range(len(SOURCES)) if counts[i][1]}
+
+
+def print_reference(chunks):
+    span = (chunks[-1][0] - chunks[0][0]) / 1e6 if chunks else 0.0
+    print(f"span {span:.3f} s, {len(chunks)} chunks")
+    unit = {"sbus": "frames", "imu": "frames", "gps": "sentences"}
+    for name, (nbytes, nchunks, frames, errors) in reference(chunks).items():
+        rate = nbytes / span if span > 0 else 0.0
+        print(f"  {name:4s} {nbytes:8d} bytes ({rate:7.0f} B/s) in {nchunks:6d} chunks: "
+              f"{frames} {unit[name]}, {errors} checksum/format errors")
+
+
+# ---------------------------------------------------------------- 串口
+def set_line(fd, baud, parity, stop):
+    """原始模式 + 波特率/校验/停止位；非标准波特率（SBUS的100000）在Linux上用termios2设置"""
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    cflag = attrs[2] & ~(termios.PARENB | termios.PARODD | termios.CSTOPB)
+    if parity in ("E", "O"):
+        cflag |= termios.PARENB | (termios.PARODD if parity == "O" else 0)
+    if stop == 2:
+        cflag |= termios.CSTOPB
+    attrs[2] = cflag
+    speed = getattr(termios, f"B{baud}", None)
+    if speed is not None:
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    # struct termios2：4个标志 + c_line + c_cc[19] + ispeed + ospeed（44字节）
+    tcgets2, tcsets2, bother, cbaud = 0x802C542A, 0x402C542B, 0o010000, 0o010017
+    buf = bytearray(44)
+    fcntl.ioctl(fd, tcgets2, buf)
+    iflag, oflag, cflag, lflag = struct.unpack_from("<4I", buf)
+    struct.pack_into("<4I", buf, 0, iflag, oflag, (cflag & ~cbaud) | bother, lflag)
+    struct.pack_into("<2I", buf, 36, baud, baud)
+    fcntl.ioctl(fd, tcsets2, buf)
+
+
+class LinkMonitor:
+    """回放期间在后台读取调试串口遥测：最新的INPUT消息、TASK消息中的最大输入延迟、CPU主频"""
+
+    def __init__(self, path, baud):
+        self.fd = open_port(path, baud)
+        self.decoder = Decoder()
+        self.input = None
+        self.age_max = [0, 0, 0]        # imu/rc/gps，CPU周期
+        self.cpu_hz = CPU_HZ
+        self.lock = threading.Lock()
+        self._stop = False
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+    def _run(self):
+        while not self._stop:
+            ready, _, _ = select.select([self.fd], [], [], 0.1)
+            if not ready:
+                continue
+            try:
+                data = os.read(self.fd, 4096)
+            except BlockingIOError:
+                continue
+            with self.lock:
+                for msg in self.decoder.feed(data):
+                    if msg.name == "input":
+                        self.input = dict(msg.fields)
+                    elif msg.name == "task":
+                        for i, k in enumerate(("input_age_imu", "input_age_rc", "input_age_gps")):
+                            self.age_max[i] = max(self.age_max[i], msg.fields[k])
+                    elif msg.name == "power":
+                        self.cpu_hz = msg.fields["cpu_hz"]
+
+    def wait_input(self, timeout=3.0):
+        """等待下一条INPUT消息（固件默认1Hz），返回其字段"""
+        with self.lock:
+            self.input = None
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            with self.lock:
+                if self.input is not None:
+                    return dict(self.input)
+            time.sleep(0.05)
+        return None
+
+    def reset_age(self):
+        with self.lock:
+            self.age_max = [0, 0, 0]
+
+    def close(self):
+        self._stop = True
+        self._thread.join()
+        os.close(self.fd)
+
+
+# ---------------------------------------------------------------- 子命令
+def cmd_record(args):
+    mask = sum(1 << CAPTURE_SOURCES[s] for s in args.sources)
+    writer = CaptureWriter(args.output)
+    extractor = Extractor(writer)
+    link = Uplink(open_port(args.port, args.baud), on_message=extractor.feed)
+    result = link.send(CMD_CAPTURE, mask)
+    if result != "ok":
+        print(f"capture: {result or 'no ack'}", file=sys.stderr)
+        writer.close()
+        sys.exit(1)
+    print(f"recording {' '.join(args.sources)} to {args.output}"
+          + (f" for {args.duration:g} s" if args.duration else " (Ctrl-C to stop)"), file=sys.stderr)
+    deadline = time.monotonic() + args.duration if args.duration else None
+    try:
+        while deadline is None or time.monotonic() < deadline:
+            link.poll(0.2 if deadline is None else max(0.0, min(0.2, deadline - time.monotonic())))
+    except KeyboardInterrupt:
+        pass
+    result = link.send(CMD_CAPTURE, 0)
+    link.poll(0.3)                      # 停止前已在发送缓冲区中的数据块
+    writer.close()
+    os.close(link.fd)
+    print(extractor.summary())
+    if result != "ok":
+        print(f"stop: {result or 'no ack'} (capture may still be running)", file=sys.stderr)
+
+
+def cmd_convert(args):
+    writer = CaptureWriter(args.output)
+    extractor = Extractor(writer)
+    decoder = Decoder()
+    src = sys.stdin.buffer if args.raw == "-" else open(args.raw, "rb")
+    with src:
+        while True:
+            data = src.read(READ_CHUNK)
+            if not data:
+                break
+            for msg in decoder.feed(data):
+                extractor.feed(msg)
+    writer.close()
+    print(extractor.summary())
+
+
+def cmd_stats(args):
+    _, chunks = read_capture(args.capture)
+    print_reference(chunks)
+
+
+def cmd_split(args):
+    _, chunks = read_capture(args.capture)
+    os.makedirs(args.out, exist_ok=True)
+    files = {}
+    for _, source, data in chunks:
+        if source not in files:
+            files[source] = open(os.path.join(args.out, f"{SOURCES[source]}.bin"), "wb")
+        files[source].write(data)
+    for source, f in files.items():
+        print(f"{f.name}: {f.tell()} bytes")
+        f.close()
+
+
+def cmd_replay(args):
+    _, chunks = read_capture(args.capture)
+    ports = {}
+    for name in SOURCES:
+        path = getattr(args, name)
+        if path:
+            fd = os.open(path, os.O_WRONLY | os.O_NOCTTY)
+            set_line(fd, *LINES[name])
+            ports[SOURCES.index(name)] = fd
+    if not ports:
+        print("replay: give at least one of --sbus/--imu/--gps", file=sys.stderr)
+        sys.exit(2)
+    chunks = [c for c in chunks if c[1] in ports]
+    if not chunks:
+        print("replay: no data for the selected sources", file=sys.stderr)
+        sys.exit(1)
+
+    monitor = LinkMonitor(args.link, args.baud) if args.link else None
+    before = monitor.wait_input() if monitor else None
+    if monitor:
+        monitor.reset_age()
+
+    # 按录制时刻（除以speed）写出；speed=0时连续写，由串口驱动按线路速率限速
+    t0 = chunks[0][0]
+    start = time.monotonic()
+    slip_max = 0.0
+    sent = 0
+    try:
+        for t, source, data in chunks:
+            if args.speed > 0:
+                due = start + (t - t0) / 1e6 / args.speed
+                delay = due - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+                else:
+                    slip_max = max(slip_max, -delay)
+            os.write(ports[source], data)
+            sent += len(data)
+    except KeyboardInterrupt:
+        pass
+    for fd in ports.values():
+        termios.tcdrain(fd)
+    elapsed = time.monotonic() - start
+    print(f"replayed {sent} bytes in {elapsed:.3f} s ({sent / elapsed if elapsed > 0 else 0:.0f} B/s), "
+          f"schedule slip max {slip_max * 1000:.1f} ms")
+    print("reference (capture file):")
+    print_reference(chunks)
+
+    if monitor:
+        time.sleep(0.2)                 # 等最后一段被解析
+        after = monitor.wait_input()
+        with monitor.lock:
+            age, cpu_hz = list(monitor.age_max), monitor.cpu_hz
+        monitor.close()
+        if before is None or after is None:
+            print("firmware: no INPUT telemetry on the link (rate input 1?)")
+        else:
+            d = {k: (after[k] - before[k]) & 0xFFFFFFFF for k in after}
+            print("firmware (during replay):")
+            print(f"  sbus {d['sbus_frames']} frames, {d['sbus_errors']} format errors")
+            print(f"  imu  {d['imu_frames']} frames, {d['imu_errors']} checksum errors")
+            print(f"  gps  {d['gps_sentences']} sentences, {d['gps_errors']} checksum errors, {d['gps_bytes']} bytes")
+            print(f"  input age max: imu {age[0] * 1e6 / cpu_hz:.0f} us, rc {age[1] * 1e6 / cpu_hz:.0f} us, "
+                  f"gps {age[2] * 1e6 / cpu_hz:.0f} us")
+    for fd in ports.values():
+        os.close(fd)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="record and replay raw sensor UART captures")
+    sub = parser.add_subparsers(dest="op", required=True)
+    p = sub.add_parser("record", help="enable capture on the board and record it")
+    p.add_argument("port", help="debug UART (telemetry/uplink) device or pty")
+    p.add_argument("-o", "--output", required=True)
+    p.add_argument("--sources", nargs="+", choices=SOURCES, default=["imu", "gps"])
+    p.add_argument("--duration", type=float, default=0.0, help="seconds, 0 = until Ctrl-C")
+    p.add_argument("--baud", type=int, default=115200)
+    p = sub.add_parser("convert", help="extract a capture file from a raw debug UART dump")
+    p.add_argument("raw", help="raw serial dump or FISH_H7_sim --tlm output ('-' for stdin)")
+    p.add_argument("-o", "--output", required=True)
+    p = sub.add_parser("stats", help="reference-decode a capture file")
+    p.add_argument("capture")
+    p = sub.add_parser("split", help="write each source as a raw byte file")
+    p.add_argument("capture")
+    p.add_argument("-o", "--out", default=".")
+    p = sub.add_parser("replay", help="replay a capture into sensor UARTs through serial adapters")
+    p.add_argument("capture")
+    for name in SOURCES:
+        p.add_argument(f"--{name}", help=f"serial adapter wired to the {name} UART RX")
+    p.add_argument("--speed", type=float, default=1.0, help="time scale, 0 = as fast as the line allows")
+    p.add_argument("--link", help="debug UART to read firmware INPUT/TASK telemetry from")
+    p.add_argument("--baud", type=int, default=115200, help="debug UART baud rate")
+    args = parser.parse_args()
+    try:
+        {"record": cmd_record, "convert": cmd_convert, "stats": cmd_stats,
+         "split": cmd_split, "replay": cmd_replay}[args.op](args)
+    except ValueError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
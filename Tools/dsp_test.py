@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+CMSIS-DSP测试套件结果汇总（对应 cmake/cmsis_dsp 的cmsis_dsp库与 Sim/CMakeLists.txt 的FISH_H7_dsp_test）
+
+FISH_H7_dsp_test用主机编译器构建DSP_Lib_TestSuite（FILEIO），被测函数来自cmsis_dsp（与固件相同的-O3/循环展开/矩阵尺寸检查），
+逐个与参考实现RefLibs比较，JTest结果逐行输出：
+    Group Name: / Test Name: / Function Under Test: / Cycles: N / Test Passed|Test Failed
+本工具运行测试程序（或读取已保存的输出，例如在板上或FVP上运行同一套件的日志），按测试汇总通过/失败，
+有Cycles行时（SysTick计数的目标构建）给出各函数周期的最小/中位/最大值。
+主机上已知与目标不同的失败（参考实现依赖ARM的浮点转定点饱和）列在HOST_KNOWN中，不计为失败。
+
+用法：
+    cmake --build build/Sim --target FISH_H7_dsp_test             # 测试组由-DFISH_DSP_TESTS选择，默认为固件用到的组
+    python3 dsp_test.py                                           # 运行并汇总，有意外失败时退出码1
+    python3 dsp_test.py --log target.log --json result.json       # 汇总已保存的输出（主机输出另加--host）
+    python3 dsp_test.py --verbose                                 # 列出每个测试
+耗时比较使用微基准测试（Tools/bench.py，FISH_H7_bench/FISH_H7_bench_host链接同一个cmsis_dsp库）。
+"""
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DSP_TEST = os.path.join(ROOT, "build", "Sim", "Sim", "FISH_H7_dsp_test")
+
+# 主机上的已知失败：测试名 -> 原因
+HOST_KNOWN = {
+    "arm_sin_cos_q31_test": "reference converts cos(0)=+1.0 to q31 with a float->int cast, "
+                            "which saturates on ARM but wraps to -1.0 on x86",
+}
+
+
+def parse(lines):
+    """逐行解析JTest输出，返回 (测试列表, 是否输出了最终汇总)"""
+    tests = []
+    groups = []
+    depth = 0                   # 未结束的组（每组开始输出Group Name，结束输出Tests Run汇总）
+    current = None
+    expect = None
+    finished = False
+    for raw in lines:
+        line = raw.strip()
+        if expect is not None:
+            if expect == "group":
+                groups.append(line)
+                depth += 1
+            elif expect == "test":
+                current = {"name": line, "group": groups[-1] if groups else "", "function": "",
+                           "passed": None, "cycles": []}
+                tests.append(current)
+            elif expect == "function" and current is not None:
+                current["function"] = line
+            expect = None
+            continue
+        if line == "Group Name:":
+            expect = "group"
+        elif line == "Test Name:":
+            expect = "test"
+        elif line == "Function Under Test:":
+            expect = "function"
+        elif line.startswith("Cycles:") and current is not None:
+            try:
+                current["cycles"].append(int(line.split(":", 1)[1]))
+            except ValueError:
+                pass
+        elif line == "Test Passed" and current is not None:
+            current["passed"] = True
+        elif line == "Test Failed" and current is not None:
+            current["passed"] = False
+        elif line.startswith("Error:") and current is not None:
+            current["error"] = line
+        elif line.startswith("Tests Run:") and depth > 0:
+            depth -= 1
+            finished = depth == 0   # 最外层all_tests的汇总
+    return tests, finished
+
+
+def main():
+    parser = argparse.ArgumentParser(description="run the CMSIS-DSP test suite against the cmsis_dsp library and summarise it")
+    parser.add_argument("--bin", default=DSP_TEST, help="FISH_H7_dsp_test executable")
+    parser.add_argument("--log", help="summarise a saved test log instead of running the executable")
+    parser.add_argument("--host", action="store_true", help="the saved log comes from the host runner (apply HOST_KNOWN)")
+    parser.add_argument("--json", help="write per-test results as JSON")
+    parser.add_argument("--verbose", action="store_true", help="list every test")
+    parser.add_argument("--timeout", type=float, default=600.0, help="seconds before the run is abandoned")
+    args = parser.parse_args()
+
+    known = HOST_KNOWN if args.host else {}
+    returncode = 0
+    if args.log:
+        with open(args.log, "r", errors="replace") as f:
+            lines = f.read().splitlines()
+    else:
+        if not os.path.exists(args.bin):
+            raise SystemExit(f"{args.bin} not found (cmake --build <dir> --target FISH_H7_dsp_test)")
+        try:
+            proc = subprocess.run([args.bin], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                  timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            raise SystemExit(f"{args.bin} did not finish within {args.timeout:g}s")
+        lines = proc.stdout.decode("ascii", errors="replace").splitlines()
+        returncode = proc.returncode
+        known = HOST_KNOWN
+
+    tests, finished = parse(lines)
+    if not tests:
+        raise SystemExit("no test results found")
+    unexpected = []
+    for t in tests:
+        status = "pass" if t["passed"] else "FAIL"
+        if t["passed"] is None:
+            status = "INCOMPLETE"
+        elif not t["passed"] and t["name"] in known:
+            status = "known"
+            t["known"] = known[t["name"]]
+        t["status"] = status
+        if status in ("FAIL", "INCOMPLETE"):
+            unexpected.append(t)
+
+    with_cycles = [t for t in tests if t["cycles"]]
+    if args.verbose or with_cycles:
+        header = f"{'Group':<24} {'Test':<44} {'status':<10}"
+        if with_cycles:
+            header += f" {'min':>9} {'median':>9} {'max':>9}  (cycles)"
+        print(header)
+        for t in tests:
+            if not args.verbose and not t["cycles"] and t["status"] == "pass":
+                continue
+            row = f"{t['group']:<24} {t['name']:<44} {t['status']:<10}"
+            if t["cycles"]:
+                c = t["cycles"]
+                row += f" {min(c):>9} {statistics.median(c):>9.0f} {max(c):>9}"
+            print(row)
+    for t in tests:
+        if t["status"] == "known":
+            print(f"known host difference: {t['name']}: {t['known']}")
+        elif t["status"] != "pass":
+            print(f"{t['status']}: {t['group']}/{t['name']} ({t['function']}) {t.get('error', '')}".rstrip())
+
+    passed = sum(1 for t in tests if t["status"] == "pass")
+    known_n = sum(1 for t in tests if t["status"] == "known")
+    groups = sorted({t["group"] for t in tests})
+    print(f"{passed}/{len(tests)} tests passed in {len(groups)} groups"
+          + (f", {known_n} known host difference(s)" if known_n else "")
+          + (f", {len(unexpected)} unexpected failure(s)" if unexpected else ""))
+    if not finished:
+        print("test run did not complete" + (f" (exit status {returncode})" if returncode else ""))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"complete": finished, "tests": tests}, f, indent=2)
+            f.write("\n")
+    return 1 if unexpected or not finished or returncode != 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+固件体积对比（对应顶层 CMakeLists.txt 的功能选项，默认对比FISH_PRINTF_FLOAT关/开）
+
+用arm-none-eabi工具链（cmake/gcc-arm-none-eabi.cmake）把固件按两组选项各构建一次，
+用arm-none-eabi-size统计text/data/bss（Flash = text + data，RAM = data + bss），
+再用arm-none-eabi-nm对照两边的符号，列出体积变化最大的符号（例如打开浮点printf后多出的_dtoa_r、大数运算与_sbrk）：
+    python3 fwsize.py                                                    # FISH_PRINTF_FLOAT=OFF 对 ON
+    python3 fwsize.py --base FISH_TCM=ON --variant FISH_TCM=OFF           # 其他选项
+    python3 fwsize.py --target FISH_H7_bench                             # 微基准测试镜像（ON时多出vsnprintf_f32用例）
+    python3 fwsize.py --elf a.elf b.elf                                  # 只比较已有的两个ELF
+构建目录为build/fwsize-base与build/fwsize-variant。
+周期对比：FISH_PRINTF_FLOAT=ON的固件启动时由FMT_Bench打印FMT与newlib的周期，
+微基准测试镜像另有vsnprintf_f32与fmt_snprintf_f32用例（Tools/bench.py读取）。
+"""
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TOOLCHAIN = os.path.join(ROOT, "cmake", "gcc-arm-none-eabi.cmake")
+PREFIX = "arm-none-eabi-"
+
+
+def build(name, defines, target, build_type):
+    """配置并构建一组选项，返回ELF路径"""
+    build_dir = os.path.join(ROOT, "build", f"fwsize-{name}")
+    cmd = ["cmake", "-S", ROOT, "-B", build_dir, f"-DCMAKE_TOOLCHAIN_FILE={TOOLCHAIN}",
+           f"-DCMAKE_BUILD_TYPE={build_type}", "-DFISH_SIM=OFF"]
+    cmd += [f"-D{d}" for d in defines]
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+    subprocess.run(["cmake", "--build", build_dir, "--target", target, "-j", str(os.cpu_count() or 1)],
+                   check=True, stdout=subprocess.DEVNULL)
+    return os.path.join(build_dir, f"{target}.elf")
+
+
+def sections(elf):
+    """arm-none-eabi-size（Berkeley格式），返回 {text, data, bss}"""
+    out = subprocess.run([PREFIX + "size", elf], check=True, capture_output=True, text=True).stdout
+    text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+    return {"text": text, "data": data, "bss": bss}
+
+
+def symbols(elf):
+    """arm-none-eabi-nm，返回 {符号: 字节数}（同名静态符号累加）"""
+    out = subprocess.run([PREFIX + "nm", "--size-sort", "-S", elf], check=True, capture_output=True,
+                         text=True).stdout
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4:
+            sizes[parts[3]] = sizes.get(parts[3], 0) + int(parts[1], 16)
+    return sizes
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare firmware flash/RAM size between two sets of CMake options")
+    parser.add_argument("--base", nargs="*", default=["FISH_PRINTF_FLOAT=OFF"], help="NAME=VALUE options of the baseline build")
+    parser.add_argument("--variant", nargs="*", default=["FISH_PRINTF_FLOAT=ON"], help="NAME=VALUE options of the compared build")
+    parser.add_argument("--target", default="FISH_H7", help="CMake target to build (FISH_H7 or FISH_H7_bench)")
+    parser.add_argument("--build-type", default="Release", help="CMAKE_BUILD_TYPE of both builds")
+    parser.add_argument("--elf", nargs=2, metavar=("BASE", "VARIANT"), help="compare two existing ELF files instead of building")
+    parser.add_argument("--top", type=int, default=15, help="number of symbols to list")
+    args = parser.parse_args()
+
+    if shutil.which(PREFIX + "size") is None:
+        raise SystemExit(f"{PREFIX}size not found (install the GNU Arm Embedded toolchain)")
+    if args.elf:
+        base_elf, variant_elf = args.elf
+    else:
+        base_elf = build("base", args.base, args.target, args.build_type)
+        variant_elf = build("variant", args.variant, args.target, args.build_type)
+
+    base, variant = sections(base_elf), sections(variant_elf)
+    base["flash"], variant["flash"] = base["text"] + base["data"], variant["text"] + variant["data"]
+    base["ram"], variant["ram"] = base["data"] + base["bss"], variant["data"] + variant["bss"]
+    print(f"base:    {base_elf} ({' '.join(args.base) if not args.elf else 'given'})")
+    print(f"variant: {variant_elf} ({' '.join(args.variant) if not args.elf else 'given'})")
+    print(f"{'':<8} {'base':>10} {'variant':>10} {'delta':>10}")
+    for key in ("text", "data", "bss", "flash", "ram"):
+        print(f"{key:<8} {base[key]:>10} {variant[key]:>10} {variant[key] - base[key]:>+10}")
+
+    base_syms, variant_syms = symbols(base_elf), symbols(variant_elf)
+    deltas = [(variant_syms.get(s, 0) - base_syms.get(s, 0), s) for s in set(base_syms) | set(variant_syms)]
+    deltas = sorted((d for d in deltas if d[0] != 0), key=lambda d: -abs(d[0]))[:args.top]
+    if deltas:
+        print("\nlargest symbol changes (bytes):")
+        for delta, name in deltas:
+            print(f"  {delta:>+8}  {name}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
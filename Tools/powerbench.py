@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+功耗对比测量工具（对应固件 Core/Inc/Power.h）
+
+依次把板子切到 性能/节能 时钟档 × 空闲睡眠 开/关 四种组合（上行命令POWER，0x8C），
+每种组合等待稳定后收集若干秒的遥测POWER（0x0F）与CPU（0x0B）消息，同时读取电源电流，
+输出电流与CPU余量对照表：
+    python3 powerbench.py /dev/ttyUSB0                                   # 每种组合提示手动输入电流表读数
+    python3 powerbench.py /dev/ttyUSB0 --current-cmd "./read_psu.sh"     # 由外部命令输出电流（mA，取最后一个数）
+    python3 powerbench.py /dev/ttyUSB0 --profiles economy --window 10
+CPU余量取空闲任务占用（无节拍空闲下含睡眠时间），睡眠占比与每秒唤醒次数来自POWER消息。
+测量结束后恢复性能档、睡眠开启。
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from uplink import Uplink, CMD_POWER, POWER_PROFILES, open_port  # noqa: E402
+
+
+def read_current(cmd):
+    """读取电源电流（mA）：有外部命令时取其输出的最后一个数，否则提示手动输入；无读数返回None"""
+    if cmd:
+        out = subprocess.run(cmd, shell=True, capture_output=True, text=True, timeout=10).stdout
+        nums = re.findall(r"[-+]?\d+(?:\.\d+)?", out)
+        return float(nums[-1]) if nums else None
+    text = input("  supply current (mA, empty to skip): ").strip()
+    try:
+        return float(text)
+    except ValueError:
+        return None
+
+
+def measure(link, window):
+    """收集window秒内的POWER与CPU消息，返回各字段的平均值"""
+    power, cpu = [], []
+    deadline = time.monotonic() + window
+    while time.monotonic() < deadline:
+        for msg in link.poll(deadline - time.monotonic()):
+            if msg.name == "power":
+                power.append(msg.fields)
+            elif msg.name == "cpu":
+                cpu.append(msg.fields)
+
+    def avg(items, key):
+        return sum(m[key] for m in items) / len(items) if items else None
+
+    return {
+        "cpu_hz": power[-1]["cpu_hz"] if power else None,
+        "profile": power[-1]["profile"] if power else None,
+        "sleep_enable": power[-1]["sleep_enable"] if power else None,
+        "sleep": avg(power, "sleep"),
+        "wakeups": avg(power, "sleeps"),
+        "idle": avg(cpu, "load_idle"),
+        "samples": min(len(power), len(cpu)),
+    }
+
+
+def fmt(value, spec):
+    return format(value, spec) if value is not None else "-"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare supply current against CPU headroom for each power profile")
+    parser.add_argument("port", help="serial device or pty path")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--profiles", nargs="+", choices=POWER_PROFILES, default=list(POWER_PROFILES))
+    parser.add_argument("--settle", type=float, default=3.0, help="seconds to wait after each switch")
+    parser.add_argument("--window", type=float, default=5.0, help="seconds of telemetry to average")
+    parser.add_argument("--current-cmd", help="shell command printing the supply current in mA")
+    args = parser.parse_args()
+
+    link = Uplink(open_port(args.port, args.baud))
+    rows = []
+    for profile in args.profiles:
+        for sleep in (1, 0):
+            label = f"{profile}/{'sleep' if sleep else 'spin'}"
+            result = link.send(CMD_POWER, POWER_PROFILES[profile], sleep)
+            print(f"{label}: {result or 'no ack'}")
+            if result != "ok":
+                continue
+            deadline = time.monotonic() + args.settle
+            while time.monotonic() < deadline:
+                link.poll(deadline - time.monotonic())
+            m = measure(link, args.window)
+            if m["profile"] != POWER_PROFILES[profile] or m["sleep_enable"] != sleep:
+                print(f"  warning: board reports profile {m['profile']} sleep {m['sleep_enable']}")
+            m["ma"] = read_current(args.current_cmd)
+            rows.append((profile, sleep, m))
+    link.send(CMD_POWER, POWER_PROFILES["performance"], 1)
+    os.close(link.fd)
+
+    if not rows:
+        sys.exit("no measurements")
+    print(f"\n{'PROFILE':<12} {'SLEEP':<5} {'MHz':>5} {'BUSY%':>6} {'IDLE%':>6} {'SLEEP%':>6} "
+          f"{'WAKE/s':>7} {'mA':>7}")
+    for profile, sleep, m in rows:
+        mhz = m["cpu_hz"] / 1e6 if m["cpu_hz"] else None
+        busy = 100.0 - m["idle"] if m["idle"] is not None else None
+        print(f"{profile:<12} {'on' if sleep else 'off':<5} {fmt(mhz, '5.0f')} {fmt(busy, '6.2f')} "
+              f"{fmt(m['idle'], '6.2f')} {fmt(m['sleep'], '6.2f')} {fmt(m['wakeups'], '7.0f')} "
+              f"{fmt(m['ma'], '7.1f')}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,511 @@
+#!/usr/bin/env python3
+"""
+最坏负载/可调度性压力场景（对应固件 Task_Link/Start_Task.h 中各任务的周期与截止时间）
+
+每个场景为各输入生成合成数据流（SBUS帧、JY901S姿态帧组、NMEA语句组），按场景的帧率送入，
+可选把遥测全部调到控制频率；运行结束后按预算判定通过/不通过：
+    控制周期错过截止时间次数、CPU余量（各1s窗口空闲任务占用的最小值）、控制耗时与起点抖动、输入延迟、
+    队列深度（调试串口发送缓冲区水位、JY901S/GPS接收缓冲区积压）、丢帧（解析帧数与送入帧数之差、校验错误、
+    调试串口/遥测丢弃、GPS接收溢出）
+
+用法：
+    python3 stress.py list                                        # 场景与预算
+    python3 stress.py sim                                         # 全部场景在主机仿真上运行（每个10s虚拟时间）
+    python3 stress.py sim worst_case --duration 30 --json out.json
+    python3 stress.py target worst_case --link /dev/ttyUSB0 --sbus /dev/ttyUSB1 --imu /dev/ttyUSB2 --gps /dev/ttyUSB3
+    python3 stress.py sim worst_case --budget headroom_pct=40 --budget control_us=1500
+仿真：数据流写成文件后以FISH_H7_sim --sbus/--imu/--gps 文件,period=,burst=,loop送入（每段按波特率逐字节到达，
+    DMA半满/满与空闲事件的时刻同硬件），遥测频率命令经--link送入；CTest以--cpu-scale 0运行全部场景（Sim/CMakeLists.txt）；
+    CPU余量按DWT计算，含主机执行时间×--cpu-scale（默认1，即按主机速度估算；0时任务不占虚拟时间，余量恒为100%），
+    截止时间、队列深度、丢帧与主机速度无关。
+板上：USB串口适配器TX接各传感器串口RX（传感器断开，同capture.py replay），SBUS需经反相器；本工具按场景帧率写出，
+    经--link读取遥测TASK/CPU/INPUT/POWER消息；最大值类指标（控制耗时、抖动、输入延迟、水位、积压）自上电起累计，
+    每个场景前复位板子可得到该场景自身的最大值。场景结束后遥测频率恢复固件默认值。
+"""
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder, MESSAGES  # noqa: E402
+from uplink import Uplink, CMD_TLM_RATE, TLM_TYPES, encode_command, open_port  # noqa: E402
+from capture import LINES, set_line  # noqa: E402
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SIM = os.path.join(ROOT, "build", "Sim", "Sim", "FISH_H7_sim")
+CPU_HZ = 550_000_000                # 收到POWER消息前按性能档换算
+UART_TX_RING_SIZE = 4096            # 与UART_TX.h一致
+IMU_RX_SIZE = 256                   # JY901S.h的RX_SIZE
+GPS_RX_SIZE = 512                   # GPS_T.h的GPS_DMA_RX_SIZE
+TLM_RATE_MAX = 100                  # 遥测频率上限（控制频率）
+# 固件默认遥测频率（与Telemetry.c的tlm_default_rate一致），板上场景结束后恢复
+TLM_DEFAULT_RATES = {"imu": 50, "rc": 10, "gait": 20, "servo": 50, "gps": 5, "task": 1, "nav": 10,
+                     "bb_status": 1, "cpu": 1, "power": 1, "input": 1}
+# 各串口单字节线上时间，us（SBUS 100000波特8E2，其余115200波特8N1）
+BYTE_US = {"sbus": 120.0, "imu": 86.806, "gps": 86.806, "link": 86.806}
+
+# ---------------------------------------------------------------- 场景
+IMU_ALL = ["accel", "gyro", "angle", "magnet", "quater"]
+GPS_ALL = ["GGA", "GSA", "GSV", "GSV", "GSV", "RMC", "VTG"]
+# sbus：帧间隔ms；imu：(Hz, 帧类型)；gps：(Hz, 语句)；tlm="max"：可设置频率的遥测全部100Hz
+SCENARIOS = {
+    "idle": {"desc": "no sensor input, default telemetry (baseline)"},
+    "nominal": {"desc": "SBUS 14 ms, IMU 100 Hz accel/gyro/angle, GPS 1 Hz GGA+RMC",
+                "sbus": 14, "imu": (100, ["accel", "gyro", "angle"]), "gps": (1, ["GGA", "RMC"])},
+    "sbus_fast": {"desc": "SBUS high-speed mode (7 ms) only", "sbus": 7},
+    "imu_200hz": {"desc": "IMU 200 Hz with all five frame types (95% of 115200 baud)", "imu": (200, IMU_ALL)},
+    "gps_10hz": {"desc": "GPS 10 Hz with the full NMEA sentence set", "gps": (10, GPS_ALL)},
+    "tlm_max": {"desc": "every telemetry message at the control rate (link saturates, shedding allowed)",
+                "tlm": "max", "budget": {"uart_dropped": None, "tlm_dropped": None, "uart_level_pct": None}},
+    "worst_case": {"desc": "SBUS 7 ms + IMU 200 Hz all frames + GPS 10 Hz full set + default telemetry",
+                   "sbus": 7, "imu": (200, IMU_ALL), "gps": (10, GPS_ALL)},
+    "worst_case_tlm_max": {"desc": "worst_case with every telemetry message at the control rate",
+                           "sbus": 7, "imu": (200, IMU_ALL), "gps": (10, GPS_ALL), "tlm": "max",
+                           "budget": {"uart_dropped": None, "tlm_dropped": None, "uart_level_pct": None}},
+    "overload": {"desc": "all sensor UARTs back-to-back at line rate (beyond spec): control must keep its deadlines",
+                 "sbus": 3, "imu": (209, IMU_ALL), "gps": (24, GPS_ALL),
+                 "budget": {"sbus_lost_pct": None, "imu_lost_pct": None, "gps_lost_pct": None,
+                            "gps_overruns": None, "imu_backlog_pct": None, "gps_backlog_pct": None,
+                            "headroom_pct": 5.0, "input_age_us": None}},
+}
+# 预算：上限（headroom_pct为下限），None=不检查
+BUDGETS = {
+    "deadline_misses": 0,           # 控制周期错过截止时间（结束时已过下一个周期起点）
+    "headroom_pct": 25.0,           # CPU余量下限（空闲任务占用，各窗口最小值），%
+    "control_us": 2000.0,           # 控制周期最大耗时，us
+    "jitter_us": 2000.0,            # 控制周期起点抖动最大值，us
+    "input_age_us": 15000.0,        # 各输入从接收中断到被控制周期读到的最大延迟，us
+    "sbus_lost_pct": 1.0,           # 送入而未解析出的帧，%
+    "imu_lost_pct": 1.0,
+    "gps_lost_pct": 1.0,
+    "input_errors": 0,              # SBUS帧格式/JY901S校验/NMEA校验错误
+    "gps_overruns": 0,              # GPS接收缓冲区被DMA覆盖次数
+    "uart_dropped": 0,              # 调试串口发送缓冲区满丢弃的字节
+    "tlm_dropped": 0,               # 遥测丢弃帧数
+    "uart_level_pct": 90.0,         # 调试串口发送缓冲区最高水位，%
+    "imu_backlog_pct": 75.0,        # JY901S接收缓冲区最大积压，%
+    "gps_backlog_pct": 75.0,        # GPS接收缓冲区最大积压，%
+}
+
+
+def budgets_of(name, overrides):
+    b = dict(BUDGETS)
+    b.update(SCENARIOS[name].get("budget", {}))
+    b.update(overrides)
+    return b
+
+
+# ---------------------------------------------------------------- 数据流生成
+def sbus_frame(i):
+    """25字节SBUS帧：摇杆通道缓慢变化，模式通道（CH5）在中位（手动），标志位为0"""
+    ch = [992] * 16
+    for k in range(4):
+        ch[k] = 992 + int(600 * math.sin(i / 40.0 + k))
+    bits = 0
+    for k, v in enumerate(ch):
+        bits |= (v & 0x7FF) << (11 * k)
+    return bytes([0x0F]) + bits.to_bytes(22, "little") + bytes([0x00, 0x00])
+
+
+IMU_TYPES = {"accel": 0x51, "gyro": 0x52, "angle": 0x53, "magnet": 0x54, "quater": 0x59}
+
+
+def imu_group(i, types):
+    """一组JY901S输出：每帧 0x55 + 类型 + 4个int16 + 和校验"""
+    out = bytearray()
+    for t in types:
+        v = [int(3000 * math.sin(i / 25.0 + k + IMU_TYPES[t])) for k in range(4)]
+        body = bytes([0x55, IMU_TYPES[t]]) + b"".join(x.to_bytes(2, "little", signed=True) for x in v)
+        out += body + bytes([sum(body) & 0xFF])
+    return bytes(out)
+
+
+def nmea(body):
+    x = 0
+    for c in body.encode():
+        x ^= c
+    return f"${body}*{x:02X}\r\n".encode()
+
+
+def gps_group(i, sentences):
+    """一组NMEA语句（各字段定宽，每组长度相同，便于仿真按固定burst循环送入）"""
+    t = i % 86400
+    hms = f"{t // 3600:02d}{t // 60 % 60:02d}{t % 60:02d}.{i % 10}0"
+    lat = f"{3000 + (i % 600) / 100.0:09.4f}"
+    lon = f"{12000 + (i % 600) / 100.0:010.4f}"
+    out = bytearray()
+    gsv = 0
+    for s in sentences:
+        if s == "GGA":
+            out += nmea(f"GNGGA,{hms},{lat},N,{lon},E,1,12,0.80,0012.3,M,-005.0,M,,")
+        elif s == "RMC":
+            out += nmea(f"GNRMC,{hms},A,{lat},N,{lon},E,001.20,087.50,190126,,,A")
+        elif s == "GSA":
+            out += nmea("GNGSA,A,3,01,03,06,09,12,17,19,22,25,28,31,32,1.40,0.80,1.10")
+        elif s == "GSV":
+            gsv += 1
+            sats = ",".join(f"{(gsv - 1) * 4 + k + 1:02d},{30 + k:02d},{90 * k:03d},{40 + k:02d}" for k in range(4))
+            out += nmea(f"GPGSV,3,{gsv},12,{sats}")
+        elif s == "VTG":
+            out += nmea("GNVTG,087.50,T,,M,001.20,N,002.22,K,A")
+    return bytes(out)
+
+
+def streams(scenario):
+    """场景的各输入：{名称: (帧周期ms, 生成函数(i)->bytes, 每段的帧/语句数)}"""
+    s = SCENARIOS[scenario]
+    out = {}
+    if "sbus" in s:
+        out["sbus"] = (float(s["sbus"]), sbus_frame, 1)
+    if "imu" in s:
+        rate, types = s["imu"]
+        out["imu"] = (1000.0 / rate, lambda i, t=types: imu_group(i, t), len(types))
+    if "gps" in s:
+        rate, sentences = s["gps"]
+        out["gps"] = (1000.0 / rate, lambda i, n=sentences: gps_group(i, n), len(sentences))
+    return out
+
+
+def line_load(scenario):
+    """各输入占用线路的比例（>1即超过波特率，送入端只能按线路速率）"""
+    return {name: len(gen(0)) * BYTE_US[name] / (period * 1000.0)
+            for name, (period, gen, _) in streams(scenario).items()}
+
+
+def rate_commands(scenario):
+    """场景需要的遥测频率：[(类型号, Hz)]"""
+    if SCENARIOS[scenario].get("tlm") == "max":
+        return [(t, TLM_RATE_MAX) for t in TLM_TYPES.values()]
+    return []
+
+
+# ---------------------------------------------------------------- 指标与判定
+def evaluate(metrics, budgets):
+    """返回[(指标, 值, 预算, 是否通过)]，预算为None的只报告"""
+    rows = []
+    for key, value in metrics.items():
+        budget = budgets.get(key)
+        if budget is None or value is None:
+            ok = None
+        elif key == "headroom_pct":
+            ok = value >= budget
+        else:
+            ok = value <= budget
+        rows.append((key, value, budget, ok))
+    return rows
+
+
+def lost_pct(sent, got):
+    return max(0.0, 100.0 * (sent - got) / sent) if sent else 0.0
+
+
+def common_metrics(task, inp, cpu_idle, cpu_hz, sent, got, errors):
+    """由TASK/INPUT字段（已按基线作差的计数）整理指标"""
+    to_us = 1e6 / cpu_hz
+    return {
+        "deadline_misses": task["control_misses"],
+        "headroom_pct": min(cpu_idle) if cpu_idle else None,
+        "control_us": round(task["control_cycles_max"] * to_us, 1),
+        "jitter_us": task["control_jitter_max"],
+        "input_age_us": round(max(task["input_age_imu"], task["input_age_rc"], task["input_age_gps"]) * to_us, 1),
+        "sbus_lost_pct": round(lost_pct(sent.get("sbus", 0), got["sbus"]), 2),
+        "imu_lost_pct": round(lost_pct(sent.get("imu", 0), got["imu"]), 2),
+        "gps_lost_pct": round(lost_pct(sent.get("gps", 0), got["gps"]), 2),
+        "input_errors": errors,
+        "gps_overruns": task["gps_overruns"],
+        "uart_dropped": task["uart_dropped"],
+        "tlm_dropped": task["tlm_dropped"],
+        "uart_level_pct": round(100.0 * task["uart_level_max"] / UART_TX_RING_SIZE, 1),
+        "imu_backlog_pct": round(100.0 * inp["imu_backlog_max"] / IMU_RX_SIZE, 1),
+        "gps_backlog_pct": round(100.0 * inp["gps_backlog_max"] / GPS_RX_SIZE, 1),
+    }
+
+
+def cpu_windows(messages):
+    """CPU消息中各窗口的空闲占用（%）：跳过尚无完整窗口的消息（占用全为0）与第一个窗口（含启动过程）"""
+    idle = [m.fields["load_idle"] for m in messages
+            if m.name == "cpu" and any(v for k, v in m.fields.items() if k.startswith("load_"))]
+    return idle[1:] if len(idle) > 1 else idle
+
+
+# ---------------------------------------------------------------- 主机仿真
+def run_sim(scenario, args, workdir, sim_args=()):
+    """生成输入文件并运行FISH_H7_sim（sim_args为附加的命令行参数），返回指标"""
+    cmd = [args.sim, "--duration", str(args.duration), "--cpu-scale", str(args.cpu_scale)]
+    frames_per_burst = {}
+    burst_bytes = {}
+    for name, (period, gen, per_burst) in streams(scenario).items():
+        n = max(1, int(args.duration * 1000.0 / period) + 2)
+        data = b"".join(gen(i) for i in range(min(n, 1000)))
+        burst = len(gen(0))
+        path = os.path.join(workdir, f"{scenario}_{name}.bin")
+        with open(path, "wb") as f:
+            f.write(data)
+        cmd += [f"--{name}", f"{path},period={period:g},burst={burst},loop"]
+        frames_per_burst[name] = per_burst
+        burst_bytes[name] = burst
+    rates = rate_commands(scenario)
+    if rates:
+        # 每条命令单独一段（不足部分用0x00填充，空帧被忽略），第一段在调度器启动后立即送入
+        block = 32
+        data = b"".join(encode_command(CMD_TLM_RATE, i, t, hz).ljust(block, b"\x00") for i, (t, hz) in enumerate(rates))
+        path = os.path.join(workdir, f"{scenario}_link.bin")
+        with open(path, "wb") as f:
+            f.write(data)
+        cmd += ["--link", f"{path},period=5,burst={block}"]
+    tlm = os.path.join(workdir, f"{scenario}_tlm.bin")
+    report = os.path.join(workdir, f"{scenario}_report.json")
+    cmd += list(sim_args) + ["--tlm", tlm, "--report", report]
+    proc = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if proc.returncode != 0:
+        raise SystemExit(f"{scenario}: FISH_H7_sim exited with {proc.returncode}: {proc.stderr.strip()}")
+    with open(report) as f:
+        r = json.load(f)
+    decoder = Decoder()
+    with open(tlm, "rb") as f:
+        messages = decoder.feed(f.read())
+
+    uart = r["uart"]
+    sent, got = {}, {}
+    rx = {"sbus": "usart1_sbus", "imu": "usart2_imu", "gps": "usart6_gps"}
+    for name, key in rx.items():
+        if name in burst_bytes:
+            sent[name] = uart[key]["rx_bytes"] // burst_bytes[name] * frames_per_burst[name]
+    got["sbus"] = r["sbus"]["frames"]
+    got["imu"] = r["imu"]["frames"]
+    got["gps"] = r["gps"]["sentences"]
+    errors = r["sbus"]["format_errors"] + r["imu"]["checksum_errors"] + r["gps"]["checksum_errors"]
+    c = r["control"]
+    task = {
+        "control_misses": c["deadline_misses"],
+        "control_cycles_max": c["cycles_max"],
+        "control_jitter_max": c["jitter_us_max"],
+        "input_age_imu": c["input_age_max"][0], "input_age_rc": c["input_age_max"][1],
+        "input_age_gps": c["input_age_max"][2],
+        "gps_overruns": r["gps"]["ring_overruns"],
+        "uart_dropped": r["uart_tx"]["dropped"],
+        "tlm_dropped": r["telemetry"]["dropped"],
+        "uart_level_max": r["uart_tx"]["level_max"],
+    }
+    inp = {"imu_backlog_max": r["imu"]["backlog_max"], "gps_backlog_max": r["gps"]["backlog_max"]}
+    metrics = common_metrics(task, inp, cpu_windows(messages), r["power"]["cpu_hz"], sent, got, errors)
+    extra = {"virtual_s": r["timing"]["virtual_s"], "wall_s": r["timing"]["wall_s"],
+             "sent": sent, "decoded": got,
+             "rx_dropped": {name: uart[key]["rx_dropped"] for name, key in rx.items()}}
+    return metrics, extra
+
+
+# ---------------------------------------------------------------- 板上
+class Stimulus(threading.Thread):
+    """按帧周期向一个传感器串口写出合成数据（计时按单调时钟，落后时不补发）"""
+
+    def __init__(self, name, path, period_ms, gen, per_burst):
+        super().__init__(daemon=True)
+        self.fd = os.open(path, os.O_WRONLY | os.O_NOCTTY)
+        set_line(self.fd, *LINES[name])
+        self.period = period_ms / 1000.0
+        self.gen = gen
+        self.per_burst = per_burst
+        self.sent = 0                   # 写出的帧/语句数
+        self.late = 0                   # 错过写出时刻（超过一个周期）的次数
+        self.stop = threading.Event()
+
+    def run(self):
+        i = 0
+        due = time.monotonic()
+        while not self.stop.is_set():
+            os.write(self.fd, self.gen(i))
+            self.sent += self.per_burst
+            i += 1
+            due += self.period
+            delay = due - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            elif delay < -self.period:
+                self.late += 1
+                due = time.monotonic()
+
+    def close(self):
+        self.stop.set()
+        self.join()
+        os.close(self.fd)
+
+
+class Collector:
+    """收集遥测消息（Uplink的回调）"""
+
+    def __init__(self):
+        self.messages = []
+        self.latest = {}
+        self.cpu_hz = CPU_HZ
+
+    def feed(self, msg):
+        self.messages.append(msg)
+        self.latest[msg.name] = msg.fields
+        if msg.name == "power":
+            self.cpu_hz = msg.fields["cpu_hz"]
+
+    def wait(self, link, names, timeout=3.0):
+        """等到names中每种消息都收到一条新的，返回其字段"""
+        for name in names:
+            self.latest.pop(name, None)
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline and any(n not in self.latest for n in names):
+            link.poll(0.1)
+        if any(n not in self.latest for n in names):
+            raise SystemExit(f"no {'/'.join(names)} telemetry on the link (rates 1 Hz?)")
+        return [dict(self.latest[n]) for n in names]
+
+
+def set_rates(link, rates):
+    for t, hz in rates:
+        result = link.send(CMD_TLM_RATE, t, hz)
+        if result != "ok":
+            print(f"  rate {MESSAGES[t][0]}={hz}: {result or 'no ack'}", file=sys.stderr)
+
+
+def run_target(scenario, args, link, collector):
+    sources = streams(scenario)
+    missing = [n for n in sources if not getattr(args, n)]
+    if missing:
+        raise SystemExit(f"{scenario}: needs --{' --'.join(missing)}")
+    task0, inp0 = collector.wait(link, ["task", "input"])
+    set_rates(link, rate_commands(scenario))
+    collector.messages.clear()
+    threads = [Stimulus(n, getattr(args, n), p, g, k) for n, (p, g, k) in sources.items()]
+    for t in threads:
+        t.start()
+    deadline = time.monotonic() + args.duration
+    while time.monotonic() < deadline:
+        link.poll(0.2)
+    for t in threads:
+        t.close()
+    messages = list(collector.messages)
+    if rate_commands(scenario):
+        set_rates(link, [(TLM_TYPES[n], hz) for n, hz in TLM_DEFAULT_RATES.items()])
+    link.poll(0.5)                      # 最后一段被解析
+    task1, inp1 = collector.wait(link, ["task", "input"])
+
+    def delta(a, b, key):
+        return (b[key] - a[key]) & 0xFFFFFFFF
+    task = dict(task1)
+    for key in ("control_misses", "gps_overruns", "uart_dropped", "tlm_dropped"):
+        task[key] = delta(task0, task1, key)
+    sent = {t_name: t.sent for t_name, t in zip(sources, threads)}
+    got = {"sbus": delta(inp0, inp1, "sbus_frames"), "imu": delta(inp0, inp1, "imu_frames"),
+           "gps": delta(inp0, inp1, "gps_sentences")}
+    errors = sum(delta(inp0, inp1, k) for k in ("sbus_errors", "imu_errors", "gps_errors"))
+    metrics = common_metrics(task, inp1, cpu_windows(messages), collector.cpu_hz, sent, got, errors)
+    extra = {"sent": sent, "decoded": got, "late_writes": {n: t.late for n, t in zip(sources, threads)}}
+    return metrics, extra
+
+
+# ---------------------------------------------------------------- 输出
+def fmt(v):
+    if v is None:
+        return "-"
+    return f"{v:g}" if isinstance(v, float) else str(v)
+
+
+def print_result(name, rows, extra):
+    passed = all(ok is not False for _, _, _, ok in rows)
+    print(f"\n== {name}: {SCENARIOS[name]['desc']}")
+    for key, value in line_load(name).items():
+        print(f"   {key} line load {value * 100:.0f}%")
+    print(f"   {'metric':<18} {'value':>10} {'budget':>10}")
+    for key, value, budget, ok in rows:
+        mark = {True: "pass", False: "FAIL", None: ""}[ok]
+        print(f"   {key:<18} {fmt(value):>10} {fmt(budget):>10}  {mark}")
+    print(f"   sent {extra['sent']}, decoded {extra['decoded']}")
+    print(f"   => {'PASS' if passed else 'FAIL'}")
+    return passed
+
+
+def parse_budgets(items):
+    out = {}
+    for item in items or []:
+        key, _, value = item.partition("=")
+        if key not in BUDGETS:
+            raise SystemExit(f"unknown budget {key} (see 'stress.py list')")
+        out[key] = None if value in ("", "none") else float(value)
+    return out
+
+
+def cmd_list(_args):
+    for name, s in SCENARIOS.items():
+        load = ", ".join(f"{k} {v * 100:.0f}%" for k, v in line_load(name).items())
+        print(f"{name:<20} {s['desc']}" + (f"\n{'':<20} line load: {load}" if load else ""))
+        if s.get("budget"):
+            print(f"{'':<20} budget: " + ", ".join(f"{k}={fmt(v)}" for k, v in s["budget"].items()))
+    print("\ndefault budgets:")
+    for key, value in BUDGETS.items():
+        print(f"  {key:<18} {fmt(value)}" + (" (minimum)" if key == "headroom_pct" else ""))
+
+
+def run_all(args, runner):
+    names = args.scenarios or list(SCENARIOS)
+    for name in names:
+        if name not in SCENARIOS:
+            raise SystemExit(f"unknown scenario {name} (see 'stress.py list')")
+    overrides = parse_budgets(args.budget)
+    results = {}
+    failed = []
+    for name in names:
+        metrics, extra = runner(name)
+        rows = evaluate(metrics, budgets_of(name, overrides))
+        if not print_result(name, rows, extra):
+            failed.append(name)
+        results[name] = {"pass": name not in failed, "metrics": metrics,
+                         "budgets": {k: b for k, _, b, _ in rows}, **extra}
+    print(f"\n{len(names) - len(failed)}/{len(names)} scenarios passed" + (f", failed: {' '.join(failed)}" if failed else ""))
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+    return 1 if failed else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="worst-case load and schedulability scenarios")
+    sub = parser.add_subparsers(dest="op", required=True)
+    sub.add_parser("list", help="list scenarios and budgets")
+    for op in ("sim", "target"):
+        p = sub.add_parser(op, help="run scenarios on the host simulation" if op == "sim"
+                           else "run scenarios on the board through UART loopback")
+        p.add_argument("scenarios", nargs="*", help="scenario names (default: all)")
+        p.add_argument("--duration", type=float, default=10.0 if op == "sim" else 30.0, help="seconds per scenario")
+        p.add_argument("--budget", action="append", metavar="KEY=VALUE", help="override a budget ('none' = report only)")
+        p.add_argument("--json", help="write results as JSON")
+        if op == "sim":
+            p.add_argument("--sim", default=SIM, help="FISH_H7_sim binary")
+            p.add_argument("--cpu-scale", type=float, default=1.0, help="host CPU time counted into DWT cycles")
+        else:
+            p.add_argument("--link", required=True, help="debug UART (telemetry/uplink)")
+            p.add_argument("--baud", type=int, default=115200)
+            for name in ("sbus", "imu", "gps"):
+                p.add_argument(f"--{name}", help=f"serial adapter wired to the {name} UART RX")
+    args = parser.parse_args()
+
+    if args.op == "list":
+        cmd_list(args)
+        return 0
+    if args.op == "sim":
+        if not os.access(args.sim, os.X_OK):
+            raise SystemExit(f"{args.sim}: not found (build with cmake --preset Sim, or pass --sim)")
+        with tempfile.TemporaryDirectory(prefix="stress_") as workdir:
+            return run_all(args, lambda name: run_sim(name, args, workdir))
+    collector = Collector()
+    link = Uplink(open_port(args.link, args.baud), on_message=collector.feed)
+    try:
+        return run_all(args, lambda name: run_target(name, args, link, collector))
+    finally:
+        os.close(link.fd)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,242 @@
+"""
+机器鱼二进制遥测解码库（对应固件 Core/Inc/Telemetry.h）
+
+帧格式：0x00 + COBS(消息头 + 负载 + CRC32小端) + 0x00
+    消息头：type(u8) seq(u16) time_us(u64，TimeBase微秒)，全部小端、紧凑排列
+    CRC32：与zlib.crc32一致（固件用STM32H7 CRC外设计算）
+调试串口同时输出printf文本，文本中不含0x00，按0x00切分后校验失败的片段即视为文本。
+"""
+import struct
+import zlib
+from dataclasses import dataclass, field
+
+HEADER = struct.Struct("<BHQ")
+CRC = struct.Struct("<I")
+# CPU消息中的任务/中断顺序（与RT_Stats.c中的统计槽位、RT_ISR_Id_t一致）
+CPU_TASKS = ["sbus", "gps", "jy901s", "control", "blackbox", "timer", "idle"]
+CPU_ISRS = ["dma1_s0", "dma1_s1", "dma1_s2", "dma1_s3", "dma1_s4", "usart1", "usart2", "usart3", "usart6", "tim23"]
+
+# 消息类型 -> (名称, 负载格式, 字段名, 缩放系数)；必须与Telemetry.h中的结构体一一对应
+MESSAGES = {
+    0x01: ("imu", "<10h",
+           ["ax", "ay", "az", "gx", "gy", "gz", "roll", "pitch", "yaw", "temp"],
+           [0.01, 0.01, 0.01, 0.1, 0.1, 0.1, 0.01, 0.01, 0.01, 0.01]),
+    0x02: ("rc", "<16H4B",
+           [f"ch{i + 1}" for i in range(16)] + ["flags", "failsafe", "frame_lost", "auto_mode"],
+           None),
+    0x03: ("gait", "<5B2h2fB",
+           ["state", "command", "speed", "ap_active", "wp_index",
+            "yaw_rate", "heading_error", "distance", "cross_track", "source"],
+           [1, 1, 1, 1, 1, 0.01, 0.01, 1, 1, 1]),
+    0x04: ("servo", "<4H",
+           ["angle_body", "angle_tail", "pulse_body", "pulse_tail"],
+           None),
+    0x05: ("gps", "<3iI4H3B",
+           ["latitude", "longitude", "altitude", "utc_time", "speed", "course", "hdop", "pdop",
+            "fix_quality", "satellites", "is_valid"],
+           [1e-7, 1e-7, 0.01, 1, 0.01, 0.01, 0.01, 0.01, 1, 1, 1]),
+    0x06: ("task", "<6H10I3HIH",
+           ["stack_sbus", "stack_gps", "stack_jy901s", "stack_control", "stack_blackbox", "stack_timer",
+            "uart_dropped", "tlm_dropped", "gps_overruns",
+            "control_cycles", "control_cycles_max", "switch_cycles_avg", "switch_cycles_max",
+            "input_age_imu", "input_age_rc", "input_age_gps", "switches", "control_jitter_max", "stack_bytes",
+            "control_misses", "uart_level_max"],
+           None),
+    0x07: ("nav", "<4fIB",
+           ["pos_n", "pos_e", "vel_n", "vel_e", "gps_updates", "valid"],
+           None),
+    0x08: ("ack", "<BHB",
+           ["cmd", "seq", "result"],
+           None),
+    0x09: ("bb_data", "<II32s",
+           ["generation", "offset", "data"],
+           None),
+    0x0A: ("bb_status", "<6I2H2B",
+           ["session", "generation", "records", "dropped", "flash_bytes", "dump_words",
+            "erases", "erase_ms_max", "state", "sector"],
+           None),
+    0x0B: ("cpu", "<24HI",
+           [f"load_{t}" for t in CPU_TASKS] + [f"stack_{t}" for t in CPU_TASKS]
+           + [f"isr_{v}" for v in CPU_ISRS] + ["stats_cycles"],
+           [0.01] * 7 + [1] * 7 + [0.01] * 10 + [1]),
+    0x0C: ("trace_data", "<HBB40s",
+           ["index", "count", "reserved", "events"],
+           None),
+    0x0D: ("trace_info", "<2I3H2BQI",
+           ["cpu_hz", "recorded", "events", "dumped", "event_cycles", "state", "trigger", "sync_us", "sync_cycles"],
+           None),
+    0x0E: ("trace_name", "<2B16s",
+           ["kind", "id", "name"],
+           None),
+    0x0F: ("power", "<2I3H3B",
+           ["cpu_hz", "sleeps", "sleep", "switch_us", "switches", "profile", "sleep_enable", "vos"],
+           [1, 1, 0.01, 1, 1, 1, 1, 1]),
+    0x10: ("capture", "<2I2B",
+           ["offset", "time_us", "source", "len"],
+           None),
+    0x11: ("input", "<8I2H",
+           ["sbus_frames", "sbus_errors", "imu_frames", "imu_errors",
+            "gps_sentences", "gps_errors", "gps_bytes", "capture_dropped", "imu_backlog_max", "gps_backlog_max"],
+           None),
+}
+# 变长消息：负载 = 定长部分 + 数据，数据放在字段"data"中
+VARIABLE = {0x10}
+_STRUCTS = {t: struct.Struct(m[1]) for t, m in MESSAGES.items()}
+
+
+@dataclass
+class Message:
+    type: int
+    name: str
+    seq: int
+    time_us: int
+    fields: dict
+
+
+@dataclass
+class Stats:
+    bytes: int = 0              # 输入总字节数
+    frame_bytes: int = 0        # 有效帧占用字节数（含COBS与分隔符）
+    frames: int = 0             # 校验通过的帧数
+    crc_errors: int = 0         # 像帧但CRC错误的片段数
+    text_bytes: int = 0         # 非帧片段（printf文本）字节数
+    seq_gaps: int = 0           # 按序号推算的丢帧数
+    unknown: int = 0            # 未知类型的帧数
+    per_type: dict = field(default_factory=dict)
+    first_us: int = None
+    last_us: int = None
+
+
+def cobs_decode(data: bytes) -> bytes:
+    """COBS解码，格式错误抛出ValueError"""
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        end = i + code
+        if code == 0 or end > n:
+            raise ValueError("bad cobs")
+        out += data[i + 1:end]
+        i = end
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """COBS编码（与固件TLM_COBS_Encode一致，供测试/回放使用）"""
+    out = bytearray([0])
+    code_pos = 0
+    code = 1
+    for b in data:
+        if b == 0:
+            out[code_pos] = code
+            code_pos = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_pos] = code
+                code_pos = len(out)
+                out.append(0)
+                code = 1
+    out[code_pos] = code
+    return bytes(out)
+
+
+def encode_frame(msg_type: int, seq: int, time_us: int, payload: bytes) -> bytes:
+    """按固件格式打包一帧"""
+    return pack_frame(HEADER.pack(msg_type, seq & 0xFFFF, time_us) + payload)
+
+
+def pack_frame(body: bytes) -> bytes:
+    """body追加CRC32后COBS编码，前后加分隔符（遥测与上行命令通用）"""
+    return b"\x00" + cobs_encode(body + CRC.pack(zlib.crc32(body))) + b"\x00"
+
+
+def unpack_frame(chunk: bytes):
+    """COBS解码并校验CRC32，返回去掉CRC的body；无效返回None"""
+    try:
+        raw = cobs_decode(chunk)
+    except ValueError:
+        return None
+    if len(raw) <= CRC.size:
+        return None
+    body, (crc,) = raw[:-CRC.size], CRC.unpack(raw[-CRC.size:])
+    if zlib.crc32(body) != crc:
+        return None
+    return body
+
+
+def decode_frame(chunk: bytes):
+    """解码一个分隔符之间的片段，返回Message；不是有效帧返回None"""
+    body = unpack_frame(chunk)
+    if body is None or len(body) < HEADER.size:
+        return None
+    msg_type, seq, time_us = HEADER.unpack_from(body)
+    payload = body[HEADER.size:]
+    size = _STRUCTS[msg_type].size if msg_type in MESSAGES else None
+    if size is None or len(payload) < size or (len(payload) != size and msg_type not in VARIABLE):
+        return Message(msg_type, "unknown", seq, time_us, {"payload": payload.hex()})
+    name, _, names, scales = MESSAGES[msg_type]
+    values = _STRUCTS[msg_type].unpack(payload[:size])
+    if scales:
+        values = [v * s if s != 1 else v for v, s in zip(values, scales)]
+    fields = dict(zip(names, values))
+    if msg_type in VARIABLE:
+        fields["data"] = payload[size:]
+    return Message(msg_type, name, seq, time_us, fields)
+
+
+class Decoder:
+    """流式解码器：feed()任意切分的字节流，返回解出的消息列表"""
+
+    def __init__(self, keep_text=False):
+        self.stats = Stats()
+        self.text = bytearray() if keep_text else None
+        self._buf = bytearray()
+        self._last_seq = None
+
+    def feed(self, data: bytes):
+        self.stats.bytes += len(data)
+        self._buf += data
+        messages = []
+        while True:
+            idx = self._buf.find(0)
+            if idx < 0:
+                break
+            chunk = bytes(self._buf[:idx])
+            del self._buf[:idx + 1]
+            if chunk:
+                msg = self._handle(chunk)
+                if msg is not None:
+                    messages.append(msg)
+        return messages
+
+    def _handle(self, chunk: bytes):
+        st = self.stats
+        msg = decode_frame(chunk)
+        if msg is None:
+            # 长度与消息头相当且不含换行的片段多半是损坏的帧，其余按文本计
+            if b"\n" not in chunk and len(chunk) >= HEADER.size + CRC.size + 1:
+                st.crc_errors += 1
+            else:
+                st.text_bytes += len(chunk)
+                if self.text is not None:
+                    self.text += chunk
+            return None
+        st.frames += 1
+        st.frame_bytes += len(chunk) + 2
+        if msg.name == "unknown":
+            st.unknown += 1
+        st.per_type[msg.name] = st.per_type.get(msg.name, 0) + 1
+        if self._last_seq is not None:
+            st.seq_gaps += (msg.seq - self._last_seq - 1) & 0xFFFF
+        self._last_seq = msg.seq
+        if st.first_us is None:
+            st.first_us = msg.time_us
+        st.last_us = msg.time_us
+        return msg
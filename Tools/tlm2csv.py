@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+遥测抓包转CSV
+
+用法：
+    python3 tlm2csv.py capture.bin -o out_dir      # 每类消息一个CSV：out_dir/imu.csv ...
+    python3 tlm2csv.py capture.bin --text log.txt  # 同时把printf文本单独保存
+抓包可直接用串口工具保存调试串口（USART3，115200）的原始字节，例如：
+    stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin
+结束后打印吞吐量统计：字节数、帧数、CRC错误、序号推算的丢帧数、各消息实际频率。
+"""
+import argparse
+import csv
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder  # noqa: E402
+
+CHUNK = 64 * 1024
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode fish telemetry capture to CSV")
+    parser.add_argument("capture", help="raw serial capture ('-' for stdin)")
+    parser.add_argument("-o", "--out", default=".", help="output directory for CSV files")
+    parser.add_argument("--text", help="also save non-frame bytes (printf text) to this file")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    src = sys.stdin.buffer if args.capture == "-" else open(args.capture, "rb")
+    decoder = Decoder(keep_text=args.text is not None)
+    writers = {}
+    files = []
+    text = open(args.text, "wb") if args.text else None
+
+    with src:
+        while True:
+            data = src.read(CHUNK)
+            if not data:
+                break
+            for msg in decoder.feed(data):
+                w = writers.get(msg.name)
+                if w is None:
+                    f = open(os.path.join(args.out, f"{msg.name}.csv"), "w", newline="")
+                    files.append(f)
+                    w = csv.writer(f)
+                    w.writerow(["seq", "time_us"] + list(msg.fields))
+                    writers[msg.name] = w
+                w.writerow([msg.seq, msg.time_us] + [
+                    f"{v:.6g}" if isinstance(v, float) else v for v in msg.fields.values()])
+            if text:
+                text.write(decoder.text)
+                decoder.text.clear()
+
+    for f in files:
+        f.close()
+    if text:
+        text.close()
+    report(decoder.stats)
+
+
+def report(st):
+    span = (st.last_us - st.first_us) / 1e6 if st.frames > 1 else 0.0
+    print(f"input bytes   : {st.bytes}")
+    print(f"frames        : {st.frames}  ({st.frame_bytes} bytes)")
+    print(f"crc errors    : {st.crc_errors}")
+    print(f"seq gaps      : {st.seq_gaps}  (frames dropped on target or lost on the wire)")
+    print(f"unknown types : {st.unknown}")
+    print(f"text bytes    : {st.text_bytes}")
+    if span > 0:
+        print(f"time span     : {span:.3f} s")
+        print(f"throughput    : {st.frame_bytes / span:.0f} B/s telemetry, "
+              f"{st.bytes / span:.0f} B/s total ({st.bytes * 10 / span / 115200 * 100:.1f}% of 115200 baud)")
+        for name, count in sorted(st.per_type.items()):
+            print(f"  {name:<8}: {count:>8} frames  {count / span:7.1f} Hz")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+调度事件导出与时间线转换工具（对应固件 Core/Inc/Trace.h）
+
+经上行命令TRACE（0x8B，op=dump）触发导出，收集遥测TRACE_INFO/TRACE_NAME/TRACE_DATA消息，
+转换为Chrome trace事件格式（JSON），可直接拖入 https://ui.perfetto.dev 或 chrome://tracing 查看：
+    python3 trace2json.py /dev/ttyUSB0 -o trace.json
+    python3 trace2json.py --capture dump_capture.bin -o trace.json
+时间线：每个任务一行（运行区间），每个中断一行，每个用户标记一行（区间/标记），每个队列/事件组一行（瞬时事件），
+触发点为全局瞬时事件。时间戳为32位DWT周期，按相邻事件展开后按cpu_hz换算为微秒；
+状态消息带有停止记录时刻的TimeBase微秒与DWT计数（sync_us/sync_cycles），据此把时间线平移到TimeBase时间，
+与遥测、日志中的time_us直接对齐（无同步点时从0开始）。
+"""
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder  # noqa: E402
+from uplink import Uplink, CMD_TRACE, TRACE_OPS, open_port  # noqa: E402
+
+EVENT = struct.Struct("<IBBH")          # Trace_Event_t：time type id arg
+# 事件类型（与Trace_EventType_t一致）
+(EV_TASK_IN, EV_TASK_OUT, EV_ISR_ENTER, EV_ISR_EXIT, EV_QUEUE_SEND, EV_QUEUE_RECEIVE, EV_QUEUE_SEND_FAILED,
+ EV_QUEUE_RECEIVE_FAILED, EV_QUEUE_BLOCK, EV_NOTIFY, EV_MARK, EV_SPAN_BEGIN, EV_SPAN_END, EV_TRIGGER,
+ EV_FLAGS_SET) = range(1, 16)
+NAME_KINDS = ["task", "isr", "object", "marker"]
+STATE_NAMES = ["recording", "triggered", "stopped", "dumping"]
+TRIGGER_NAMES = ["none", "control_late", "manual"]
+QUEUE_EVENTS = {EV_QUEUE_SEND: "send", EV_QUEUE_RECEIVE: "receive", EV_QUEUE_SEND_FAILED: "send_failed",
+                EV_QUEUE_RECEIVE_FAILED: "receive_failed", EV_QUEUE_BLOCK: "block"}
+# 时间线行号（tid）：任务直接用任务号，其余按类型偏移
+TID_ISR, TID_MARKER, TID_OBJECT = 100, 200, 300
+PID = 1
+IDLE_TIMEOUT = 5.0                      # 导出中超过该时间没有新数据视为结束（s）
+
+
+class Assembler:
+    """收集TRACE_*消息"""
+
+    def __init__(self):
+        self.info = None
+        self.names = {}                 # (kind, id) -> 名称
+        self.chunks = {}                # index -> 事件字节
+        self.done = False
+        self.last_data = time.monotonic()
+
+    def feed(self, msg):
+        if msg.name == "trace_data":
+            f = msg.fields
+            self.chunks[f["index"]] = f["events"][:f["count"] * EVENT.size]
+            self.last_data = time.monotonic()
+        elif msg.name == "trace_name":
+            f = msg.fields
+            self.names[(NAME_KINDS[f["kind"]] if f["kind"] < 4 else "?", f["id"])] = \
+                f["name"].split(b"\x00")[0].decode(errors="replace")
+            self.last_data = time.monotonic()
+        elif msg.name == "trace_info":
+            self.info = msg.fields
+            # 导出结束时固件再发一次状态（dumped==events）
+            if self.chunks and msg.fields["dumped"] >= msg.fields["events"]:
+                self.done = True
+
+    def events(self):
+        """按序号拼接，返回[(time, type, id, arg)]与缺失的事件数"""
+        out = []
+        missing = 0
+        expect = 0
+        for index in sorted(self.chunks):
+            missing += max(0, index - expect)
+            data = self.chunks[index]
+            out += [EVENT.unpack_from(data, off) for off in range(0, len(data), EVENT.size)]
+            expect = index + len(data) // EVENT.size
+        if self.info:
+            missing += max(0, self.info["events"] - expect)
+        return out, missing
+
+
+def unwrap(events, cpu_hz, sync_us=None, sync_cycles=None):
+    """32位周期计数展开并换算为微秒：有同步点时为TimeBase时间，否则相对第一个事件"""
+    out = []
+    total = 0
+    last = None
+    for t, typ, ident, arg in events:
+        if last is not None:
+            total += (t - last) & 0xFFFFFFFF
+        last = t
+        out.append((total * 1e6 / cpu_hz, typ, ident, arg))
+    if out and sync_us and sync_cycles is not None:
+        # 同步点在最后一个事件之后（停止记录时读取），两者之差不超过一次回绕
+        offset = sync_us - ((sync_cycles - last) & 0xFFFFFFFF) * 1e6 / cpu_hz - out[-1][0]
+        out = [(ts + offset, typ, ident, arg) for ts, typ, ident, arg in out]
+    return out
+
+
+def convert(asm):
+    """返回(Chrome trace字典, 摘要)"""
+    info = asm.info or {}
+    cpu_hz = info.get("cpu_hz") or 550_000_000
+    raw, missing = asm.events()
+    events = unwrap(raw, cpu_hz, info.get("sync_us"), info.get("sync_cycles"))
+    names = asm.names
+
+    def name(kind, ident):
+        return names.get((kind, ident), f"{kind}{ident}")
+
+    out = []
+    tracks = {}                         # tid -> 行名
+
+    def track(tid, label):
+        tracks.setdefault(tid, label)
+        return tid
+
+    def slice_(tid, label, start, end, args=None):
+        ev = {"ph": "X", "pid": PID, "tid": tid, "name": label, "ts": round(start, 3),
+              "dur": round(max(end - start, 0.0), 3)}
+        if args:
+            ev["args"] = args
+        out.append(ev)
+
+    def instant(tid, label, ts, args=None, scope="t"):
+        ev = {"ph": "i", "pid": PID, "tid": tid, "name": label, "ts": round(ts, 3), "s": scope}
+        if args:
+            ev["args"] = args
+        out.append(ev)
+
+    running = None                      # (任务号, 换入时间, 优先级)
+    isr_open = {}                       # 中断号 -> [进入时间]（同一中断不会自嵌套，保留列表以防丢事件）
+    span_open = {}                      # 标记号 -> [(开始时间, 所在任务)]
+    spans = {}                          # 标记名 -> [耗时us]
+    start_ts = events[0][0] if events else 0.0
+    end_ts = events[-1][0] if events else 0.0
+
+    for ts, typ, ident, arg in events:
+        if typ == EV_TASK_IN:
+            running = (ident, ts, arg)
+        elif typ == EV_TASK_OUT:
+            start, prio = (running[1], running[2]) if running and running[0] == ident else (None, None)
+            slice_(track(ident, name("task", ident)), name("task", ident), start_ts if start is None else start, ts,
+                   {"priority": prio} if prio is not None else None)
+            running = None
+        elif typ == EV_ISR_ENTER:
+            isr_open.setdefault(ident, []).append(ts)
+        elif typ == EV_ISR_EXIT:
+            if isr_open.get(ident):
+                slice_(track(TID_ISR + ident, "isr " + name("isr", ident)), name("isr", ident),
+                       isr_open[ident].pop(), ts)
+        elif typ == EV_SPAN_BEGIN:
+            span_open.setdefault(ident, []).append((ts, running[0] if running else None))
+        elif typ == EV_SPAN_END:
+            if span_open.get(ident):
+                start, task = span_open[ident].pop()
+                label = name("marker", ident)
+                slice_(track(TID_MARKER + ident, "mark " + label), label, start, ts,
+                       {"task": name("task", task)} if task is not None else None)
+                spans.setdefault(label, []).append(ts - start)
+        elif typ == EV_MARK:
+            label = name("marker", ident)
+            instant(track(TID_MARKER + ident, "mark " + label), label, ts, {"arg": arg})
+        elif typ in QUEUE_EVENTS:
+            label = name("object", ident)
+            args = {"waiting": arg} if typ != EV_QUEUE_BLOCK else {"on": "receive" if arg else "send"}
+            if running:
+                args["task"] = name("task", running[0])
+            instant(track(TID_OBJECT + ident, "object " + label), QUEUE_EVENTS[typ], ts, args)
+        elif typ == EV_FLAGS_SET:
+            args = {"bits": f"0x{arg:04x}"}
+            if running:
+                args["task"] = name("task", running[0])
+            instant(track(TID_OBJECT + ident, "object " + name("object", ident)), "set", ts, args)
+        elif typ == EV_NOTIFY:
+            instant(track(ident, name("task", ident)), "notify", ts,
+                    {"value": arg, "from": name("task", running[0]) if running else "isr"})
+        elif typ == EV_TRIGGER:
+            instant(0, "trigger " + (TRIGGER_NAMES[ident] if ident < len(TRIGGER_NAMES) else str(ident)),
+                    ts, scope="g")
+
+    # 导出时仍在运行的任务延续到最后一个事件
+    if running:
+        slice_(track(running[0], name("task", running[0])), name("task", running[0]), running[1], end_ts)
+
+    meta = [{"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "FISH_H7"}}]
+    for tid, label in sorted(tracks.items()):
+        meta.append({"ph": "M", "pid": PID, "tid": tid, "name": "thread_name", "args": {"name": label}})
+        meta.append({"ph": "M", "pid": PID, "tid": tid, "name": "thread_sort_index", "args": {"sort_index": tid}})
+
+    trace = {"traceEvents": meta + out, "displayTimeUnit": "ns",
+             "otherData": {"cpu_hz": cpu_hz, "recorded": info.get("recorded"),
+                           "event_cycles": info.get("event_cycles"), "sync_us": info.get("sync_us"),
+                           "trigger": TRIGGER_NAMES[info["trigger"]] if info.get("trigger", 0) < 3 else None}}
+    summary = {"events": len(events), "missing": missing, "start_us": start_ts, "span_us": end_ts - start_ts,
+               "spans": spans}
+    return trace, summary
+
+
+def collect_live(port, baud):
+    asm = Assembler()
+    link = Uplink(open_port(port, baud), on_message=asm.feed)
+    result = link.send(CMD_TRACE, TRACE_OPS["dump"])
+    if result != "ok":
+        sys.exit(f"trace dump: {result or 'no ack'}")
+    last_report = 0.0
+    while not asm.done and time.monotonic() - asm.last_data < IDLE_TIMEOUT:
+        link.poll(0.2)
+        now = time.monotonic()
+        if now - last_report > 1.0:
+            last_report = now
+            total = asm.info["events"] if asm.info else 0
+            got = sum(len(c) for c in asm.chunks.values()) // EVENT.size
+            print(f"\r{got}/{total} events", end="", file=sys.stderr, flush=True)
+    print(file=sys.stderr)
+    os.close(link.fd)
+    return asm
+
+
+def collect_capture(path):
+    asm = Assembler()
+    decoder = Decoder()
+    with open(path, "rb") as f:
+        while True:
+            data = f.read(64 * 1024)
+            if not data:
+                break
+            for msg in decoder.feed(data):
+                asm.feed(msg)
+    return asm
+
+
+def main():
+    parser = argparse.ArgumentParser(description="download the scheduler trace and convert it to Chrome/Perfetto JSON")
+    parser.add_argument("port", nargs="?", help="serial device or pty path")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--capture", help="read an existing raw capture instead of a live port")
+    parser.add_argument("-o", "--out", default="trace.json", help="output JSON")
+    args = parser.parse_args()
+    if not args.port and not args.capture:
+        parser.error("need a port or --capture")
+
+    asm = collect_capture(args.capture) if args.capture else collect_live(args.port, args.baud)
+    if not asm.chunks:
+        sys.exit("no trace data received")
+    trace, summary = convert(asm)
+    with open(args.out, "w") as f:
+        json.dump(trace, f)
+
+    info = asm.info or {}
+    state = info.get("state")
+    print(f"events {summary['events']} (missing {summary['missing']}), {summary['span_us'] / 1000:.1f} ms "
+          f"from {summary['start_us'] / 1e6:.6f} s, "
+          f"recorded {info.get('recorded', '?')}, state {STATE_NAMES[state] if state is not None and state < 4 else '?'}, "
+          f"event cost {info.get('event_cycles', '?')} cycles")
+    for label, durations in sorted(summary["spans"].items()):
+        print(f"  {label:<16} n={len(durations):<5} avg={sum(durations) / len(durations):8.1f} us "
+              f"max={max(durations):8.1f} us")
+    print(f"wrote {args.out}; open it in https://ui.perfetto.dev or chrome://tracing")
+
+
+if __name__ == "__main__":
+    main()
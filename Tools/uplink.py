@@ -0,0 +1,249 @@
+#!/usr/bin/env python3
+"""
+地面站上行命令客户端（对应固件 Core/Inc/Uplink.h）
+
+帧格式与遥测相同：0x00 + COBS(type(u8) seq(u16) 负载 + CRC32小端) + 0x00
+每条命令经遥测ACK消息（0x08）回送结果，本客户端等待ACK，超时重发。
+
+用法：
+    python3 uplink.py /dev/ttyUSB0 mode manual
+    python3 uplink.py /dev/ttyUSB0 setpoint --yaw-rate 10 --speed 4 --repeat 5   # 设定需周期重发（固件500ms超时）
+    python3 uplink.py /dev/ttyUSB0 command forward
+    python3 uplink.py /dev/ttyUSB0 gait --amplitude 30 --speed 4 --body-bias 20 --tail-bias 10
+    python3 uplink.py /dev/ttyUSB0 wp-clear
+    python3 uplink.py /dev/ttyUSB0 wp-add 31.1234567 121.1234567 --radius 5
+    python3 uplink.py /dev/ttyUSB0 mode auto
+    python3 uplink.py /dev/ttyUSB0 rate imu 20
+    python3 uplink.py /dev/ttyUSB0 top                                            # 打印各任务/中断CPU占用
+    python3 uplink.py /dev/ttyUSB0 trace trigger                                  # 调度事件记录手动触发（导出用trace2json.py）
+    python3 uplink.py /dev/ttyUSB0 power economy                                  # 切到节能时钟档（--no-sleep关闭空闲睡眠）
+    python3 uplink.py /dev/ttyUSB0 capture imu gps                                # 开启传感器原始数据采集（录制用capture.py）
+没有板子时可先运行 board_standin.py，它会打印一个pty路径，把该路径当作串口传给本脚本。
+"""
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from telemetry import Decoder, MESSAGES, pack_frame  # noqa: E402
+
+HEADER = struct.Struct("<BH")
+
+# 命令类型 -> 负载格式（与Uplink.h中的结构体一一对应）
+CMD_HEARTBEAT = 0x81
+CMD_MODE = 0x82
+CMD_SETPOINT = 0x83
+CMD_COMMAND = 0x84
+CMD_GAIT = 0x85
+CMD_WP_CLEAR = 0x86
+CMD_WP_ADD = 0x87
+CMD_TLM_RATE = 0x88
+CMD_BB_DUMP = 0x89
+CMD_TOP = 0x8A
+CMD_TRACE = 0x8B
+CMD_POWER = 0x8C
+CMD_CAPTURE = 0x8D
+PAYLOADS = {
+    CMD_HEARTBEAT: struct.Struct("<"),
+    CMD_MODE: struct.Struct("<B"),
+    CMD_SETPOINT: struct.Struct("<fB"),
+    CMD_COMMAND: struct.Struct("<B"),
+    CMD_GAIT: struct.Struct("<4H"),
+    CMD_WP_CLEAR: struct.Struct("<"),
+    CMD_WP_ADD: struct.Struct("<iif"),
+    CMD_TLM_RATE: struct.Struct("<BH"),
+    CMD_BB_DUMP: struct.Struct("<"),
+    CMD_TOP: struct.Struct("<"),
+    CMD_TRACE: struct.Struct("<B"),
+    CMD_POWER: struct.Struct("<BB"),
+    CMD_CAPTURE: struct.Struct("<B"),
+}
+MODES = {"manual": 0, "auto": 1}
+COMMANDS = {"stop": 0, "forward": 1, "left": 2, "right": 3}
+TRACE_OPS = {"dump": 0, "restart": 1, "trigger": 2}
+POWER_PROFILES = {"performance": 0, "economy": 1}
+CAPTURE_SOURCES = {"sbus": 0, "imu": 1, "gps": 2}   # 与Capture_Source_t一致
+RESULTS = ["ok", "bad_length", "bad_value", "rejected", "unknown"]
+# 事件消息不按频率发送，不能设置频率
+TLM_TYPES = {m[0]: t for t, m in MESSAGES.items()
+             if m[0] not in ("ack", "bb_data", "trace_data", "trace_info", "trace_name", "capture")}
+
+
+def encode_command(cmd: int, seq: int, *values) -> bytes:
+    """打包一条上行命令帧"""
+    return pack_frame(HEADER.pack(cmd, seq & 0xFFFF) + PAYLOADS[cmd].pack(*values))
+
+
+def open_port(path: str, baud: int = 115200) -> int:
+    """以原始模式打开串口（或pty），不依赖pyserial"""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    speed = getattr(termios, f"B{baud}")
+    attrs[4] = attrs[5] = speed
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+class Uplink:
+    """上行客户端：发送命令并等待ACK，同时把收到的遥测交给回调"""
+
+    def __init__(self, fd: int, on_message=None, keep_text=False):
+        self.fd = fd
+        self.seq = 0
+        self.decoder = Decoder(keep_text=keep_text)
+        self.on_message = on_message
+
+    def poll(self, timeout: float):
+        """读取timeout秒内到达的数据，返回解出的消息"""
+        messages = []
+        deadline = time.monotonic() + timeout
+        while True:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                break
+            ready, _, _ = select.select([self.fd], [], [], left)
+            if not ready:
+                break
+            try:
+                data = os.read(self.fd, 4096)
+            except BlockingIOError:
+                continue
+            if not data:
+                break
+            for msg in self.decoder.feed(data):
+                if self.on_message:
+                    self.on_message(msg)
+                messages.append(msg)
+            if messages:
+                break
+        return messages
+
+    def send(self, cmd: int, *values, timeout: float = 0.3, retries: int = 3):
+        """发送命令并等待对应ACK，返回结果字符串；无应答返回None"""
+        seq = self.seq
+        self.seq = (self.seq + 1) & 0xFFFF
+        frame = encode_command(cmd, seq, *values)
+        for _ in range(retries):
+            os.write(self.fd, frame)
+            deadline = time.monotonic() + timeout
+            while time.monotonic() < deadline:
+                for msg in self.poll(deadline - time.monotonic()):
+                    if msg.name == "ack" and msg.fields["cmd"] == cmd and msg.fields["seq"] == seq:
+                        r = msg.fields["result"]
+                        return RESULTS[r] if r < len(RESULTS) else str(r)
+        return None
+
+
+def build_command(args):
+    """命令行参数 -> (命令类型, 负载字段)"""
+    if args.op == "heartbeat":
+        return CMD_HEARTBEAT, ()
+    if args.op == "mode":
+        return CMD_MODE, (MODES[args.mode],)
+    if args.op == "setpoint":
+        return CMD_SETPOINT, (args.yaw_rate, args.speed)
+    if args.op == "command":
+        return CMD_COMMAND, (COMMANDS[args.command],)
+    if args.op == "gait":
+        return CMD_GAIT, (args.amplitude, args.speed, args.body_bias, args.tail_bias)
+    if args.op == "wp-clear":
+        return CMD_WP_CLEAR, ()
+    if args.op == "wp-add":
+        return CMD_WP_ADD, (round(args.lat * 1e7), round(args.lon * 1e7), args.radius)
+    if args.op == "rate":
+        return CMD_TLM_RATE, (TLM_TYPES[args.type], args.hz)
+    if args.op == "top":
+        return CMD_TOP, ()
+    if args.op == "trace":
+        return CMD_TRACE, (TRACE_OPS[args.trace_op],)
+    if args.op == "power":
+        return CMD_POWER, (POWER_PROFILES[args.profile], 0 if args.no_sleep else 1)
+    if args.op == "capture":
+        bad = [s for s in args.sources if s not in CAPTURE_SOURCES]
+        if bad:
+            raise SystemExit(f"capture: unknown source {bad[0]} (choose from {', '.join(CAPTURE_SOURCES)})")
+        return CMD_CAPTURE, (sum(1 << CAPTURE_SOURCES[s] for s in args.sources),)
+    raise ValueError(args.op)
+
+
+def print_top(link, window=1.0):
+    """等待固件在下一个统计窗口结束时输出top文本（最多两个窗口），原样打印"""
+    deadline = time.monotonic() + 2 * window + 0.5
+    while time.monotonic() < deadline:
+        link.poll(deadline - time.monotonic())
+        text = link.decoder.text
+        start = text.find(b"top - ")
+        if start >= 0 and text.rfind(b"tasks ") > start and text.endswith(b"\n"):
+            break
+    text = link.decoder.text
+    start = text.find(b"top - ")
+    if start < 0:
+        print("top: no report received")
+        return
+    print(text[start:].decode(errors="replace").replace("\r", ""), end="")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="send ground-station commands over the debug UART")
+    parser.add_argument("port", help="serial device or pty path")
+    parser.add_argument("--baud", type=int, default=115200)
+    common = argparse.ArgumentParser(add_help=False)
+    common.add_argument("--repeat", type=int, default=1, help="send N times at --interval (keeps setpoints alive)")
+    common.add_argument("--interval", type=float, default=0.1, help="seconds between repeats")
+    sub = parser.add_subparsers(dest="op", required=True)
+    sub.add_parser("heartbeat", parents=[common])
+    p = sub.add_parser("mode", parents=[common])
+    p.add_argument("mode", choices=MODES)
+    p = sub.add_parser("setpoint", parents=[common])
+    p.add_argument("--yaw-rate", type=float, default=0.0, help="deg/s, clockwise positive")
+    p.add_argument("--speed", type=int, default=2, help="swing speed step 1-10, 0 = stop")
+    p = sub.add_parser("command", parents=[common])
+    p.add_argument("command", choices=COMMANDS)
+    p = sub.add_parser("gait", parents=[common])
+    p.add_argument("--amplitude", type=int, default=30)
+    p.add_argument("--speed", type=int, default=2)
+    p.add_argument("--body-bias", type=int, default=20)
+    p.add_argument("--tail-bias", type=int, default=10)
+    sub.add_parser("wp-clear", parents=[common])
+    p = sub.add_parser("wp-add", parents=[common])
+    p.add_argument("lat", type=float)
+    p.add_argument("lon", type=float)
+    p.add_argument("--radius", type=float, default=0.0, help="m, 0 = firmware default")
+    p = sub.add_parser("rate", parents=[common])
+    p.add_argument("type", choices=TLM_TYPES)
+    p.add_argument("hz", type=int)
+    sub.add_parser("top", parents=[common])
+    p = sub.add_parser("trace", parents=[common])
+    p.add_argument("trace_op", choices=TRACE_OPS)
+    p = sub.add_parser("power", parents=[common])
+    p.add_argument("profile", choices=POWER_PROFILES)
+    p.add_argument("--no-sleep", action="store_true", help="keep the idle task spinning instead of sleeping")
+    p = sub.add_parser("capture", parents=[common])
+    p.add_argument("sources", nargs="*", metavar="{sbus,imu,gps}", help="sources to capture, none = stop")
+    args = parser.parse_args()
+
+    cmd, values = build_command(args)
+    link = Uplink(open_port(args.port, args.baud), keep_text=args.op == "top")
+    failed = 0
+    for i in range(args.repeat):
+        start = time.monotonic()
+        result = link.send(cmd, *values)
+        rtt = (time.monotonic() - start) * 1000
+        print(f"{args.op}: {result or 'no ack'}" + (f"  ({rtt:.1f} ms)" if result else ""))
+        failed += result != "ok"
+        if args.op == "top" and result == "ok":
+            print_top(link)
+        if i + 1 < args.repeat:
+            time.sleep(max(0.0, args.interval - (time.monotonic() - start)))
+    os.close(link.fd)
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
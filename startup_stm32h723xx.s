@@ -65,6 +65,43 @@ Reset_Handler:
 /* Call the clock system initialization function.*/
   bl  SystemInit
 
+/* Copy the FAST_CODE section from flash to ITCM */
+  ldr r0, =_sitcm
+  ldr r1, =_eitcm
+  ldr r2, =_siitcm
+  movs r3, #0
+  b LoopCopyItcm
+
+CopyItcm:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyItcm:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyItcm
+/* Make the copied code visible to instruction fetch */
+  dsb
+  isb
+
+/* Copy the FAST_DATA/FAST_CONST section from flash to DTCM */
+  ldr r0, =_sdtcm
+  ldr r1, =_edtcm
+  ldr r2, =_sidtcm
+  movs r3, #0
+  b LoopCopyDtcm
+
+CopyDtcm:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyDtcm:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyDtcm
+
 /* Copy the data segment initializers from flash to SRAM */
   ldr r0, =_sdata
   ldr r1, =_edata